@@ -0,0 +1,402 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2025 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+/**
+ * # CategoryCompat
+ *
+ * Extensions that only exist in sdl2-compat.
+ *
+ * SDL 2 Classic does not have any of these functions, so programs that
+ * might run against it should look them up at runtime with
+ * SDL_LoadFunction() instead of linking to them directly.
+ */
+
+#ifndef SDL_compat_h_
+#define SDL_compat_h_
+
+#include "SDL_stdinc.h"
+#include "SDL_events.h"
+#include "SDL_surface.h"
+#include "SDL_render.h"
+
+#include "begin_code.h"
+
+/* Set up for C function definitions, even when using C++ */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Drain up to `numevents` events from the event queue in one call.
+ *
+ * This pumps the event loop once, like SDL_PollEvent(), and then removes as
+ * many pending events as fit in `events`, in queue order. This is the same
+ * as calling SDL_PollEvent() in a loop, but avoids the per-event call
+ * overhead.
+ *
+ * \param events an array of at least `numevents` events to fill.
+ * \param numevents the maximum number of events to return.
+ * \returns the number of events stored in `events`, or -1 on error; call
+ *          SDL_GetError() for more information.
+ *
+ * \since This function is available since sdl2-compat 2.32.56.
+ *
+ * \sa SDL_PollEvent
+ * \sa SDL_PeepEvents
+ */
+extern DECLSPEC int SDLCALL SDL_CompatPollEvents(SDL_Event *events, int numevents);
+
+/**
+ * The number of buckets in SDL_CompatEventStats::latency.
+ *
+ * \since This macro is available since sdl2-compat 2.32.56.
+ */
+#define SDL_COMPAT_EVENT_LATENCY_BUCKETS 24
+
+/**
+ * The SDL_CompatEventStats::type of SDL3 events that have no SDL2 version.
+ *
+ * They are all dropped, and counted together under this type, after every
+ * ::SDL_EventType.
+ *
+ * \since This macro is available since sdl2-compat 2.32.56.
+ */
+#define SDL_COMPAT_EVENT_UNSUPPORTED 0xFFFFFFFFu
+
+/**
+ * Statistics on one event type passing through sdl2-compat.
+ *
+ * All times are in nanoseconds and summed over every event of this type.
+ *
+ * \since This struct is available since sdl2-compat 2.32.56.
+ *
+ * \sa SDL_CompatGetEventStats
+ */
+typedef struct SDL_CompatEventStats
+{
+    Uint32 type;        /**< the event type, an ::SDL_EventType or SDL_COMPAT_EVENT_UNSUPPORTED */
+    Uint32 padding;
+    Uint64 count;       /**< events of this type that were sent by SDL */
+    Uint64 dropped;     /**< events that never reached the queue because the event filter rejected them */
+    Uint64 coalesced;   /**< events that were merged into an older one still in the queue */
+    Uint64 delivered;   /**< events that the app took off the queue */
+    Uint64 bridge_ns;   /**< time spent turning these into SDL2 events */
+    Uint64 gesture_ns;  /**< part of bridge_ns spent on gesture recognition */
+    Uint64 dispatch_ns; /**< part of bridge_ns spent in the event filter and event watchers */
+    Uint64 latency[SDL_COMPAT_EVENT_LATENCY_BUCKETS]; /**< latency[i] counts delivered events that waited less than 2^i microseconds (the last bucket counts everything slower) */
+} SDL_CompatEventStats;
+
+/**
+ * Get statistics on the events that passed through sdl2-compat.
+ *
+ * Nothing is recorded unless the "SDL2_EVENT_STATS" hint is set to "1". If
+ * the "SDL2_EVENT_STATS_LOG_INTERVAL" hint is set to a number of
+ * milliseconds, the statistics are also logged that often, while the app
+ * takes events off the queue.
+ *
+ * Latency is measured from the time SDL timestamped the event to the time
+ * SDL_PollEvent(), SDL_WaitEvent() or SDL_PeepEvents() returned it.
+ *
+ * \param stats an array of `maxstats` entries to fill, sorted by event type,
+ *              may be NULL if `maxstats` is 0.
+ * \param maxstats the number of entries `stats` can hold.
+ * \returns the number of event types with statistics, which may be more
+ *          than `maxstats`, or -1 on error; call SDL_GetError() for more
+ *          information.
+ *
+ * \since This function is available since sdl2-compat 2.32.56.
+ *
+ * \sa SDL_CompatResetEventStats
+ */
+extern DECLSPEC int SDLCALL SDL_CompatGetEventStats(SDL_CompatEventStats *stats, int maxstats);
+
+/**
+ * Forget all event statistics collected so far.
+ *
+ * \since This function is available since sdl2-compat 2.32.56.
+ *
+ * \sa SDL_CompatGetEventStats
+ */
+extern DECLSPEC void SDLCALL SDL_CompatResetEventStats(void);
+
+/**
+ * Start writing every event the app takes off the queue to a trace file.
+ *
+ * Each event is stored with the nanosecond timestamp SDL gave it, so
+ * SDL_CompatStartEventReplay() can inject the same input later, with the
+ * same timing. This can also be turned on without changing the app by
+ * setting the "SDL2_EVENT_RECORD" hint (or environment variable) to a file
+ * name.
+ *
+ * Traces are written in the native byte order and event layout, so they
+ * can only be replayed by a build of sdl2-compat for the same platform.
+ * Events that refer to memory owned by SDL (SDL_SYSWMEVENT,
+ * SDL_TEXTEDITING_EXT, SDL_DROPFILE and SDL_DROPTEXT) are not recorded, and
+ * the data pointers of user events are recorded as NULL.
+ *
+ * Any recording already in progress is stopped first.
+ *
+ * \param file the file to create or overwrite.
+ * \returns 0 on success or -1 on error; call SDL_GetError() for more
+ *          information.
+ *
+ * \since This function is available since sdl2-compat 2.32.56.
+ *
+ * \sa SDL_CompatStopEventRecording
+ * \sa SDL_CompatStartEventReplay
+ */
+extern DECLSPEC int SDLCALL SDL_CompatStartEventRecording(const char *file);
+
+/**
+ * Stop recording events and close the trace file.
+ *
+ * \since This function is available since sdl2-compat 2.32.56.
+ *
+ * \sa SDL_CompatStartEventRecording
+ */
+extern DECLSPEC void SDLCALL SDL_CompatStopEventRecording(void);
+
+/**
+ * Start pushing the events from a trace file back onto the event queue.
+ *
+ * The events are pushed with SDL_PushEvent() from a background thread,
+ * either as fast as the app takes them off the queue, or spaced out like
+ * they were when they were recorded. Only one replay can run at a time.
+ *
+ * Window IDs and device instance IDs are replayed as recorded, so for
+ * faithful results, replay to the same program with the same windows and
+ * devices. No window or device is needed to replay the events, though, so
+ * this works under the dummy video driver.
+ *
+ * \param file a trace written by SDL_CompatStartEventRecording().
+ * \param realtime SDL_TRUE to reproduce the recorded timing, SDL_FALSE to
+ *                 push the events as fast as possible.
+ * \returns 0 on success or -1 on error; call SDL_GetError() for more
+ *          information.
+ *
+ * \since This function is available since sdl2-compat 2.32.56.
+ *
+ * \sa SDL_CompatIsEventReplayDone
+ * \sa SDL_CompatStopEventReplay
+ */
+extern DECLSPEC int SDLCALL SDL_CompatStartEventReplay(const char *file, SDL_bool realtime);
+
+/**
+ * Check whether a replay has pushed all of its events.
+ *
+ * \returns SDL_TRUE if the replay is done or none is running, SDL_FALSE
+ *          otherwise.
+ *
+ * \since This function is available since sdl2-compat 2.32.56.
+ *
+ * \sa SDL_CompatStartEventReplay
+ */
+extern DECLSPEC SDL_bool SDLCALL SDL_CompatIsEventReplayDone(void);
+
+/**
+ * Stop replaying events and wait for the replay thread to finish.
+ *
+ * This must be called to clean up a replay, even after it's done.
+ *
+ * \returns the number of events that were pushed.
+ *
+ * \since This function is available since sdl2-compat 2.32.56.
+ *
+ * \sa SDL_CompatStartEventReplay
+ */
+extern DECLSPEC int SDLCALL SDL_CompatStopEventReplay(void);
+
+/**
+ * Perform many fast blits from one surface to another in one call.
+ *
+ * This is the same as calling SDL_BlitSurface() once for each pair of
+ * rectangles, in order, but the surfaces are only checked and prepared once
+ * for the whole batch. Use this to draw many tiles or sprites from one atlas.
+ *
+ * Like with SDL_BlitSurface(), each destination rectangle is clipped and
+ * then updated to the area that was actually drawn, or set to an empty
+ * rectangle if nothing was drawn.
+ *
+ * \param src the SDL_Surface structure to be copied from.
+ * \param srcrects an array of `count` rectangles to be copied, or NULL to
+ *                 copy the entire surface each time.
+ * \param dst the SDL_Surface structure that is the blit target.
+ * \param dstrects an array of `count` rectangles, only their x and y are
+ *                 used as input.
+ * \param count the number of blits to perform.
+ * \returns 0 if every blit succeeded or -1 on error; call SDL_GetError() for
+ *          more information.
+ *
+ * \since This function is available since sdl2-compat 2.32.56.
+ *
+ * \sa SDL_BlitSurface
+ */
+extern DECLSPEC int SDLCALL SDL_CompatBlitSurfaces(SDL_Surface *src, const SDL_Rect *srcrects, SDL_Surface *dst, SDL_Rect *dstrects, int count);
+
+/**
+ * One textured rectangle to draw with SDL_CompatRenderSprites().
+ *
+ * \since This struct is available since sdl2-compat 2.32.56.
+ *
+ * \sa SDL_CompatRenderSprites
+ */
+typedef struct SDL_CompatSprite
+{
+    SDL_Texture *texture;   /**< the texture to draw from */
+    SDL_Rect srcrect;       /**< the area of the texture to draw, or all of it if w or h is 0 */
+    SDL_FRect dstrect;      /**< where to draw it on the rendering target */
+    double angle;           /**< degrees to rotate dstrect clockwise around its center */
+    SDL_RendererFlip flip;  /**< how to flip the texture */
+    SDL_Color color;        /**< the color and alpha to multiply the texture by */
+} SDL_CompatSprite;
+
+/**
+ * Draw many textured rectangles in as few draw calls as possible.
+ *
+ * This draws the same thing as calling SDL_RenderCopyExF() for each sprite,
+ * in order, except that each sprite is modulated by its own `color` instead
+ * of the texture's color and alpha mod. Sprites in a row with the same
+ * texture are drawn together with one call to the renderer, so sort them by
+ * texture when the drawing order allows it.
+ *
+ * Apps that can't be changed to use this function can set the
+ * "SDL2_RENDER_MERGE_COPIES" hint to "1" before creating a renderer with
+ * batching enabled. SDL_RenderCopy() and SDL_RenderCopyF() on that renderer
+ * then queue up the copies in a row with the same texture and draw them
+ * together when anything else is drawn or changed. Errors in queued copies
+ * are reported by the function that draws them.
+ *
+ * \param renderer the rendering context.
+ * \param sprites an array of `count` sprites to draw.
+ * \param count the number of sprites to draw.
+ * \returns 0 on success or -1 on error; call SDL_GetError() for more
+ *          information.
+ *
+ * \since This function is available since sdl2-compat 2.32.56.
+ *
+ * \sa SDL_RenderCopyExF
+ * \sa SDL_RenderGeometry
+ */
+extern DECLSPEC int SDLCALL SDL_CompatRenderSprites(SDL_Renderer *renderer, const SDL_CompatSprite *sprites, int count);
+
+/**
+ * Start writing every call to the main rendering functions to a trace file.
+ *
+ * Each call is stored with its arguments and the time it took, along with
+ * the renderer state it depends on. The calls that are recorded are
+ * SDL_RenderCopy(), SDL_RenderCopyEx(), SDL_RenderDrawPoint(),
+ * SDL_RenderDrawLine(), SDL_RenderDrawRect(), SDL_RenderFillRect(), their
+ * float and multiple item versions, SDL_RenderGeometry(),
+ * SDL_RenderGeometryRaw(), SDL_SetRenderTarget(), SDL_UpdateTexture(),
+ * SDL_UpdateYUVTexture(), SDL_UpdateNVTexture(), SDL_UnlockTexture(),
+ * SDL_CreateTextureFromSurface(), SDL_CompatRenderSprites(),
+ * SDL_RenderClear(), SDL_RenderReadPixels() and SDL_RenderPresent(). The
+ * pixels of each texture upload are stored once, in the record for that
+ * upload, and SDL_UnlockTexture() stores what was written to the area locked
+ * by SDL_LockTexture() or SDL_LockTextureToSurface(). This can also be turned
+ * on without changing the app by setting the "SDL2_RENDER_RECORD" hint (or
+ * environment variable) to a file name.
+ *
+ * Traces are written in the native byte order and layout, so they can only
+ * be replayed by a build of sdl2-compat for the same platform. Textures
+ * that were created or locked before the recording started, and YUV
+ * textures that were filled with SDL_LockTexture() or SDL_UpdateTexture(),
+ * are replayed without their contents.
+ *
+ * Any recording already in progress is stopped first.
+ *
+ * \param file the file to create or overwrite.
+ * \returns 0 on success or -1 on error; call SDL_GetError() for more
+ *          information.
+ *
+ * \since This function is available since sdl2-compat 2.32.56.
+ *
+ * \sa SDL_CompatStopRenderRecording
+ * \sa SDL_CompatReplayRenderRecording
+ */
+extern DECLSPEC int SDLCALL SDL_CompatStartRenderRecording(const char *file);
+
+/**
+ * Stop recording rendering calls and close the trace file.
+ *
+ * \since This function is available since sdl2-compat 2.32.56.
+ *
+ * \sa SDL_CompatStartRenderRecording
+ */
+extern DECLSPEC void SDLCALL SDL_CompatStopRenderRecording(void);
+
+/**
+ * Statistics on one rendering function in a replayed trace.
+ *
+ * All times are in nanoseconds and summed over every call to the function.
+ *
+ * \since This struct is available since sdl2-compat 2.32.56.
+ *
+ * \sa SDL_CompatReplayRenderRecording
+ */
+typedef struct SDL_CompatRenderCallStats
+{
+    const char *name;   /**< the function's name, like "SDL_RenderCopy" */
+    Uint64 count;       /**< calls to the function in the trace */
+    Uint64 bytes;       /**< space those calls take up in the trace */
+    Uint64 recorded_ns; /**< time the calls took when they were recorded */
+    Uint64 replayed_ns; /**< time the calls took when they were replayed */
+} SDL_CompatRenderCallStats;
+
+/**
+ * Replay a trace written by SDL_CompatStartRenderRecording() offscreen.
+ *
+ * The calls are made again, in order, against a software renderer that
+ * draws to a surface the size of the recorded output, so this needs no
+ * window and works under the dummy video driver. If the app used several
+ * renderers, all of them are replayed with that one renderer. Calls that
+ * use textures the replay couldn't create are skipped, and errors from the
+ * replayed calls are ignored. A trace that was cut short is replayed up to
+ * its last whole record.
+ *
+ * To see what was replayed, set the "SDL2_RENDER_REPLAY_FRAMES" hint (or
+ * environment variable) to a file name prefix, and each frame the replay
+ * presents is saved to "<prefix><n>.bmp", with n counting from 0.
+ *
+ * \param file a trace written by SDL_CompatStartRenderRecording().
+ * \param stats an array of `maxstats` entries to fill, one for each
+ *              function that was called, in a fixed order, may be NULL if
+ *              `maxstats` is 0.
+ * \param maxstats the number of entries `stats` can hold.
+ * \returns the number of functions with statistics, which may be more than
+ *          `maxstats`, or -1 on error; call SDL_GetError() for more
+ *          information.
+ *
+ * \since This function is available since sdl2-compat 2.32.56.
+ *
+ * \sa SDL_CompatStartRenderRecording
+ */
+extern DECLSPEC int SDLCALL SDL_CompatReplayRenderRecording(const char *file, SDL_CompatRenderCallStats *stats, int maxstats);
+
+/* Ends C function definitions when using C++ */
+#ifdef __cplusplus
+}
+#endif
+#include "close_code.h"
+
+#endif /* SDL_compat_h_ */
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -213,11 +213,10 @@ do { \
 #define PROP_WINDOW_EXPECTED_HEIGHT "sdl2-compat.window.expected_height"
 #define PROP_WINDOW_EXPECTED_SCALE "sdl2-compat.window.expected_scale"
 #define PROP_WINDOW_GAMMA_RAMP "sdl2-compat.window.gamma_ramp"
-#define PROP_RENDERER_BATCHING "sdl2-compat.renderer.batching"
-#define PROP_RENDERER_RELATIVE_SCALING "sdl2-compat.renderer.relative-scaling"
-#define PROP_RENDERER_INTEGER_SCALE "sdl2-compat.renderer.integer_scale"
+#define PROP_RENDERER_STATE "sdl2-compat.renderer.state"
 #define PROP_TEXTURE_SCALE_MODE "sdl2-compat.texture.scale_mode"
 #define PROP_SURFACE2 "sdl2-compat.surface2"
+#define PROP_SURFACE_DAMAGE "sdl2-compat.surface.damage"
 #define PROP_STREAM2 "sdl2-compat.stream2"
 
 #define PROP_TEXTURE_SCALE_MODE_UNAVAILABLE (-42)
@@ -1175,13 +1174,36 @@ BOOL WINAPI _DllMainCRTStartup(HANDLE dllhandle, DWORD reason, LPVOID reserved)
 
 /* Some SDL2 state we need to keep... */
 
+/* The SDL2 event watchers are published as an immutable, refcounted snapshot. SDL_AddEventWatch()
+   and SDL_DelEventWatch() build a new one (serialized by EventWatchListMutex) and swap it in. The
+   event filter only holds EventWatchersLock long enough to take a reference, so dispatching events
+   never waits on a mutex and watchers are free to add or remove watchers while they run. */
+typedef struct EventWatchSnapshot
+{
+    SDL_AtomicInt refcount;
+    int num_watchers;
+    EventFilterWrapperData watchers[1];  /* actually num_watchers long, newest first. */
+} EventWatchSnapshot;
+
 /* !!! FIXME: unify coding convention on the globals: some are MyVariableName and some are my_variable_name */
 static int timer_init = 0;
 static SDL2_EventFilter EventFilter2 = NULL;
 static void *EventFilterUserData2 = NULL;
 static SDL_mutex *EventWatchListMutex = NULL;
 static SDL2_LogOutputFunction LogOutputFunction2 = NULL;
-static EventFilterWrapperData *EventWatchers2 = NULL;
+static SDL_SpinLock EventWatchersLock = 0;
+static EventWatchSnapshot *EventWatchers2 = NULL;
+static SDL_mutex *PendingWindowEventsLock = NULL;
+static SDL_mutex *EventTraceLock = NULL;
+static SDL_mutex *RenderTraceLock = NULL;
+static SDL_mutex *ParallelLock = NULL;
+static SDL_mutex *ScaledBlitLock = NULL;
+static int SDL2_ParallelBlitThreads = 0;
+static int SDL2_ParallelBlitThreshold = 65536;
+static int SDL2_ParallelConvertThreads = 0;
+static int SDL2_ParallelConvertThreshold = 65536;
+static bool SDL2_WindowSurfaceDamage = false;
+static int SDL2_ShapeFastPaths = 2;
 static SDL2_bool relative_mouse_mode = SDL2_FALSE;
 static SDL_JoystickID *joystick_instance_list = NULL;
 static int num_joystick_instances = 0;
@@ -1231,6 +1253,24 @@ static SDL_JoystickID JoystickID2to3(SDL2_JoystickID id);
 static SDL2_JoystickID JoystickID3to2(SDL_JoystickID id);
 static SDL_SensorID SensorID2to3(SDL2_SensorID id);
 static SDL2_SensorID SensorID3to2(SDL_SensorID id);
+static void SDLCALL SDL2_EventStatsChanged(void *userdata, const char *name, const char *oldValue, const char *hint);
+static void SDLCALL SDL2_EventStatsLogIntervalChanged(void *userdata, const char *name, const char *oldValue, const char *hint);
+static void SDLCALL SDL2_EventRecordChanged(void *userdata, const char *name, const char *oldValue, const char *hint);
+static void SDLCALL SDL2_RenderRecordChanged(void *userdata, const char *name, const char *oldValue, const char *hint);
+static void SDLCALL SDL2_IMESupportExtendedTextChanged(void *userdata, const char *name, const char *oldValue, const char *hint);
+static void SDLCALL SDL2_CoalesceMouseMotionChanged(void *userdata, const char *name, const char *oldValue, const char *hint);
+static void FreeSurfaceLinks(void);
+static void FreeFormats(void);
+static void FreeRendererStates(void);
+static void FreeRenderTraceScratch(void);
+static void SDLCALL SDL2_ParallelThreadsChanged(void *userdata, const char *name, const char *oldValue, const char *hint);
+static void SDLCALL SDL2_ParallelThresholdChanged(void *userdata, const char *name, const char *oldValue, const char *hint);
+static void StopParallelWorkers(void);
+static void FreeConvertSurfaceCache(void);
+static void FreeScaledBlitCache(void);
+static void SDLCALL SDL2_WindowSurfaceDamageChanged(void *userdata, const char *name, const char *oldValue, const char *hint);
+static void SDLCALL SDL2_ShapeFastPathsChanged(void *userdata, const char *name, const char *oldValue, const char *hint);
+static void SetWindowSurfaceDamaged(SDL_Window *window);
 
 /* Functions! */
 
@@ -1251,10 +1291,37 @@ static void SDLCALL SDL2_EventLoggingChanged(void *userdata, const char *name, c
 static void SDL2Compat_QuitInternal(void)
 {
     SDL3_RemoveHintCallback("SDL2_EVENT_LOGGING", SDL2_EventLoggingChanged, NULL);
+    SDL3_RemoveHintCallback("SDL2_EVENT_STATS", SDL2_EventStatsChanged, NULL);
+    SDL3_RemoveHintCallback("SDL2_EVENT_STATS_LOG_INTERVAL", SDL2_EventStatsLogIntervalChanged, NULL);
+    SDL3_RemoveHintCallback("SDL2_EVENT_RECORD", SDL2_EventRecordChanged, NULL);
+    SDL3_RemoveHintCallback("SDL2_RENDER_RECORD", SDL2_RenderRecordChanged, NULL);
+    SDL3_RemoveHintCallback("SDL2_COALESCE_MOUSE_MOTION", SDL2_CoalesceMouseMotionChanged, NULL);
+    SDL3_RemoveHintCallback("SDL_IME_SUPPORT_EXTENDED_TEXT", SDL2_IMESupportExtendedTextChanged, NULL);
+    SDL3_RemoveHintCallback("SDL2_PARALLEL_BLIT", SDL2_ParallelThreadsChanged, &SDL2_ParallelBlitThreads);
+    SDL3_RemoveHintCallback("SDL2_PARALLEL_BLIT_THRESHOLD", SDL2_ParallelThresholdChanged, &SDL2_ParallelBlitThreshold);
+    SDL3_RemoveHintCallback("SDL2_PARALLEL_CONVERT", SDL2_ParallelThreadsChanged, &SDL2_ParallelConvertThreads);
+    SDL3_RemoveHintCallback("SDL2_PARALLEL_CONVERT_THRESHOLD", SDL2_ParallelThresholdChanged, &SDL2_ParallelConvertThreshold);
+    SDL3_RemoveHintCallback("SDL2_WINDOW_SURFACE_DAMAGE", SDL2_WindowSurfaceDamageChanged, NULL);
+    SDL3_RemoveHintCallback("SDL2_SHAPE_FAST_PATHS", SDL2_ShapeFastPathsChanged, NULL);
+    SDL_CompatStopEventRecording();
+    SDL_CompatStopRenderRecording();
+    FreeRenderTraceScratch();
     if (EventWatchListMutex) {
         SDL3_DestroyMutex(EventWatchListMutex);
         EventWatchListMutex = NULL;
     }
+    if (PendingWindowEventsLock) {
+        SDL3_DestroyMutex(PendingWindowEventsLock);
+        PendingWindowEventsLock = NULL;
+    }
+    if (EventTraceLock) {
+        SDL3_DestroyMutex(EventTraceLock);
+        EventTraceLock = NULL;
+    }
+    if (RenderTraceLock) {
+        SDL3_DestroyMutex(RenderTraceLock);
+        RenderTraceLock = NULL;
+    }
     if (sensor_lock) {
         SDL3_DestroyMutex(sensor_lock);
         sensor_lock = NULL;
@@ -1267,6 +1334,22 @@ static void SDL2Compat_QuitInternal(void)
         SDL3_DestroyMutex(AudioDeviceLock);
         AudioDeviceLock = NULL;
     }
+    if (ParallelLock) {
+        SDL3_LockMutex(ParallelLock);
+        StopParallelWorkers();
+        SDL3_UnlockMutex(ParallelLock);
+        SDL3_DestroyMutex(ParallelLock);
+        ParallelLock = NULL;
+    }
+    if (ScaledBlitLock) {
+        SDL3_DestroyMutex(ScaledBlitLock);
+        ScaledBlitLock = NULL;
+    }
+    FreeSurfaceLinks();
+    FreeFormats();
+    FreeRendererStates();
+    FreeConvertSurfaceCache();
+    FreeScaledBlitCache();
 }
 
 static void SDL2Compat_Quit(void)
@@ -1299,6 +1382,21 @@ SDL2Compat_InitOnStartupInternal(void)
         goto fail;
     }
 
+    PendingWindowEventsLock = SDL3_CreateMutex();
+    if (!PendingWindowEventsLock) {
+        goto fail;
+    }
+
+    EventTraceLock = SDL3_CreateMutex();
+    if (!EventTraceLock) {
+        goto fail;
+    }
+
+    RenderTraceLock = SDL3_CreateMutex();
+    if (!RenderTraceLock) {
+        goto fail;
+    }
+
     sensor_lock = SDL3_CreateMutex();
     if (sensor_lock == NULL) {
         goto fail;
@@ -1314,6 +1412,16 @@ SDL2Compat_InitOnStartupInternal(void)
         goto fail;
     }
 
+    ParallelLock = SDL3_CreateMutex();
+    if (!ParallelLock) {
+        goto fail;
+    }
+
+    ScaledBlitLock = SDL3_CreateMutex();
+    if (!ScaledBlitLock) {
+        goto fail;
+    }
+
     SDL3_SetHint("SDL_WINDOWS_DPI_AWARENESS", "unaware");
     SDL3_SetHint("SDL_BORDERLESS_WINDOWED_STYLE", "0");
     SDL3_SetHint("SDL_VIDEO_SYNC_WINDOW_OPERATIONS", "1");
@@ -1330,6 +1438,18 @@ SDL2Compat_InitOnStartupInternal(void)
     SDL3_SetHint(SDL_HINT_VIDEO_WAYLAND_SCALE_TO_DISPLAY, "1");
 
     SDL3_AddHintCallback("SDL2_EVENT_LOGGING", SDL2_EventLoggingChanged, NULL);
+    SDL3_AddHintCallback("SDL2_EVENT_STATS", SDL2_EventStatsChanged, NULL);
+    SDL3_AddHintCallback("SDL2_EVENT_STATS_LOG_INTERVAL", SDL2_EventStatsLogIntervalChanged, NULL);
+    SDL3_AddHintCallback("SDL2_EVENT_RECORD", SDL2_EventRecordChanged, NULL);
+    SDL3_AddHintCallback("SDL2_RENDER_RECORD", SDL2_RenderRecordChanged, NULL);
+    SDL3_AddHintCallback("SDL2_COALESCE_MOUSE_MOTION", SDL2_CoalesceMouseMotionChanged, NULL);
+    SDL3_AddHintCallback("SDL_IME_SUPPORT_EXTENDED_TEXT", SDL2_IMESupportExtendedTextChanged, NULL);
+    SDL3_AddHintCallback("SDL2_PARALLEL_BLIT", SDL2_ParallelThreadsChanged, &SDL2_ParallelBlitThreads);
+    SDL3_AddHintCallback("SDL2_PARALLEL_BLIT_THRESHOLD", SDL2_ParallelThresholdChanged, &SDL2_ParallelBlitThreshold);
+    SDL3_AddHintCallback("SDL2_PARALLEL_CONVERT", SDL2_ParallelThreadsChanged, &SDL2_ParallelConvertThreads);
+    SDL3_AddHintCallback("SDL2_PARALLEL_CONVERT_THRESHOLD", SDL2_ParallelThresholdChanged, &SDL2_ParallelConvertThreshold);
+    SDL3_AddHintCallback("SDL2_WINDOW_SURFACE_DAMAGE", SDL2_WindowSurfaceDamageChanged, NULL);
+    SDL3_AddHintCallback("SDL2_SHAPE_FAST_PATHS", SDL2_ShapeFastPathsChanged, NULL);
 
     SDL2Compat_InitLogPrefixes();
 
@@ -1987,6 +2107,470 @@ static void LogEvent2(const SDL2_Event *event)
 #undef uint
 }
 
+/**
+ * Event statistics as defined in the SDL2_EVENT_STATS hint:
+ *  - 0: (default) nothing is recorded
+ *  - 1: events are counted and timed, see SDL_CompatGetEventStats()
+ *
+ * If SDL2_EVENT_STATS_LOG_INTERVAL is also set, they are logged every that many milliseconds.
+ */
+#define EVENT_STATS_MAX_TYPES 256  /* must be a power of two. Comfortably more than the event types that exist. */
+
+static bool SDL2_EventStatsEnabled = false;
+static Uint64 SDL2_EventStatsLogIntervalNS = 0;
+static SDL_SpinLock EventStatsLock = 0;
+static SDL2_CompatEventStats EventStats[EVENT_STATS_MAX_TYPES];  /* open addressing, a type of 0 is an empty slot. */
+static int NumEventStats = 0;
+static Uint64 EventStatsLastLogNS = 0;
+
+static void SDLCALL SDL2_EventStatsChanged(void *userdata, const char *name, const char *oldValue, const char *hint)
+{
+    SDL2_EventStatsEnabled = (hint && *hint) ? (SDL_atoi(hint) > 0) : false;
+}
+
+static void SDLCALL SDL2_EventStatsLogIntervalChanged(void *userdata, const char *name, const char *oldValue, const char *hint)
+{
+    const int ms = (hint && *hint) ? SDL_atoi(hint) : 0;
+    SDL2_EventStatsLogIntervalNS = (ms > 0) ? SDL_MS_TO_NS(ms) : 0;
+}
+
+/* EventStatsLock must be held. Returns NULL if the table is full, which shouldn't happen in practice. */
+static SDL2_CompatEventStats *GetEventStats(Uint32 type)
+{
+    Uint32 slot = (type * 0x9E3779B1u) & (EVENT_STATS_MAX_TYPES - 1);
+    int i;
+
+    for (i = 0; i < EVENT_STATS_MAX_TYPES; i++) {
+        SDL2_CompatEventStats *stats = &EventStats[slot];
+        if (stats->type == type) {
+            return stats;
+        } else if (stats->type == 0) {
+            stats->type = type;
+            NumEventStats++;
+            return stats;
+        }
+        slot = (slot + 1) & (EVENT_STATS_MAX_TYPES - 1);
+    }
+    return NULL;
+}
+
+/* SDL3's top level window and display events reach the app as they are, but SDL2 apps only know the
+   SDL_WINDOWEVENT and SDL_DISPLAYEVENT we convert them into, and those are counted on their own. */
+static bool IsSDL3OnlyEventType(Uint32 type)
+{
+    return (type >= SDL_EVENT_DISPLAY_FIRST && type <= SDL_EVENT_DISPLAY_LAST) ||
+           (type >= SDL_EVENT_WINDOW_FIRST && type <= SDL_EVENT_WINDOW_LAST);
+}
+
+static void RecordEventBridged(Uint32 type, bool dropped, Uint64 bridge_ns, Uint64 gesture_ns, Uint64 dispatch_ns)
+{
+    SDL2_CompatEventStats *stats;
+
+    SDL3_LockSpinlock(&EventStatsLock);
+    stats = GetEventStats(type);
+    if (stats) {
+        stats->count++;
+        if (dropped) {
+            stats->dropped++;
+        }
+        stats->bridge_ns += bridge_ns;
+        stats->gesture_ns += gesture_ns;
+        stats->dispatch_ns += dispatch_ns;
+    }
+    SDL3_UnlockSpinlock(&EventStatsLock);
+}
+
+static void RecordEventCoalesced(Uint32 type)
+{
+    SDL2_CompatEventStats *stats;
+
+    SDL3_LockSpinlock(&EventStatsLock);
+    stats = GetEventStats(type);
+    if (stats) {
+        stats->coalesced++;
+    }
+    SDL3_UnlockSpinlock(&EventStatsLock);
+}
+
+static int SDLCALL CompareEventStats(const void *a, const void *b)
+{
+    const Uint32 atype = ((const SDL2_CompatEventStats *) a)->type;
+    const Uint32 btype = ((const SDL2_CompatEventStats *) b)->type;
+    return (atype < btype) ? -1 : (atype > btype) ? 1 : 0;
+}
+
+SDL_DECLSPEC int SDLCALL
+SDL_CompatGetEventStats(SDL2_CompatEventStats *stats, int maxstats)
+{
+    SDL2_CompatEventStats *sorted;
+    int retval;
+    int i, j;
+
+    if (maxstats < 0) {
+        SDL3_InvalidParamError("maxstats");
+        return -1;
+    } else if (!stats && (maxstats > 0)) {
+        SDL3_InvalidParamError("stats");
+        return -1;
+    }
+
+    /* copy out whatever is there and sort it without holding the spinlock. */
+    sorted = (SDL2_CompatEventStats *) SDL3_malloc(sizeof (EventStats));
+    if (!sorted) {
+        return -1;
+    }
+
+    SDL3_LockSpinlock(&EventStatsLock);
+    retval = NumEventStats;
+    for (i = 0, j = 0; i < EVENT_STATS_MAX_TYPES; i++) {
+        if (EventStats[i].type != 0) {
+            SDL3_copyp(&sorted[j++], &EventStats[i]);
+        }
+    }
+    SDL3_UnlockSpinlock(&EventStatsLock);
+
+    SDL3_qsort(sorted, retval, sizeof (*sorted), CompareEventStats);
+    if (maxstats > 0) {
+        SDL3_memcpy(stats, sorted, SDL_min(retval, maxstats) * sizeof (*stats));
+    }
+    SDL3_free(sorted);
+    return retval;
+}
+
+SDL_DECLSPEC void SDLCALL
+SDL_CompatResetEventStats(void)
+{
+    SDL3_LockSpinlock(&EventStatsLock);
+    SDL3_zeroa(EventStats);
+    NumEventStats = 0;
+    SDL3_UnlockSpinlock(&EventStatsLock);
+}
+
+/* upper bound of the latency bucket that `percent` of the deliveries fall into, in microseconds. */
+static Uint64 GetEventStatsLatencyPercentile(const SDL2_CompatEventStats *stats, int percent)
+{
+    const Uint64 target = ((stats->delivered * percent) + 99) / 100;
+    Uint64 total = 0;
+    int i;
+
+    for (i = 0; i < SDL2_COMPAT_EVENT_LATENCY_BUCKETS - 1; i++) {
+        total += stats->latency[i];
+        if (total >= target) {
+            break;
+        }
+    }
+    return ((Uint64) 1) << i;
+}
+
+static void LogEventStats(void)
+{
+    SDL2_CompatEventStats *stats;
+    int num_stats;
+    int i;
+
+    num_stats = SDL_CompatGetEventStats(NULL, 0);
+    if (num_stats <= 0) {
+        return;
+    }
+
+    stats = (SDL2_CompatEventStats *) SDL3_malloc(num_stats * sizeof (*stats));
+    if (!stats) {
+        return;
+    }
+
+    num_stats = SDL_min(SDL_CompatGetEventStats(stats, num_stats), num_stats);
+    for (i = 0; i < num_stats; i++) {
+        const SDL2_CompatEventStats *s = &stats[i];
+        const Uint64 bridged = SDL_max(s->count, 1);
+        SDL_Log("SDL2 EVENT STATS: type=0x%x count=%" SDL_PRIu64 " dropped=%" SDL_PRIu64 " coalesced=%" SDL_PRIu64 " delivered=%" SDL_PRIu64
+                " latency(p50<%" SDL_PRIu64 "us p99<%" SDL_PRIu64 "us) avg(bridge=%" SDL_PRIu64 "ns gesture=%" SDL_PRIu64 "ns dispatch=%" SDL_PRIu64 "ns)",
+                (unsigned int) s->type, s->count, s->dropped, s->coalesced, s->delivered,
+                GetEventStatsLatencyPercentile(s, 50), GetEventStatsLatencyPercentile(s, 99),
+                s->bridge_ns / bridged, s->gesture_ns / bridged, s->dispatch_ns / bridged);
+    }
+    SDL3_free(stats);
+}
+
+static void RecordEventsDelivered(const SDL_Event *events3, const SDL2_Event *events2, int numevents)
+{
+    const Uint64 now = SDL3_GetTicksNS();
+    const Uint64 log_interval = SDL2_EventStatsLogIntervalNS;
+    bool log_stats = false;
+    int i;
+
+    SDL3_LockSpinlock(&EventStatsLock);
+    for (i = 0; i < numevents; i++) {
+        SDL2_CompatEventStats *stats = IsSDL3OnlyEventType(events2[i].type) ? NULL : GetEventStats(events2[i].type);
+        if (stats) {
+            const Uint64 timestamp = events3[i].common.timestamp;
+            Uint64 us = (now > timestamp) ? SDL_NS_TO_US(now - timestamp) : 0;
+            int bucket = 0;
+            while (us && (bucket < SDL2_COMPAT_EVENT_LATENCY_BUCKETS - 1)) {
+                us >>= 1;
+                bucket++;
+            }
+            stats->delivered++;
+            stats->latency[bucket]++;
+        }
+    }
+    if (log_interval && ((now - EventStatsLastLogNS) >= log_interval)) {
+        EventStatsLastLogNS = now;
+        log_stats = true;
+    }
+    SDL3_UnlockSpinlock(&EventStatsLock);
+
+    if (log_stats) {
+        LogEventStats();
+    }
+}
+
+/* Event traces, see SDL_CompatStartEventRecording(). A trace is an EventTraceHeader followed by
+   one EventTraceRecord per delivered event, in native byte order and layout. */
+#define EVENT_TRACE_MAGIC "SDL2EVTR"
+#define EVENT_TRACE_VERSION 1
+
+typedef struct EventTraceHeader
+{
+    char magic[8];
+    Uint32 version;
+    Uint32 record_size;
+} EventTraceHeader;
+
+typedef struct EventTraceRecord
+{
+    Uint64 timestamp_ns;  /* when SDL3 timestamped the original event */
+    SDL2_Event event;
+} EventTraceRecord;
+
+typedef struct EventReplay
+{
+    SDL_IOStream *io;
+    bool realtime;
+    SDL_AtomicInt done;
+    SDL_AtomicInt quit;
+    int num_pushed;
+    SDL_Thread *thread;
+} EventReplay;
+
+static SDL_IOStream *EventTraceStream = NULL;  /* only changed with EventTraceLock held. */
+static EventReplay *EventReplayState = NULL;
+
+static SDL_Thread *SDL2_CreateThread(SDL_ThreadFunction fn, const char *name, void *userdata, SDL_FunctionPointer pfnBeginThread, SDL_FunctionPointer pfnEndThread);
+
+static void WriteEventTrace(const SDL_Event *events3, const SDL2_Event *events2, int numevents)
+{
+    EventTraceRecord record;
+    int i;
+
+    SDL3_LockMutex(EventTraceLock);
+    for (i = 0; EventTraceStream && (i < numevents); i++) {
+        /* the SDL2 event they were converted into is recorded, and replaying both would deliver it twice. */
+        if (IsSDL3OnlyEventType(events2[i].type)) {
+            continue;
+        }
+        switch (events2[i].type) {
+        /* these point to memory that won't exist at replay time. */
+        case SDL2_SYSWMEVENT:
+        case SDL2_TEXTEDITING_EXT:
+        case SDL_EVENT_DROP_FILE:
+        case SDL_EVENT_DROP_TEXT:
+        /* SDL pushes its own when the app polls. */
+        case SDL_EVENT_POLL_SENTINEL:
+            continue;
+        default:
+            break;
+        }
+
+        SDL3_zero(record);
+        record.timestamp_ns = events3[i].common.timestamp;
+        SDL3_copyp(&record.event, &events2[i]);
+        if (record.event.type >= SDL_EVENT_USER) {
+            record.event.user.data1 = NULL;
+            record.event.user.data2 = NULL;
+        }
+        if (SDL3_WriteIO(EventTraceStream, &record, sizeof (record)) != sizeof (record)) {
+            SDL3_CloseIO(EventTraceStream);  /* disk full or something, give up instead of writing a truncated trace. */
+            EventTraceStream = NULL;
+        }
+    }
+    SDL3_UnlockMutex(EventTraceLock);
+}
+
+/* Called with the SDL3 events the app just took off the queue, and their SDL2 versions. */
+static void EventsDelivered(const SDL_Event *events3, const SDL2_Event *events2, int numevents)
+{
+    if (SDL2_EventStatsEnabled) {
+        RecordEventsDelivered(events3, events2, numevents);
+    }
+    if (SDL3_GetAtomicPointer((void **)&EventTraceStream)) {
+        WriteEventTrace(events3, events2, numevents);
+    }
+}
+
+SDL_DECLSPEC int SDLCALL
+SDL_CompatStartEventRecording(const char *file)
+{
+    EventTraceHeader header;
+    SDL_IOStream *io;
+
+    if (!file) {
+        SDL3_InvalidParamError("file");
+        return -1;
+    }
+
+    io = SDL3_IOFromFile(file, "wb");
+    if (!io) {
+        return -1;
+    }
+
+    SDL3_zero(header);
+    SDL3_memcpy(header.magic, EVENT_TRACE_MAGIC, sizeof (header.magic));
+    header.version = EVENT_TRACE_VERSION;
+    header.record_size = (Uint32) sizeof (EventTraceRecord);
+    if (SDL3_WriteIO(io, &header, sizeof (header)) != sizeof (header)) {
+        SDL3_CloseIO(io);
+        return -1;
+    }
+
+    SDL_CompatStopEventRecording();
+    SDL3_LockMutex(EventTraceLock);
+    EventTraceStream = io;
+    SDL3_UnlockMutex(EventTraceLock);
+    return 0;
+}
+
+SDL_DECLSPEC void SDLCALL
+SDL_CompatStopEventRecording(void)
+{
+    SDL3_LockMutex(EventTraceLock);
+    if (EventTraceStream) {
+        SDL3_CloseIO(EventTraceStream);
+        EventTraceStream = NULL;
+    }
+    SDL3_UnlockMutex(EventTraceLock);
+}
+
+static void SDLCALL SDL2_EventRecordChanged(void *userdata, const char *name, const char *oldValue, const char *hint)
+{
+    if (hint && *hint) {
+        SDL_CompatStartEventRecording(hint);
+    } else {
+        SDL_CompatStopEventRecording();
+    }
+}
+
+static int SDLCALL EventReplayThread(void *data)
+{
+    EventReplay *replay = (EventReplay *) data;
+    EventTraceRecord record;
+    const Uint64 start_ns = SDL3_GetTicksNS();
+    Uint64 first_ns = 0;
+    bool first = true;
+
+    while (!SDL3_GetAtomicInt(&replay->quit) && (SDL3_ReadIO(replay->io, &record, sizeof (record)) == sizeof (record))) {
+        int rc;
+
+        if (replay->realtime) {
+            Uint64 when, now;
+            if (first) {
+                first_ns = record.timestamp_ns;
+                first = false;
+            }
+            when = start_ns + ((record.timestamp_ns > first_ns) ? (record.timestamp_ns - first_ns) : 0);
+            /* sleep in small steps so SDL_CompatStopEventReplay() doesn't have to wait for a long gap in the trace. */
+            while (!SDL3_GetAtomicInt(&replay->quit) && ((now = SDL3_GetTicksNS()) < when)) {
+                SDL3_DelayNS(SDL_min(when - now, SDL_MS_TO_NS(10)));
+            }
+        }
+
+        record.event.common.timestamp = 0;  /* let SDL timestamp it as it's pushed. */
+        while (((rc = SDL_PushEvent(&record.event)) < 0) && !SDL3_GetAtomicInt(&replay->quit)) {
+            SDL3_Delay(1);  /* the queue is full, wait for the app to catch up. */
+        }
+        if (rc == 1) {
+            replay->num_pushed++;
+        }
+    }
+
+    SDL3_SetAtomicInt(&replay->done, 1);
+    return 0;
+}
+
+SDL_DECLSPEC int SDLCALL
+SDL_CompatStartEventReplay(const char *file, SDL2_bool realtime)
+{
+    EventTraceHeader header;
+    EventReplay *replay;
+    SDL_IOStream *io;
+
+    if (!file) {
+        SDL3_InvalidParamError("file");
+        return -1;
+    } else if (EventReplayState) {
+        SDL3_SetError("An event replay is already running");
+        return -1;
+    }
+
+    io = SDL3_IOFromFile(file, "rb");
+    if (!io) {
+        return -1;
+    }
+
+    if ((SDL3_ReadIO(io, &header, sizeof (header)) != sizeof (header)) ||
+        (SDL3_memcmp(header.magic, EVENT_TRACE_MAGIC, sizeof (header.magic)) != 0)) {
+        SDL3_CloseIO(io);
+        SDL3_SetError("Not an sdl2-compat event trace");
+        return -1;
+    } else if ((header.version != EVENT_TRACE_VERSION) || (header.record_size != sizeof (EventTraceRecord))) {
+        SDL3_CloseIO(io);
+        SDL3_SetError("Event trace was recorded by an incompatible build");
+        return -1;
+    }
+
+    replay = (EventReplay *) SDL3_calloc(1, sizeof (*replay));
+    if (!replay) {
+        SDL3_CloseIO(io);
+        return -1;
+    }
+    replay->io = io;
+    replay->realtime = realtime ? true : false;
+
+    replay->thread = SDL2_CreateThread(EventReplayThread, "SDL2EventReplay", replay, NULL, NULL);
+    if (!replay->thread) {
+        SDL3_CloseIO(io);
+        SDL3_free(replay);
+        return -1;
+    }
+
+    EventReplayState = replay;
+    return 0;
+}
+
+SDL_DECLSPEC SDL2_bool SDLCALL
+SDL_CompatIsEventReplayDone(void)
+{
+    return (!EventReplayState || SDL3_GetAtomicInt(&EventReplayState->done)) ? SDL2_TRUE : SDL2_FALSE;
+}
+
+SDL_DECLSPEC int SDLCALL
+SDL_CompatStopEventReplay(void)
+{
+    EventReplay *replay = EventReplayState;
+    int retval;
+
+    if (!replay) {
+        return 0;
+    }
+
+    SDL3_SetAtomicInt(&replay->quit, 1);
+    SDL3_WaitThread(replay->thread, NULL);
+    SDL3_CloseIO(replay->io);
+    retval = replay->num_pushed;
+    SDL3_free(replay);
+    EventReplayState = NULL;
+    return retval;
+}
+
 static void UpdateGamepadButtonSwap(SDL_Gamepad *gamepad)
 {
     int i;
@@ -2190,47 +2774,298 @@ static SDL_AudioDeviceID AudioDeviceID3to2(SDL_AudioDeviceID id)
 
 static int GetIndexFromJoystickInstance(SDL_JoystickID jid);
 
-static SDL2_Event *Event3to2(const SDL_Event *event3, SDL2_Event *event2)
+/* Event3to2() and Event2to3() copy everything after the common header in one go and then fix up the
+   fields that changed. This is the list of fields the bulk copy is trusted with, and the build fails
+   if any of them moves or changes size in either version of the event. Fields that aren't listed are
+   converted explicitly. */
+#define SDL2COMPAT_CHECK_EVENT_FIELD(type2, field2, type3, field3) \
+    SDL_COMPILE_TIME_ASSERT(type2##_##field2, \
+        ((offsetof(type2, field2) - sizeof (SDL2_CommonEvent)) == (offsetof(type3, field3) - sizeof (SDL_CommonEvent))) && \
+        (sizeof (((type2 *) NULL)->field2) == sizeof (((type3 *) NULL)->field3)))
+
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_MouseMotionEvent, windowID, SDL_MouseMotionEvent, windowID);
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_MouseMotionEvent, which, SDL_MouseMotionEvent, which);
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_MouseMotionEvent, state, SDL_MouseMotionEvent, state);
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_MouseButtonEvent, windowID, SDL_MouseButtonEvent, windowID);
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_MouseButtonEvent, which, SDL_MouseButtonEvent, which);
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_MouseButtonEvent, button, SDL_MouseButtonEvent, button);
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_MouseButtonEvent, state, SDL_MouseButtonEvent, down);
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_MouseButtonEvent, clicks, SDL_MouseButtonEvent, clicks);
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_MouseWheelEvent, windowID, SDL_MouseWheelEvent, windowID);
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_MouseWheelEvent, which, SDL_MouseWheelEvent, which);
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_MouseWheelEvent, direction, SDL_MouseWheelEvent, direction);
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_JoyAxisEvent, axis, SDL_JoyAxisEvent, axis);
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_JoyAxisEvent, value, SDL_JoyAxisEvent, value);
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_JoyBallEvent, ball, SDL_JoyBallEvent, ball);
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_JoyBallEvent, xrel, SDL_JoyBallEvent, xrel);
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_JoyBallEvent, yrel, SDL_JoyBallEvent, yrel);
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_JoyHatEvent, hat, SDL_JoyHatEvent, hat);
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_JoyHatEvent, value, SDL_JoyHatEvent, value);
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_JoyButtonEvent, button, SDL_JoyButtonEvent, button);
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_JoyButtonEvent, state, SDL_JoyButtonEvent, down);
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_ControllerAxisEvent, axis, SDL_GamepadAxisEvent, axis);
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_ControllerAxisEvent, value, SDL_GamepadAxisEvent, value);
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_ControllerButtonEvent, button, SDL_GamepadButtonEvent, button);
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_ControllerButtonEvent, state, SDL_GamepadButtonEvent, down);
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_ControllerTouchpadEvent, touchpad, SDL_GamepadTouchpadEvent, touchpad);
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_ControllerTouchpadEvent, finger, SDL_GamepadTouchpadEvent, finger);
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_ControllerTouchpadEvent, x, SDL_GamepadTouchpadEvent, x);
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_ControllerTouchpadEvent, y, SDL_GamepadTouchpadEvent, y);
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_ControllerTouchpadEvent, pressure, SDL_GamepadTouchpadEvent, pressure);
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_ControllerSensorEvent, sensor, SDL_GamepadSensorEvent, sensor);
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_ControllerSensorEvent, data, SDL_GamepadSensorEvent, data);
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_SensorEvent, data, SDL_SensorEvent, data);
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_TouchFingerEvent, touchId, SDL_TouchFingerEvent, touchID);
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_TouchFingerEvent, fingerId, SDL_TouchFingerEvent, fingerID);
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_TouchFingerEvent, x, SDL_TouchFingerEvent, x);
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_TouchFingerEvent, y, SDL_TouchFingerEvent, y);
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_TouchFingerEvent, dx, SDL_TouchFingerEvent, dx);
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_TouchFingerEvent, dy, SDL_TouchFingerEvent, dy);
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_TouchFingerEvent, pressure, SDL_TouchFingerEvent, pressure);
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_TouchFingerEvent, windowID, SDL_TouchFingerEvent, windowID);
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_UserEvent, windowID, SDL_UserEvent, windowID);
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_UserEvent, code, SDL_UserEvent, code);
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_UserEvent, data1, SDL_UserEvent, data1);
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_UserEvent, data2, SDL_UserEvent, data2);
+SDL2COMPAT_CHECK_EVENT_FIELD(SDL2_AudioDeviceEvent, iscapture, SDL_AudioDeviceEvent, recording);
+
+#undef SDL2COMPAT_CHECK_EVENT_FIELD
+
+/* The view and draw state of a renderer, as written to render traces by TraceRendererState() */
+typedef struct RenderTraceState
+{
+    SDL_Rect viewport;
+    SDL_Rect clip;              /* empty if clipping is off */
+    float scale_x, scale_y;
+    Sint32 logical_w, logical_h;
+    Sint32 logical_mode;
+    Sint32 draw_blend_mode;
+    Uint8 draw_color[4];
+} RenderTraceState;
+
+/* Per-renderer sdl2-compat state, so draw calls don't need a property lookup each.
+ * Each block is owned by a PROP_RENDERER_STATE property of its renderer, whose cleanup removes and
+ * frees it, and the blocks are found through an open-addressed hash table keyed by the renderer.
+ */
+typedef struct RendererState
 {
     SDL_Renderer *renderer;
-    SDL_Event cvtevent3;
+    bool batching;              /* SDL_RENDER_BATCHING when the renderer was created */
+    bool relative_scaling;      /* SDL_MOUSE_RELATIVE_SCALING when the renderer was created */
+    bool integer_scale;         /* SDL_RenderSetIntegerScale() */
+    bool merge_copies;          /* SDL2_RENDER_MERGE_COPIES when the renderer was created, see SDL_RenderCopy() */
+    SDL_Texture *gamma_texture; /* owned by the renderer, see ApplyRenderGamma() */
+    void *scratch;              /* see GetRendererScratch() */
+    size_t scratch_size;
+    SDL_Texture *sprite_texture; /* see QueueSprite() */
+    SDL_Vertex *sprite_vertices;
+    int *sprite_indices;
+    int num_sprites;
+    int max_sprites;
+    Uint32 trace_generation;    /* RenderTraceGeneration when the renderer was last written to a render trace */
+    RenderTraceState trace_state; /* the state that was last written to the render trace */
+    SDL_Surface *damage_surface; /* the window surface a software renderer draws to, referenced, see SetRendererSurfaceDamaged() */
+} RendererState;
+
+static SDL_SpinLock RendererStatesLock = 0;
+static RendererState **RendererStates = NULL;  /* NULL for an empty slot */
+static int NumRendererStates = 0;
+static int MaxRendererStates = 0;  /* always 0 or a power of two */
+static SDL_AtomicInt NumMergingRenderers;  /* renderers with merge_copies set, so nothing else needs to look for queued copies */
+
+static int GetRendererStateHome(const SDL_Renderer *renderer)
+{
+    const Uint64 key = (Uint64)(uintptr_t)renderer;
+    return (int)(((key >> 4) * SDL_UINT64_C(0x9E3779B97F4A7C15)) >> 32) & (MaxRendererStates - 1);
+}
+
+/* Must be called with RendererStatesLock held and MaxRendererStates > 0 */
+static int FindRendererStateSlot(const SDL_Renderer *renderer)
+{
+    const int mask = MaxRendererStates - 1;
+    int i = GetRendererStateHome(renderer);
+
+    while (RendererStates[i] && RendererStates[i]->renderer != renderer) {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+/* Must be called with RendererStatesLock held */
+static bool GrowRendererStates(void)
+{
+    RendererState **oldstates = RendererStates;
+    const int oldmax = MaxRendererStates;
+    const int newmax = oldmax ? (oldmax * 2) : 8;
+    RendererState **states;
+    int i;
 
-    /* currently everything _mostly_ matches up between SDL2 and SDL3, but this might
-       drift more as SDL3 development continues. */
+    states = (RendererState **)SDL3_calloc(newmax, sizeof(*states));
+    if (!states) {
+        return false;
+    }
 
-    /* for now, the timestamp field has grown in size (and precision), everything after it is currently the same, minus padding at the end, so bump the fields down. */
-    event2->common.type = event3->type;
-    event2->common.timestamp = (Uint32) SDL_NS_TO_MS(event3->common.timestamp);
-    SDL3_memcpy((&event2->common) + 1, (&event3->common) + 1, sizeof (SDL2_Event) - sizeof (SDL2_CommonEvent));
-    /* mouse coords became floats in SDL3: */
-    switch (event3->type) {
-    case SDL_EVENT_KEY_DOWN:
-    case SDL_EVENT_KEY_UP:
-        event2->key.keysym.scancode = SDL3ScancodeToSDL2Scancode(event3->key.scancode);
-        event2->key.keysym.sym = SDL3KeycodeToSDL2Keycode(event3->key.scancode, event3->key.key);
-        event2->key.keysym.mod = event3->key.mod;
-        event2->key.state = event3->key.down;
-        event2->key.repeat = event3->key.repeat;
-        break;
-    case SDL_EVENT_TEXT_INPUT:
-        SDL3_strlcpy(event2->text.text, event3->text.text, sizeof(event2->text.text));
-        break;
-    case SDL_EVENT_TEXT_EDITING:
-        if (SDL3_GetHintBoolean("SDL_IME_SUPPORT_EXTENDED_TEXT", false) &&
-            SDL3_strlen(event3->edit.text) >= sizeof(event2->edit.text)) {
-            /* From events/SDL_keyboard.c::SDL_SendEditingText() of SDL2 */
-            event2->editExt.type = SDL2_TEXTEDITING_EXT;
-            event2->editExt.windowID = event3->edit.windowID;
-            event2->editExt.text = SDL3_strdup(event3->edit.text);
-            event2->editExt.start = event3->edit.start;
-            event2->editExt.length = event3->edit.length;
-        } else {
-            SDL3_strlcpy(event2->edit.text, event3->edit.text, sizeof(event2->edit.text));
-            event2->edit.start = event3->edit.start;
-            event2->edit.length = event3->edit.length;
+    RendererStates = states;
+    MaxRendererStates = newmax;
+    for (i = 0; i < oldmax; ++i) {
+        if (oldstates[i]) {
+            RendererStates[FindRendererStateSlot(oldstates[i]->renderer)] = oldstates[i];
         }
-        break;
-    case SDL_EVENT_DROP_FILE:
+    }
+    SDL3_free(oldstates);
+    return true;
+}
+
+static void SDLCALL CleanupRendererState(void *userdata, void *value)
+{
+    RendererState *state = (RendererState *)value;
+    int i, j, home;
+
+    SDL3_LockSpinlock(&RendererStatesLock);
+    if (NumRendererStates > 0) {
+        const int mask = MaxRendererStates - 1;
+        i = FindRendererStateSlot(state->renderer);
+        if (RendererStates[i] == state) {
+            /* Move later entries of the probe sequence back into the hole, so lookups don't need tombstones */
+            for (j = (i + 1) & mask; RendererStates[j]; j = (j + 1) & mask) {
+                home = GetRendererStateHome(RendererStates[j]->renderer);
+                if ((i <= j) ? (home <= i || home > j) : (home <= i && home > j)) {
+                    RendererStates[i] = RendererStates[j];
+                    i = j;
+                }
+            }
+            RendererStates[i] = NULL;
+            --NumRendererStates;
+        }
+    }
+    SDL3_UnlockSpinlock(&RendererStatesLock);
+    if (state->merge_copies) {
+        SDL3_AddAtomicInt(&NumMergingRenderers, -1);
+    }
+    SDL3_free(state->scratch);
+    SDL3_free(state->sprite_vertices);
+    SDL3_free(state->sprite_indices);
+    if (state->damage_surface) {
+        SDL3_DestroySurface(state->damage_surface);
+    }
+    SDL3_free(state);
+}
+
+static void FreeRendererStates(void)
+{
+    SDL3_LockSpinlock(&RendererStatesLock);
+    if (NumRendererStates == 0) {  /* otherwise a renderer outlived us, and its cleanup still needs the table */
+        SDL3_free(RendererStates);
+        RendererStates = NULL;
+        MaxRendererStates = 0;
+    }
+    SDL3_UnlockSpinlock(&RendererStatesLock);
+}
+
+/* Returns NULL if the renderer has no state yet and `create` is false, or if it couldn't be created */
+static RendererState *GetRendererState(SDL_Renderer *renderer, bool create)
+{
+    RendererState *state = NULL;
+    bool result = true;
+    int i;
+
+    if (!renderer) {
+        return NULL;
+    }
+
+    SDL3_LockSpinlock(&RendererStatesLock);
+    if (NumRendererStates > 0) {
+        state = RendererStates[FindRendererStateSlot(renderer)];
+    }
+    SDL3_UnlockSpinlock(&RendererStatesLock);
+
+    if (state || !create) {
+        return state;
+    }
+
+    state = (RendererState *)SDL3_calloc(1, sizeof(*state));
+    if (!state) {
+        return NULL;
+    }
+    state->renderer = renderer;
+    state->relative_scaling = true;
+
+    SDL3_LockSpinlock(&RendererStatesLock);
+    if ((NumRendererStates + 1) * 2 > MaxRendererStates) {
+        result = GrowRendererStates();
+    }
+    if (result) {
+        i = FindRendererStateSlot(renderer);
+        if (RendererStates[i]) {
+            result = false;  /* another thread created it in the meantime */
+        } else {
+            RendererStates[i] = state;
+            ++NumRendererStates;
+        }
+    }
+    SDL3_UnlockSpinlock(&RendererStatesLock);
+
+    if (!result) {
+        SDL3_free(state);
+        return GetRendererState(renderer, false);
+    }
+
+    /* If this fails, the cleanup runs right away and frees the state again */
+    if (!SDL3_SetPointerPropertyWithCleanup(SDL3_GetRendererProperties(renderer), PROP_RENDERER_STATE, state, CleanupRendererState, NULL)) {
+        return NULL;
+    }
+    return state;
+}
+
+/* Cached SDL_IME_SUPPORT_EXTENDED_TEXT, so IME events don't need a hint lookup each. */
+static bool SDL2_IMESupportExtendedText = false;
+
+static void SDLCALL SDL2_IMESupportExtendedTextChanged(void *userdata, const char *name, const char *oldValue, const char *hint)
+{
+    SDL2_IMESupportExtendedText = (hint && *hint) ? !(*hint == '0' || SDL3_strcasecmp(hint, "false") == 0) : false;
+}
+
+static SDL2_Event *Event3to2(const SDL_Event *event3, SDL2_Event *event2)
+{
+    SDL_Renderer *renderer;
+    SDL_Event cvtevent3;
+
+    /* currently everything _mostly_ matches up between SDL2 and SDL3, but this might
+       drift more as SDL3 development continues. */
+
+    /* for now, the timestamp field has grown in size (and precision), everything after it is currently the same, minus padding at the end, so bump the fields down. */
+    event2->common.type = event3->type;
+    event2->common.timestamp = (Uint32) SDL_NS_TO_MS(event3->common.timestamp);
+    SDL3_memcpy((&event2->common) + 1, (&event3->common) + 1, sizeof (SDL2_Event) - sizeof (SDL2_CommonEvent));
+    /* mouse coords became floats in SDL3: */
+    switch (event3->type) {
+    case SDL_EVENT_KEY_DOWN:
+    case SDL_EVENT_KEY_UP:
+        event2->key.keysym.scancode = SDL3ScancodeToSDL2Scancode(event3->key.scancode);
+        event2->key.keysym.sym = SDL3KeycodeToSDL2Keycode(event3->key.scancode, event3->key.key);
+        event2->key.keysym.mod = event3->key.mod;
+        event2->key.state = event3->key.down;
+        event2->key.repeat = event3->key.repeat;
+        break;
+    case SDL_EVENT_TEXT_INPUT:
+        SDL3_strlcpy(event2->text.text, event3->text.text, sizeof(event2->text.text));
+        break;
+    case SDL_EVENT_TEXT_EDITING:
+        if (SDL2_IMESupportExtendedText &&
+            SDL3_strlen(event3->edit.text) >= sizeof(event2->edit.text)) {
+            /* From events/SDL_keyboard.c::SDL_SendEditingText() of SDL2 */
+            event2->editExt.type = SDL2_TEXTEDITING_EXT;
+            event2->editExt.windowID = event3->edit.windowID;
+            event2->editExt.text = SDL3_strdup(event3->edit.text);
+            event2->editExt.start = event3->edit.start;
+            event2->editExt.length = event3->edit.length;
+        } else {
+            SDL3_strlcpy(event2->edit.text, event3->edit.text, sizeof(event2->edit.text));
+            event2->edit.start = event3->edit.start;
+            event2->edit.length = event3->edit.length;
+        }
+        break;
+    case SDL_EVENT_DROP_FILE:
     case SDL_EVENT_DROP_TEXT:
         event2->drop.file = SDL3_strdup(event3->drop.data);
         SDL_FALLTHROUGH;
@@ -2242,11 +3077,13 @@ static SDL2_Event *Event3to2(const SDL_Event *event3, SDL2_Event *event2)
         renderer = SDL3_GetRenderer(SDL3_GetWindowFromID(event3->motion.windowID));
         if (renderer) {
             SDL_RendererLogicalPresentation mode = SDL_LOGICAL_PRESENTATION_DISABLED;
+            const RendererState *state;
             SDL3_GetRenderLogicalPresentation(renderer, NULL, NULL, &mode);
             if (mode != SDL_LOGICAL_PRESENTATION_DISABLED) {
                 SDL3_memcpy(&cvtevent3, event3, sizeof (SDL_Event));
                 SDL3_ConvertEventToRenderCoordinates(renderer, &cvtevent3);
-                if (!SDL3_GetBooleanProperty(SDL3_GetRendererProperties(renderer), PROP_RENDERER_RELATIVE_SCALING, true)) {
+                state = GetRendererState(renderer, false);
+                if (state && !state->relative_scaling) {
                     /* Undo the relative scaling that SDL_ConvertEventToRenderCoordinates() performed */
                     cvtevent3.motion.xrel = event3->motion.xrel;
                     cvtevent3.motion.yrel = event3->motion.yrel;
@@ -2432,6 +3269,7 @@ static SDL_Event *Event2to3(const SDL2_Event *event2, SDL_Event *event3)
     /* for now, the timestamp field has grown in size (and precision), everything after it is currently the same, minus padding at the end, so bump the fields down. */
     event3->common.type = event2->type;
     event3->common.timestamp = (Uint64) SDL_MS_TO_NS(event2->common.timestamp);
+    event3->common.reserved = 0;  /* we use this to tag coalesced mouse motion. */
     SDL3_memcpy((&event3->common) + 1, (&event2->common) + 1, sizeof (SDL2_Event) - sizeof (SDL2_CommonEvent));
     /* mouse coords became floats in SDL3: */
     switch (event2->type) {
@@ -2618,3812 +3456,8871 @@ WindowEventType3To2(Uint32 event_type3)
     }
 }
 
-typedef struct RemovePendingSizeChangedAndResizedEvents_Data
+/* Moves, exposures and size changes are superseded by newer SDL2 window events of the same kind.
+   Instead of scanning the whole event queue to remove the old one whenever a new one arrives, we
+   remember which of these are still queued for each window: a newer event just updates the queued
+   one's data, and the queued event picks up the latest data when it's converted back to SDL2. */
+typedef enum PendingWindowEventKind
 {
-    const SDL2_Event *new_event;
-    bool saw_resized;
-} RemovePendingSizeChangedAndResizedEvents_Data;
+    PENDING_WINDOWEVENT_RESIZED,
+    PENDING_WINDOWEVENT_SIZE_CHANGED,
+    PENDING_WINDOWEVENT_MOVED,
+    PENDING_WINDOWEVENT_EXPOSED,
+    PENDING_WINDOWEVENT_MAX
+} PendingWindowEventKind;
 
-static int SDLCALL
-RemovePendingSizeChangedAndResizedEvents(void *userdata, SDL2_Event *event)
+/* A queued window event we're tracking has this in padding1, its kind in padding2 and its serial in padding3. */
+#define PENDING_WINDOWEVENT_MARKER 0xC5
+
+typedef struct PendingWindowEvent
 {
-    RemovePendingSizeChangedAndResizedEvents_Data *resizedata = (RemovePendingSizeChangedAndResizedEvents_Data *)userdata;
-    const SDL2_Event *new_event = resizedata->new_event;
+    bool pending;
+    Uint8 serial;
+    Uint32 timestamp;
+    Sint32 data1;
+    Sint32 data2;
+} PendingWindowEvent;
 
-    if (event->type == SDL2_WINDOWEVENT &&
-        (event->window.event == SDL_WINDOWEVENT_SIZE_CHANGED ||
-         event->window.event == SDL_WINDOWEVENT_RESIZED) &&
-        event->window.windowID == new_event->window.windowID) {
+typedef struct PendingWindowEvents
+{
+    SDL_WindowID windowID;
+    PendingWindowEvent events[PENDING_WINDOWEVENT_MAX];
+} PendingWindowEvents;
 
-        if (event->window.event == SDL_WINDOWEVENT_RESIZED) {
-            resizedata->saw_resized = true;
-        }
+static PendingWindowEvents *PendingWindowEventsList = NULL;
+static int NumPendingWindowEvents = 0;
 
-        /* We're about to post a new size event, drop the old one */
-        return 0;
+static int GetPendingWindowEventKind(Uint8 event)
+{
+    switch (event) {
+    case SDL_WINDOWEVENT_RESIZED:
+        return PENDING_WINDOWEVENT_RESIZED;
+    case SDL_WINDOWEVENT_SIZE_CHANGED:
+        return PENDING_WINDOWEVENT_SIZE_CHANGED;
+    case SDL_WINDOWEVENT_MOVED:
+        return PENDING_WINDOWEVENT_MOVED;
+    case SDL_WINDOWEVENT_EXPOSED:
+        return PENDING_WINDOWEVENT_EXPOSED;
+    default:
+        return -1;
     }
-    return 1;
 }
 
-static int SDLCALL
-RemoveSupercededWindowEvents(void *userdata, SDL2_Event *event)
+/* PendingWindowEventsLock must be held. */
+static PendingWindowEvents *FindPendingWindowEvents(SDL_WindowID windowID, bool create)
 {
-    SDL2_Event *new_event = (SDL2_Event *)userdata;
+    PendingWindowEvents *entry;
+    int i;
 
-    if (event->type == SDL2_WINDOWEVENT &&
-        event->window.event == new_event->window.event &&
-        event->window.windowID == new_event->window.windowID) {
-        /* We're about to post a new move event, drop the old one */
-        return 0;
+    for (i = 0; i < NumPendingWindowEvents; i++) {
+        if (PendingWindowEventsList[i].windowID == windowID) {
+            return &PendingWindowEventsList[i];
+        }
     }
-    return 1;
-}
 
-#define SDL_PROP_SENSOR_TIMESTAMP "sdl2-compat.sensor.timestamp"
+    if (!create) {
+        return NULL;
+    }
 
-#define SDL_PROP_GAMEPAD_UNKNOWN_TIMESTAMP "sdl2-compat.gamepad.timestamp.unknown"
-#define SDL_PROP_GAMEPAD_ACCEL_TIMESTAMP "sdl2-compat.gamepad.timestamp.accel"
-#define SDL_PROP_GAMEPAD_GYRO_TIMESTAMP "sdl2-compat.gamepad.timestamp.gyro"
-#define SDL_PROP_GAMEPAD_ACCEL_L_TIMESTAMP "sdl2-compat.gamepad.timestamp.accel_l"
-#define SDL_PROP_GAMEPAD_GYRO_L_TIMESTAMP "sdl2-compat.gamepad.timestamp.gyro_l"
-#define SDL_PROP_GAMEPAD_ACCEL_R_TIMESTAMP "sdl2-compat.gamepad.timestamp.accel_r"
-#define SDL_PROP_GAMEPAD_GYRO_R_TIMESTAMP "sdl2-compat.gamepad.timestamp.gyro_r"
+    entry = (PendingWindowEvents *) SDL3_realloc(PendingWindowEventsList, (NumPendingWindowEvents + 1) * sizeof (*entry));
+    if (!entry) {
+        return NULL;
+    }
+    PendingWindowEventsList = entry;
+    entry = &PendingWindowEventsList[NumPendingWindowEvents++];
+    SDL3_zerop(entry);
+    entry->windowID = windowID;
+    return entry;
+}
 
-static const char *GetGamepadSensorTimestampPropertyName(SDL_SensorType type)
+static bool IsPendingWindowEvent(SDL_WindowID windowID, int kind)
 {
-    switch (type)
-    {
-        case SDL_SENSOR_UNKNOWN:
-            return SDL_PROP_GAMEPAD_UNKNOWN_TIMESTAMP;
-        case SDL_SENSOR_ACCEL:
-            return SDL_PROP_GAMEPAD_ACCEL_TIMESTAMP;
-        case SDL_SENSOR_GYRO:
-            return SDL_PROP_GAMEPAD_GYRO_TIMESTAMP;
-        case SDL_SENSOR_ACCEL_L:
-            return SDL_PROP_GAMEPAD_ACCEL_L_TIMESTAMP;
-        case SDL_SENSOR_GYRO_L:
-            return SDL_PROP_GAMEPAD_GYRO_L_TIMESTAMP;
-        case SDL_SENSOR_ACCEL_R:
-            return SDL_PROP_GAMEPAD_ACCEL_R_TIMESTAMP;
-        case SDL_SENSOR_GYRO_R:
-            return SDL_PROP_GAMEPAD_GYRO_R_TIMESTAMP;
-        default:
-            return NULL;
+    const PendingWindowEvents *entry;
+    bool retval = false;
+
+    SDL3_LockMutex(PendingWindowEventsLock);
+    entry = FindPendingWindowEvents(windowID, false);
+    if (entry) {
+        retval = entry->events[kind].pending;
     }
+    SDL3_UnlockMutex(PendingWindowEventsLock);
+    return retval;
 }
 
+typedef struct RemovePendingWindowEvent_Data
+{
+    SDL_WindowID windowID;
+    Uint8 kind;
+    Uint8 serial;
+} RemovePendingWindowEvent_Data;
+
 static bool SDLCALL
-EventFilter3to2(void *userdata, SDL_Event *event3)
+RemovePendingWindowEventFilter(void *userdata, SDL_Event *event3)
 {
-    SDL2_Event event2;  /* note that event filters do not receive events as const! So we have to convert or copy it for each one! */
-    bool post_event = true;
+    const RemovePendingWindowEvent_Data *data = (const RemovePendingWindowEvent_Data *)userdata;
+    SDL2_Event event2;
 
-    /* Drop SDL3 events which have no SDL2 equivalent and may incorrectly overlap with SDL2 event numbers. */
-    switch (event3->type) {
-        case SDL_EVENT_KEYBOARD_ADDED: /* Overlaps with SDL_TEXTEDITING_EXT */
-        case SDL_EVENT_KEYBOARD_REMOVED:
-            return false;
+    if (event3->type != SDL2_WINDOWEVENT) {
+        return true;
     }
 
-    GestureProcessEvent(event3);  /* this might need to generate new gesture events from touch input. */
-
-    switch (event3->type) {
-        /* Ensure joystick and haptic IDs are updated before calling Event3to2() */
-        case SDL_EVENT_JOYSTICK_ADDED:
-        case SDL_EVENT_GAMEPAD_ADDED:
-        case SDL_EVENT_GAMEPAD_REMOVED:
-        case SDL_EVENT_JOYSTICK_REMOVED:
-            SDL_NumJoysticks(); /* Refresh */
-            SDL_NumHaptics(); /* Refresh */
-            break;
+    /* match the exact tracked event, without resolving it. */
+    Event3to2(event3, &event2);
+    return !(event2.window.windowID == data->windowID &&
+             event2.window.padding1 == PENDING_WINDOWEVENT_MARKER &&
+             event2.window.padding2 == data->kind &&
+             event2.window.padding3 == data->serial);
+}
 
-        case SDL_EVENT_AUDIO_DEVICE_ADDED:
-        case SDL_EVENT_AUDIO_DEVICE_REMOVED:
-            SDL_GetNumAudioDevices(event3->adevice.recording ? SDL2_TRUE : SDL2_FALSE); /* Refresh */
-            break;
+/* Drop a still-queued event, when the newer one has to be queued after something else instead.
+   This walks the queue, but only happens for size changes the app didn't ask for. */
+static void RemovePendingWindowEvent(SDL_WindowID windowID, int kind)
+{
+    PendingWindowEvents *entry;
+    RemovePendingWindowEvent_Data data;
+    bool queued = false;
 
-        /* Save the timestamp for the most recent sensor values */
-        case SDL_EVENT_SENSOR_UPDATE:
-            SDL3_SetNumberProperty(SDL3_GetSensorProperties(SDL3_GetSensorFromID(event3->sensor.which)),
-                                   SDL_PROP_SENSOR_TIMESTAMP,
-                                   SDL_NS_TO_US(event3->sensor.sensor_timestamp));
-            break;
-        case SDL_EVENT_GAMEPAD_SENSOR_UPDATE:
-            SDL3_SetNumberProperty(SDL3_GetGamepadProperties(SDL3_GetGamepadFromID(event3->gsensor.which)),
-                                   GetGamepadSensorTimestampPropertyName((SDL_SensorType)event3->gsensor.sensor),
-                                   SDL_NS_TO_US(event3->gsensor.sensor_timestamp));
-            break;
+    SDL3_LockMutex(PendingWindowEventsLock);
+    entry = FindPendingWindowEvents(windowID, false);
+    if (entry && entry->events[kind].pending) {
+        entry->events[kind].pending = false;
+        data.windowID = windowID;
+        data.kind = (Uint8) kind;
+        data.serial = entry->events[kind].serial;
+        queued = true;
     }
+    SDL3_UnlockMutex(PendingWindowEventsLock);
 
-    if (SDL2_EventLoggingVerbosity > 0) {
-        LogEvent2(Event3to2(event3, &event2));
+    if (queued) {
+        SDL3_FilterEvents(RemovePendingWindowEventFilter, &data);
     }
+}
 
-    if (EventFilter2) {
-        post_event = !!EventFilter2(EventFilterUserData2, Event3to2(event3, &event2));
-    }
+/* Called on every queued event converted to SDL2, to give a tracked window event the latest data for it.
+   If `claim` is true, the event is leaving the queue and newer events need to be queued again. */
+static SDL2_Event *ResolvePendingWindowEvent(SDL2_Event *event2, bool claim)
+{
+    const int kind = event2->window.padding2;
+    PendingWindowEvents *entry;
 
-    if (post_event && EventWatchers2 != NULL) {
-        EventFilterWrapperData *i;
-        SDL3_LockMutex(EventWatchListMutex);
-        for (i = EventWatchers2; i != NULL; i = i->next) {
-            i->filter2(i->userdata, Event3to2(event3, &event2));
-        }
-        SDL3_UnlockMutex(EventWatchListMutex);
+    if ((event2->type != SDL2_WINDOWEVENT) || (event2->window.padding1 != PENDING_WINDOWEVENT_MARKER)) {
+        return event2;
     }
 
-    /* push new events when we need to convert something, like toplevel SDL3 events generating the SDL2 SDL_WINDOWEVENT. */
-
-    switch (event3->type) {
-        /* display events moved to the top level in SDL3. */
-        case SDL_EVENT_DISPLAY_ORIENTATION:
-        case SDL_EVENT_DISPLAY_ADDED:
-        case SDL_EVENT_DISPLAY_REMOVED:
-            if (SDL3_EventEnabled(SDL2_DISPLAYEVENT)) {
-                event2.display.type = SDL2_DISPLAYEVENT;
-                event2.display.timestamp = (Uint32) SDL_NS_TO_MS(event3->display.timestamp);
-                event2.display.display = Display_IDToIndex(event3->display.displayID);
-                event2.display.event = (Uint8) ((event3->type - ((Uint32) SDL_EVENT_DISPLAY_ORIENTATION)) + 1);
-                event2.display.padding1 = 0;
-                event2.display.padding2 = 0;
-                event2.display.padding3 = 0;
-                event2.display.data1 = event3->display.data1;
-                SDL_PushEvent(&event2);
+    if (kind < PENDING_WINDOWEVENT_MAX) {
+        SDL3_LockMutex(PendingWindowEventsLock);
+        entry = FindPendingWindowEvents(event2->window.windowID, false);
+        if (entry) {
+            PendingWindowEvent *pending = &entry->events[kind];
+            if (pending->pending && (pending->serial == event2->window.padding3)) {
+                event2->window.timestamp = pending->timestamp;
+                event2->window.data1 = pending->data1;
+                event2->window.data2 = pending->data2;
+                if (claim) {
+                    pending->pending = false;
+                }
             }
-            break;
+        }
+        SDL3_UnlockMutex(PendingWindowEventsLock);
+    }
 
-        /* window events moved to the top level in SDL3. */
-        case SDL_EVENT_WINDOW_SHOWN:
-        case SDL_EVENT_WINDOW_HIDDEN:
-        case SDL_EVENT_WINDOW_EXPOSED:
-        case SDL_EVENT_WINDOW_MOVED:
-        case SDL_EVENT_WINDOW_RESIZED:
-        case SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED:
-        case SDL_EVENT_WINDOW_MINIMIZED:
-        case SDL_EVENT_WINDOW_MAXIMIZED:
-        case SDL_EVENT_WINDOW_RESTORED:
-        case SDL_EVENT_WINDOW_MOUSE_ENTER:
-        case SDL_EVENT_WINDOW_MOUSE_LEAVE:
-        case SDL_EVENT_WINDOW_FOCUS_GAINED:
-        case SDL_EVENT_WINDOW_FOCUS_LOST:
-        case SDL_EVENT_WINDOW_CLOSE_REQUESTED:
-        case SDL_EVENT_WINDOW_HIT_TEST:
-        case SDL_EVENT_WINDOW_ICCPROF_CHANGED:
-        case SDL_EVENT_WINDOW_DISPLAY_CHANGED:
-            if (SDL3_EventEnabled(SDL2_WINDOWEVENT)) {
-                if (event3->type == SDL_EVENT_WINDOW_RESIZED) {
-                    /* Do resize handling based on SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED, which always fires */
-                    break;
-                }
+    /* the app never sees our bookkeeping. */
+    event2->window.padding1 = 0;
+    event2->window.padding2 = 0;
+    event2->window.padding3 = 0;
+    return event2;
+}
 
-                event2.window.type = SDL2_WINDOWEVENT;
-                event2.window.timestamp = (Uint32) SDL_NS_TO_MS(event3->window.timestamp);
-                event2.window.windowID = event3->window.windowID;
-                event2.window.event = WindowEventType3To2(event3->type);
-                event2.window.padding1 = 0;
-                event2.window.padding2 = 0;
-                event2.window.padding3 = 0;
-                event2.window.data1 = event3->window.data1;
-                event2.window.data2 = event3->window.data2;
+/* Fold event2 into the queued event of the same kind, if there still is one. */
+static bool UpdatePendingWindowEvent(const SDL2_Event *event2, int kind)
+{
+    PendingWindowEvents *entry;
+    bool retval = false;
 
-                if (event2.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
-                    SDL_Window *window = SDL3_GetWindowFromID(event3->window.windowID);
-                    if (!window) {
-                        break;
-                    }
+    SDL3_LockMutex(PendingWindowEventsLock);
+    entry = FindPendingWindowEvents(event2->window.windowID, false);
+    if (entry && entry->events[kind].pending) {
+        PendingWindowEvent *pending = &entry->events[kind];
+        pending->timestamp = event2->window.timestamp;
+        pending->data1 = event2->window.data1;
+        pending->data2 = event2->window.data2;
+        retval = true;
+    }
+    SDL3_UnlockMutex(PendingWindowEventsLock);
+    return retval;
+}
 
-                    /* The size changed event has the window size, not pixel size */
-                    SDL3_GetWindowSize(window, &event2.window.data1, &event2.window.data2);
+static void PushPendingWindowEvent(const SDL2_Event *event2, int kind)
+{
+    PendingWindowEvents *entry;
+    SDL2_Event queued2;
+    bool tracked = false;
+
+    SDL3_copyp(&queued2, event2);
+
+    SDL3_LockMutex(PendingWindowEventsLock);
+    entry = FindPendingWindowEvents(event2->window.windowID, true);
+    if (entry) {
+        PendingWindowEvent *pending = &entry->events[kind];
+        pending->pending = true;
+        pending->serial++;
+        pending->timestamp = event2->window.timestamp;
+        pending->data1 = event2->window.data1;
+        pending->data2 = event2->window.data2;
+        queued2.window.padding1 = PENDING_WINDOWEVENT_MARKER;
+        queued2.window.padding2 = (Uint8) kind;
+        queued2.window.padding3 = pending->serial;
+        tracked = true;
+    }  /* else out of memory, just queue it untracked. */
+    SDL3_UnlockMutex(PendingWindowEventsLock);
+
+    if ((SDL_PushEvent(&queued2) != 1) && tracked) {
+        /* it was filtered out or the queue is full, so there's nothing to update later. */
+        SDL3_LockMutex(PendingWindowEventsLock);
+        entry = FindPendingWindowEvents(event2->window.windowID, false);
+        if (entry && (entry->events[kind].serial == queued2.window.padding3)) {
+            entry->events[kind].pending = false;
+        }
+        SDL3_UnlockMutex(PendingWindowEventsLock);
+    }
+}
 
-                    /* Fixes queue overflow with resize events that aren't processed */
-                    {
-                        SDL_PropertiesID props = SDL3_GetWindowProperties(window);
-                        RemovePendingSizeChangedAndResizedEvents_Data resizedata;
-                        resizedata.new_event = &event2;
-                        resizedata.saw_resized = false;
-                        SDL_FilterEvents(RemovePendingSizeChangedAndResizedEvents, &resizedata);
-                        if (resizedata.saw_resized) { /* if there was a pending resize, make sure one at the new dimensions remains. */
-                            event2.window.event = SDL_WINDOWEVENT_RESIZED;
-                            SDL_PushEvent(&event2);
-                            event2.window.event = SDL_WINDOWEVENT_SIZE_CHANGED; /* then push the actual event next. */
-                        } else {
-                            int expected_w = (int)SDL3_GetNumberProperty(props, PROP_WINDOW_EXPECTED_WIDTH, 0);
-                            int expected_h = (int)SDL3_GetNumberProperty(props, PROP_WINDOW_EXPECTED_HEIGHT, 0);
-                            float expected_scale = SDL3_GetFloatProperty(props, PROP_WINDOW_EXPECTED_SCALE, 0.0f);
+static bool FilterAndWatchEvent2(const SDL2_Event *event2);
 
-                            /* Store off the expected values for next time */
-                            SDL3_SetNumberProperty(props, PROP_WINDOW_EXPECTED_WIDTH, event2.window.data1);
-                            SDL3_SetNumberProperty(props, PROP_WINDOW_EXPECTED_HEIGHT, event2.window.data2);
-                            SDL3_SetFloatProperty(props, PROP_WINDOW_EXPECTED_SCALE, SDL3_GetWindowDisplayScale(window));
-                            if (!expected_w || !expected_h) {
-                                /* Don't send the initial size, SDL2 didn't in this case.
-                                 * ffplay breaks if the initial size is sent, see https://github.com/libsdl-org/sdl2-compat/issues/268 for details.
-                                 */
-                                break;
-                            }
+/* Queue a move, exposure or size event, or fold it into a still-queued one of the same kind for that window. */
+static void CoalesceWindowEvent(const SDL2_Event *event2)
+{
+    const int kind = GetPendingWindowEventKind(event2->window.event);
 
-                            if (event2.window.data1 != expected_w ||
-                                event2.window.data2 != expected_h ||
-                                SDL3_GetWindowDisplayScale(window) != expected_scale) {
-                                event2.window.event = SDL_WINDOWEVENT_RESIZED;
-                                SDL_PushEvent(&event2);
-                                event2.window.event = SDL_WINDOWEVENT_SIZE_CHANGED; /* then push the actual event next. */
-                            }
-                        }
-                    }
-                } else if (event2.window.event == SDL_WINDOWEVENT_MOVED || event2.window.event == SDL_WINDOWEVENT_EXPOSED) {
-                    /* Flush old move and exposure events */
-                    SDL_FilterEvents(RemoveSupercededWindowEvents, &event2);
-                }
+    SDL_assert(kind >= 0);
 
-                SDL_PushEvent(&event2);
+    if (IsPendingWindowEvent(event2->window.windowID, kind)) {
+        /* Nothing gets queued, but the SDL2 event filter and watchers still need to see it, as if it was. */
+        if (!FilterAndWatchEvent2(event2)) {
+            return;
+        } else if (UpdatePendingWindowEvent(event2, kind)) {
+            if (SDL2_EventStatsEnabled) {
+                RecordEventCoalesced(event2->type);
             }
-            break;
-
-        default: break;
+            return;
+        }
+        /* The queued one was taken by another thread in the meantime, queue this one after all. */
     }
-
-    return post_event;
+    PushPendingWindowEvent(event2, kind);
 }
 
-static void CheckEventFilter(void)
+/* The queued window events are gone (flushed), so there's nothing left to update. */
+static void ResetPendingWindowEvents(void)
 {
-    SDL_EventFilter filter = NULL;
+    int i, j;
 
-    if (!SDL3_GetEventFilter(&filter, NULL) || filter != EventFilter3to2) {
-        SDL3_SetEventFilter(EventFilter3to2, NULL);
+    SDL3_LockMutex(PendingWindowEventsLock);
+    for (i = 0; i < NumPendingWindowEvents; i++) {
+        for (j = 0; j < PENDING_WINDOWEVENT_MAX; j++) {
+            PendingWindowEventsList[i].events[j].pending = false;
+        }
     }
+    SDL3_UnlockMutex(PendingWindowEventsLock);
 }
 
-SDL_DECLSPEC void SDLCALL
-SDL_SetEventFilter(SDL2_EventFilter filter2, void *userdata)
-{
-    CheckEventFilter();
-
-    EventFilter2 = filter2;
-    EventFilterUserData2 = userdata;
-}
-
-SDL_DECLSPEC SDL2_bool SDLCALL
-SDL_GetEventFilter(SDL2_EventFilter *filter2, void **userdata)
+static void RemovePendingWindowEvents(SDL_WindowID windowID)
 {
-    if (!EventFilter2) {
-        return SDL2_FALSE;
-    }
+    int i;
 
-    if (filter2) {
-        *filter2 = EventFilter2;
-    }
-    if (userdata) {
-        *userdata = EventFilterUserData2;
+    SDL3_LockMutex(PendingWindowEventsLock);
+    for (i = 0; i < NumPendingWindowEvents; i++) {
+        if (PendingWindowEventsList[i].windowID == windowID) {
+            PendingWindowEventsList[i] = PendingWindowEventsList[--NumPendingWindowEvents];
+            break;
+        }
     }
-
-    return SDL2_TRUE;
+    SDL3_UnlockMutex(PendingWindowEventsLock);
 }
 
-SDL_DECLSPEC int SDLCALL
-SDL_PeepEvents(SDL2_Event *events2, int numevents, SDL_eventaction action, Uint32 minType, Uint32 maxType)
+/* With SDL2_COALESCE_MOUSE_MOTION set, a mouse motion event is folded into the previous one if that
+   is still the last event in the queue and is for the same window and mouse, so the app gets one
+   event with the latest position and the summed relative motion instead of a flood of them. The
+   queued event is tagged with a serial number in its (otherwise unused) reserved field, and picks up
+   the merged data when it's converted to SDL2. */
+typedef struct PendingMouseMotion
 {
-    int isstack = 0;
-    SDL_Event *events3 = NULL;
-    int retval = 0;
-    int i;
+    bool pending;
+    Uint32 serial;
+    Uint64 timestamp;
+    SDL_WindowID windowID;
+    SDL_MouseID which;
+    SDL_MouseButtonFlags state;
+    float x;
+    float y;
+    float xrel;
+    float yrel;
+} PendingMouseMotion;
 
-    // For GET/PEEK the event may be NULL, so avoid allocation.
-    if (events2) {
-        events3 = SDL3_small_alloc(SDL_Event, numevents ? numevents : 1, &isstack);
-        if (!events3) {
-            return -1;
-        }
-    }
-    if (action == SDL_ADDEVENT) {
-        if (events2 && events3) {
-            for (i = 0; i < numevents; i++) {
-                Event2to3(&events2[i], &events3[i]);
-            }
-        }
-        retval = SDL3_PeepEvents(events3, numevents, action, minType, maxType);
-    } else {  /* SDL2 assumes it's SDL_PEEKEVENT if it isn't SDL_ADDEVENT or SDL_GETEVENT. */
-        retval = SDL3_PeepEvents(events3, numevents, action, minType, maxType);
-        if (events3) {
-            for (i = 0; i < retval; i++) {
-                Event3to2(&events3[i], &events2[i]);
-            }
-        }
-    }
+static bool SDL2_CoalesceMouseMotion = false;
+static SDL_SpinLock PendingMouseMotionLock = 0;
+static PendingMouseMotion PendingMotion;
 
-    if (events3) {
-        SDL3_small_free(events3, isstack);
+static void SDLCALL SDL2_CoalesceMouseMotionChanged(void *userdata, const char *name, const char *oldValue, const char *hint)
+{
+    SDL2_CoalesceMouseMotion = (hint && *hint) ? (SDL_atoi(hint) > 0) : false;
+    if (!SDL2_CoalesceMouseMotion) {
+        SDL3_LockSpinlock(&PendingMouseMotionLock);
+        PendingMotion.pending = false;
+        SDL3_UnlockSpinlock(&PendingMouseMotionLock);
     }
-
-    return retval;
 }
 
-SDL_DECLSPEC int SDLCALL
-SDL_WaitEventTimeout(SDL2_Event *event2, int timeout)
+/* Fold motion3 into the queued motion event, if it's still the last one in the queue. */
+static bool MergeMouseMotion(const SDL_MouseMotionEvent *motion3)
 {
-    SDL_Event event3;
-    const int retval = SDL3_WaitEventTimeout(event2 ? &event3 : NULL, timeout);
-    if ((retval == 1) && event2) {
-        Event3to2(&event3, event2);
+    bool retval = false;
+
+    SDL3_LockSpinlock(&PendingMouseMotionLock);
+    if (PendingMotion.pending && (PendingMotion.windowID == motion3->windowID) && (PendingMotion.which == motion3->which)) {
+        PendingMotion.timestamp = motion3->timestamp;
+        PendingMotion.state = motion3->state;
+        PendingMotion.x = motion3->x;
+        PendingMotion.y = motion3->y;
+        PendingMotion.xrel += motion3->xrel;
+        PendingMotion.yrel += motion3->yrel;
+        retval = true;
     }
+    SDL3_UnlockSpinlock(&PendingMouseMotionLock);
     return retval;
 }
 
-SDL_DECLSPEC int SDLCALL
-SDL_PollEvent(SDL2_Event *event2)
+/* Called for every event right before it goes into the queue. */
+static void TrackQueuedEvent(SDL_Event *event3)
 {
-    return SDL_WaitEventTimeout(event2, 0);
+    SDL3_LockSpinlock(&PendingMouseMotionLock);
+    if (event3->type == SDL_EVENT_MOUSE_MOTION) {
+        PendingMotion.pending = true;
+        if (++PendingMotion.serial == 0) {
+            PendingMotion.serial = 1;  /* zero means untagged. */
+        }
+        PendingMotion.timestamp = event3->motion.timestamp;
+        PendingMotion.windowID = event3->motion.windowID;
+        PendingMotion.which = event3->motion.which;
+        PendingMotion.state = event3->motion.state;
+        PendingMotion.x = event3->motion.x;
+        PendingMotion.y = event3->motion.y;
+        PendingMotion.xrel = event3->motion.xrel;
+        PendingMotion.yrel = event3->motion.yrel;
+        event3->common.reserved = PendingMotion.serial;
+    } else {
+        PendingMotion.pending = false;  /* anything after it in the queue would be reordered by merging. */
+    }
+    SDL3_UnlockSpinlock(&PendingMouseMotionLock);
 }
 
-SDL_DECLSPEC int SDLCALL
-SDL_WaitEvent(SDL2_Event *event2)
+/* Events were added to the queue without going through our event filter, or the queued motion was flushed. */
+static void ResetPendingMouseMotion(void)
 {
-    return SDL_WaitEventTimeout(event2, -1);
+    if (SDL2_CoalesceMouseMotion) {
+        SDL3_LockSpinlock(&PendingMouseMotionLock);
+        PendingMotion.pending = false;
+        SDL3_UnlockSpinlock(&PendingMouseMotionLock);
+    }
 }
 
-SDL_DECLSPEC void SDLCALL
-SDL_AddEventWatch(SDL2_EventFilter filter2, void *userdata)
+/* Called on every queued SDL3 event before it's converted to SDL2, to give a merged motion event the merged data.
+   `event3` must be our own copy. If `claim` is true, the event is leaving the queue and nothing can be merged into it anymore. */
+static void ResolvePendingMouseMotion(SDL_Event *event3, bool claim)
 {
-    EventFilterWrapperData *wrapperdata;
-
-    CheckEventFilter();
-
-    /* we set up an SDL3 event filter to manage things already; we will also use it to call all added SDL2 event watchers. Put this new one in that list. */
-    wrapperdata = (EventFilterWrapperData *) SDL3_malloc(sizeof (EventFilterWrapperData));
-    if (!wrapperdata) {
-        return;  /* oh well. */
+    if ((event3->type != SDL_EVENT_MOUSE_MOTION) || !event3->common.reserved) {
+        return;
     }
-    wrapperdata->filter2 = filter2;
-    wrapperdata->userdata = userdata;
-    SDL3_LockMutex(EventWatchListMutex);
-    wrapperdata->next = EventWatchers2;
-    EventWatchers2 = wrapperdata;
-    SDL3_UnlockMutex(EventWatchListMutex);
-}
 
-SDL_DECLSPEC void SDLCALL
-SDL_DelEventWatch(SDL2_EventFilter filter2, void *userdata)
-{
-    EventFilterWrapperData *i;
-    EventFilterWrapperData *prev = NULL;
-    SDL3_LockMutex(EventWatchListMutex);
-    for (i = EventWatchers2; i != NULL; i = i->next) {
-        if ((i->filter2 == filter2) && (i->userdata == userdata)) {
-            if (prev) {
-                SDL_assert(i != EventWatchers2);
-                prev->next = i->next;
-            } else {
-                SDL_assert(i == EventWatchers2);
-                EventWatchers2 = i->next;
-            }
-            SDL3_free(i);
-            break;
+    SDL3_LockSpinlock(&PendingMouseMotionLock);
+    if (PendingMotion.pending && (PendingMotion.serial == event3->common.reserved)) {
+        event3->motion.timestamp = PendingMotion.timestamp;
+        event3->motion.state = PendingMotion.state;
+        event3->motion.x = PendingMotion.x;
+        event3->motion.y = PendingMotion.y;
+        event3->motion.xrel = PendingMotion.xrel;
+        event3->motion.yrel = PendingMotion.yrel;
+        if (claim) {
+            PendingMotion.pending = false;
         }
     }
-    SDL3_UnlockMutex(EventWatchListMutex);
+    SDL3_UnlockSpinlock(&PendingMouseMotionLock);
 }
 
-static bool SDLCALL
-EventFilterWrapper3to2(void *userdata, SDL_Event *event)
+static void FreePendingWindowEvents(void)
 {
-    const EventFilterWrapperData *wrapperdata = (const EventFilterWrapperData *) userdata;
-    SDL2_Event event2;
-    return wrapperdata->filter2(wrapperdata->userdata, Event3to2(event, &event2));
+    SDL3_LockMutex(PendingWindowEventsLock);
+    SDL3_free(PendingWindowEventsList);
+    PendingWindowEventsList = NULL;
+    NumPendingWindowEvents = 0;
+    SDL3_UnlockMutex(PendingWindowEventsLock);
 }
 
-SDL_DECLSPEC void SDLCALL
-SDL_FilterEvents(SDL2_EventFilter filter2, void *userdata)
+/* The timestamp of the latest sensor update, for SDL_SensorGetDataWithTimestamp() and
+   SDL_GameControllerGetSensorDataWithTimestamp(). These are updated for every IMU sample, so
+   instead of properties we keep small open-addressed hash tables keyed by sensor and joystick
+   instance ID. Entries go away when the sensor is closed or the gamepad is removed, since SDL3
+   never reuses an instance ID. */
+#define NUM_GAMEPAD_SENSOR_TIMESTAMPS (SDL_SENSOR_GYRO_R + 1)
+
+typedef struct SensorTimestamps
 {
-    EventFilterWrapperData wrapperdata;
-    wrapperdata.filter2 = filter2;
-    wrapperdata.userdata = userdata;
-    wrapperdata.next = NULL;
-    SDL3_FilterEvents(EventFilterWrapper3to2, &wrapperdata);
-}
+    Uint32 id;  /* 0 for an empty slot */
+    Uint64 timestamps[NUM_GAMEPAD_SENSOR_TIMESTAMPS];  /* plain sensors only use the first */
+} SensorTimestamps;
 
-SDL_DECLSPEC Uint32 SDLCALL
-SDL_RegisterEvents(int numevents)
+typedef struct SensorTimestampTable
 {
-    Uint32 r = SDL3_RegisterEvents(numevents);
-    return r > 0 ? r : (Uint32)(-1);
-}
+    SensorTimestamps *entries;
+    int num_entries;
+    int max_entries;  /* always 0 or a power of two */
+} SensorTimestampTable;
 
-SDL_DECLSPEC SDL2_Keymod SDLCALL
-SDL_GetModState(void)
+static SDL_SpinLock SensorTimestampsLock = 0;
+static SensorTimestampTable SensorTimestampTables[2];  /* sensors, then gamepads */
+#define SENSOR_TIMESTAMPS (&SensorTimestampTables[0])
+#define GAMEPAD_SENSOR_TIMESTAMPS (&SensorTimestampTables[1])
+
+static int GetSensorTimestampsHome(const SensorTimestampTable *table, Uint32 id)
 {
-    return SDL3_GetModState();
+    return (int)((id * SDL_UINT64_C(0x9E3779B97F4A7C15)) >> 32) & (table->max_entries - 1);
 }
 
-SDL_DECLSPEC void SDLCALL
-SDL_SetModState(SDL2_Keymod modstate)
+/* Must be called with SensorTimestampsLock held and table->max_entries > 0 */
+static int FindSensorTimestampsSlot(const SensorTimestampTable *table, Uint32 id)
 {
-    SDL3_SetModState((SDL_Keymod)modstate);
+    const int mask = table->max_entries - 1;
+    int i = GetSensorTimestampsHome(table, id);
+
+    while (table->entries[i].id && table->entries[i].id != id) {
+        i = (i + 1) & mask;
+    }
+    return i;
 }
 
-SDL_DECLSPEC SDL_Keycode SDLCALL
-SDL_GetKeyFromScancode(SDL2_Scancode scancode)
+/* Must be called with SensorTimestampsLock held */
+static bool GrowSensorTimestamps(SensorTimestampTable *table)
 {
-    if (((int)scancode) < SDL2_SCANCODE_UNKNOWN || scancode >= SDL2_NUM_SCANCODES) {
-        SDL3_InvalidParamError("scancode");
-        return 0;
+    SensorTimestamps *oldentries = table->entries;
+    const int oldmax = table->max_entries;
+    const int newmax = oldmax ? (oldmax * 2) : 16;
+    SensorTimestamps *entries;
+    int i;
+
+    entries = (SensorTimestamps *)SDL3_calloc(newmax, sizeof(*entries));
+    if (!entries) {
+        return false;
     }
 
-    if (scancode <= SDL2_SCANCODE_MODE) {
-        /* Filter out extended keycodes. This matches the key mapping behavior of SDL2 backends. */
-        const SDL_Keycode keycode = SDL3_GetKeyFromScancode(SDL2ScancodeToSDL3Scancode(scancode), SDL_KMOD_NONE, true);
-        if (!(keycode & SDLK_EXTENDED_MASK)) {
-            return keycode;
+    table->entries = entries;
+    table->max_entries = newmax;
+    for (i = 0; i < oldmax; ++i) {
+        if (oldentries[i].id) {
+            table->entries[FindSensorTimestampsSlot(table, oldentries[i].id)] = oldentries[i];
         }
     }
+    SDL3_free(oldentries);
+    return true;
+}
 
-    return SDL_SCANCODE_TO_KEYCODE(scancode);
+/* Must be called with SensorTimestampsLock held, returns NULL if there's no entry and `create` is false, or if out of memory */
+static Uint64 *GetSensorTimestamps(SensorTimestampTable *table, Uint32 id, bool create)
+{
+    int i;
+
+    if (id == 0) {
+        return NULL;
+    }
+    if (create && (table->num_entries + 1) * 2 > table->max_entries && !GrowSensorTimestamps(table)) {
+        return NULL;
+    }
+    if (table->num_entries == 0 && !create) {
+        return NULL;
+    }
+
+    i = FindSensorTimestampsSlot(table, id);
+    if (!table->entries[i].id) {
+        if (!create) {
+            return NULL;
+        }
+        table->entries[i].id = id;
+        ++table->num_entries;
+    }
+    return table->entries[i].timestamps;
 }
 
-SDL_DECLSPEC SDL2_Scancode SDLCALL
-SDL_GetScancodeFromKey(SDL_Keycode key)
+static void RemoveSensorTimestamps(SensorTimestampTable *table, Uint32 id)
 {
-    SDL_Keymod modstate = SDL_KMOD_NONE;
-    SDL_Scancode scancode = SDL3_GetScancodeFromKey(key, &modstate);
+    int i, j, home;
 
-    if (scancode == SDL_SCANCODE_UNKNOWN) {
-        /* Keys commonly remapped to extended keycodes in SDL3.
-         * If the keymap returns no mapping, convert the key to a scancode directly.
-         */
-        switch (key) {
-        case SDLK_LCTRL:
-        case SDLK_RCTRL:
-        case SDLK_LALT:
-        case SDLK_RALT:
-        case SDLK_LGUI:
-        case SDLK_RGUI:
-        case SDLK_CAPSLOCK:
-        case SDLK_SCROLLLOCK:
-        case SDLK_PRINTSCREEN:
-        case SDLK_INSERT:
-            scancode = (SDL_Scancode)(key & ~SDLK_SCANCODE_MASK);
-            break;
-        case SDLK_TAB:
-            /* ASCII value that can't be directly converted to a scancode. */
-            scancode = SDL_SCANCODE_TAB;
-            break;
-        default:
-            break;
+    SDL3_LockSpinlock(&SensorTimestampsLock);
+    if (table->num_entries > 0 && id != 0) {
+        const int mask = table->max_entries - 1;
+        i = FindSensorTimestampsSlot(table, id);
+        if (table->entries[i].id) {
+            /* Move later entries of the probe sequence back into the hole, so lookups don't need tombstones */
+            for (j = (i + 1) & mask; table->entries[j].id; j = (j + 1) & mask) {
+                home = GetSensorTimestampsHome(table, table->entries[j].id);
+                if ((i <= j) ? (home <= i || home > j) : (home <= i && home > j)) {
+                    table->entries[i] = table->entries[j];
+                    i = j;
+                }
+            }
+            SDL3_zero(table->entries[i]);
+            --table->num_entries;
         }
     }
+    SDL3_UnlockSpinlock(&SensorTimestampsLock);
+}
 
-    if (modstate != SDL_KMOD_NONE) {
-        return SDL2_SCANCODE_UNKNOWN;
+static void SetSensorTimestamp(SDL_SensorID id, Uint64 timestamp)
+{
+    Uint64 *timestamps;
+
+    SDL3_LockSpinlock(&SensorTimestampsLock);
+    timestamps = GetSensorTimestamps(SENSOR_TIMESTAMPS, id, true);
+    if (timestamps) {
+        timestamps[0] = timestamp;
     }
-    return SDL3ScancodeToSDL2Scancode(scancode);
+    SDL3_UnlockSpinlock(&SensorTimestampsLock);
 }
 
-static const char *SDL2_scancode_names[] = {
-    /* 258 */ "AudioNext",
-    /* 259 */ "AudioPrev",
-    /* 260 */ "AudioStop",
-    /* 261 */ "AudioPlay",
-    /* 262 */ "AudioMute",
-    /* 263 */ "MediaSelect",
-    /* 264 */ "WWW",
-    /* 265 */ "Mail",
-    /* 266 */ "Calculator",
-    /* 267 */ "Computer",
-    /* 268 */ "AC Search",
-    /* 269 */ "AC Home",
-    /* 270 */ "AC Back",
-    /* 271 */ "AC Forward",
-    /* 272 */ "AC Stop",
-    /* 273 */ "AC Refresh",
-    /* 274 */ "AC Bookmarks",
-    /* 275 */ "BrightnessDown",
-    /* 276 */ "BrightnessUp",
-    /* 277 */ "DisplaySwitch",
-    /* 278 */ "KBDIllumToggle",
-    /* 279 */ "KBDIllumDown",
-    /* 280 */ "KBDIllumUp",
-    /* 281 */ "Eject",
-    /* 282 */ "Sleep",
-    /* 283 */ "App1",
-    /* 284 */ "App2",
-    /* 285 */ "AudioRewind",
-    /* 286 */ "AudioFastForward",
-    /* 287 */ "SoftLeft",
-    /* 288 */ "SoftRight",
-    /* 289 */ "Call",
-    /* 290 */ "EndCall",
-};
+static Uint64 GetSensorTimestamp(SDL_SensorID id)
+{
+    Uint64 *timestamps;
+    Uint64 timestamp = 0;
 
-SDL_DECLSPEC const char *SDLCALL
-SDL_GetScancodeName(SDL2_Scancode scancode)
+    SDL3_LockSpinlock(&SensorTimestampsLock);
+    timestamps = GetSensorTimestamps(SENSOR_TIMESTAMPS, id, false);
+    if (timestamps) {
+        timestamp = timestamps[0];
+    }
+    SDL3_UnlockSpinlock(&SensorTimestampsLock);
+    return timestamp;
+}
+
+static void SetGamepadSensorTimestamp(SDL_JoystickID id, SDL_SensorType type, Uint64 timestamp)
 {
-    unsigned int i;
+    Uint64 *timestamps;
 
-    if (scancode <= SDL2_SCANCODE_MODE) {
-        // They're the same
-        return SDL3_GetScancodeName(SDL2ScancodeToSDL3Scancode(scancode));
+    if ((type < 0) || (type >= NUM_GAMEPAD_SENSOR_TIMESTAMPS)) {
+        return;
     }
 
-    i = (unsigned int)scancode - (SDL2_SCANCODE_MODE + 1);
-    if (i >= SDL_arraysize(SDL2_scancode_names)) {
-        SDL3_InvalidParamError("scancode");
-        return "";
+    SDL3_LockSpinlock(&SensorTimestampsLock);
+    timestamps = GetSensorTimestamps(GAMEPAD_SENSOR_TIMESTAMPS, id, true);
+    if (timestamps) {
+        timestamps[type] = timestamp;
     }
-    return SDL2_scancode_names[i];
+    SDL3_UnlockSpinlock(&SensorTimestampsLock);
 }
 
-SDL_DECLSPEC SDL2_Scancode SDLCALL
-SDL_GetScancodeFromName(const char *name)
+static Uint64 GetGamepadSensorTimestamp(SDL_JoystickID id, SDL_SensorType type)
 {
-    int i;
+    Uint64 *timestamps;
+    Uint64 timestamp = 0;
 
-    if (!name || !*name) {
-        SDL3_InvalidParamError("name");
-        return SDL2_SCANCODE_UNKNOWN;
+    if ((type < 0) || (type >= NUM_GAMEPAD_SENSOR_TIMESTAMPS)) {
+        return 0;
     }
 
-    for (i = 0; i < SDL2_NUM_SCANCODES; ++i) {
-        if (SDL3_strcasecmp(name, SDL_GetScancodeName((SDL2_Scancode)i)) == 0) {
-            return (SDL2_Scancode)i;
-        }
+    SDL3_LockSpinlock(&SensorTimestampsLock);
+    timestamps = GetSensorTimestamps(GAMEPAD_SENSOR_TIMESTAMPS, id, false);
+    if (timestamps) {
+        timestamp = timestamps[type];
     }
-
-    SDL3_InvalidParamError("name");
-    return SDL2_SCANCODE_UNKNOWN;
+    SDL3_UnlockSpinlock(&SensorTimestampsLock);
+    return timestamp;
 }
 
-SDL_DECLSPEC const char * SDLCALL
-SDL_GetKeyName(SDL_Keycode key)
+static void FreeSensorTimestamps(void)
 {
-    if (key & SDLK_SCANCODE_MASK) {
-        return SDL_GetScancodeName((SDL2_Scancode)(key & ~SDLK_SCANCODE_MASK));
+    int i;
+
+    SDL3_LockSpinlock(&SensorTimestampsLock);
+    for (i = 0; i < (int) SDL_arraysize(SensorTimestampTables); ++i) {
+        SDL3_free(SensorTimestampTables[i].entries);
+        SDL3_zero(SensorTimestampTables[i]);
     }
-    return SDL3_GetKeyName(key);
+    SDL3_UnlockSpinlock(&SensorTimestampsLock);
 }
 
-SDL_DECLSPEC SDL_Keycode SDLCALL
-SDL_GetKeyFromName(const char *name)
+/* Event filters and watchers don't receive events as const, but SDL2 handed each of them the
+   original event. Instead of reconverting from SDL3 for every consumer, we convert once into
+   `shared` and give out `event2`, only restoring it if the previous consumer wrote to it. */
+static SDL2_Event *RestoreSharedEvent2(const SDL2_Event *shared, SDL2_Event *event2)
 {
-    SDL_Keycode key;
-
-    /* Check input */
-    if (!name) {
-        return SDLK_UNKNOWN;
-    }
-
-    /* If it's a single UTF-8 character, then that's the keycode itself */
-    key = *(const unsigned char *)name;
-    if (key >= 0xF0) {
-        if (SDL3_strlen(name) == 4) {
-            int i = 0;
-            key = (Uint16)(name[i] & 0x07) << 18;
-            key |= (Uint16)(name[++i] & 0x3F) << 12;
-            key |= (Uint16)(name[++i] & 0x3F) << 6;
-            key |= (Uint16)(name[++i] & 0x3F);
-            return key;
-        }
-        return SDLK_UNKNOWN;
-    } else if (key >= 0xE0) {
-        if (SDL3_strlen(name) == 3) {
-            int i = 0;
-            key = (Uint16)(name[i] & 0x0F) << 12;
-            key |= (Uint16)(name[++i] & 0x3F) << 6;
-            key |= (Uint16)(name[++i] & 0x3F);
-            return key;
-        }
-        return SDLK_UNKNOWN;
-    } else if (key >= 0xC0) {
-        if (SDL3_strlen(name) == 2) {
-            int i = 0;
-            key = (Uint16)(name[i] & 0x1F) << 6;
-            key |= (Uint16)(name[++i] & 0x3F);
-            return key;
-        }
-        return SDLK_UNKNOWN;
-    } else {
-        if (SDL3_strlen(name) == 1) {
-            if (key >= 'A' && key <= 'Z') {
-                key += 32;
-            }
-            return key;
-        }
-
-        /* Get the scancode for this name, and the associated keycode */
-        return SDL_GetKeyFromScancode(SDL_GetScancodeFromName(name));
+    if (SDL3_memcmp(event2, shared, sizeof (*shared)) != 0) {
+        SDL3_copyp(event2, shared);
     }
+    return event2;
 }
 
-SDL_DECLSPEC const Uint8 *SDLCALL
-SDL_GetKeyboardState(int *numkeys)
+static EventWatchSnapshot *AcquireEventWatchers(void)
 {
-    return (const Uint8 *)SDL3_GetKeyboardState(numkeys);
-}
+    EventWatchSnapshot *snapshot;
 
-/* Several SDL3 video backends have had their names lower-cased, map to the SDL2 equivalent name. */
-static const char *ReplaceVideoBackendName(const char *name)
-{
-    if (name) {
-        #define CHECKBACKEND(sdl2name) if (SDL3_strcasecmp(name, sdl2name) == 0) { return sdl2name; }
-        CHECKBACKEND("KMSDRM");
-        CHECKBACKEND("RPI");
-        CHECKBACKEND("Android");
-        CHECKBACKEND("PSP");
-        CHECKBACKEND("PS2");
-        CHECKBACKEND("VITA");
-        #undef CHECKBACKEND
+    if (!SDL3_GetAtomicPointer((void **)&EventWatchers2)) {
+        return NULL;  /* the common case, don't bother with the lock. */
     }
-    return name;
-}
 
-SDL_DECLSPEC const char * SDLCALL
-SDL_GetVideoDriver(int idx)
-{
-    return ReplaceVideoBackendName(SDL3_GetVideoDriver(idx));
+    SDL3_LockSpinlock(&EventWatchersLock);
+    snapshot = EventWatchers2;
+    if (snapshot) {
+        SDL3_AtomicIncRef(&snapshot->refcount);
+    }
+    SDL3_UnlockSpinlock(&EventWatchersLock);
+    return snapshot;
 }
 
-SDL_DECLSPEC const char * SDLCALL
-SDL_GetCurrentVideoDriver(void)
+static void ReleaseEventWatchers(EventWatchSnapshot *snapshot)
 {
-    return ReplaceVideoBackendName(SDL3_GetCurrentVideoDriver());
+    if (snapshot && SDL3_AtomicDecRef(&snapshot->refcount)) {
+        SDL3_free(snapshot);
+    }
 }
 
-
-/* mouse coords became floats in SDL3 */
-
-SDL_DECLSPEC Uint32 SDLCALL
-SDL_GetMouseState(int *x, int *y)
+/* EventWatchListMutex must be held. Takes ownership of `snapshot` (which may be NULL). */
+static void PublishEventWatchers(EventWatchSnapshot *snapshot)
 {
-    float fx, fy;
-    Uint32 ret = SDL3_GetMouseState(&fx, &fy);
-    if (x) *x = (int)fx;
-    if (y) *y = (int)fy;
-    return ret;
-}
+    EventWatchSnapshot *old;
 
-SDL_DECLSPEC Uint32 SDLCALL
-SDL_GetGlobalMouseState(int *x, int *y)
-{
-    float fx, fy;
-    Uint32 ret = SDL3_GetGlobalMouseState(&fx, &fy);
-    if (x) *x = (int)fx;
-    if (y) *y = (int)fy;
-    return ret;
-}
+    SDL3_LockSpinlock(&EventWatchersLock);
+    old = EventWatchers2;
+    EventWatchers2 = snapshot;
+    SDL3_UnlockSpinlock(&EventWatchersLock);
 
-SDL_DECLSPEC Uint32 SDLCALL
-SDL_GetRelativeMouseState(int *x, int *y)
-{
-    float fx, fy;
-    Uint32 ret = SDL3_GetRelativeMouseState(&fx, &fy);
-    if (x) *x = (int)fx;
-    if (y) *y = (int)fy;
-    return ret;
+    ReleaseEventWatchers(old);  /* drop the published reference; in-flight dispatches keep it alive until they're done. */
 }
 
-SDL_DECLSPEC void SDLCALL
-SDL_WarpMouseInWindow(SDL_Window *window, int x, int y)
+/* Run an SDL2 event through the logger, the SDL2 event filter and the event watchers, like SDL3 would when it's queued. */
+static bool DispatchEvent2(const SDL2_Event *shared2, SDL2_Event *event2, bool log_event, SDL2_EventFilter filter2, EventWatchSnapshot *watchers)
 {
-    SDL3_WarpMouseInWindow(window, (float)x, (float)y);
-}
+    bool post_event = true;
 
-SDL_DECLSPEC int SDLCALL
-SDL_WarpMouseGlobal(int x, int y)
-{
-    return SDL3_WarpMouseGlobal((float)x, (float)y) ? 0 : -1;
-}
+    if (log_event) {
+        LogEvent2(shared2);
+    }
 
-SDL_DECLSPEC int SDLCALL
-SDL_SetRelativeMouseMode(SDL2_bool enabled)
-{
-    int retval = 0;
-    SDL_Window **windows = SDL3_GetWindows(NULL);
-    if (windows) {
-        int i;
+    if (filter2) {
+        post_event = !!filter2(EventFilterUserData2, event2);
+    }
 
-        for (i = 0; windows[i]; ++i) {
-            if (!SDL3_SetWindowRelativeMouseMode(windows[i], enabled)) {
-                retval = -1;
+    if (watchers) {
+        if (post_event) {
+            int i;
+            for (i = 0; i < watchers->num_watchers; i++) {
+                const EventFilterWrapperData *watcher = &watchers->watchers[i];
+                watcher->filter2(watcher->userdata, RestoreSharedEvent2(shared2, event2));
             }
         }
-
-        SDL3_free(windows);
+        ReleaseEventWatchers(watchers);
     }
-    if (retval == 0) {
-        relative_mouse_mode = enabled;
-    }
-    return retval;
-}
-
-SDL_DECLSPEC SDL2_bool SDLCALL
-SDL_GetRelativeMouseMode(void)
-{
-    return relative_mouse_mode;
-}
 
-SDL_DECLSPEC int SDLCALL
-SDL_CaptureMouse(SDL2_bool enabled)
-{
-    return SDL3_CaptureMouse(enabled) ? 0 : -1;
+    return post_event;
 }
 
-SDL_DECLSPEC SDL2_RWops *SDLCALL
-SDL_AllocRW(void)
+/* The SDL2 type that event3 is converted to, for the event stats, or 0 if it has none. */
+static Uint32 GetEventStatsType(const SDL_Event *event3)
 {
-    SDL2_RWops *rwops2 = (SDL2_RWops *)SDL3_malloc(sizeof *rwops2);
-    if (rwops2) {
-        rwops2->type = SDL_RWOPS_UNKNOWN;
+    if (IsSDL3OnlyEventType(event3->type)) {
+        return 0;
+    } else if (event3->type == SDL_EVENT_TEXT_EDITING && SDL2_IMESupportExtendedText &&
+               SDL3_strlen(event3->edit.text) >= sizeof(((SDL2_Event *)NULL)->edit.text)) {
+        return SDL2_TEXTEDITING_EXT;
     }
-    return rwops2;
+    return event3->type;
 }
 
-static Sint64 SDLCALL
-RWops3to2_size(SDL2_RWops *rwops2)
+static bool FilterAndWatchEvent2(const SDL2_Event *event2)
 {
-    return SDL3_GetIOSize(rwops2->hidden.sdl3.iostrm);
+    SDL2_Event copy2;
+    SDL3_copyp(&copy2, event2);
+    return DispatchEvent2(event2, &copy2, (SDL2_EventLoggingVerbosity > 0), EventFilter2, AcquireEventWatchers());
 }
 
-static Sint64 SDLCALL
-RWops3to2_seek(SDL2_RWops *rwops2, Sint64 offset, int whence)
+static bool SDLCALL
+EventFilter3to2(void *userdata, SDL_Event *event3)
 {
-    return SDL3_SeekIO(rwops2->hidden.sdl3.iostrm, offset, (SDL_IOWhence) whence);
-}
+    SDL2_Event shared2;  /* event3 converted once, for the logger, the filter and every watcher. */
+    SDL2_Event event2;  /* note that event filters do not receive events as const! So we hand out a copy of shared2. */
+    bool post_event = true;
+    SDL2_EventFilter filter2;
+    EventWatchSnapshot *watchers;
+    bool log_event;
+    const bool record_stats = SDL2_EventStatsEnabled;
+    Uint64 start_ns = 0, gesture_ns = 0, dispatch_ns = 0;
 
-static size_t SDLCALL
-RWops3to2_read(SDL2_RWops *rwops2, void *ptr, size_t size, size_t maxnum)
-{
-    size_t count = 0;
-    if (size > 0 && maxnum > 0) {
-        count = SDL3_ReadIO(rwops2->hidden.sdl3.iostrm, ptr, (size * maxnum)) / size;
+    if (record_stats) {
+        start_ns = SDL3_GetTicksNS();
     }
-    return count;
-}
 
-static size_t SDLCALL
-RWops3to2_write(SDL2_RWops *rwops2, const void *ptr, size_t size, size_t maxnum)
-{
-    size_t count = 0;
-    if (size > 0 && maxnum > 0) {
-        count = SDL3_WriteIO(rwops2->hidden.sdl3.iostrm, ptr, (size * maxnum)) / size;
+    /* Drop SDL3 events which have no SDL2 equivalent and may incorrectly overlap with SDL2 event numbers. */
+    switch (event3->type) {
+        case SDL_EVENT_KEYBOARD_ADDED: /* Overlaps with SDL_TEXTEDITING_EXT */
+        case SDL_EVENT_KEYBOARD_REMOVED:
+            if (record_stats) {
+                RecordEventBridged(SDL2_COMPAT_EVENT_UNSUPPORTED, true, SDL3_GetTicksNS() - start_ns, 0, 0);
+            }
+            return false;
+
+        case SDL_EVENT_MOUSE_MOTION:
+            if (SDL2_CoalesceMouseMotion && MergeMouseMotion(&event3->motion)) {
+                if (record_stats) {
+                    RecordEventCoalesced(GetEventStatsType(event3));
+                }
+                return false;  /* the queued one has it now. */
+            }
+            break;
     }
-    return count;
-}
 
-static int SDLCALL
-RWops3to2_close(SDL2_RWops *rwops2)
-{
-    int retval = 0;
-    if (rwops2->hidden.sdl3.iostrm) {
-        if (!SDL3_CloseIO(rwops2->hidden.sdl3.iostrm)) {
-            retval = -1;
-        }
-        rwops2->hidden.sdl3.iostrm = NULL;
+    GestureProcessEvent(event3);  /* this might need to generate new gesture events from touch input. */
+    if (record_stats) {
+        gesture_ns = SDL3_GetTicksNS() - start_ns;
     }
-    SDL_FreeRW(rwops2);
-    return retval;
-}
 
-static SDL2_RWops *
-RWops3to2(SDL_IOStream *iostrm3, Uint32 type)
-{
-    SDL2_RWops *rwops2 = NULL;
-    if (iostrm3) {
-        rwops2 = SDL_AllocRW();
-        if (!rwops2) {
-            SDL3_CloseIO(iostrm3);  /* !!! FIXME: make sure this is still safe if things change. */
-            return NULL;
-        }
+    switch (event3->type) {
+        /* Ensure joystick and haptic IDs are updated before calling Event3to2() */
+        case SDL_EVENT_GAMEPAD_REMOVED:
+            RemoveSensorTimestamps(GAMEPAD_SENSOR_TIMESTAMPS, event3->gdevice.which);
+            SDL_FALLTHROUGH;
+        case SDL_EVENT_JOYSTICK_ADDED:
+        case SDL_EVENT_GAMEPAD_ADDED:
+        case SDL_EVENT_JOYSTICK_REMOVED:
+            SDL_NumJoysticks(); /* Refresh */
+            SDL_NumHaptics(); /* Refresh */
+            break;
 
-        SDL3_zerop(rwops2);
-        rwops2->size = RWops3to2_size;
-        rwops2->seek = RWops3to2_seek;
-        rwops2->read = RWops3to2_read;
-        rwops2->write = RWops3to2_write;
-        rwops2->close = RWops3to2_close;
-        rwops2->type = type;
-        rwops2->hidden.sdl3.iostrm = iostrm3;
+        case SDL_EVENT_AUDIO_DEVICE_ADDED:
+        case SDL_EVENT_AUDIO_DEVICE_REMOVED:
+            SDL_GetNumAudioDevices(event3->adevice.recording ? SDL2_TRUE : SDL2_FALSE); /* Refresh */
+            break;
+
+        /* Save the timestamp for the most recent sensor values */
+        case SDL_EVENT_SENSOR_UPDATE:
+            SetSensorTimestamp(event3->sensor.which, SDL_NS_TO_US(event3->sensor.sensor_timestamp));
+            break;
+        case SDL_EVENT_GAMEPAD_SENSOR_UPDATE:
+            SetGamepadSensorTimestamp(event3->gsensor.which, (SDL_SensorType)event3->gsensor.sensor,
+                                      SDL_NS_TO_US(event3->gsensor.sensor_timestamp));
+            break;
     }
-    return rwops2;
-}
 
-SDL_DECLSPEC void SDLCALL
-SDL_FreeRW(SDL2_RWops *rwops2)
-{
-    if (rwops2->close == RWops3to2_close &&
-        rwops2->hidden.sdl3.iostrm) {
-        SDL3_CloseIO(rwops2->hidden.sdl3.iostrm);
-        rwops2->hidden.sdl3.iostrm = NULL;
+    log_event = (SDL2_EventLoggingVerbosity > 0);
+    filter2 = EventFilter2;
+    watchers = AcquireEventWatchers();
+    if (log_event || filter2 || watchers) {
+        ResolvePendingWindowEvent(Event3to2(event3, &shared2), false);
+        SDL3_copyp(&event2, &shared2);
+        if (record_stats) {
+            dispatch_ns = SDL3_GetTicksNS();
+        }
+        post_event = DispatchEvent2(&shared2, &event2, log_event, filter2, watchers);
+        if (record_stats) {
+            dispatch_ns = SDL3_GetTicksNS() - dispatch_ns;
+        }
     }
-    SDL3_free(rwops2);
-}
 
-SDL_DECLSPEC SDL2_RWops *SDLCALL
-SDL_RWFromFile(const char *file, const char *mode)
-{
-    SDL2_RWops *rwops2 = NULL;
+    /* push new events when we need to convert something, like toplevel SDL3 events generating the SDL2 SDL_WINDOWEVENT. */
 
-    /* match some SDL2 Apple-specific quirks that were removed from SDL3. */
-    #if defined(SDL_PLATFORM_APPLE)
-    char *adjusted_path = NULL;
-    /* If the file mode is writable, skip all the bundle stuff because generally the bundle is read-only. */
-    if (mode && (SDL3_strchr(mode, 'r') != NULL) && SDL3_GetHintBoolean(SDL_HINT_APPLE_RWFROMFILE_USE_RESOURCES, true)) {
-        const char *base = SDL3_GetBasePath();
-        if (base) {
-            if (SDL3_asprintf(&adjusted_path, "%s%s", base, file) < 0) {
-                return NULL;
+    switch (event3->type) {
+        /* display events moved to the top level in SDL3. */
+        case SDL_EVENT_DISPLAY_ORIENTATION:
+        case SDL_EVENT_DISPLAY_ADDED:
+        case SDL_EVENT_DISPLAY_REMOVED:
+            if (SDL3_EventEnabled(SDL2_DISPLAYEVENT)) {
+                event2.display.type = SDL2_DISPLAYEVENT;
+                event2.display.timestamp = (Uint32) SDL_NS_TO_MS(event3->display.timestamp);
+                event2.display.display = Display_IDToIndex(event3->display.displayID);
+                event2.display.event = (Uint8) ((event3->type - ((Uint32) SDL_EVENT_DISPLAY_ORIENTATION)) + 1);
+                event2.display.padding1 = 0;
+                event2.display.padding2 = 0;
+                event2.display.padding3 = 0;
+                event2.display.data1 = event3->display.data1;
+                SDL_PushEvent(&event2);
             }
-            rwops2 = RWops3to2(SDL3_IOFromFile(adjusted_path, mode), SDL_RWOPS_PLATFORM_FILE);
-            SDL3_free(adjusted_path);
-        }
-    }
-    if (!rwops2) {
-        rwops2 = RWops3to2(SDL3_IOFromFile(file, mode), SDL_RWOPS_PLATFORM_FILE);
-    }
-    #else
-    rwops2 = RWops3to2(SDL3_IOFromFile(file, mode), SDL_RWOPS_PLATFORM_FILE);
-    #endif
+            break;
 
-    if (rwops2) {
-        const SDL_PropertiesID props = SDL3_GetIOProperties(rwops2->hidden.sdl3.iostrm);
-        if (props) {
-            void *handle = NULL;
-            #if defined(SDL_PLATFORM_WINDOWS)
-            if (!handle) {
-                handle = SDL3_GetPointerProperty(props, SDL_PROP_IOSTREAM_WINDOWS_HANDLE_POINTER, NULL);
-                if (handle) {
-                    rwops2->hidden.windowsio.h = handle;
-                }
+        /* window events moved to the top level in SDL3. */
+        case SDL_EVENT_WINDOW_SHOWN:
+        case SDL_EVENT_WINDOW_HIDDEN:
+        case SDL_EVENT_WINDOW_EXPOSED:
+        case SDL_EVENT_WINDOW_MOVED:
+        case SDL_EVENT_WINDOW_RESIZED:
+        case SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED:
+        case SDL_EVENT_WINDOW_MINIMIZED:
+        case SDL_EVENT_WINDOW_MAXIMIZED:
+        case SDL_EVENT_WINDOW_RESTORED:
+        case SDL_EVENT_WINDOW_MOUSE_ENTER:
+        case SDL_EVENT_WINDOW_MOUSE_LEAVE:
+        case SDL_EVENT_WINDOW_FOCUS_GAINED:
+        case SDL_EVENT_WINDOW_FOCUS_LOST:
+        case SDL_EVENT_WINDOW_CLOSE_REQUESTED:
+        case SDL_EVENT_WINDOW_HIT_TEST:
+        case SDL_EVENT_WINDOW_ICCPROF_CHANGED:
+        case SDL_EVENT_WINDOW_DISPLAY_CHANGED:
+            if (event3->type == SDL_EVENT_WINDOW_EXPOSED && SDL2_WindowSurfaceDamage) {
+                SetWindowSurfaceDamaged(SDL3_GetWindowFromID(event3->window.windowID));
             }
-            #elif defined(SDL_PLATFORM_ANDROID)
-            if (!handle) {
-                handle = SDL3_GetPointerProperty(props, SDL_PROP_IOSTREAM_ANDROID_AASSET_POINTER, NULL);
-                if (handle) {
-                    rwops2->hidden.androidio.asset = handle;
+            if (SDL3_EventEnabled(SDL2_WINDOWEVENT)) {
+                if (event3->type == SDL_EVENT_WINDOW_RESIZED) {
+                    /* Do resize handling based on SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED, which always fires */
+                    break;
                 }
-            }
-            #endif
 
-            if (!handle) {
-                handle = SDL3_GetPointerProperty(props, SDL_PROP_IOSTREAM_STDIO_FILE_POINTER, NULL);
-                if (handle) {
-                    rwops2->hidden.stdio.autoclose = SDL2_FALSE;
-                    rwops2->hidden.stdio.fp = handle;
+                event2.window.type = SDL2_WINDOWEVENT;
+                event2.window.timestamp = (Uint32) SDL_NS_TO_MS(event3->window.timestamp);
+                event2.window.windowID = event3->window.windowID;
+                event2.window.event = WindowEventType3To2(event3->type);
+                event2.window.padding1 = 0;
+                event2.window.padding2 = 0;
+                event2.window.padding3 = 0;
+                event2.window.data1 = event3->window.data1;
+                event2.window.data2 = event3->window.data2;
+
+                if (event2.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+                    SDL_Window *window = SDL3_GetWindowFromID(event3->window.windowID);
+                    if (!window) {
+                        break;
+                    }
+
+                    /* The size changed event has the window size, not pixel size */
+                    SDL3_GetWindowSize(window, &event2.window.data1, &event2.window.data2);
+
+                    /* Fixes queue overflow with resize events that aren't processed */
+                    {
+                        SDL_PropertiesID props = SDL3_GetWindowProperties(window);
+                        if (IsPendingWindowEvent(event2.window.windowID, PENDING_WINDOWEVENT_RESIZED)) { /* if there was a pending resize, make sure it has the new dimensions. */
+                            event2.window.event = SDL_WINDOWEVENT_RESIZED;
+                            CoalesceWindowEvent(&event2);
+                            event2.window.event = SDL_WINDOWEVENT_SIZE_CHANGED; /* then the actual event. */
+                        } else {
+                            int expected_w = (int)SDL3_GetNumberProperty(props, PROP_WINDOW_EXPECTED_WIDTH, 0);
+                            int expected_h = (int)SDL3_GetNumberProperty(props, PROP_WINDOW_EXPECTED_HEIGHT, 0);
+                            float expected_scale = SDL3_GetFloatProperty(props, PROP_WINDOW_EXPECTED_SCALE, 0.0f);
+
+                            /* Store off the expected values for next time */
+                            SDL3_SetNumberProperty(props, PROP_WINDOW_EXPECTED_WIDTH, event2.window.data1);
+                            SDL3_SetNumberProperty(props, PROP_WINDOW_EXPECTED_HEIGHT, event2.window.data2);
+                            SDL3_SetFloatProperty(props, PROP_WINDOW_EXPECTED_SCALE, SDL3_GetWindowDisplayScale(window));
+                            if (!expected_w || !expected_h) {
+                                /* Don't send the initial size, SDL2 didn't in this case.
+                                 * ffplay breaks if the initial size is sent, see https://github.com/libsdl-org/sdl2-compat/issues/268 for details.
+                                 */
+                                break;
+                            }
+
+                            if (event2.window.data1 != expected_w ||
+                                event2.window.data2 != expected_h ||
+                                SDL3_GetWindowDisplayScale(window) != expected_scale) {
+                                /* the resize has to come before the size change, so drop a still-queued size change and queue both anew. */
+                                RemovePendingWindowEvent(event2.window.windowID, PENDING_WINDOWEVENT_SIZE_CHANGED);
+                                event2.window.event = SDL_WINDOWEVENT_RESIZED;
+                                CoalesceWindowEvent(&event2);
+                                event2.window.event = SDL_WINDOWEVENT_SIZE_CHANGED; /* then the actual event. */
+                            }
+                        }
+                    }
+                }
+
+                if (GetPendingWindowEventKind(event2.window.event) >= 0) {
+                    /* Superseded size, move and exposure events are updated in place instead of piling up in the queue */
+                    CoalesceWindowEvent(&event2);
+                } else {
+                    SDL_PushEvent(&event2);
                 }
             }
-        }
+            break;
+
+        case SDL_EVENT_WINDOW_DESTROYED:
+            RemovePendingWindowEvents(event3->window.windowID);
+            break;
+
+        default: break;
     }
-    return rwops2;
-}
 
-SDL_DECLSPEC SDL2_RWops *SDLCALL
-SDL_RWFromMem(void *mem, int size)
-{
-    if (size < 0) { /* SDL3 already checks size == 0 */
-        SDL3_InvalidParamError("size");
-        return NULL;
+    if (post_event && SDL2_CoalesceMouseMotion) {
+        TrackQueuedEvent(event3);
     }
-    return RWops3to2(SDL3_IOFromMem(mem, size), SDL_RWOPS_MEMORY);
-}
 
-SDL_DECLSPEC SDL2_RWops *SDLCALL
-SDL_RWFromConstMem(const void *mem, int size)
-{
-    if (size < 0) { /* SDL3 already checks size == 0 */
-        SDL3_InvalidParamError("size");
-        return NULL;
+    if (record_stats) {
+        const Uint32 stats_type = GetEventStatsType(event3);
+        if (stats_type) {
+            RecordEventBridged(stats_type, !post_event, SDL3_GetTicksNS() - start_ns, gesture_ns, dispatch_ns);
+        }
     }
-    return RWops3to2(SDL3_IOFromConstMem(mem, size), SDL_RWOPS_MEMORY_RO);
-}
 
-SDL_DECLSPEC Sint64 SDLCALL
-SDL_RWsize(SDL2_RWops *rwops2)
-{
-    return rwops2->size(rwops2);
+    return post_event;
 }
 
-SDL_DECLSPEC Sint64 SDLCALL
-SDL_RWseek(SDL2_RWops *rwops2, Sint64 offset, int whence)
+static void CheckEventFilter(void)
 {
-    return rwops2->seek(rwops2, offset, whence);
+    SDL_EventFilter filter = NULL;
+
+    if (!SDL3_GetEventFilter(&filter, NULL) || filter != EventFilter3to2) {
+        SDL3_SetEventFilter(EventFilter3to2, NULL);
+    }
 }
 
-SDL_DECLSPEC Sint64 SDLCALL
-SDL_RWtell(SDL2_RWops *rwops2)
+SDL_DECLSPEC void SDLCALL
+SDL_SetEventFilter(SDL2_EventFilter filter2, void *userdata)
 {
-    return rwops2->seek(rwops2, 0, SDL_IO_SEEK_CUR);
+    CheckEventFilter();
+
+    EventFilter2 = filter2;
+    EventFilterUserData2 = userdata;
 }
 
-SDL_DECLSPEC size_t SDLCALL
-SDL_RWread(SDL2_RWops *rwops2, void *ptr, size_t size, size_t maxnum)
+SDL_DECLSPEC SDL2_bool SDLCALL
+SDL_GetEventFilter(SDL2_EventFilter *filter2, void **userdata)
 {
-    return rwops2->read(rwops2, ptr, size, maxnum);
+    if (!EventFilter2) {
+        return SDL2_FALSE;
+    }
+
+    if (filter2) {
+        *filter2 = EventFilter2;
+    }
+    if (userdata) {
+        *userdata = EventFilterUserData2;
+    }
+
+    return SDL2_TRUE;
 }
 
-SDL_DECLSPEC size_t SDLCALL
-SDL_RWwrite(SDL2_RWops *rwops2, const void *ptr, size_t size, size_t num)
+/* Per-thread array of SDL3 events to convert from/into, so SDL_PeepEvents() and
+   SDL_CompatPollEvents() don't need to allocate on every call. */
+#define EVENT_SCRATCH_SIZE 128
+static SDL_TLSID EventScratchTLS;
+
+static SDL_Event *GetEventScratch(void)
 {
-    return rwops2->write(rwops2, ptr, size, num);
+    SDL_Event *events3 = (SDL_Event *) SDL3_GetTLS(&EventScratchTLS);
+    if (!events3) {
+        events3 = (SDL_Event *) SDL3_malloc(sizeof (SDL_Event) * EVENT_SCRATCH_SIZE);
+        if (!events3) {
+            return NULL;
+        } else if (!SDL3_SetTLS(&EventScratchTLS, events3, SDL3_free)) {
+            SDL3_free(events3);
+            return NULL;
+        }
+    }
+    return events3;
 }
 
 SDL_DECLSPEC int SDLCALL
-SDL_RWclose(SDL2_RWops *rwops2)
+SDL_PeepEvents(SDL2_Event *events2, int numevents, SDL_eventaction action, Uint32 minType, Uint32 maxType)
 {
-    return rwops2->close(rwops2);
-}
+    int isstack = 0;
+    bool isscratch = false;
+    SDL_Event *events3 = NULL;
+    int retval = 0;
+    int i;
 
-SDL_DECLSPEC Uint8 SDLCALL
-SDL_ReadU8(SDL2_RWops *rwops2)
-{
-    Uint8 x = 0;
-    SDL_RWread(rwops2, &x, sizeof (x), 1);
-    return x;
+    // For GET/PEEK the event may be NULL, so avoid allocation.
+    if (events2) {
+        if (numevents <= EVENT_SCRATCH_SIZE) {
+            events3 = GetEventScratch();
+            isscratch = (events3 != NULL);
+        }
+        if (!events3) {
+            events3 = SDL3_small_alloc(SDL_Event, numevents ? numevents : 1, &isstack);
+        }
+        if (!events3) {
+            return -1;
+        }
+    }
+    if (action == SDL_ADDEVENT) {
+        if (events2 && events3) {
+            for (i = 0; i < numevents; i++) {
+                Event2to3(&events2[i], &events3[i]);
+            }
+        }
+        retval = SDL3_PeepEvents(events3, numevents, action, minType, maxType);
+        if (retval > 0) {
+            ResetPendingMouseMotion();  /* these didn't go through our event filter. */
+        }
+    } else {  /* SDL2 assumes it's SDL_PEEKEVENT if it isn't SDL_ADDEVENT or SDL_GETEVENT. */
+        retval = SDL3_PeepEvents(events3, numevents, action, minType, maxType);
+        if (events3) {
+            for (i = 0; i < retval; i++) {
+                ResolvePendingMouseMotion(&events3[i], (action == SDL_GETEVENT));
+                ResolvePendingWindowEvent(Event3to2(&events3[i], &events2[i]), (action == SDL_GETEVENT));
+            }
+            if ((action == SDL_GETEVENT) && (retval > 0)) {
+                EventsDelivered(events3, events2, retval);
+            }
+        }
+    }
+
+    if (events3 && !isscratch) {
+        SDL3_small_free(events3, isstack);
+    }
+
+    return retval;
 }
 
-SDL_DECLSPEC size_t SDLCALL
-SDL_WriteU8(SDL2_RWops *rwops2, Uint8 x)
+SDL_DECLSPEC int SDLCALL
+SDL_CompatPollEvents(SDL2_Event *events2, int numevents)
 {
-    return SDL_RWwrite(rwops2, &x, sizeof(x), 1);
-}
+    SDL_Event *events3;
+    int retval = 0;
 
-#define DO_RWOPS_ENDIAN(order, bits)        \
-SDL_DECLSPEC Uint##bits SDLCALL             \
-SDL_Read##order##bits(SDL2_RWops *rwops2) { \
-    Uint##bits x = 0;                       \
-    SDL_RWread(rwops2, &x, sizeof (x), 1);  \
-    return SDL_Swap##bits##order(x);        \
-} \
-                                                           \
-SDL_DECLSPEC size_t SDLCALL                                \
-SDL_Write##order##bits(SDL2_RWops *rwops2, Uint##bits x) { \
-    x = SDL_Swap##bits##order(x);                          \
-    return SDL_RWwrite(rwops2, &x, sizeof(x), 1);          \
-}
-DO_RWOPS_ENDIAN(LE, 16)
-DO_RWOPS_ENDIAN(BE, 16)
-DO_RWOPS_ENDIAN(LE, 32)
-DO_RWOPS_ENDIAN(BE, 32)
-DO_RWOPS_ENDIAN(LE, 64)
-DO_RWOPS_ENDIAN(BE, 64)
-#undef DO_RWOPS_ENDIAN
-
-/* stdio SDL_RWops was removed from SDL3, to prevent incompatible C runtime issues */
-#ifndef HAVE_STDIO_H
-SDL_DECLSPEC SDL2_RWops * SDLCALL
-SDL_RWFromFP(void *fp, SDL2_bool autoclose)
-{
-    SDL3_SetError("SDL not compiled with stdio support");
-    return NULL;
-}
-#else
-
-/* !!! FIXME: SDL2 has a bunch of macro salsa to try and use the most 64-bit
-fseek, etc, and I'm avoiding that for now; this can change if it becomes a
-problem.  --ryan. */
-
-/* Functions to read/write stdio file pointers */
-
-static Sint64 SDLCALL
-stdio_size(SDL2_RWops *rwops2)
-{
-    Sint64 pos, size;
-
-    pos = SDL_RWseek(rwops2, 0, SDL_IO_SEEK_CUR);
-    if (pos < 0) {
+    if (!events2) {
+        SDL3_InvalidParamError("events");
         return -1;
+    } else if (numevents <= 0) {
+        return 0;
     }
-    size = SDL_RWseek(rwops2, 0, SDL_IO_SEEK_END);
-
-    SDL_RWseek(rwops2, pos, SDL_IO_SEEK_SET);
-    return size;
-}
 
-static Sint64 SDLCALL
-stdio_seek(SDL2_RWops *rwops2, Sint64 offset, int whence)
-{
-    FILE *fp = (FILE *) rwops2->hidden.stdio.fp;
-    int stdiowhence;
+    SDL3_PumpEvents();
 
-    switch (whence) {
-    case SDL_IO_SEEK_SET:
-        stdiowhence = SEEK_SET;
-        break;
-    case SDL_IO_SEEK_CUR:
-        stdiowhence = SEEK_CUR;
-        break;
-    case SDL_IO_SEEK_END:
-        stdiowhence = SEEK_END;
-        break;
-    default:
-        SDL3_SetError("Unknown value for 'whence'");
+    events3 = GetEventScratch();
+    if (!events3) {
         return -1;
     }
 
-#if defined(FSEEK_OFF_MIN) && defined(FSEEK_OFF_MAX)
-    if (offset < (Sint64)(FSEEK_OFF_MIN) || offset > (Sint64)(FSEEK_OFF_MAX)) {
-        SDL3_SetError("Seek offset out of range");
-        return -1;
-    }
-#endif
+    while (retval < numevents) {
+        const int want = SDL_min(numevents - retval, EVENT_SCRATCH_SIZE);
+        const int got = SDL3_PeepEvents(events3, want, SDL_GETEVENT, SDL_EVENT_FIRST, SDL_EVENT_LAST);
+        int i;
 
-    if (fseek(fp, (long)offset, stdiowhence) == 0) {
-        Sint64 pos = ftell(fp);
-        if (pos < 0) {
-            SDL3_SetError("Couldn't get stream offset");
-            return -1;
+        if (got < 0) {
+            return (retval > 0) ? retval : -1;
+        }
+        for (i = 0; i < got; i++) {
+            ResolvePendingMouseMotion(&events3[i], true);
+            ResolvePendingWindowEvent(Event3to2(&events3[i], &events2[retval + i]), true);
+        }
+        if (got > 0) {
+            EventsDelivered(events3, &events2[retval], got);
+        }
+        retval += got;
+        if (got < want) {
+            break;  /* queue is empty. */
         }
-        return pos;
     }
-    return SDL_Error(SDL_EFSEEK);
+
+    return retval;
 }
 
-static size_t SDLCALL
-stdio_read(SDL2_RWops *rwops2, void *ptr, size_t size, size_t maxnum)
+SDL_DECLSPEC int SDLCALL
+SDL_WaitEventTimeout(SDL2_Event *event2, int timeout)
 {
-    FILE *fp = (FILE *) rwops2->hidden.stdio.fp;
-    size_t nread = fread(ptr, size, maxnum, fp);
-    if (nread == 0 && ferror(fp)) {
-        SDL_Error(SDL_EFREAD);
+    SDL_Event event3;
+    const int retval = SDL3_WaitEventTimeout(event2 ? &event3 : NULL, timeout);
+    if ((retval == 1) && event2) {
+        ResolvePendingMouseMotion(&event3, true);
+        ResolvePendingWindowEvent(Event3to2(&event3, event2), true);
+        EventsDelivered(&event3, event2, 1);
     }
-    return nread;
+    return retval;
 }
 
-static size_t SDLCALL
-stdio_write(SDL2_RWops *rwops2, const void *ptr, size_t size, size_t num)
+SDL_DECLSPEC int SDLCALL
+SDL_PollEvent(SDL2_Event *event2)
 {
-    FILE *fp = (FILE *) rwops2->hidden.stdio.fp;
-    size_t nwrote = fwrite(ptr, size, num, fp);
-    if (nwrote == 0 && ferror(fp)) {
-        SDL_Error(SDL_EFWRITE);
-    }
-    return nwrote;
+    return SDL_WaitEventTimeout(event2, 0);
 }
 
-static int SDLCALL
-stdio_close(SDL2_RWops *rwops2)
+SDL_DECLSPEC int SDLCALL
+SDL_WaitEvent(SDL2_Event *event2)
 {
-    int status = 0;
-    if (rwops2) {
-        if (rwops2->hidden.stdio.autoclose) {
-            if (fclose((FILE *)rwops2->hidden.stdio.fp) != 0) {
-                status = SDL_Error(SDL_EFWRITE);
+    return SDL_WaitEventTimeout(event2, -1);
+}
+
+SDL_DECLSPEC void SDLCALL
+SDL_AddEventWatch(SDL2_EventFilter filter2, void *userdata)
+{
+    EventWatchSnapshot *snapshot;
+    const EventWatchSnapshot *old;
+    int num_watchers;
+
+    CheckEventFilter();
+
+    /* we set up an SDL3 event filter to manage things already; we will also use it to call all added SDL2 event watchers. Put this new one in that list. */
+    SDL3_LockMutex(EventWatchListMutex);
+    old = EventWatchers2;  /* only changed under EventWatchListMutex, so no need for a reference. */
+    num_watchers = old ? old->num_watchers : 0;
+    snapshot = (EventWatchSnapshot *) SDL3_malloc(sizeof (EventWatchSnapshot) + (num_watchers * sizeof (EventFilterWrapperData)));
+    if (snapshot) {
+        SDL3_SetAtomicInt(&snapshot->refcount, 1);
+        snapshot->num_watchers = num_watchers + 1;
+        snapshot->watchers[0].filter2 = filter2;
+        snapshot->watchers[0].userdata = userdata;
+        snapshot->watchers[0].next = NULL;
+        if (num_watchers > 0) {
+            SDL3_memcpy(&snapshot->watchers[1], old->watchers, num_watchers * sizeof (EventFilterWrapperData));
+        }
+        PublishEventWatchers(snapshot);
+    }  /* else oh well. */
+    SDL3_UnlockMutex(EventWatchListMutex);
+}
+
+SDL_DECLSPEC void SDLCALL
+SDL_DelEventWatch(SDL2_EventFilter filter2, void *userdata)
+{
+    const EventWatchSnapshot *old;
+    int i;
+
+    SDL3_LockMutex(EventWatchListMutex);
+    old = EventWatchers2;
+    for (i = 0; old && (i < old->num_watchers); i++) {
+        if ((old->watchers[i].filter2 == filter2) && (old->watchers[i].userdata == userdata)) {
+            EventWatchSnapshot *snapshot = NULL;
+            const int num_watchers = old->num_watchers - 1;
+            if (num_watchers > 0) {
+                snapshot = (EventWatchSnapshot *) SDL3_malloc(sizeof (EventWatchSnapshot) + ((num_watchers - 1) * sizeof (EventFilterWrapperData)));
+                if (!snapshot) {
+                    break;  /* oh well, leave it in place. */
+                }
+                SDL3_SetAtomicInt(&snapshot->refcount, 1);
+                snapshot->num_watchers = num_watchers;
+                SDL3_memcpy(&snapshot->watchers[0], &old->watchers[0], i * sizeof (EventFilterWrapperData));
+                SDL3_memcpy(&snapshot->watchers[i], &old->watchers[i + 1], (num_watchers - i) * sizeof (EventFilterWrapperData));
             }
+            PublishEventWatchers(snapshot);
+            break;
         }
-        SDL_FreeRW(rwops2);
     }
-    return status;
+    SDL3_UnlockMutex(EventWatchListMutex);
 }
 
-SDL_DECLSPEC SDL2_RWops * SDLCALL
-SDL_RWFromFP(void *fp, SDL2_bool autoclose)
+static bool SDLCALL
+EventFilterWrapper3to2(void *userdata, SDL_Event *event)
 {
-    SDL2_RWops *rwops = SDL_AllocRW();
-    if (rwops != NULL) {
-        rwops->size = stdio_size;
-        rwops->seek = stdio_seek;
-        rwops->read = stdio_read;
-        rwops->write = stdio_write;
-        rwops->close = stdio_close;
-        rwops->hidden.stdio.fp = (FILE *) fp;
-        rwops->hidden.stdio.autoclose = autoclose;
-        rwops->type = SDL_RWOPS_STDFILE;
+    const EventFilterWrapperData *wrapperdata = (const EventFilterWrapperData *) userdata;
+    SDL_Event motion3;
+    SDL2_Event queued2;
+    SDL2_Event event2;
+
+    if (event->type == SDL_EVENT_MOUSE_MOTION) {
+        SDL3_copyp(&motion3, event);  /* don't change the event in the queue. */
+        ResolvePendingMouseMotion(&motion3, false);
+        event = &motion3;
     }
-    return rwops;
+
+    Event3to2(event, &queued2);
+    SDL3_copyp(&event2, &queued2);
+    if (!wrapperdata->filter2(wrapperdata->userdata, ResolvePendingWindowEvent(&event2, false))) {
+        /* it's being removed from the queue. */
+        ResolvePendingMouseMotion(event, true);
+        ResolvePendingWindowEvent(&queued2, true);
+        return false;
+    }
+    return true;
 }
-#endif
 
-static Sint64 SDLCALL
-RWops2to3_size(void *userdata)
+SDL_DECLSPEC void SDLCALL
+SDL_FilterEvents(SDL2_EventFilter filter2, void *userdata)
 {
-    return SDL_RWsize((SDL2_RWops *) userdata);
+    EventFilterWrapperData wrapperdata;
+    wrapperdata.filter2 = filter2;
+    wrapperdata.userdata = userdata;
+    wrapperdata.next = NULL;
+    SDL3_FilterEvents(EventFilterWrapper3to2, &wrapperdata);
 }
 
-static Sint64 SDLCALL
-RWops2to3_seek(void *userdata, Sint64 offset, SDL_IOWhence whence)
+SDL_DECLSPEC void SDLCALL
+SDL_FlushEvent(Uint32 type)
 {
-    return SDL_RWseek((SDL2_RWops *) userdata, offset, whence);
+    SDL3_FlushEvent(type);
+    if (type == SDL2_WINDOWEVENT) {
+        ResetPendingWindowEvents();
+    } else if (type == SDL_EVENT_MOUSE_MOTION) {
+        ResetPendingMouseMotion();
+    }
 }
 
-static size_t SDLCALL
-RWops2to3_read(void *userdata, void *ptr, size_t size, SDL_IOStatus *status)
+SDL_DECLSPEC void SDLCALL
+SDL_FlushEvents(Uint32 minType, Uint32 maxType)
 {
-    return SDL_RWread((SDL2_RWops *) userdata, ptr, 1, size);
+    SDL3_FlushEvents(minType, maxType);
+    if ((minType <= SDL2_WINDOWEVENT) && (maxType >= SDL2_WINDOWEVENT)) {
+        ResetPendingWindowEvents();
+    }
+    if ((minType <= SDL_EVENT_MOUSE_MOTION) && (maxType >= SDL_EVENT_MOUSE_MOTION)) {
+        ResetPendingMouseMotion();
+    }
 }
 
-static size_t SDLCALL
-RWops2to3_write(void *userdata, const void *ptr, size_t size, SDL_IOStatus *status)
+SDL_DECLSPEC Uint32 SDLCALL
+SDL_RegisterEvents(int numevents)
 {
-    return SDL_RWwrite((SDL2_RWops *) userdata, ptr, 1, size);
+    Uint32 r = SDL3_RegisterEvents(numevents);
+    return r > 0 ? r : (Uint32)(-1);
 }
 
-static bool SDLCALL
-RWops2to3_close(void *userdata)
+SDL_DECLSPEC SDL2_Keymod SDLCALL
+SDL_GetModState(void)
 {
-    /* Never close the SDL2_RWops here! This is just a wrapper to talk to SDL3 APIs. We will manually close the rwops2 if appropriate. */
-    /*return SDL3_CloseIO((SDL2_RWops *) userdata) ? 0 : -1;*/
-    return true;
+    return SDL3_GetModState();
 }
 
-static SDL_IOStream *
-RWops2to3(SDL2_RWops *rwops2)
+SDL_DECLSPEC void SDLCALL
+SDL_SetModState(SDL2_Keymod modstate)
 {
-    SDL_IOStream *iostrm3 = NULL;
-    if (rwops2) {
-        SDL_IOStreamInterface iface;
-        SDL_INIT_INTERFACE(&iface);
-        iface.size = RWops2to3_size;
-        iface.seek = RWops2to3_seek;
-        iface.read = RWops2to3_read;
-        iface.write = RWops2to3_write;
-        iface.close = RWops2to3_close;
-
-        iostrm3 = SDL3_OpenIO(&iface, rwops2);
-        if (!iostrm3) {
-            return NULL;
-        }
-    }
-    return iostrm3;
+    SDL3_SetModState((SDL_Keymod)modstate);
 }
 
-SDL_DECLSPEC void *SDLCALL
-SDL_LoadFile_RW(SDL2_RWops *rwops2, size_t *datasize, int freesrc)
+SDL_DECLSPEC SDL_Keycode SDLCALL
+SDL_GetKeyFromScancode(SDL2_Scancode scancode)
 {
-    void *retval = NULL;
-
-    SDL_IOStream *iostrm3 = RWops2to3(rwops2);
-    if (iostrm3) {
-        retval = SDL3_LoadFile_IO(iostrm3, datasize, true);  /* always close the iostrm3 bridge object. */
+    if (((int)scancode) < SDL2_SCANCODE_UNKNOWN || scancode >= SDL2_NUM_SCANCODES) {
+        SDL3_InvalidParamError("scancode");
+        return 0;
     }
 
-    if (rwops2 && freesrc) {
-        SDL_RWclose(rwops2);
+    if (scancode <= SDL2_SCANCODE_MODE) {
+        /* Filter out extended keycodes. This matches the key mapping behavior of SDL2 backends. */
+        const SDL_Keycode keycode = SDL3_GetKeyFromScancode(SDL2ScancodeToSDL3Scancode(scancode), SDL_KMOD_NONE, true);
+        if (!(keycode & SDLK_EXTENDED_MASK)) {
+            return keycode;
+        }
     }
 
-    return retval;
+    return SDL_SCANCODE_TO_KEYCODE(scancode);
 }
 
-SDL_DECLSPEC SDL2_AudioSpec *SDLCALL
-SDL_LoadWAV_RW(SDL2_RWops *rwops2, int freesrc, SDL2_AudioSpec *spec2, Uint8 **audio_buf, Uint32 *audio_len)
+SDL_DECLSPEC SDL2_Scancode SDLCALL
+SDL_GetScancodeFromKey(SDL_Keycode key)
 {
-    SDL2_AudioSpec *retval = NULL;
+    SDL_Keymod modstate = SDL_KMOD_NONE;
+    SDL_Scancode scancode = SDL3_GetScancodeFromKey(key, &modstate);
 
-    if (spec2 == NULL) {
-        SDL3_InvalidParamError("spec");
-    } else {
-        SDL_IOStream *iostrm3 = RWops2to3(rwops2);
-        if (iostrm3) {
-            SDL_AudioSpec spec3;
-            const bool rc = SDL3_LoadWAV_IO(iostrm3, true, &spec3, audio_buf, audio_len);   /* always close the iostrm3 bridge object. */
-            SDL3_zerop(spec2);
-            if (rc) {
-                spec2->format = spec3.format;
-                spec2->channels = spec3.channels;
-                spec2->freq = spec3.freq;
-                spec2->samples = 4096; /* This is what SDL2 hardcodes, also. */
-                spec2->silence = SDL3_GetSilenceValueForFormat(spec3.format);
-                retval = spec2;
-            }
+    if (scancode == SDL_SCANCODE_UNKNOWN) {
+        /* Keys commonly remapped to extended keycodes in SDL3.
+         * If the keymap returns no mapping, convert the key to a scancode directly.
+         */
+        switch (key) {
+        case SDLK_LCTRL:
+        case SDLK_RCTRL:
+        case SDLK_LALT:
+        case SDLK_RALT:
+        case SDLK_LGUI:
+        case SDLK_RGUI:
+        case SDLK_CAPSLOCK:
+        case SDLK_SCROLLLOCK:
+        case SDLK_PRINTSCREEN:
+        case SDLK_INSERT:
+            scancode = (SDL_Scancode)(key & ~SDLK_SCANCODE_MASK);
+            break;
+        case SDLK_TAB:
+            /* ASCII value that can't be directly converted to a scancode. */
+            scancode = SDL_SCANCODE_TAB;
+            break;
+        default:
+            break;
         }
     }
 
-    if (rwops2 && freesrc) {
-        SDL_RWclose(rwops2);
+    if (modstate != SDL_KMOD_NONE) {
+        return SDL2_SCANCODE_UNKNOWN;
     }
-
-    return retval;
+    return SDL3ScancodeToSDL2Scancode(scancode);
 }
 
-static SDL2_Surface *CreateSurface2from3(SDL_Surface *surface3)
-{
-    /* Allocate the surface */
-    SDL2_Surface *surface = (SDL2_Surface *)SDL3_calloc(1, sizeof(*surface));
-    if (!surface) {
-        SDL3_OutOfMemory();
-        return NULL;
-    }
+static const char *SDL2_scancode_names[] = {
+    /* 258 */ "AudioNext",
+    /* 259 */ "AudioPrev",
+    /* 260 */ "AudioStop",
+    /* 261 */ "AudioPlay",
+    /* 262 */ "AudioMute",
+    /* 263 */ "MediaSelect",
+    /* 264 */ "WWW",
+    /* 265 */ "Mail",
+    /* 266 */ "Calculator",
+    /* 267 */ "Computer",
+    /* 268 */ "AC Search",
+    /* 269 */ "AC Home",
+    /* 270 */ "AC Back",
+    /* 271 */ "AC Forward",
+    /* 272 */ "AC Stop",
+    /* 273 */ "AC Refresh",
+    /* 274 */ "AC Bookmarks",
+    /* 275 */ "BrightnessDown",
+    /* 276 */ "BrightnessUp",
+    /* 277 */ "DisplaySwitch",
+    /* 278 */ "KBDIllumToggle",
+    /* 279 */ "KBDIllumDown",
+    /* 280 */ "KBDIllumUp",
+    /* 281 */ "Eject",
+    /* 282 */ "Sleep",
+    /* 283 */ "App1",
+    /* 284 */ "App2",
+    /* 285 */ "AudioRewind",
+    /* 286 */ "AudioFastForward",
+    /* 287 */ "SoftLeft",
+    /* 288 */ "SoftRight",
+    /* 289 */ "Call",
+    /* 290 */ "EndCall",
+};
 
-    /* Link the surfaces */
-    surface->map = (SDL_BlitMap *)surface3;
-    SDL3_SetPointerProperty(SDL3_GetSurfaceProperties(surface3), PROP_SURFACE2, surface);
+SDL_DECLSPEC const char *SDLCALL
+SDL_GetScancodeName(SDL2_Scancode scancode)
+{
+    unsigned int i;
 
-    surface->format = SDL_AllocFormat(surface3->format);
-    if (!surface->format) {
-        SDL_FreeSurface(surface);
-        return NULL;
+    if (scancode <= SDL2_SCANCODE_MODE) {
+        // They're the same
+        return SDL3_GetScancodeName(SDL2ScancodeToSDL3Scancode(scancode));
     }
-    surface->flags = (surface3->flags & SHARED_SURFACE_FLAGS);
-    surface->w = surface3->w;
-    surface->h = surface3->h;
-    surface->pixels = surface3->pixels;
-    surface->pitch = surface3->pitch;
-
-    SDL3_GetSurfaceClipRect(surface3, &surface->clip_rect);
 
-    if (SDL_ISPIXELFORMAT_INDEXED(surface3->format)) {
-        SDL_Palette *palette = SDL3_GetSurfacePalette(surface3);
-        if (!palette) {
-            palette = SDL3_CreateSurfacePalette(surface3);
-            if (!palette) {
-                SDL_FreeSurface(surface);
-                return NULL;
-            }
-        }
-        surface->format->palette = palette;
-        ++palette->refcount;
+    i = (unsigned int)scancode - (SDL2_SCANCODE_MODE + 1);
+    if (i >= SDL_arraysize(SDL2_scancode_names)) {
+        SDL3_InvalidParamError("scancode");
+        return "";
     }
-
-    /* The surface is ready to go */
-    surface->refcount = 1;
-    return surface;
+    return SDL2_scancode_names[i];
 }
 
-static SDL2_Surface *Surface3to2(SDL_Surface *surface)
+SDL_DECLSPEC SDL2_Scancode SDLCALL
+SDL_GetScancodeFromName(const char *name)
 {
-    SDL2_Surface *surface2 = NULL;
+    int i;
 
-    if (surface) {
-        surface2 = (SDL2_Surface *)SDL3_GetPointerProperty(SDL3_GetSurfaceProperties(surface), PROP_SURFACE2, NULL);
-        if (!surface2) {
-            surface2 = CreateSurface2from3(surface);
+    if (!name || !*name) {
+        SDL3_InvalidParamError("name");
+        return SDL2_SCANCODE_UNKNOWN;
+    }
+
+    for (i = 0; i < SDL2_NUM_SCANCODES; ++i) {
+        if (SDL3_strcasecmp(name, SDL_GetScancodeName((SDL2_Scancode)i)) == 0) {
+            return (SDL2_Scancode)i;
         }
     }
-    return surface2;
+
+    SDL3_InvalidParamError("name");
+    return SDL2_SCANCODE_UNKNOWN;
 }
 
-static void SynchronizeSurface3to2(SDL_Surface *surface, SDL2_Surface *surface2)
+SDL_DECLSPEC const char * SDLCALL
+SDL_GetKeyName(SDL_Keycode key)
 {
-    /* Synchronize any changes made by SDL to the SDL3 surface
-     * SDL might have changed flags or freed the pixels, e.g.:
-     * https://github.com/libsdl-org/SDL/blob/be991239d9bc6df06b0ca7a9ae9dbb7251e93c12/src/video/SDL_RLEaccel.c#L1180-L1189
-     */
-    if (surface && surface->pixels != surface2->pixels) {
-        surface2->flags &= ~SHARED_SURFACE_FLAGS;
-        surface2->flags |= (surface->flags & SHARED_SURFACE_FLAGS);
-        surface2->pixels = surface->pixels;
-        surface2->pitch = surface->pitch;
+    if (key & SDLK_SCANCODE_MASK) {
+        return SDL_GetScancodeName((SDL2_Scancode)(key & ~SDLK_SCANCODE_MASK));
     }
+    return SDL3_GetKeyName(key);
 }
 
-static SDL_Surface *Surface2to3(SDL2_Surface *surface)
+SDL_DECLSPEC SDL_Keycode SDLCALL
+SDL_GetKeyFromName(const char *name)
 {
-    SDL_Surface *surface3 = NULL;
+    SDL_Keycode key;
 
-    if (surface) {
-        surface3 = (SDL_Surface *)surface->map;
-        SDL_assert(surface3 != NULL);
+    /* Check input */
+    if (!name) {
+        return SDLK_UNKNOWN;
+    }
 
-        /* Synchronize any changes made by the application to the SDL2 surface
-         * The application might have changed memory allocation, e.g.:
-         * https://github.com/libsdl-org/SDL_ttf/blob/7e4a456bf463b887b94c191030dd742d7654d6ff/SDL_ttf.c#L1476-L1478
-         */
-        surface3->w = surface->w;
-        surface3->h = surface->h;
-        surface3->flags &= ~SHARED_SURFACE_FLAGS;
-        surface3->flags |= (surface->flags & SHARED_SURFACE_FLAGS);
-        surface3->pixels = surface->pixels;
-        surface3->pitch = surface->pitch;
+    /* If it's a single UTF-8 character, then that's the keycode itself */
+    key = *(const unsigned char *)name;
+    if (key >= 0xF0) {
+        if (SDL3_strlen(name) == 4) {
+            int i = 0;
+            key = (Uint16)(name[i] & 0x07) << 18;
+            key |= (Uint16)(name[++i] & 0x3F) << 12;
+            key |= (Uint16)(name[++i] & 0x3F) << 6;
+            key |= (Uint16)(name[++i] & 0x3F);
+            return key;
+        }
+        return SDLK_UNKNOWN;
+    } else if (key >= 0xE0) {
+        if (SDL3_strlen(name) == 3) {
+            int i = 0;
+            key = (Uint16)(name[i] & 0x0F) << 12;
+            key |= (Uint16)(name[++i] & 0x3F) << 6;
+            key |= (Uint16)(name[++i] & 0x3F);
+            return key;
+        }
+        return SDLK_UNKNOWN;
+    } else if (key >= 0xC0) {
+        if (SDL3_strlen(name) == 2) {
+            int i = 0;
+            key = (Uint16)(name[i] & 0x1F) << 6;
+            key |= (Uint16)(name[++i] & 0x3F);
+            return key;
+        }
+        return SDLK_UNKNOWN;
+    } else {
+        if (SDL3_strlen(name) == 1) {
+            if (key >= 'A' && key <= 'Z') {
+                key += 32;
+            }
+            return key;
+        }
+
+        /* Get the scancode for this name, and the associated keycode */
+        return SDL_GetKeyFromScancode(SDL_GetScancodeFromName(name));
     }
-    return surface3;
 }
 
-SDL_DECLSPEC SDL2_Surface *SDLCALL
-SDL_LoadBMP_RW(SDL2_RWops *rwops2, int freesrc)
+SDL_DECLSPEC const Uint8 *SDLCALL
+SDL_GetKeyboardState(int *numkeys)
 {
-    SDL_Surface *retval = NULL;
-    SDL_IOStream *iostrm3 = RWops2to3(rwops2);
-    if (iostrm3) {
-        retval = SDL3_LoadBMP_IO(iostrm3, true);   /* always close the iostrm3 bridge object. */
-    }
-    if (rwops2 && freesrc) {
-        SDL_RWclose(rwops2);
-    }
-    return Surface3to2(retval);
+    return (const Uint8 *)SDL3_GetKeyboardState(numkeys);
 }
 
-SDL_DECLSPEC int SDLCALL
-SDL_SaveBMP_RW(SDL2_Surface *surface, SDL2_RWops *rwops, int freedst)
+/* Several SDL3 video backends have had their names lower-cased, map to the SDL2 equivalent name. */
+static const char *ReplaceVideoBackendName(const char *name)
 {
-    int retval = -1;
-    SDL_IOStream *iostream = RWops2to3(rwops);
-    if (iostream) {
-        retval = SDL3_SaveBMP_IO(Surface2to3(surface), iostream, true) ? 0 : -1;    /* always close the iostrm3 bridge object. */
-    }
-    if (rwops && freedst) {
-        SDL_RWclose(rwops);
+    if (name) {
+        #define CHECKBACKEND(sdl2name) if (SDL3_strcasecmp(name, sdl2name) == 0) { return sdl2name; }
+        CHECKBACKEND("KMSDRM");
+        CHECKBACKEND("RPI");
+        CHECKBACKEND("Android");
+        CHECKBACKEND("PSP");
+        CHECKBACKEND("PS2");
+        CHECKBACKEND("VITA");
+        #undef CHECKBACKEND
     }
-    return retval;
+    return name;
 }
 
-SDL_DECLSPEC int SDLCALL
-SDL_GameControllerAddMappingsFromRW(SDL2_RWops *rwops2, int freerw)
+SDL_DECLSPEC const char * SDLCALL
+SDL_GetVideoDriver(int idx)
 {
-    int retval = -1;
-    SDL_IOStream *iostrm3 = RWops2to3(rwops2);
-    if (iostrm3) {
-        retval = SDL3_AddGamepadMappingsFromIO(iostrm3, true);    /* always close the iostrm3 bridge object. */
+    return ReplaceVideoBackendName(SDL3_GetVideoDriver(idx));
+}
+
+SDL_DECLSPEC const char * SDLCALL
+SDL_GetCurrentVideoDriver(void)
+{
+    return ReplaceVideoBackendName(SDL3_GetCurrentVideoDriver());
+}
+
+
+/* mouse coords became floats in SDL3 */
+
+SDL_DECLSPEC Uint32 SDLCALL
+SDL_GetMouseState(int *x, int *y)
+{
+    float fx, fy;
+    Uint32 ret = SDL3_GetMouseState(&fx, &fy);
+    if (x) *x = (int)fx;
+    if (y) *y = (int)fy;
+    return ret;
+}
+
+SDL_DECLSPEC Uint32 SDLCALL
+SDL_GetGlobalMouseState(int *x, int *y)
+{
+    float fx, fy;
+    Uint32 ret = SDL3_GetGlobalMouseState(&fx, &fy);
+    if (x) *x = (int)fx;
+    if (y) *y = (int)fy;
+    return ret;
+}
+
+SDL_DECLSPEC Uint32 SDLCALL
+SDL_GetRelativeMouseState(int *x, int *y)
+{
+    float fx, fy;
+    Uint32 ret = SDL3_GetRelativeMouseState(&fx, &fy);
+    if (x) *x = (int)fx;
+    if (y) *y = (int)fy;
+    return ret;
+}
+
+SDL_DECLSPEC void SDLCALL
+SDL_WarpMouseInWindow(SDL_Window *window, int x, int y)
+{
+    SDL3_WarpMouseInWindow(window, (float)x, (float)y);
+}
+
+SDL_DECLSPEC int SDLCALL
+SDL_WarpMouseGlobal(int x, int y)
+{
+    return SDL3_WarpMouseGlobal((float)x, (float)y) ? 0 : -1;
+}
+
+SDL_DECLSPEC int SDLCALL
+SDL_SetRelativeMouseMode(SDL2_bool enabled)
+{
+    int retval = 0;
+    SDL_Window **windows = SDL3_GetWindows(NULL);
+    if (windows) {
+        int i;
+
+        for (i = 0; windows[i]; ++i) {
+            if (!SDL3_SetWindowRelativeMouseMode(windows[i], enabled)) {
+                retval = -1;
+            }
+        }
+
+        SDL3_free(windows);
     }
-    if (rwops2 && freerw) {
-        SDL_RWclose(rwops2);
+    ResetPendingMouseMotion();  /* SDL3 flushes queued mouse motion when relative mode changes. */
+    if (retval == 0) {
+        relative_mouse_mode = enabled;
     }
     return retval;
 }
 
+SDL_DECLSPEC SDL2_bool SDLCALL
+SDL_GetRelativeMouseMode(void)
+{
+    return relative_mouse_mode;
+}
+
 SDL_DECLSPEC int SDLCALL
-SDL_SetWindowBrightness(SDL_Window *window, float brightness)
+SDL_CaptureMouse(SDL2_bool enabled)
 {
-    Uint16 ramp[256];
-    int status;
+    return SDL3_CaptureMouse(enabled) ? 0 : -1;
+}
 
-    if (!window) {
-        SDL3_SetError("Invalid window");
-        return -1;
+SDL_DECLSPEC SDL2_RWops *SDLCALL
+SDL_AllocRW(void)
+{
+    SDL2_RWops *rwops2 = (SDL2_RWops *)SDL3_malloc(sizeof *rwops2);
+    if (rwops2) {
+        rwops2->type = SDL_RWOPS_UNKNOWN;
+    }
+    return rwops2;
+}
+
+static Sint64 SDLCALL
+RWops3to2_size(SDL2_RWops *rwops2)
+{
+    return SDL3_GetIOSize(rwops2->hidden.sdl3.iostrm);
+}
+
+static Sint64 SDLCALL
+RWops3to2_seek(SDL2_RWops *rwops2, Sint64 offset, int whence)
+{
+    return SDL3_SeekIO(rwops2->hidden.sdl3.iostrm, offset, (SDL_IOWhence) whence);
+}
+
+static size_t SDLCALL
+RWops3to2_read(SDL2_RWops *rwops2, void *ptr, size_t size, size_t maxnum)
+{
+    size_t count = 0;
+    if (size > 0 && maxnum > 0) {
+        count = SDL3_ReadIO(rwops2->hidden.sdl3.iostrm, ptr, (size * maxnum)) / size;
     }
+    return count;
+}
 
-    SDL_CalculateGammaRamp(brightness, ramp);
-    status = SDL_SetWindowGammaRamp(window, ramp, ramp, ramp);
-    if (status == 0) {
-        SDL3_SetFloatProperty(SDL3_GetWindowProperties(window), PROP_WINDOW_BRIGHTNESS, brightness);
+static size_t SDLCALL
+RWops3to2_write(SDL2_RWops *rwops2, const void *ptr, size_t size, size_t maxnum)
+{
+    size_t count = 0;
+    if (size > 0 && maxnum > 0) {
+        count = SDL3_WriteIO(rwops2->hidden.sdl3.iostrm, ptr, (size * maxnum)) / size;
+    }
+    return count;
+}
+
+static int SDLCALL
+RWops3to2_close(SDL2_RWops *rwops2)
+{
+    int retval = 0;
+    if (rwops2->hidden.sdl3.iostrm) {
+        if (!SDL3_CloseIO(rwops2->hidden.sdl3.iostrm)) {
+            retval = -1;
+        }
+        rwops2->hidden.sdl3.iostrm = NULL;
+    }
+    SDL_FreeRW(rwops2);
+    return retval;
+}
+
+static SDL2_RWops *
+RWops3to2(SDL_IOStream *iostrm3, Uint32 type)
+{
+    SDL2_RWops *rwops2 = NULL;
+    if (iostrm3) {
+        rwops2 = SDL_AllocRW();
+        if (!rwops2) {
+            SDL3_CloseIO(iostrm3);  /* !!! FIXME: make sure this is still safe if things change. */
+            return NULL;
+        }
+
+        SDL3_zerop(rwops2);
+        rwops2->size = RWops3to2_size;
+        rwops2->seek = RWops3to2_seek;
+        rwops2->read = RWops3to2_read;
+        rwops2->write = RWops3to2_write;
+        rwops2->close = RWops3to2_close;
+        rwops2->type = type;
+        rwops2->hidden.sdl3.iostrm = iostrm3;
+    }
+    return rwops2;
+}
+
+SDL_DECLSPEC void SDLCALL
+SDL_FreeRW(SDL2_RWops *rwops2)
+{
+    if (rwops2->close == RWops3to2_close &&
+        rwops2->hidden.sdl3.iostrm) {
+        SDL3_CloseIO(rwops2->hidden.sdl3.iostrm);
+        rwops2->hidden.sdl3.iostrm = NULL;
+    }
+    SDL3_free(rwops2);
+}
+
+SDL_DECLSPEC SDL2_RWops *SDLCALL
+SDL_RWFromFile(const char *file, const char *mode)
+{
+    SDL2_RWops *rwops2 = NULL;
+
+    /* match some SDL2 Apple-specific quirks that were removed from SDL3. */
+    #if defined(SDL_PLATFORM_APPLE)
+    char *adjusted_path = NULL;
+    /* If the file mode is writable, skip all the bundle stuff because generally the bundle is read-only. */
+    if (mode && (SDL3_strchr(mode, 'r') != NULL) && SDL3_GetHintBoolean(SDL_HINT_APPLE_RWFROMFILE_USE_RESOURCES, true)) {
+        const char *base = SDL3_GetBasePath();
+        if (base) {
+            if (SDL3_asprintf(&adjusted_path, "%s%s", base, file) < 0) {
+                return NULL;
+            }
+            rwops2 = RWops3to2(SDL3_IOFromFile(adjusted_path, mode), SDL_RWOPS_PLATFORM_FILE);
+            SDL3_free(adjusted_path);
+        }
+    }
+    if (!rwops2) {
+        rwops2 = RWops3to2(SDL3_IOFromFile(file, mode), SDL_RWOPS_PLATFORM_FILE);
+    }
+    #else
+    rwops2 = RWops3to2(SDL3_IOFromFile(file, mode), SDL_RWOPS_PLATFORM_FILE);
+    #endif
+
+    if (rwops2) {
+        const SDL_PropertiesID props = SDL3_GetIOProperties(rwops2->hidden.sdl3.iostrm);
+        if (props) {
+            void *handle = NULL;
+            #if defined(SDL_PLATFORM_WINDOWS)
+            if (!handle) {
+                handle = SDL3_GetPointerProperty(props, SDL_PROP_IOSTREAM_WINDOWS_HANDLE_POINTER, NULL);
+                if (handle) {
+                    rwops2->hidden.windowsio.h = handle;
+                }
+            }
+            #elif defined(SDL_PLATFORM_ANDROID)
+            if (!handle) {
+                handle = SDL3_GetPointerProperty(props, SDL_PROP_IOSTREAM_ANDROID_AASSET_POINTER, NULL);
+                if (handle) {
+                    rwops2->hidden.androidio.asset = handle;
+                }
+            }
+            #endif
+
+            if (!handle) {
+                handle = SDL3_GetPointerProperty(props, SDL_PROP_IOSTREAM_STDIO_FILE_POINTER, NULL);
+                if (handle) {
+                    rwops2->hidden.stdio.autoclose = SDL2_FALSE;
+                    rwops2->hidden.stdio.fp = handle;
+                }
+            }
+        }
+    }
+    return rwops2;
+}
+
+SDL_DECLSPEC SDL2_RWops *SDLCALL
+SDL_RWFromMem(void *mem, int size)
+{
+    if (size < 0) { /* SDL3 already checks size == 0 */
+        SDL3_InvalidParamError("size");
+        return NULL;
+    }
+    return RWops3to2(SDL3_IOFromMem(mem, size), SDL_RWOPS_MEMORY);
+}
+
+SDL_DECLSPEC SDL2_RWops *SDLCALL
+SDL_RWFromConstMem(const void *mem, int size)
+{
+    if (size < 0) { /* SDL3 already checks size == 0 */
+        SDL3_InvalidParamError("size");
+        return NULL;
+    }
+    return RWops3to2(SDL3_IOFromConstMem(mem, size), SDL_RWOPS_MEMORY_RO);
+}
+
+SDL_DECLSPEC Sint64 SDLCALL
+SDL_RWsize(SDL2_RWops *rwops2)
+{
+    return rwops2->size(rwops2);
+}
+
+SDL_DECLSPEC Sint64 SDLCALL
+SDL_RWseek(SDL2_RWops *rwops2, Sint64 offset, int whence)
+{
+    return rwops2->seek(rwops2, offset, whence);
+}
+
+SDL_DECLSPEC Sint64 SDLCALL
+SDL_RWtell(SDL2_RWops *rwops2)
+{
+    return rwops2->seek(rwops2, 0, SDL_IO_SEEK_CUR);
+}
+
+SDL_DECLSPEC size_t SDLCALL
+SDL_RWread(SDL2_RWops *rwops2, void *ptr, size_t size, size_t maxnum)
+{
+    return rwops2->read(rwops2, ptr, size, maxnum);
+}
+
+SDL_DECLSPEC size_t SDLCALL
+SDL_RWwrite(SDL2_RWops *rwops2, const void *ptr, size_t size, size_t num)
+{
+    return rwops2->write(rwops2, ptr, size, num);
+}
+
+SDL_DECLSPEC int SDLCALL
+SDL_RWclose(SDL2_RWops *rwops2)
+{
+    return rwops2->close(rwops2);
+}
+
+SDL_DECLSPEC Uint8 SDLCALL
+SDL_ReadU8(SDL2_RWops *rwops2)
+{
+    Uint8 x = 0;
+    SDL_RWread(rwops2, &x, sizeof (x), 1);
+    return x;
+}
+
+SDL_DECLSPEC size_t SDLCALL
+SDL_WriteU8(SDL2_RWops *rwops2, Uint8 x)
+{
+    return SDL_RWwrite(rwops2, &x, sizeof(x), 1);
+}
+
+#define DO_RWOPS_ENDIAN(order, bits)        \
+SDL_DECLSPEC Uint##bits SDLCALL             \
+SDL_Read##order##bits(SDL2_RWops *rwops2) { \
+    Uint##bits x = 0;                       \
+    SDL_RWread(rwops2, &x, sizeof (x), 1);  \
+    return SDL_Swap##bits##order(x);        \
+} \
+                                                           \
+SDL_DECLSPEC size_t SDLCALL                                \
+SDL_Write##order##bits(SDL2_RWops *rwops2, Uint##bits x) { \
+    x = SDL_Swap##bits##order(x);                          \
+    return SDL_RWwrite(rwops2, &x, sizeof(x), 1);          \
+}
+DO_RWOPS_ENDIAN(LE, 16)
+DO_RWOPS_ENDIAN(BE, 16)
+DO_RWOPS_ENDIAN(LE, 32)
+DO_RWOPS_ENDIAN(BE, 32)
+DO_RWOPS_ENDIAN(LE, 64)
+DO_RWOPS_ENDIAN(BE, 64)
+#undef DO_RWOPS_ENDIAN
+
+/* stdio SDL_RWops was removed from SDL3, to prevent incompatible C runtime issues */
+#ifndef HAVE_STDIO_H
+SDL_DECLSPEC SDL2_RWops * SDLCALL
+SDL_RWFromFP(void *fp, SDL2_bool autoclose)
+{
+    SDL3_SetError("SDL not compiled with stdio support");
+    return NULL;
+}
+#else
+
+/* !!! FIXME: SDL2 has a bunch of macro salsa to try and use the most 64-bit
+fseek, etc, and I'm avoiding that for now; this can change if it becomes a
+problem.  --ryan. */
+
+/* Functions to read/write stdio file pointers */
+
+static Sint64 SDLCALL
+stdio_size(SDL2_RWops *rwops2)
+{
+    Sint64 pos, size;
+
+    pos = SDL_RWseek(rwops2, 0, SDL_IO_SEEK_CUR);
+    if (pos < 0) {
+        return -1;
+    }
+    size = SDL_RWseek(rwops2, 0, SDL_IO_SEEK_END);
+
+    SDL_RWseek(rwops2, pos, SDL_IO_SEEK_SET);
+    return size;
+}
+
+static Sint64 SDLCALL
+stdio_seek(SDL2_RWops *rwops2, Sint64 offset, int whence)
+{
+    FILE *fp = (FILE *) rwops2->hidden.stdio.fp;
+    int stdiowhence;
+
+    switch (whence) {
+    case SDL_IO_SEEK_SET:
+        stdiowhence = SEEK_SET;
+        break;
+    case SDL_IO_SEEK_CUR:
+        stdiowhence = SEEK_CUR;
+        break;
+    case SDL_IO_SEEK_END:
+        stdiowhence = SEEK_END;
+        break;
+    default:
+        SDL3_SetError("Unknown value for 'whence'");
+        return -1;
+    }
+
+#if defined(FSEEK_OFF_MIN) && defined(FSEEK_OFF_MAX)
+    if (offset < (Sint64)(FSEEK_OFF_MIN) || offset > (Sint64)(FSEEK_OFF_MAX)) {
+        SDL3_SetError("Seek offset out of range");
+        return -1;
+    }
+#endif
+
+    if (fseek(fp, (long)offset, stdiowhence) == 0) {
+        Sint64 pos = ftell(fp);
+        if (pos < 0) {
+            SDL3_SetError("Couldn't get stream offset");
+            return -1;
+        }
+        return pos;
+    }
+    return SDL_Error(SDL_EFSEEK);
+}
+
+static size_t SDLCALL
+stdio_read(SDL2_RWops *rwops2, void *ptr, size_t size, size_t maxnum)
+{
+    FILE *fp = (FILE *) rwops2->hidden.stdio.fp;
+    size_t nread = fread(ptr, size, maxnum, fp);
+    if (nread == 0 && ferror(fp)) {
+        SDL_Error(SDL_EFREAD);
+    }
+    return nread;
+}
+
+static size_t SDLCALL
+stdio_write(SDL2_RWops *rwops2, const void *ptr, size_t size, size_t num)
+{
+    FILE *fp = (FILE *) rwops2->hidden.stdio.fp;
+    size_t nwrote = fwrite(ptr, size, num, fp);
+    if (nwrote == 0 && ferror(fp)) {
+        SDL_Error(SDL_EFWRITE);
+    }
+    return nwrote;
+}
+
+static int SDLCALL
+stdio_close(SDL2_RWops *rwops2)
+{
+    int status = 0;
+    if (rwops2) {
+        if (rwops2->hidden.stdio.autoclose) {
+            if (fclose((FILE *)rwops2->hidden.stdio.fp) != 0) {
+                status = SDL_Error(SDL_EFWRITE);
+            }
+        }
+        SDL_FreeRW(rwops2);
+    }
+    return status;
+}
+
+SDL_DECLSPEC SDL2_RWops * SDLCALL
+SDL_RWFromFP(void *fp, SDL2_bool autoclose)
+{
+    SDL2_RWops *rwops = SDL_AllocRW();
+    if (rwops != NULL) {
+        rwops->size = stdio_size;
+        rwops->seek = stdio_seek;
+        rwops->read = stdio_read;
+        rwops->write = stdio_write;
+        rwops->close = stdio_close;
+        rwops->hidden.stdio.fp = (FILE *) fp;
+        rwops->hidden.stdio.autoclose = autoclose;
+        rwops->type = SDL_RWOPS_STDFILE;
+    }
+    return rwops;
+}
+#endif
+
+static Sint64 SDLCALL
+RWops2to3_size(void *userdata)
+{
+    return SDL_RWsize((SDL2_RWops *) userdata);
+}
+
+static Sint64 SDLCALL
+RWops2to3_seek(void *userdata, Sint64 offset, SDL_IOWhence whence)
+{
+    return SDL_RWseek((SDL2_RWops *) userdata, offset, whence);
+}
+
+static size_t SDLCALL
+RWops2to3_read(void *userdata, void *ptr, size_t size, SDL_IOStatus *status)
+{
+    return SDL_RWread((SDL2_RWops *) userdata, ptr, 1, size);
+}
+
+static size_t SDLCALL
+RWops2to3_write(void *userdata, const void *ptr, size_t size, SDL_IOStatus *status)
+{
+    return SDL_RWwrite((SDL2_RWops *) userdata, ptr, 1, size);
+}
+
+static bool SDLCALL
+RWops2to3_close(void *userdata)
+{
+    /* Never close the SDL2_RWops here! This is just a wrapper to talk to SDL3 APIs. We will manually close the rwops2 if appropriate. */
+    /*return SDL3_CloseIO((SDL2_RWops *) userdata) ? 0 : -1;*/
+    return true;
+}
+
+static SDL_IOStream *
+RWops2to3(SDL2_RWops *rwops2)
+{
+    SDL_IOStream *iostrm3 = NULL;
+    if (rwops2) {
+        SDL_IOStreamInterface iface;
+        SDL_INIT_INTERFACE(&iface);
+        iface.size = RWops2to3_size;
+        iface.seek = RWops2to3_seek;
+        iface.read = RWops2to3_read;
+        iface.write = RWops2to3_write;
+        iface.close = RWops2to3_close;
+
+        iostrm3 = SDL3_OpenIO(&iface, rwops2);
+        if (!iostrm3) {
+            return NULL;
+        }
+    }
+    return iostrm3;
+}
+
+SDL_DECLSPEC void *SDLCALL
+SDL_LoadFile_RW(SDL2_RWops *rwops2, size_t *datasize, int freesrc)
+{
+    void *retval = NULL;
+
+    SDL_IOStream *iostrm3 = RWops2to3(rwops2);
+    if (iostrm3) {
+        retval = SDL3_LoadFile_IO(iostrm3, datasize, true);  /* always close the iostrm3 bridge object. */
+    }
+
+    if (rwops2 && freesrc) {
+        SDL_RWclose(rwops2);
+    }
+
+    return retval;
+}
+
+SDL_DECLSPEC SDL2_AudioSpec *SDLCALL
+SDL_LoadWAV_RW(SDL2_RWops *rwops2, int freesrc, SDL2_AudioSpec *spec2, Uint8 **audio_buf, Uint32 *audio_len)
+{
+    SDL2_AudioSpec *retval = NULL;
+
+    if (spec2 == NULL) {
+        SDL3_InvalidParamError("spec");
+    } else {
+        SDL_IOStream *iostrm3 = RWops2to3(rwops2);
+        if (iostrm3) {
+            SDL_AudioSpec spec3;
+            const bool rc = SDL3_LoadWAV_IO(iostrm3, true, &spec3, audio_buf, audio_len);   /* always close the iostrm3 bridge object. */
+            SDL3_zerop(spec2);
+            if (rc) {
+                spec2->format = spec3.format;
+                spec2->channels = spec3.channels;
+                spec2->freq = spec3.freq;
+                spec2->samples = 4096; /* This is what SDL2 hardcodes, also. */
+                spec2->silence = SDL3_GetSilenceValueForFormat(spec3.format);
+                retval = spec2;
+            }
+        }
+    }
+
+    if (rwops2 && freesrc) {
+        SDL_RWclose(rwops2);
+    }
+
+    return retval;
+}
+
+/* SDL3 surface -> SDL2 surface, an open-addressed hash table keyed by the SDL3 surface pointer.
+ * Each SDL3 surface also carries a PROP_SURFACE2 property whose cleanup removes its entry, so an
+ * entry can't outlive its surface and get picked up by a new surface at the same address.
+ * The property is only touched when linking and unlinking, lookups never go through it.
+ */
+typedef struct SurfaceLink
+{
+    SDL_Surface *surface3;  /* NULL for an empty slot */
+    SDL2_Surface *surface2;
+} SurfaceLink;
+
+static SDL_SpinLock SurfaceLinksLock = 0;
+static SurfaceLink *SurfaceLinks = NULL;
+static int NumSurfaceLinks = 0;
+static int MaxSurfaceLinks = 0;  /* always 0 or a power of two */
+
+static int GetSurfaceLinkHome(const SDL_Surface *surface3)
+{
+    const Uint64 key = (Uint64)(uintptr_t)surface3;
+    return (int)(((key >> 4) * SDL_UINT64_C(0x9E3779B97F4A7C15)) >> 32) & (MaxSurfaceLinks - 1);
+}
+
+/* Must be called with SurfaceLinksLock held and MaxSurfaceLinks > 0 */
+static int FindSurfaceLinkSlot(const SDL_Surface *surface3)
+{
+    const int mask = MaxSurfaceLinks - 1;
+    int i = GetSurfaceLinkHome(surface3);
+
+    while (SurfaceLinks[i].surface3 && SurfaceLinks[i].surface3 != surface3) {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+/* Must be called with SurfaceLinksLock held */
+static bool GrowSurfaceLinks(void)
+{
+    SurfaceLink *oldlinks = SurfaceLinks;
+    const int oldmax = MaxSurfaceLinks;
+    const int newmax = oldmax ? (oldmax * 2) : 64;
+    SurfaceLink *links;
+    int i;
+
+    links = (SurfaceLink *)SDL3_calloc(newmax, sizeof(*links));
+    if (!links) {
+        return false;
+    }
+
+    SurfaceLinks = links;
+    MaxSurfaceLinks = newmax;
+    for (i = 0; i < oldmax; ++i) {
+        if (oldlinks[i].surface3) {
+            SurfaceLinks[FindSurfaceLinkSlot(oldlinks[i].surface3)] = oldlinks[i];
+        }
+    }
+    SDL3_free(oldlinks);
+    return true;
+}
+
+static SDL2_Surface *FindSurface2(const SDL_Surface *surface3)
+{
+    SDL2_Surface *surface2 = NULL;
+
+    SDL3_LockSpinlock(&SurfaceLinksLock);
+    if (NumSurfaceLinks > 0) {
+        surface2 = SurfaceLinks[FindSurfaceLinkSlot(surface3)].surface2;
+    }
+    SDL3_UnlockSpinlock(&SurfaceLinksLock);
+    return surface2;
+}
+
+static void RemoveSurfaceLink(const SDL_Surface *surface3, const SDL2_Surface *surface2)
+{
+    int i, j, home;
+
+    SDL3_LockSpinlock(&SurfaceLinksLock);
+    if (NumSurfaceLinks > 0) {
+        const int mask = MaxSurfaceLinks - 1;
+        i = FindSurfaceLinkSlot(surface3);
+        if (SurfaceLinks[i].surface3 && SurfaceLinks[i].surface2 == surface2) {
+            /* Move later entries of the probe sequence back into the hole, so lookups don't need tombstones */
+            for (j = (i + 1) & mask; SurfaceLinks[j].surface3; j = (j + 1) & mask) {
+                home = GetSurfaceLinkHome(SurfaceLinks[j].surface3);
+                if ((i <= j) ? (home <= i || home > j) : (home <= i && home > j)) {
+                    SurfaceLinks[i] = SurfaceLinks[j];
+                    i = j;
+                }
+            }
+            SurfaceLinks[i].surface3 = NULL;
+            SurfaceLinks[i].surface2 = NULL;
+            --NumSurfaceLinks;
+        }
+    }
+    SDL3_UnlockSpinlock(&SurfaceLinksLock);
+}
+
+static void SDLCALL CleanupSurfaceLink(void *userdata, void *value)
+{
+    RemoveSurfaceLink((const SDL_Surface *)userdata, (const SDL2_Surface *)value);
+}
+
+static bool LinkSurfaces(SDL_Surface *surface3, SDL2_Surface *surface2)
+{
+    bool result = true;
+    int i;
+
+    SDL3_LockSpinlock(&SurfaceLinksLock);
+    if ((NumSurfaceLinks + 1) * 2 > MaxSurfaceLinks) {
+        result = GrowSurfaceLinks();
+    }
+    if (result) {
+        i = FindSurfaceLinkSlot(surface3);
+        if (!SurfaceLinks[i].surface3) {
+            SurfaceLinks[i].surface3 = surface3;
+            ++NumSurfaceLinks;
+        }
+        SurfaceLinks[i].surface2 = surface2;
+    }
+    SDL3_UnlockSpinlock(&SurfaceLinksLock);
+
+    if (!result) {
+        return SDL3_OutOfMemory();
+    }
+
+    /* If this fails, the cleanup runs right away and removes the link again */
+    return SDL3_SetPointerPropertyWithCleanup(SDL3_GetSurfaceProperties(surface3), PROP_SURFACE2, surface2, CleanupSurfaceLink, surface3);
+}
+
+static void FreeSurfaceLinks(void)
+{
+    SDL3_LockSpinlock(&SurfaceLinksLock);
+    SDL3_free(SurfaceLinks);
+    SurfaceLinks = NULL;
+    NumSurfaceLinks = 0;
+    MaxSurfaceLinks = 0;
+    SDL3_UnlockSpinlock(&SurfaceLinksLock);
+}
+
+static SDL2_Surface *CreateSurface2from3(SDL_Surface *surface3)
+{
+    /* Allocate the surface */
+    SDL2_Surface *surface = (SDL2_Surface *)SDL3_calloc(1, sizeof(*surface));
+    if (!surface) {
+        SDL3_OutOfMemory();
+        return NULL;
+    }
+
+    /* Link the surfaces */
+    surface->map = (SDL_BlitMap *)surface3;
+    if (!LinkSurfaces(surface3, surface)) {
+        SDL_FreeSurface(surface);
+        return NULL;
+    }
+
+    surface->format = SDL_AllocFormat(surface3->format);
+    if (!surface->format) {
+        SDL_FreeSurface(surface);
+        return NULL;
+    }
+    surface->flags = (surface3->flags & SHARED_SURFACE_FLAGS);
+    surface->w = surface3->w;
+    surface->h = surface3->h;
+    surface->pixels = surface3->pixels;
+    surface->pitch = surface3->pitch;
+
+    SDL3_GetSurfaceClipRect(surface3, &surface->clip_rect);
+
+    if (SDL_ISPIXELFORMAT_INDEXED(surface3->format)) {
+        SDL_Palette *palette = SDL3_GetSurfacePalette(surface3);
+        if (!palette) {
+            palette = SDL3_CreateSurfacePalette(surface3);
+            if (!palette) {
+                SDL_FreeSurface(surface);
+                return NULL;
+            }
+        }
+        surface->format->palette = palette;
+        ++palette->refcount;
+    }
+
+    /* The surface is ready to go */
+    surface->refcount = 1;
+    return surface;
+}
+
+static SDL2_Surface *Surface3to2(SDL_Surface *surface)
+{
+    SDL2_Surface *surface2 = NULL;
+
+    if (surface) {
+        surface2 = FindSurface2(surface);
+        if (!surface2) {
+            surface2 = CreateSurface2from3(surface);
+        }
+    }
+    return surface2;
+}
+
+static void SynchronizeSurface3to2(SDL_Surface *surface, SDL2_Surface *surface2)
+{
+    /* Synchronize any changes made by SDL to the SDL3 surface
+     * SDL might have changed flags or freed the pixels, e.g.:
+     * https://github.com/libsdl-org/SDL/blob/be991239d9bc6df06b0ca7a9ae9dbb7251e93c12/src/video/SDL_RLEaccel.c#L1180-L1189
+     */
+    if (surface && surface->pixels != surface2->pixels) {
+        surface2->flags &= ~SHARED_SURFACE_FLAGS;
+        surface2->flags |= (surface->flags & SHARED_SURFACE_FLAGS);
+        surface2->pixels = surface->pixels;
+        surface2->pitch = surface->pitch;
+    }
+}
+
+static SDL_Surface *Surface2to3(SDL2_Surface *surface)
+{
+    SDL_Surface *surface3 = NULL;
+
+    if (surface) {
+        surface3 = (SDL_Surface *)surface->map;
+        SDL_assert(surface3 != NULL);
+
+        /* Synchronize any changes made by the application to the SDL2 surface
+         * The application might have changed memory allocation, e.g.:
+         * https://github.com/libsdl-org/SDL_ttf/blob/7e4a456bf463b887b94c191030dd742d7654d6ff/SDL_ttf.c#L1476-L1478
+         * This is rare, so only write to the SDL3 surface when something actually changed.
+         */
+        if (surface3->pixels != surface->pixels ||
+            surface3->pitch != surface->pitch ||
+            surface3->w != surface->w ||
+            surface3->h != surface->h ||
+            ((surface3->flags ^ surface->flags) & SHARED_SURFACE_FLAGS)) {
+            surface3->w = surface->w;
+            surface3->h = surface->h;
+            surface3->flags &= ~SHARED_SURFACE_FLAGS;
+            surface3->flags |= (surface->flags & SHARED_SURFACE_FLAGS);
+            surface3->pixels = surface->pixels;
+            surface3->pitch = surface->pitch;
+        }
+    }
+    return surface3;
+}
+
+SDL_DECLSPEC SDL2_Surface *SDLCALL
+SDL_LoadBMP_RW(SDL2_RWops *rwops2, int freesrc)
+{
+    SDL_Surface *retval = NULL;
+    SDL_IOStream *iostrm3 = RWops2to3(rwops2);
+    if (iostrm3) {
+        retval = SDL3_LoadBMP_IO(iostrm3, true);   /* always close the iostrm3 bridge object. */
+    }
+    if (rwops2 && freesrc) {
+        SDL_RWclose(rwops2);
+    }
+    return Surface3to2(retval);
+}
+
+SDL_DECLSPEC int SDLCALL
+SDL_SaveBMP_RW(SDL2_Surface *surface, SDL2_RWops *rwops, int freedst)
+{
+    int retval = -1;
+    SDL_IOStream *iostream = RWops2to3(rwops);
+    if (iostream) {
+        retval = SDL3_SaveBMP_IO(Surface2to3(surface), iostream, true) ? 0 : -1;    /* always close the iostrm3 bridge object. */
+    }
+    if (rwops && freedst) {
+        SDL_RWclose(rwops);
+    }
+    return retval;
+}
+
+SDL_DECLSPEC int SDLCALL
+SDL_GameControllerAddMappingsFromRW(SDL2_RWops *rwops2, int freerw)
+{
+    int retval = -1;
+    SDL_IOStream *iostrm3 = RWops2to3(rwops2);
+    if (iostrm3) {
+        retval = SDL3_AddGamepadMappingsFromIO(iostrm3, true);    /* always close the iostrm3 bridge object. */
+    }
+    if (rwops2 && freerw) {
+        SDL_RWclose(rwops2);
+    }
+    return retval;
+}
+
+SDL_DECLSPEC int SDLCALL
+SDL_SetWindowBrightness(SDL_Window *window, float brightness)
+{
+    Uint16 ramp[256];
+    int status;
+
+    if (!window) {
+        SDL3_SetError("Invalid window");
+        return -1;
+    }
+
+    SDL_CalculateGammaRamp(brightness, ramp);
+    status = SDL_SetWindowGammaRamp(window, ramp, ramp, ramp);
+    if (status == 0) {
+        SDL3_SetFloatProperty(SDL3_GetWindowProperties(window), PROP_WINDOW_BRIGHTNESS, brightness);
+    }
+    return status;
+}
+
+SDL_DECLSPEC float SDLCALL
+SDL_GetWindowBrightness(SDL_Window *window)
+{
+    if (!window) {
+        SDL3_SetError("Invalid window");
+        return 1.0f;
+    }
+
+    return SDL3_GetFloatProperty(SDL3_GetWindowProperties(window), PROP_WINDOW_BRIGHTNESS, 1.0f);
+}
+
+SDL_DECLSPEC void SDLCALL
+SDL_CalculateGammaRamp(float gamma, Uint16 *ramp)
+{
+    int i;
+
+    /* Input validation */
+    if (gamma < 0.0f) {
+      SDL3_InvalidParamError("gamma");
+      return;
+    }
+    if (ramp == NULL) {
+      SDL3_InvalidParamError("ramp");
+      return;
+    }
+
+    /* 0.0 gamma is all black */
+    if (gamma == 0.0f) {
+        SDL3_memset(ramp, 0, 256 * sizeof(Uint16));
+        return;
+    }
+    if (gamma == 1.0f) {
+        /* 1.0 gamma is identity */
+        for (i = 0; i < 256; ++i) {
+            ramp[i] = (i << 8) | i;
+        }
+        return;
+    } else {
+        /* Calculate a real gamma ramp */
+        int value;
+        gamma = 1.0f / gamma;
+        for (i = 0; i < 256; ++i) {
+            value =
+                (int) (SDL3_pow((double) i / 256.0, gamma) * 65535.0 + 0.5);
+            if (value > 65535) {
+                value = 65535;
+            }
+            ramp[i] = (Uint16) value;
+        }
+    }
+}
+
+static void SDLCALL CleanupFreeableProperty(void *userdata, void *value)
+{
+    SDL3_free(value);
+}
+
+/* Gamma ramp emulation.
+ *
+ * SDL3 doesn't do gamma ramps, so if the SDL2_GAMMA_RAMP_EMULATION hint is set, sdl2-compat
+ * applies them itself as the last step before a frame is shown:
+ *  - SDL_UpdateWindowSurface() and SDL_UpdateWindowSurfaceRects() run the updated part of the
+ *    window surface through the ramp, show it, and then put the app's pixels back.
+ *  - SDL_RenderPresent() reads the frame back, runs it through the ramp and draws it over the
+ *    whole window.
+ * Only 32-bit formats with 8-bit color channels are ramped in place, which covers the window
+ * surfaces SDL3 makes on desktop platforms. Render readbacks in other formats are converted.
+ *
+ * Windows with an identity ramp, which includes all of them until an app sets one, aren't
+ * counted in NumGammaRampWindows, so apps that never touch gamma don't pay for any of this.
+ */
+typedef struct WindowGammaRamp
+{
+    Uint16 ramp[3 * 256];
+    Uint8 lut[3][256];  /* the ramp cut down to 8 bits */
+    bool identity;
+    void *backup;       /* the window surface pixels under the ramp while it's shown */
+    size_t backup_size;
+} WindowGammaRamp;
+
+typedef struct GammaKernel
+{
+    const Uint8 (*lut)[256];
+    Uint32 keep;            /* the bits that aren't red, green or blue */
+    int shifts[3];
+    int offsets[3];         /* byte offset of each channel in memory */
+    Uint32 lut32[3][256];   /* the lut, already shifted into place */
+} GammaKernel;
+
+static SDL_AtomicInt NumGammaRampWindows;
+
+static void SDLCALL CleanupWindowGammaRamp(void *userdata, void *value)
+{
+    WindowGammaRamp *gamma = (WindowGammaRamp *)value;
+
+    if (!gamma->identity) {
+        SDL3_AddAtomicInt(&NumGammaRampWindows, -1);
+    }
+    SDL3_free(gamma->backup);
+    SDL3_free(gamma);
+}
+
+static WindowGammaRamp *GetWindowGammaRamp(SDL_Window *window, bool create)
+{
+    SDL_PropertiesID props = SDL3_GetWindowProperties(window);
+    WindowGammaRamp *gamma = (WindowGammaRamp *)SDL3_GetPointerProperty(props, PROP_WINDOW_GAMMA_RAMP, NULL);
+
+    if (!gamma && create) {
+        int i;
+
+        gamma = (WindowGammaRamp *)SDL3_calloc(1, sizeof(*gamma));
+        if (!gamma) {
+            return NULL;
+        }
+
+        /* Create an identity gamma ramp */
+        for (i = 0; i < 256; ++i) {
+            Uint16 value = (Uint16)((i << 8) | i);
+
+            gamma->ramp[0*256+i] = value;
+            gamma->ramp[1*256+i] = value;
+            gamma->ramp[2*256+i] = value;
+            gamma->lut[0][i] = gamma->lut[1][i] = gamma->lut[2][i] = (Uint8)i;
+        }
+        gamma->identity = true;
+        if (!SDL3_SetPointerPropertyWithCleanup(props, PROP_WINDOW_GAMMA_RAMP, gamma, CleanupWindowGammaRamp, NULL)) {
+            return NULL;
+        }
+    }
+    return gamma;
+}
+
+static void UpdateGammaRampLUT(WindowGammaRamp *gamma)
+{
+    const bool was_identity = gamma->identity;
+    int i, j;
+
+    gamma->identity = true;
+    for (i = 0; i < 3; ++i) {
+        for (j = 0; j < 256; ++j) {
+            gamma->lut[i][j] = (Uint8)(gamma->ramp[i*256+j] >> 8);
+            if (gamma->lut[i][j] != j) {
+                gamma->identity = false;
+            }
+        }
+    }
+
+    if (gamma->identity != was_identity) {
+        SDL3_AddAtomicInt(&NumGammaRampWindows, gamma->identity ? -1 : 1);
+    }
+}
+
+/* Returns false if the ramp can't be applied to pixels in this format */
+static bool SetupGammaKernel(const WindowGammaRamp *gamma, SDL_PixelFormat format, GammaKernel *kernel)
+{
+    Uint32 masks[4];
+    int bpp, i, j;
+
+    if (!SDL3_GetMasksForPixelFormat(format, &bpp, &masks[0], &masks[1], &masks[2], &masks[3]) || bpp != 32) {
+        return false;
+    }
+
+    kernel->lut = gamma->lut;
+    kernel->keep = ~(masks[0] | masks[1] | masks[2]);
+    for (i = 0; i < 3; ++i) {
+        int shift;
+
+        for (shift = 0; shift < 32; shift += 8) {
+            if (masks[i] == (0xFFu << shift)) {
+                break;
+            }
+        }
+        if (shift == 32) {
+            return false;
+        }
+        kernel->shifts[i] = shift;
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+        kernel->offsets[i] = shift / 8;
+#else
+        kernel->offsets[i] = 3 - (shift / 8);
+#endif
+        for (j = 0; j < 256; ++j) {
+            kernel->lut32[i][j] = (Uint32)gamma->lut[i][j] << shift;
+        }
+    }
+    return true;
+}
+
+static void ApplyGammaRow(const GammaKernel *kernel, Uint32 *row, int w)
+{
+    const Uint32 *lut0 = kernel->lut32[0];
+    const Uint32 *lut1 = kernel->lut32[1];
+    const Uint32 *lut2 = kernel->lut32[2];
+    const int shift0 = kernel->shifts[0];
+    const int shift1 = kernel->shifts[1];
+    const int shift2 = kernel->shifts[2];
+    int x;
+
+    for (x = 0; x < w; ++x) {
+        const Uint32 pixel = row[x];
+        row[x] = (pixel & kernel->keep) |
+                 lut0[(pixel >> shift0) & 0xFF] |
+                 lut1[(pixel >> shift1) & 0xFF] |
+                 lut2[(pixel >> shift2) & 0xFF];
+    }
+}
+
+#ifdef SDL_AVX2_INTRINSICS
+/* Eight pixels at a time, with one gather per channel */
+static void SDL_TARGETING("avx2") ApplyGammaRow_AVX2(const GammaKernel *kernel, Uint32 *row, int w)
+{
+    const __m256i keep = _mm256_set1_epi32((int)kernel->keep);
+    const __m256i byte = _mm256_set1_epi32(0xFF);
+    const __m128i shift0 = _mm_cvtsi32_si128(kernel->shifts[0]);
+    const __m128i shift1 = _mm_cvtsi32_si128(kernel->shifts[1]);
+    const __m128i shift2 = _mm_cvtsi32_si128(kernel->shifts[2]);
+    int x;
+
+    for (x = 0; x + 8 <= w; x += 8) {
+        __m256i pixels = _mm256_loadu_si256((const __m256i *)(row + x));
+        __m256i c0 = _mm256_i32gather_epi32((const int *)kernel->lut32[0], _mm256_and_si256(_mm256_srl_epi32(pixels, shift0), byte), 4);
+        __m256i c1 = _mm256_i32gather_epi32((const int *)kernel->lut32[1], _mm256_and_si256(_mm256_srl_epi32(pixels, shift1), byte), 4);
+        __m256i c2 = _mm256_i32gather_epi32((const int *)kernel->lut32[2], _mm256_and_si256(_mm256_srl_epi32(pixels, shift2), byte), 4);
+
+        pixels = _mm256_or_si256(_mm256_and_si256(pixels, keep), _mm256_or_si256(c0, _mm256_or_si256(c1, c2)));
+        _mm256_storeu_si256((__m256i *)(row + x), pixels);
+    }
+    ApplyGammaRow(kernel, row + x, w - x);
+}
+#endif /* SDL_AVX2_INTRINSICS */
+
+#if defined(SDL_NEON_INTRINSICS) && (defined(__aarch64__) || defined(_M_ARM64))
+#define HAVE_GAMMA_NEON
+
+/* Look up 16 bytes in a 256 byte table, 64 bytes at a time */
+static uint8x16_t LookupGamma_NEON(const uint8x16x4_t *table, uint8x16_t index)
+{
+    const uint8x16_t step = vdupq_n_u8(64);
+    uint8x16_t result = vqtbl4q_u8(table[0], index);
+
+    index = vsubq_u8(index, step);
+    result = vqtbx4q_u8(result, table[1], index);
+    index = vsubq_u8(index, step);
+    result = vqtbx4q_u8(result, table[2], index);
+    index = vsubq_u8(index, step);
+    return vqtbx4q_u8(result, table[3], index);
+}
+
+/* Sixteen pixels at a time, split into one vector per byte */
+static void ApplyGammaRow_NEON(const GammaKernel *kernel, Uint32 *row, int w)
+{
+    uint8x16x4_t tables[3][4];
+    int i, j, k, x;
+
+    for (i = 0; i < 3; ++i) {
+        for (j = 0; j < 4; ++j) {
+            for (k = 0; k < 4; ++k) {
+                tables[i][j].val[k] = vld1q_u8(&kernel->lut[i][(j * 64) + (k * 16)]);
+            }
+        }
+    }
+
+    for (x = 0; x + 16 <= w; x += 16) {
+        uint8x16x4_t pixels = vld4q_u8((const Uint8 *)(row + x));
+
+        for (i = 0; i < 3; ++i) {
+            pixels.val[kernel->offsets[i]] = LookupGamma_NEON(tables[i], pixels.val[kernel->offsets[i]]);
+        }
+        vst4q_u8((Uint8 *)(row + x), pixels);
+    }
+    ApplyGammaRow(kernel, row + x, w - x);
+}
+#endif /* HAVE_GAMMA_NEON */
+
+static void ApplyGamma(const GammaKernel *kernel, void *pixels, int pitch, const SDL_Rect *rect)
+{
+    void (*apply_row)(const GammaKernel *kernel, Uint32 *row, int w) = ApplyGammaRow;
+    int y;
+
+#ifdef SDL_AVX2_INTRINSICS
+    if (SDL3_HasAVX2()) {
+        apply_row = ApplyGammaRow_AVX2;
+    }
+#endif
+#ifdef HAVE_GAMMA_NEON
+    if (SDL3_HasNEON()) {
+        apply_row = ApplyGammaRow_NEON;
+    }
+#endif
+
+    for (y = 0; y < rect->h; ++y) {
+        apply_row(kernel, (Uint32 *)((Uint8 *)pixels + ((rect->y + y) * pitch)) + rect->x, rect->w);
+    }
+}
+
+/* Copy the window surface pixels in area to or from the backup, returns false if out of memory */
+static bool CopyGammaBackup(WindowGammaRamp *gamma, SDL_Surface *surface, const SDL_Rect *area, bool backup)
+{
+    const size_t row_size = (size_t)area->w * 4;
+    Uint8 *pixels = (Uint8 *)surface->pixels + (area->y * surface->pitch) + (area->x * 4);
+    int y;
+
+    if (backup && (row_size * area->h) > gamma->backup_size) {
+        void *buffer = SDL3_realloc(gamma->backup, row_size * area->h);
+        if (!buffer) {
+            return false;
+        }
+        gamma->backup = buffer;
+        gamma->backup_size = row_size * area->h;
+    }
+
+    for (y = 0; y < area->h; ++y) {
+        Uint8 *saved = (Uint8 *)gamma->backup + (y * row_size);
+        if (backup) {
+            SDL3_memcpy(saved, pixels, row_size);
+        } else {
+            SDL3_memcpy(pixels, saved, row_size);
+        }
+        pixels += surface->pitch;
+    }
+    return true;
+}
+
+static int UpdateWindowSurfaceWithGamma(SDL_Window *window, const SDL_Rect *rects, int numrects)
+{
+    WindowGammaRamp *gamma = NULL;
+    SDL_Surface *surface = NULL;
+    GammaKernel kernel;
+    SDL_Rect area;
+    bool result;
+
+    if (window && SDL3_GetAtomicInt(&NumGammaRampWindows) > 0) {
+        gamma = GetWindowGammaRamp(window, false);
+        if (gamma && !gamma->identity) {
+            surface = SDL3_GetWindowSurface(window);
+        }
+    }
+
+    if (surface) {
+        SDL_Rect full;
+        int i;
+
+        /* Ramp the bounding box, so rects that overlap don't get ramped twice */
+        full.x = 0;
+        full.y = 0;
+        full.w = surface->w;
+        full.h = surface->h;
+        if (rects) {
+            SDL3_zero(area);
+            for (i = 0; i < numrects; ++i) {
+                SDL3_GetRectUnion(&area, &rects[i], &area);
+            }
+        } else {
+            area = full;
+        }
+        if (!SDL3_GetRectIntersection(&area, &full, &area) ||
+            SDL_MUSTLOCK(surface) ||
+            !SetupGammaKernel(gamma, surface->format, &kernel) ||
+            !CopyGammaBackup(gamma, surface, &area, true)) {
+            surface = NULL;
+        } else {
+            ApplyGamma(&kernel, surface->pixels, surface->pitch, &area);
+        }
+    }
+
+    if (rects) {
+        result = SDL3_UpdateWindowSurfaceRects(window, rects, numrects);
+    } else {
+        result = SDL3_UpdateWindowSurface(window);
+    }
+
+    if (surface) {
+        CopyGammaBackup(gamma, surface, &area, false);
+    }
+    return result ? 0 : -1;
+}
+
+/* Draw the frame on the window again, through its gamma ramp */
+static void ApplyRenderGamma(SDL_Renderer *renderer)
+{
+    SDL_Window *window = SDL3_GetRenderWindow(renderer);
+    WindowGammaRamp *gamma;
+    GammaKernel kernel;
+    RendererState *state;
+    SDL_Texture *target, *texture;
+    SDL_Surface *frame;
+    SDL_Rect viewport, cliprect, area;
+    bool viewport_set, clip_enabled;
+    float scale_x, scale_y;
+    int logical_w, logical_h;
+    SDL_RendererLogicalPresentation presentation;
+
+    if (!window) {
+        return;
+    }
+    gamma = GetWindowGammaRamp(window, false);
+    if (!gamma || gamma->identity) {
+        return;
+    }
+
+    /* Work on the whole window, in pixels, whatever the app has set up */
+    target = SDL3_GetRenderTarget(renderer);
+    if (target) {
+        SDL3_SetRenderTarget(renderer, NULL);
+    }
+    SDL3_GetRenderLogicalPresentation(renderer, &logical_w, &logical_h, &presentation);
+    viewport_set = SDL3_RenderViewportSet(renderer);
+    SDL3_GetRenderViewport(renderer, &viewport);
+    clip_enabled = SDL3_RenderClipEnabled(renderer);
+    SDL3_GetRenderClipRect(renderer, &cliprect);
+    SDL3_GetRenderScale(renderer, &scale_x, &scale_y);
+    SDL3_SetRenderLogicalPresentation(renderer, 0, 0, SDL_LOGICAL_PRESENTATION_DISABLED);
+    SDL3_SetRenderViewport(renderer, NULL);
+    SDL3_SetRenderClipRect(renderer, NULL);
+    SDL3_SetRenderScale(renderer, 1.0f, 1.0f);
+
+    frame = SDL3_RenderReadPixels(renderer, NULL);
+    if (frame && !SetupGammaKernel(gamma, frame->format, &kernel)) {
+        SDL_Surface *converted = SDL3_ConvertSurface(frame, SDL_PIXELFORMAT_XRGB8888);
+        SDL3_DestroySurface(frame);
+        frame = converted;
+        if (frame && !SetupGammaKernel(gamma, frame->format, &kernel)) {
+            SDL3_DestroySurface(frame);
+            frame = NULL;
+        }
+    }
+
+    if (frame) {
+        area.x = 0;
+        area.y = 0;
+        area.w = frame->w;
+        area.h = frame->h;
+        ApplyGamma(&kernel, frame->pixels, frame->pitch, &area);
+
+        state = GetRendererState(renderer, true);
+        texture = state ? state->gamma_texture : NULL;
+        if (texture && (texture->format != frame->format || texture->w != frame->w || texture->h != frame->h)) {
+            SDL3_DestroyTexture(texture);
+            texture = NULL;
+        }
+        if (!texture) {
+            texture = SDL3_CreateTexture(renderer, frame->format, SDL_TEXTUREACCESS_STREAMING, frame->w, frame->h);
+            if (texture) {
+                SDL3_SetTextureBlendMode(texture, SDL_BLENDMODE_NONE);
+                SDL3_SetTextureScaleMode(texture, SDL_SCALEMODE_NEAREST);
+            }
+        }
+        if (texture && SDL3_UpdateTexture(texture, NULL, frame->pixels, frame->pitch)) {
+            SDL3_RenderTexture(renderer, texture, NULL, NULL);
+        }
+        if (state) {
+            state->gamma_texture = texture;
+        } else if (texture) {
+            SDL3_DestroyTexture(texture);
+        }
+        SDL3_DestroySurface(frame);
+    }
+
+    SDL3_SetRenderLogicalPresentation(renderer, logical_w, logical_h, presentation);
+    SDL3_SetRenderViewport(renderer, viewport_set ? &viewport : NULL);
+    SDL3_SetRenderClipRect(renderer, clip_enabled ? &cliprect : NULL);
+    SDL3_SetRenderScale(renderer, scale_x, scale_y);
+    if (target) {
+        SDL3_SetRenderTarget(renderer, target);
+    }
+}
+
+SDL_DECLSPEC int SDLCALL
+SDL_SetWindowGammaRamp(SDL_Window *window, const Uint16 *r, const Uint16 *g, const Uint16 *b)
+{
+    WindowGammaRamp *gamma;
+
+    if (!window) {
+        SDL3_SetError("Invalid window");
+        return -1;
+    }
+
+    if (!SDL3_GetHintBoolean("SDL2_GAMMA_RAMP_EMULATION", false)) {
+        SDL3_Unsupported();
+        return -1;
+    }
+
+    gamma = GetWindowGammaRamp(window, true);
+    if (!gamma) {
+        return -1;
+    }
+
+    if (r) {
+        SDL3_memcpy(&gamma->ramp[0*256], r, 256*sizeof(Uint16));
+    }
+    if (g) {
+        SDL3_memcpy(&gamma->ramp[1*256], g, 256*sizeof(Uint16));
+    }
+    if (b) {
+        SDL3_memcpy(&gamma->ramp[2*256], b, 256*sizeof(Uint16));
+    }
+    UpdateGammaRampLUT(gamma);
+    SetWindowSurfaceDamaged(window);
+    return 0;
+}
+
+SDL_DECLSPEC int SDLCALL
+SDL_GetWindowGammaRamp(SDL_Window *window, Uint16 *red, Uint16 *green, Uint16 *blue)
+{
+    WindowGammaRamp *gamma;
+
+    if (!window) {
+        SDL3_SetError("Invalid window");
+        return -1;
+    }
+
+    gamma = GetWindowGammaRamp(window, true);
+    if (!gamma) {
+        return -1;
+    }
+
+    if (red) {
+        SDL3_memcpy(red, &gamma->ramp[0*256], 256*sizeof(Uint16));
+    }
+    if (green) {
+        SDL3_memcpy(green, &gamma->ramp[1*256], 256*sizeof(Uint16));
+    }
+    if (blue) {
+        SDL3_memcpy(blue, &gamma->ramp[2*256], 256*sizeof(Uint16));
+    }
+    return 0;
+}
+
+SDL_DECLSPEC int SDLCALL
+SDL_GetWindowOpacity(SDL_Window *window, float *out_opacity)
+{
+    float opacity = SDL3_GetWindowOpacity(window);
+    if (opacity < 0.0f) {
+        return -1;
+    }
+    if (out_opacity) {
+        *out_opacity = opacity;
+    }
+    return 0;
+}
+
+/* SDL_ConvertSurface() gets its target format as SDL2 masks, which have to be turned into an SDL3
+ * pixel format, and for palettized targets it needs a palette of its own. Apps tend to convert to
+ * the same few formats over and over, so remember the last few pixel formats, along with a palette
+ * for each. A palette is only reused once the surface it was last given to is gone, so no two live
+ * surfaces ever share one, just like when it was allocated every time.
+ */
+#define CONVERT_SURFACE_CACHE_SIZE 8
+
+typedef struct ConvertSurfaceCacheEntry
+{
+    Uint8 BitsPerPixel;
+    Uint32 Rmask;
+    Uint32 Gmask;
+    Uint32 Bmask;
+    Uint32 Amask;
+    SDL_PixelFormat pixel_format;  /* SDL_PIXELFORMAT_UNKNOWN for an empty entry */
+    SDL_Palette *palette;          /* NULL if none was needed yet */
+} ConvertSurfaceCacheEntry;
+
+static SDL_SpinLock ConvertSurfaceCacheLock = 0;
+static ConvertSurfaceCacheEntry ConvertSurfaceCache[CONVERT_SURFACE_CACHE_SIZE];
+static int ConvertSurfaceCacheNext = 0;
+
+/* Must be called with ConvertSurfaceCacheLock held */
+static ConvertSurfaceCacheEntry *FindConvertSurfaceCacheEntry(const SDL2_PixelFormat *format)
+{
+    int i;
+
+    for (i = 0; i < CONVERT_SURFACE_CACHE_SIZE; ++i) {
+        ConvertSurfaceCacheEntry *entry = &ConvertSurfaceCache[i];
+        if (entry->pixel_format != SDL_PIXELFORMAT_UNKNOWN &&
+            entry->BitsPerPixel == format->BitsPerPixel &&
+            entry->Rmask == format->Rmask && entry->Gmask == format->Gmask &&
+            entry->Bmask == format->Bmask && entry->Amask == format->Amask) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static void FreeConvertSurfaceCache(void)
+{
+    int i;
+
+    SDL3_LockSpinlock(&ConvertSurfaceCacheLock);
+    for (i = 0; i < CONVERT_SURFACE_CACHE_SIZE; ++i) {
+        if (ConvertSurfaceCache[i].palette) {
+            SDL3_DestroyPalette(ConvertSurfaceCache[i].palette);
+        }
+    }
+    SDL3_zeroa(ConvertSurfaceCache);
+    ConvertSurfaceCacheNext = 0;
+    SDL3_UnlockSpinlock(&ConvertSurfaceCacheLock);
+}
+
+/* Work out the SDL3 format to convert to, and a palette with the colors of format->palette if it has one.
+ * On success, *palette holds a reference that the caller must release with SDL3_DestroyPalette().
+ */
+static SDL_PixelFormat GetConvertSurfaceTarget(const SDL2_PixelFormat *format, SDL_Palette **palette)
+{
+    ConvertSurfaceCacheEntry *entry;
+    SDL_PixelFormat pixel_format = SDL_PIXELFORMAT_UNKNOWN;
+    SDL_Palette *new_palette = NULL;
+    SDL_Palette *old_palette = NULL;
+    const int ncolors = format->palette ? format->palette->ncolors : 0;
+
+    *palette = NULL;
+
+    SDL3_LockSpinlock(&ConvertSurfaceCacheLock);
+    entry = FindConvertSurfaceCacheEntry(format);
+    if (entry) {
+        SDL_Palette *cached = entry->palette;
+
+        pixel_format = entry->pixel_format;
+
+        /* If only we have a reference to the cached palette, no surface is using it anymore */
+        if (format->palette && cached && cached->refcount == 1 && cached->ncolors == ncolors) {
+            if (SDL3_memcmp(cached->colors, format->palette->colors, ncolors * sizeof(SDL_Color)) != 0) {
+                SDL3_SetPaletteColors(cached, format->palette->colors, 0, ncolors);
+            }
+            ++cached->refcount;
+            *palette = cached;
+        }
+    }
+    SDL3_UnlockSpinlock(&ConvertSurfaceCacheLock);
+
+    if (pixel_format == SDL_PIXELFORMAT_UNKNOWN) {
+        pixel_format = SDL3_GetPixelFormatForMasks(format->BitsPerPixel, format->Rmask, format->Gmask, format->Bmask, format->Amask);
+        if (pixel_format == SDL_PIXELFORMAT_UNKNOWN) {
+            SDL3_InvalidParamError("format");
+            return SDL_PIXELFORMAT_UNKNOWN;
+        }
+    }
+
+    if (format->palette && !*palette) {
+        // This conversion is going to assign the new surface this palette,
+        // but it might be on the stack, so always use one of our own to be
+        // safe. Real SDL2 always allocated a new palette in this function.
+        new_palette = SDL3_CreatePalette(ncolors);
+        if (!new_palette) {
+            return SDL_PIXELFORMAT_UNKNOWN;
+        }
+        SDL3_SetPaletteColors(new_palette, format->palette->colors, 0, ncolors);
+        *palette = new_palette;
+    }
+
+    if (!entry || new_palette) {
+        SDL3_LockSpinlock(&ConvertSurfaceCacheLock);
+        entry = FindConvertSurfaceCacheEntry(format);
+        if (!entry) {
+            entry = &ConvertSurfaceCache[ConvertSurfaceCacheNext];
+            ConvertSurfaceCacheNext = (ConvertSurfaceCacheNext + 1) % CONVERT_SURFACE_CACHE_SIZE;
+            old_palette = entry->palette;
+            entry->BitsPerPixel = format->BitsPerPixel;
+            entry->Rmask = format->Rmask;
+            entry->Gmask = format->Gmask;
+            entry->Bmask = format->Bmask;
+            entry->Amask = format->Amask;
+            entry->pixel_format = pixel_format;
+            entry->palette = NULL;
+        }
+        if (new_palette) {
+            /* Keep the new palette for next time, the old one stays with the surfaces using it */
+            if (entry->palette) {
+                old_palette = entry->palette;
+            }
+            entry->palette = new_palette;
+            ++new_palette->refcount;
+        }
+        SDL3_UnlockSpinlock(&ConvertSurfaceCacheLock);
+
+        if (old_palette) {
+            SDL3_DestroyPalette(old_palette);
+        }
+    }
+    return pixel_format;
+}
+
+SDL_DECLSPEC SDL2_Surface * SDLCALL
+SDL_ConvertSurface(SDL2_Surface *surface, const SDL2_PixelFormat *format, Uint32 flags)
+{
+    SDL_Palette *palette = NULL;
+    SDL_PixelFormat pixel_format;
+    SDL2_Surface *result;
+
+    (void) flags; /* SDL3 removed the (unused) `flags` argument */
+
+    if (!surface) {
+        SDL3_InvalidParamError("surface");
+        return NULL;
+    }
+    if (!format) {
+        SDL3_InvalidParamError("format");
+        return NULL;
+    }
+
+    pixel_format = GetConvertSurfaceTarget(format, &palette);
+    if (pixel_format == SDL_PIXELFORMAT_UNKNOWN) {
+        return NULL;
+    }
+
+    result = Surface3to2(SDL3_ConvertSurfaceAndColorspace(Surface2to3(surface), pixel_format, palette, SDL_COLORSPACE_SRGB, 0));
+
+    if (palette) {
+        SDL3_DestroyPalette(palette);
+    }
+    return result;
+}
+
+SDL_DECLSPEC SDL2_Surface * SDLCALL
+SDL_DuplicateSurface(SDL2_Surface *surface)
+{
+    return Surface3to2(SDL3_DuplicateSurface(Surface2to3(surface)));
+}
+
+SDL_DECLSPEC SDL2_Surface * SDLCALL
+SDL_ConvertSurfaceFormat(SDL2_Surface *surface, Uint32 pixel_format, Uint32 flags)
+{
+    (void) flags; /* SDL3 removed the (unused) `flags` argument */
+    return Surface3to2(SDL3_ConvertSurface(Surface2to3(surface), (SDL_PixelFormat)pixel_format));
+}
+
+#define SDL_YUV_SD_THRESHOLD 576
+
+static SDL_YUV_CONVERSION_MODE SDL_YUV_ConversionMode = SDL_YUV_CONVERSION_BT601;
+
+SDL_DECLSPEC void SDLCALL
+SDL_SetYUVConversionMode(SDL_YUV_CONVERSION_MODE mode)
+{
+    SDL_YUV_ConversionMode = mode;
+}
+
+SDL_DECLSPEC SDL_YUV_CONVERSION_MODE SDLCALL
+SDL_GetYUVConversionMode(void)
+{
+    return SDL_YUV_ConversionMode;
+}
+
+SDL_DECLSPEC SDL_YUV_CONVERSION_MODE SDLCALL
+SDL_GetYUVConversionModeForResolution(int width, int height)
+{
+    SDL_YUV_CONVERSION_MODE mode = SDL_GetYUVConversionMode();
+    if (mode == SDL_YUV_CONVERSION_AUTOMATIC) {
+        if (height <= SDL_YUV_SD_THRESHOLD) {
+            mode = SDL_YUV_CONVERSION_BT601;
+        } else {
+            mode = SDL_YUV_CONVERSION_BT709;
+        }
+    }
+    return mode;
+}
+
+static SDL_Colorspace GetColorspaceForFormatAndSize(Uint32 format, int width, int height)
+{
+    if (SDL_ISPIXELFORMAT_FOURCC(format)) {
+        switch (SDL_GetYUVConversionModeForResolution(width, height)) {
+        case SDL_YUV_CONVERSION_JPEG:
+            return SDL_COLORSPACE_BT601_FULL;
+        case SDL_YUV_CONVERSION_BT601:
+            return SDL_COLORSPACE_BT601_LIMITED;
+        case SDL_YUV_CONVERSION_BT709:
+            return SDL_COLORSPACE_BT709_LIMITED;
+        default:
+            break;
+        }
+    }
+    return SDL_COLORSPACE_SRGB;
+}
+
+/* Parallel band jobs.
+ *
+ * Large blits and pixel conversions can be split into horizontal bands that are run at the same
+ * time by a pool of worker threads and the calling thread. The SDL2_PARALLEL_BLIT and
+ * SDL2_PARALLEL_CONVERT hints turn this on for each of them:
+ *  - 0: (default) everything runs on the calling thread
+ *  - 1: use one thread per logical CPU core
+ *  - N: use N threads, counting the calling thread
+ * Jobs that write fewer than SDL2_PARALLEL_BLIT_THRESHOLD or SDL2_PARALLEL_CONVERT_THRESHOLD
+ * pixels (default 65536) still run on the calling thread.
+ *
+ * The pool is shared and runs one job at a time. A thread that finds it busy doesn't wait, it
+ * does its work alone instead.
+ */
+#define PARALLEL_MIN_BAND_ROWS 16
+#define PARALLEL_MAX_THREADS 64
+
+typedef struct ParallelJob ParallelJob;
+struct ParallelJob
+{
+    bool (*run_band)(ParallelJob *job, int band);  /* returns false if the band wasn't done */
+    void *data;
+    int num_bands;
+    SDL_AtomicInt next_band;
+    bool band_done[PARALLEL_MAX_THREADS];
+};
+
+static SDL_Semaphore *ParallelWorkSem = NULL;
+static SDL_Semaphore *ParallelDoneSem = NULL;
+static SDL_Thread *ParallelWorkers[PARALLEL_MAX_THREADS - 1];
+static int NumParallelWorkers = 0;
+static int ParallelWorkersWanted = 0;  /* what the hints asked for, there may be fewer workers if some couldn't start */
+static ParallelJob *ParallelCurrentJob = NULL;
+static bool ParallelQuit = false;
+static void *ParallelScratch[PARALLEL_MAX_THREADS];
+static size_t ParallelScratchSize[PARALLEL_MAX_THREADS];
+
+/* userdata points at the thread count to update */
+static void SDLCALL SDL2_ParallelThreadsChanged(void *userdata, const char *name, const char *oldValue, const char *hint)
+{
+    int threads = (hint && *hint) ? SDL_atoi(hint) : 0;
+    if (threads == 1) {
+        threads = SDL3_GetNumLogicalCPUCores();
+    }
+    *(int *)userdata = SDL_clamp(threads, 0, PARALLEL_MAX_THREADS);
+}
+
+/* userdata points at the threshold to update */
+static void SDLCALL SDL2_ParallelThresholdChanged(void *userdata, const char *name, const char *oldValue, const char *hint)
+{
+    *(int *)userdata = (hint && *hint) ? SDL_max(SDL_atoi(hint), 0) : 65536;
+}
+
+/* Band starts are rounded down to a multiple of align, so bands don't split chroma rows */
+static void GetParallelBandRows(const ParallelJob *job, int height, int align, int band, int *y, int *h)
+{
+    const int end = (band == (job->num_bands - 1)) ? height : ((height * (band + 1)) / job->num_bands) & ~(align - 1);
+
+    *y = ((height * band) / job->num_bands) & ~(align - 1);
+    *h = end - *y;
+}
+
+/* Returns scratch memory for one band, which stays valid until the pool is unlocked */
+static void *GetParallelScratch(int band, size_t size)
+{
+    if (size > ParallelScratchSize[band]) {
+        SDL3_free(ParallelScratch[band]);
+        ParallelScratch[band] = SDL3_malloc(size);
+        ParallelScratchSize[band] = ParallelScratch[band] ? size : 0;
+    }
+    return ParallelScratch[band];
+}
+
+static void RunParallelBands(ParallelJob *job)
+{
+    int band;
+
+    while ((band = SDL3_AddAtomicInt(&job->next_band, 1)) < job->num_bands) {
+        job->band_done[band] = job->run_band(job, band);
+    }
+}
+
+static int SDLCALL ParallelWorker(void *data)
+{
+    for (;;) {
+        SDL3_WaitSemaphore(ParallelWorkSem);
+        if (ParallelQuit) {
+            break;
+        }
+        RunParallelBands(ParallelCurrentJob);
+        SDL3_SignalSemaphore(ParallelDoneSem);
+    }
+    return 0;
+}
+
+/* Must be called with ParallelLock held */
+static void StopParallelWorkers(void)
+{
+    int i;
+
+    ParallelQuit = true;
+    for (i = 0; i < NumParallelWorkers; ++i) {
+        SDL3_SignalSemaphore(ParallelWorkSem);
+    }
+    for (i = 0; i < NumParallelWorkers; ++i) {
+        SDL3_WaitThread(ParallelWorkers[i], NULL);
+        ParallelWorkers[i] = NULL;
+    }
+    NumParallelWorkers = 0;
+    ParallelQuit = false;
+
+    if (ParallelWorkSem) {
+        SDL3_DestroySemaphore(ParallelWorkSem);
+        ParallelWorkSem = NULL;
+    }
+    if (ParallelDoneSem) {
+        SDL3_DestroySemaphore(ParallelDoneSem);
+        ParallelDoneSem = NULL;
+    }
+
+    for (i = 0; i < PARALLEL_MAX_THREADS; ++i) {
+        SDL3_free(ParallelScratch[i]);
+        ParallelScratch[i] = NULL;
+        ParallelScratchSize[i] = 0;
+    }
+    ParallelWorkersWanted = 0;
+}
+
+/* Must be called with ParallelLock held */
+static void StartParallelWorkers(int num_workers)
+{
+    ParallelWorkSem = SDL3_CreateSemaphore(0);
+    ParallelDoneSem = SDL3_CreateSemaphore(0);
+    if (!ParallelWorkSem || !ParallelDoneSem) {
+        StopParallelWorkers();
+        return;
+    }
+
+    while (NumParallelWorkers < num_workers) {
+        SDL_Thread *thread = SDL2_CreateThread(ParallelWorker, "SDL2Parallel", NULL, NULL, NULL);
+        if (!thread) {
+            break;
+        }
+        ParallelWorkers[NumParallelWorkers++] = thread;
+    }
+}
+
+/* Locks the pool and makes sure it has enough workers for every hint, returns false if it's busy or has no workers */
+static bool LockParallelWorkers(void)
+{
+    const int num_workers = SDL_max(SDL2_ParallelBlitThreads, SDL2_ParallelConvertThreads) - 1;
+
+    if (!ParallelLock || !SDL3_TryLockMutex(ParallelLock)) {
+        return false;
+    }
+
+    /* Only restart when the hints change, so a pool that came up short isn't respawned every call */
+    if (ParallelWorkersWanted != num_workers) {
+        StopParallelWorkers();
+        if (num_workers > 0) {
+            StartParallelWorkers(num_workers);
+        }
+        ParallelWorkersWanted = num_workers;
+    }
+    if (NumParallelWorkers == 0) {
+        SDL3_UnlockMutex(ParallelLock);
+        return false;
+    }
+    return true;
+}
+
+/* Must be called with the pool locked, job->num_bands can't be more than NumParallelWorkers + 1 */
+static void RunParallelJob(ParallelJob *job)
+{
+    const int num_workers = job->num_bands - 1;
+    int i;
+
+    SDL3_SetAtomicInt(&job->next_band, 0);
+    ParallelCurrentJob = job;
+    for (i = 0; i < num_workers; ++i) {
+        SDL3_SignalSemaphore(ParallelWorkSem);
+    }
+    RunParallelBands(job);
+    for (i = 0; i < num_workers; ++i) {
+        SDL3_WaitSemaphore(ParallelDoneSem);
+    }
+    ParallelCurrentJob = NULL;
+}
+
+/* Parallel pixel conversion.
+ *
+ * SDL3 finds the planes of a YUV image from its height, so a band of a planar image can't be
+ * passed to it in place. Bands of planar images are copied to and from scratch memory laid out
+ * like an image of the band's height instead. Bands start on even rows, so each 4:2:0 chroma row
+ * belongs to exactly one band and the result is the same as a single-threaded conversion. The
+ * colorspace is picked from the size of the whole image, not the band.
+ */
+typedef struct ConvertPixelsPlanes
+{
+    SDL_PixelFormat format;
+    SDL_Colorspace colorspace;
+    Uint8 *pixels;
+    int pitch;
+    int num_planes;     /* planes after the first have half as many rows */
+    int pitches[3];
+    int row_bytes[3];
+} ConvertPixelsPlanes;
+
+typedef struct ParallelConvertJob
+{
+    int width;
+    int height;
+    int row_align;
+    ConvertPixelsPlanes src;
+    ConvertPixelsPlanes dst;
+} ParallelConvertJob;
+
+/* Returns false for formats that can't be split into bands */
+static bool GetConvertPixelsPlanes(SDL_PixelFormat format, SDL_Colorspace colorspace, void *pixels, int pitch, int width, ConvertPixelsPlanes *planes)
+{
+    SDL3_zerop(planes);
+    planes->format = format;
+    planes->colorspace = colorspace;
+    planes->pixels = (Uint8 *)pixels;
+    planes->pitch = pitch;
+    planes->num_planes = 1;
+    planes->pitches[0] = pitch;
+    planes->row_bytes[0] = width;
+
+    switch (format) {
+    case SDL_PIXELFORMAT_YV12:
+    case SDL_PIXELFORMAT_IYUV:
+        planes->num_planes = 3;
+        planes->pitches[1] = planes->pitches[2] = (pitch + 1) / 2;
+        planes->row_bytes[1] = planes->row_bytes[2] = (width + 1) / 2;
+        return true;
+    case SDL_PIXELFORMAT_NV12:
+    case SDL_PIXELFORMAT_NV21:
+        planes->num_planes = 2;
+        planes->pitches[1] = 2 * ((pitch + 1) / 2);
+        planes->row_bytes[1] = 2 * ((width + 1) / 2);
+        return true;
+    case SDL_PIXELFORMAT_YUY2:
+    case SDL_PIXELFORMAT_UYVY:
+    case SDL_PIXELFORMAT_YVYU:
+        return true;
+    default:
+        return !SDL_ISPIXELFORMAT_FOURCC(format);
+    }
+}
+
+static size_t GetBandPlanesSize(const ConvertPixelsPlanes *planes, int h)
+{
+    size_t size = 0;
+    int i;
+
+    for (i = 0; i < planes->num_planes; ++i) {
+        size += (size_t)planes->pitches[i] * (i ? ((h + 1) / 2) : h);
+    }
+    return size;
+}
+
+/* Copy rows y to y+h-1 of every plane of a height rows tall image to or from a band */
+static void CopyBandPlanes(const ConvertPixelsPlanes *planes, int height, int y, int h, Uint8 *band, bool to_band)
+{
+    Uint8 *image = planes->pixels;
+    int i, row;
+
+    for (i = 0; i < planes->num_planes; ++i) {
+        const int pitch = planes->pitches[i];
+        const int rows = i ? ((h + 1) / 2) : h;
+        Uint8 *image_row = image + (size_t)pitch * (i ? (y / 2) : y);
+
+        for (row = 0; row < rows; ++row) {
+            if (to_band) {
+                SDL3_memcpy(band, image_row, planes->row_bytes[i]);
+            } else {
+                SDL3_memcpy(image_row, band, planes->row_bytes[i]);
+            }
+            image_row += pitch;
+            band += pitch;
+        }
+        image += (size_t)pitch * (i ? ((height + 1) / 2) : height);
+    }
+}
+
+static bool ConvertPixelsBand(ParallelJob *job, int band)
+{
+    const ParallelConvertJob *convert = (const ParallelConvertJob *)job->data;
+    size_t src_size = 0, dst_size = 0;
+    Uint8 *scratch = NULL;
+    Uint8 *src, *dst;
+    int y, h;
+
+    GetParallelBandRows(job, convert->height, convert->row_align, band, &y, &h);
+
+    if (convert->src.num_planes > 1) {
+        src_size = GetBandPlanesSize(&convert->src, h);
+    }
+    if (convert->dst.num_planes > 1) {
+        dst_size = GetBandPlanesSize(&convert->dst, h);
+    }
+    if (src_size || dst_size) {
+        scratch = (Uint8 *)GetParallelScratch(band, src_size + dst_size);
+        if (!scratch) {
+            return false;
+        }
+    }
+
+    if (src_size) {
+        src = scratch;
+        CopyBandPlanes(&convert->src, convert->height, y, h, src, true);
+    } else {
+        src = convert->src.pixels + (size_t)y * convert->src.pitch;
+    }
+    if (dst_size) {
+        dst = scratch + src_size;
+    } else {
+        dst = convert->dst.pixels + (size_t)y * convert->dst.pitch;
+    }
+
+    if (!SDL3_ConvertPixelsAndColorspace(convert->width, h, convert->src.format, convert->src.colorspace, 0, src, convert->src.pitch, convert->dst.format, convert->dst.colorspace, 0, dst, convert->dst.pitch)) {
+        return false;
+    }
+    if (dst_size) {
+        CopyBandPlanes(&convert->dst, convert->height, y, h, dst, false);
+    }
+    return true;
+}
+
+/* Returns false if the conversion should run on the calling thread instead */
+static bool ParallelConvertPixels(int width, int height,
+                                  SDL_PixelFormat src_format, SDL_Colorspace src_colorspace, const void *src, int src_pitch,
+                                  SDL_PixelFormat dst_format, SDL_Colorspace dst_colorspace, void *dst, int dst_pitch)
+{
+    ParallelConvertJob convert;
+    ParallelJob job;
+    const int num_threads = SDL2_ParallelConvertThreads;
+    int band;
+
+    if (num_threads < 2 || width <= 0 ||
+        ((Sint64)width * height) < SDL2_ParallelConvertThreshold ||
+        (height / PARALLEL_MIN_BAND_ROWS) < 2) {
+        return false;
+    }
+    if (!src || !dst || src == dst || src_pitch <= 0 || dst_pitch <= 0) {
+        return false;
+    }
+    if (!GetConvertPixelsPlanes(src_format, src_colorspace, (void *)src, src_pitch, width, &convert.src) ||
+        !GetConvertPixelsPlanes(dst_format, dst_colorspace, dst, dst_pitch, width, &convert.dst)) {
+        return false;
+    }
+    if (!LockParallelWorkers()) {
+        return false;
+    }
+
+    convert.width = width;
+    convert.height = height;
+    convert.row_align = (convert.src.num_planes > 1 || convert.dst.num_planes > 1) ? 2 : 1;
+
+    SDL3_zero(job);
+    job.run_band = ConvertPixelsBand;
+    job.data = &convert;
+    job.num_bands = SDL_min(SDL_min(num_threads, NumParallelWorkers + 1), height / PARALLEL_MIN_BAND_ROWS);
+    RunParallelJob(&job);
+
+    SDL3_UnlockMutex(ParallelLock);
+
+    /* If any band failed, the whole conversion is done again on this thread, which sets the error */
+    for (band = 0; band < job.num_bands; ++band) {
+        if (!job.band_done[band]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+SDL_DECLSPEC int SDLCALL
+SDL_ConvertPixels(int width, int height, Uint32 src_format, const void *src, int src_pitch, Uint32 dst_format, void *dst, int dst_pitch)
+{
+    SDL_Colorspace src_colorspace = GetColorspaceForFormatAndSize(src_format, width, height);
+    SDL_Colorspace dst_colorspace = GetColorspaceForFormatAndSize(dst_format, width, height);
+    if (ParallelConvertPixels(width, height, (SDL_PixelFormat)src_format, src_colorspace, src, src_pitch, (SDL_PixelFormat)dst_format, dst_colorspace, dst, dst_pitch)) {
+        return 0;
+    }
+    return SDL3_ConvertPixelsAndColorspace(width, height, (SDL_PixelFormat)src_format, src_colorspace, 0, src, src_pitch, (SDL_PixelFormat)dst_format, dst_colorspace, 0, dst, dst_pitch) ? 0 : -1;
+}
+
+SDL_DECLSPEC int SDLCALL
+SDL_PremultiplyAlpha(int width, int height, Uint32 src_format, const void * src, int src_pitch, Uint32 dst_format, void * dst, int dst_pitch)
+{
+    return SDL3_PremultiplyAlpha(width, height, (SDL_PixelFormat)src_format, src, src_pitch, (SDL_PixelFormat)dst_format, dst, dst_pitch, false) ? 0 : -1;
+}
+
+SDL_DECLSPEC SDL2_Surface * SDLCALL
+SDL_CreateRGBSurface(Uint32 flags, int width, int height, int depth, Uint32 Rmask, Uint32 Gmask, Uint32 Bmask, Uint32 Amask)
+{
+    return Surface3to2(SDL3_CreateSurface(width, height, SDL3_GetPixelFormatForMasks(depth, Rmask, Gmask, Bmask, Amask)));
+}
+
+SDL_DECLSPEC SDL2_Surface * SDLCALL
+SDL_CreateRGBSurfaceWithFormat(Uint32 flags, int width, int height, int depth, Uint32 format)
+{
+    return Surface3to2(SDL3_CreateSurface(width, height, (SDL_PixelFormat)format));
+}
+
+SDL_DECLSPEC SDL2_Surface * SDLCALL
+SDL_CreateRGBSurfaceFrom(void *pixels, int width, int height, int depth, int pitch, Uint32 Rmask, Uint32 Gmask, Uint32 Bmask, Uint32 Amask)
+{
+    return Surface3to2(SDL3_CreateSurfaceFrom(width, height, SDL3_GetPixelFormatForMasks(depth, Rmask, Gmask, Bmask, Amask), pixels, pitch));
+}
+
+SDL_DECLSPEC SDL2_Surface * SDLCALL
+SDL_CreateRGBSurfaceWithFormatFrom(void *pixels, int width, int height, int depth, int pitch, Uint32 format)
+{
+    return Surface3to2(SDL3_CreateSurfaceFrom(width, height, (SDL_PixelFormat)format, pixels, pitch));
+}
+
+SDL_DECLSPEC void SDLCALL
+SDL_FreeSurface(SDL2_Surface *surface)
+{
+    if (!surface) {
+        return;
+    }
+
+    if (surface->flags & SDL_DONTFREE) {
+        return;
+    }
+
+    if (--surface->refcount > 0) {
+        return;
+    }
+
+    if (surface->map) {
+        SDL_Surface *surface3 = (SDL_Surface *)surface->map;
+        /* Unlink first, in case something else still holds a reference to the SDL3 surface */
+        SDL3_ClearProperty(SDL3_GetSurfaceProperties(surface3), PROP_SURFACE2);
+        SDL3_DestroySurface(surface3);
+        surface->map = NULL;
+    }
+
+    if (surface->format) {
+        SDL_SetPixelFormatPalette(surface->format, NULL);
+        SDL_FreeFormat(surface->format);
+        surface->format = NULL;
+    }
+
+    SDL3_free(surface);
+}
+
+/* Window surface damage tracking.
+ *
+ * If the SDL2_WINDOW_SURFACE_DAMAGE hint is set, fills, blits and stretches to a window surface
+ * record the area they drew to, and SDL_UpdateWindowSurface() only updates those areas, or does
+ * nothing at all if nothing was drawn since the last update. Locking the window surface, and the
+ * window being exposed, mark all of it as damaged, since there's no telling what changed. So do
+ * SDL_RenderPresent() and SDL_RenderFlush() on a software renderer that draws to the window
+ * surface, and creating one, since what it draws isn't tracked.
+ *
+ * This only works for apps that draw with SDL: an app that writes to the pixels of the window
+ * surface without locking it will see those changes go missing, and so will an app that calls
+ * SDL_UpdateWindowSurface() after drawing with a software renderer, without presenting or
+ * flushing it first. Setting the hint while such an app is running is safe, since everything is
+ * damaged again whenever tracking is turned on.
+ */
+#define SURFACE_DAMAGE_MAX_RECTS 16
+
+typedef struct SurfaceDamage
+{
+    Uint32 generation;  /* SurfaceDamageGeneration when it was last used */
+    bool full;
+    int num_rects;
+    SDL_Rect rects[SURFACE_DAMAGE_MAX_RECTS];
+} SurfaceDamage;
+
+static Uint32 SurfaceDamageGeneration = 0;  /* changes each time tracking is turned on */
+
+static void SDLCALL SDL2_WindowSurfaceDamageChanged(void *userdata, const char *name, const char *oldValue, const char *hint)
+{
+    const bool enabled = (hint && *hint) ? !(*hint == '0' || SDL3_strcasecmp(hint, "false") == 0) : false;
+
+    if (enabled && !SDL2_WindowSurfaceDamage) {
+        ++SurfaceDamageGeneration;  /* nothing was tracked while it was off */
+    }
+    SDL2_WindowSurfaceDamage = enabled;
+}
+
+static SurfaceDamage *GetSurfaceDamage(SDL_Surface *surface)
+{
+    SDL_PropertiesID props = SDL3_GetSurfaceProperties(surface);
+    SurfaceDamage *damage = (SurfaceDamage *)SDL3_GetPointerProperty(props, PROP_SURFACE_DAMAGE, NULL);
+
+    if (!damage) {
+        damage = (SurfaceDamage *)SDL3_calloc(1, sizeof(*damage));
+        if (!damage) {
+            return NULL;
+        }
+        if (!SDL3_SetPointerPropertyWithCleanup(props, PROP_SURFACE_DAMAGE, damage, CleanupFreeableProperty, NULL)) {
+            return NULL;
+        }
+        damage->generation = SurfaceDamageGeneration - 1;
+    }
+
+    /* Whatever was drawn before tracking started hasn't been shown yet */
+    if (damage->generation != SurfaceDamageGeneration) {
+        damage->generation = SurfaceDamageGeneration;
+        damage->full = true;
+        damage->num_rects = 0;
+    }
+    return damage;
+}
+
+/* Record that rect, or all of the surface if rect is NULL, was drawn to */
+static void AddSurfaceDamage(SDL2_Surface *surface2, SDL_Surface *surface, const SDL_Rect *rect)
+{
+    SurfaceDamage *damage;
+    SDL_Rect full, area;
+    int i;
+
+    if (!SDL2_WindowSurfaceDamage || !(surface2->flags & SDL_DONTFREE)) {
+        return;  /* not a window surface */
+    }
+
+    damage = GetSurfaceDamage(surface);
+    if (!damage || damage->full) {
+        return;
+    }
+
+    full.x = 0;
+    full.y = 0;
+    full.w = surface->w;
+    full.h = surface->h;
+    if (!rect) {
+        damage->full = true;
+        return;
+    }
+    if (!SDL3_GetRectIntersection(rect, &full, &area)) {
+        return;
+    }
+
+    /* Grow an overlapping rect, if there is one */
+    for (i = 0; i < damage->num_rects; ++i) {
+        if (SDL3_HasRectIntersection(&damage->rects[i], &area)) {
+            SDL3_GetRectUnion(&damage->rects[i], &area, &damage->rects[i]);
+            return;
+        }
+    }
+
+    /* Out of room, fall back to the bounding box of everything */
+    if (damage->num_rects == SURFACE_DAMAGE_MAX_RECTS) {
+        for (i = 1; i < damage->num_rects; ++i) {
+            SDL3_GetRectUnion(&damage->rects[0], &damage->rects[i], &damage->rects[0]);
+        }
+        SDL3_GetRectUnion(&damage->rects[0], &area, &damage->rects[0]);
+        damage->num_rects = 1;
+        return;
+    }
+
+    damage->rects[damage->num_rects++] = area;
+}
+
+/* Mark all of a window surface as damaged, for drawing to it that isn't tracked */
+static void SetSurfaceDamaged(SDL_Surface *surface)
+{
+    SurfaceDamage *damage = (SurfaceDamage *)SDL3_GetPointerProperty(SDL3_GetSurfaceProperties(surface), PROP_SURFACE_DAMAGE, NULL);
+
+    if (damage) {
+        damage->full = true;
+    }
+}
+
+static void SetWindowSurfaceDamaged(SDL_Window *window)
+{
+    SDL_Surface *surface;
+
+    if (window && SDL3_WindowHasSurface(window)) {
+        surface = SDL3_GetWindowSurface(window);
+        if (surface) {
+            SetSurfaceDamaged(surface);
+        }
+    }
+}
+
+/* A software renderer's drawing to a window surface isn't tracked, so all of it is damaged whenever that drawing lands */
+static void SetRendererSurfaceDamaged(SDL_Renderer *renderer)
+{
+    RendererState *state;
+
+    if (!SDL2_WindowSurfaceDamage) {
+        return;
+    }
+    state = GetRendererState(renderer, false);
+    if (state && state->damage_surface) {
+        SetSurfaceDamaged(state->damage_surface);
+    }
+}
+
+SDL_DECLSPEC int SDLCALL
+SDL_FillRect(SDL2_Surface *dst, const SDL_Rect *rect, Uint32 color)
+{
+    SDL_Surface *dst3 = Surface2to3(dst);
+    if (dst) {
+        AddSurfaceDamage(dst, dst3, rect ? rect : &dst->clip_rect);
+    }
+    return SDL3_FillSurfaceRect(dst3, rect, color) ? 0 : -1;
+}
+
+SDL_DECLSPEC int SDLCALL
+SDL_FillRects(SDL2_Surface *dst, const SDL_Rect *rects, int count, Uint32 color)
+{
+    SDL_Surface *dst3 = Surface2to3(dst);
+    int i;
+    if (dst && rects) {
+        for (i = 0; i < count; ++i) {
+            AddSurfaceDamage(dst, dst3, &rects[i]);
+        }
+    }
+    return SDL3_FillSurfaceRects(dst3, rects, count, color) ? 0 : -1;
+}
+
+/* Parallel blits.
+ *
+ * Large unscaled blits are split into bands when the SDL2_PARALLEL_BLIT hint is set, see the
+ * parallel band jobs above. Blits from or to RLE surfaces still run on the calling thread.
+ *
+ * SDL3 keeps the state of a blit in progress in the source surface's blit map, so the bands
+ * can't share the real surfaces. Each band blits between temporary surfaces that point at its
+ * rows instead, with the same palette, color key, blend mode and modulation. Every pixel is
+ * blended on its own, so the result is the same as a single-threaded blit.
+ */
+typedef struct ParallelBlitJob
+{
+    SDL_Surface *src;
+    SDL_Surface *dst;
+    SDL_Rect srcrect;
+    SDL_Rect dstrect;
+    bool has_colorkey;
+    Uint32 colorkey;
+    SDL_BlendMode blend_mode;
+    Uint8 r, g, b, a;
+} ParallelBlitJob;
+
+/* Make a surface that shares rows y to y+h-1 of surface */
+static SDL_Surface *CreateBlitBandSurface(SDL_Surface *surface, int y, int h)
+{
+    SDL_Surface *band;
+    SDL_Palette *palette;
+
+    band = SDL3_CreateSurfaceFrom(surface->w, h, surface->format, (Uint8 *)surface->pixels + (y * surface->pitch), surface->pitch);
+    if (!band) {
+        return NULL;
+    }
+
+    palette = SDL3_GetSurfacePalette(surface);
+    if ((palette && !SDL3_SetSurfacePalette(band, palette)) ||
+        !SDL3_SetSurfaceColorspace(band, SDL3_GetSurfaceColorspace(surface))) {
+        SDL3_DestroySurface(band);
+        return NULL;
+    }
+    return band;
+}
+
+/* Returns false if the band couldn't be set up, in which case nothing was drawn */
+static bool BlitBand(ParallelJob *job, int band)
+{
+    const ParallelBlitJob *blit = (const ParallelBlitJob *)job->data;
+    SDL_Surface *src, *dst;
+    SDL_Rect srcrect, dstrect;
+    bool result = false;
+    int y, h;
+
+    GetParallelBandRows(job, blit->dstrect.h, 1, band, &y, &h);
+    src = CreateBlitBandSurface(blit->src, blit->srcrect.y + y, h);
+    dst = CreateBlitBandSurface(blit->dst, blit->dstrect.y + y, h);
+    if (src && dst &&
+        (!blit->has_colorkey || SDL3_SetSurfaceColorKey(src, true, blit->colorkey)) &&
+        SDL3_SetSurfaceBlendMode(src, blit->blend_mode) &&
+        SDL3_SetSurfaceColorMod(src, blit->r, blit->g, blit->b) &&
+        SDL3_SetSurfaceAlphaMod(src, blit->a)) {
+        srcrect.x = blit->srcrect.x;
+        srcrect.y = 0;
+        srcrect.w = blit->srcrect.w;
+        srcrect.h = h;
+        dstrect.x = blit->dstrect.x;
+        dstrect.y = 0;
+        dstrect.w = blit->dstrect.w;
+        dstrect.h = h;
+        SDL3_BlitSurfaceUnchecked(src, &srcrect, dst, &dstrect);
+        result = true;
+    }
+    SDL3_DestroySurface(src);
+    SDL3_DestroySurface(dst);
+    return result;
+}
+
+/* Returns false if the blit should run on the calling thread instead */
+static bool ParallelBlit(SDL_Surface *src, const SDL_Rect *srcrect, SDL_Surface *dst, const SDL_Rect *dstrect, int *result)
+{
+    ParallelBlitJob blit;
+    ParallelJob job;
+    const int num_threads = SDL2_ParallelBlitThreads;
+    int band, y, h;
+
+    if (num_threads < 2 || !srcrect || !dstrect ||
+        srcrect->w != dstrect->w || srcrect->h != dstrect->h ||
+        ((Sint64)dstrect->w * dstrect->h) < SDL2_ParallelBlitThreshold ||
+        (dstrect->h / PARALLEL_MIN_BAND_ROWS) < 2) {
+        return false;
+    }
+    if (!src->pixels || !dst->pixels || src->pixels == dst->pixels ||
+        SDL_MUSTLOCK(src) || SDL_MUSTLOCK(dst) ||
+        SDL_ISPIXELFORMAT_FOURCC(src->format) || SDL_ISPIXELFORMAT_FOURCC(dst->format)) {
+        return false;
+    }
+    if (!LockParallelWorkers()) {
+        return false;
+    }
+
+    SDL3_zero(blit);
+    blit.src = src;
+    blit.dst = dst;
+    blit.srcrect = *srcrect;
+    blit.dstrect = *dstrect;
+    blit.has_colorkey = SDL3_SurfaceHasColorKey(src);
+    if (blit.has_colorkey) {
+        SDL3_GetSurfaceColorKey(src, &blit.colorkey);
+    }
+    SDL3_GetSurfaceBlendMode(src, &blit.blend_mode);
+    SDL3_GetSurfaceColorMod(src, &blit.r, &blit.g, &blit.b);
+    SDL3_GetSurfaceAlphaMod(src, &blit.a);
+
+    SDL3_zero(job);
+    job.run_band = BlitBand;
+    job.data = &blit;
+    job.num_bands = SDL_min(SDL_min(num_threads, NumParallelWorkers + 1), dstrect->h / PARALLEL_MIN_BAND_ROWS);
+    RunParallelJob(&job);
+
+    /* Any band that couldn't be set up gets blitted directly, now that nothing else is using the surfaces */
+    *result = 0;
+    for (band = 0; band < job.num_bands; ++band) {
+        if (!job.band_done[band]) {
+            SDL_Rect band_srcrect = *srcrect;
+            SDL_Rect band_dstrect = *dstrect;
+
+            GetParallelBandRows(&job, dstrect->h, 1, band, &y, &h);
+            band_srcrect.y += y;
+            band_srcrect.h = h;
+            band_dstrect.y += y;
+            band_dstrect.h = h;
+            if (!SDL3_BlitSurfaceUnchecked(src, &band_srcrect, dst, &band_dstrect)) {
+                *result = -1;
+            }
+        }
+    }
+
+    SDL3_UnlockMutex(ParallelLock);
+    return true;
+}
+
+/* Clip a blit to the source surface and the destination clip rectangle, returns false if nothing is left to draw */
+static bool ClipBlitRects(const SDL2_Surface *src, const SDL_Rect *srcrect, const SDL2_Surface *dst, const SDL_Rect *dstrect, SDL_Rect *r_src, SDL_Rect *r_dst)
+{
+    SDL_Rect tmp;
+
+    /* Full src surface */
+    r_src->x = 0;
+    r_src->y = 0;
+    r_src->w = src->w;
+    r_src->h = src->h;
+
+    if (dstrect) {
+        r_dst->x = dstrect->x;
+        r_dst->y = dstrect->y;
+    } else {
+        r_dst->x = 0;
+        r_dst->y = 0;
+    }
+
+    /* clip the source rectangle to the source surface */
+    if (srcrect) {
+        if (!SDL3_GetRectIntersection(srcrect, r_src, &tmp)) {
+            return false;
+        }
+
+        /* Shift dstrect, if srcrect origin has changed */
+        r_dst->x += tmp.x - srcrect->x;
+        r_dst->y += tmp.y - srcrect->y;
+
+        /* Update srcrect */
+        *r_src = tmp;
+    }
+
+    /* There're no dstrect.w/h parameters. It's the same as srcrect */
+    r_dst->w = r_src->w;
+    r_dst->h = r_src->h;
+
+    /* clip the destination rectangle against the clip rectangle */
+    if (!SDL3_GetRectIntersection(r_dst, &dst->clip_rect, &tmp)) {
+        return false;
+    }
+
+    /* Shift srcrect, if dstrect has changed */
+    r_src->x += tmp.x - r_dst->x;
+    r_src->y += tmp.y - r_dst->y;
+    r_src->w = tmp.w;
+    r_src->h = tmp.h;
+
+    /* Update dstrect */
+    *r_dst = tmp;
+
+    return (r_dst->w > 0 && r_dst->h > 0);
+}
+
+SDL_DECLSPEC int SDLCALL
+SDL_UpperBlit(SDL2_Surface *src, const SDL_Rect *srcrect, SDL2_Surface *dst, SDL_Rect *dstrect)
+{
+    SDL_Rect r_src, r_dst;
+
+    /* Make sure the surfaces aren't locked */
+    if (!src) {
+        SDL3_InvalidParamError("src");
+        return -1;
+    } else if (!dst) {
+        SDL3_InvalidParamError("dst");
+        return -1;
+    } else if (src->locked || dst->locked) {
+        SDL3_SetError("Surfaces must not be locked during blit");
+        return -1;
+    }
+
+    if (ClipBlitRects(src, srcrect, dst, dstrect, &r_src, &r_dst)) {
+        if (dstrect) { /* update output parameter */
+            *dstrect = r_dst;
+        }
+        return SDL_LowerBlit(src, &r_src, dst, &r_dst);
+    }
+
+    if (dstrect) { /* update output parameter */
+        dstrect->w = dstrect->h = 0;
+    }
+    return 0;
+}
+
+SDL_DECLSPEC int SDLCALL
+SDL_CompatBlitSurfaces(SDL2_Surface *src2, const SDL_Rect *srcrects, SDL2_Surface *dst2, SDL_Rect *dstrects, int count)
+{
+    SDL_Surface *src;
+    SDL_Surface *dst;
+    SDL_Rect r_src, r_dst;
+    int result = 0;
+    int i;
+
+    /* Make sure the surfaces aren't locked */
+    if (!src2) {
+        SDL3_InvalidParamError("src");
+        return -1;
+    } else if (!dst2) {
+        SDL3_InvalidParamError("dst");
+        return -1;
+    } else if (!dstrects && count > 0) {
+        SDL3_InvalidParamError("dstrects");
+        return -1;
+    } else if (count < 0) {
+        SDL3_InvalidParamError("count");
+        return -1;
+    } else if (src2->locked || dst2->locked) {
+        SDL3_SetError("Surfaces must not be locked during blit");
+        return -1;
+    }
+
+    /* Synchronize the surfaces once for the whole batch, the blit map is validated by the first blit
+       and stays valid for the rest, since nothing else touches the surfaces in between. */
+    src = Surface2to3(src2);
+    dst = Surface2to3(dst2);
+
+    for (i = 0; i < count; ++i) {
+        int rc;
+
+        if (!ClipBlitRects(src2, srcrects ? &srcrects[i] : NULL, dst2, &dstrects[i], &r_src, &r_dst)) {
+            dstrects[i].w = dstrects[i].h = 0;
+            continue;
+        }
+        dstrects[i] = r_dst;
+        AddSurfaceDamage(dst2, dst, &r_dst);
+
+        if (!ParallelBlit(src, &r_src, dst, &r_dst, &rc)) {
+            rc = SDL3_BlitSurfaceUnchecked(src, &r_src, dst, &r_dst) ? 0 : -1;
+        }
+        if (rc < 0) {
+            result = -1;
+        }
+    }
+
+    SynchronizeSurface3to2(src, src2);
+    return result;
+}
+
+SDL_DECLSPEC int SDLCALL
+SDL_LowerBlit(SDL2_Surface *src2, SDL_Rect *srcrect, SDL2_Surface *dst2, SDL_Rect *dstrect)
+{
+    SDL_Surface *src = Surface2to3(src2);
+    SDL_Surface *dst = Surface2to3(dst2);
+    int result;
+    AddSurfaceDamage(dst2, dst, dstrect);
+    if (!ParallelBlit(src, srcrect, dst, dstrect, &result)) {
+        result = SDL3_BlitSurfaceUnchecked(src, srcrect, dst, dstrect) ? 0 : -1;
+    }
+    SynchronizeSurface3to2(src, src2);
+    return result;
+}
+
+/* Programs tend to scale the same source to the same destination rectangle every frame, so remember the
+ * last few clip results, and for the last few sizes, which source column and row each destination
+ * column and row samples from.
+ */
+#define SCALED_BLIT_CACHE_SIZE 4
+
+typedef struct ScaledBlitClipKey
+{
+    int src_w, src_h;       /* size of the source surface */
+    int has_srcrect;
+    SDL_Rect srcrect;       /* the whole source surface if !has_srcrect */
+    int has_dstrect;
+    SDL_Rect dstrect;       /* the whole destination surface if !has_dstrect */
+    SDL_Rect clip_rect;     /* clip rectangle of the destination surface */
+} ScaledBlitClipKey;
+
+typedef struct ScaledBlitClipCacheEntry
+{
+    bool valid;
+    ScaledBlitClipKey key;
+    SDL_Rect final_src;
+    SDL_Rect final_dst;
+} ScaledBlitClipCacheEntry;
+
+typedef struct ScaledBlitMap
+{
+    int src_w, src_h;
+    int dst_w, dst_h;       /* 0 for an empty entry */
+    int *columns;           /* dst_w source columns, followed by dst_h source rows */
+    int *rows;
+} ScaledBlitMap;
+
+static SDL_SpinLock ScaledBlitClipCacheLock = 0;
+static ScaledBlitClipCacheEntry ScaledBlitClipCache[SCALED_BLIT_CACHE_SIZE];
+static int ScaledBlitClipCacheNext = 0;
+static ScaledBlitMap ScaledBlitMaps[SCALED_BLIT_CACHE_SIZE];  /* protected by ScaledBlitLock */
+static int ScaledBlitMapsNext = 0;
+
+static void FreeScaledBlitCache(void)
+{
+    int i;
+
+    for (i = 0; i < SCALED_BLIT_CACHE_SIZE; ++i) {
+        SDL3_free(ScaledBlitMaps[i].columns);
+    }
+    SDL3_zeroa(ScaledBlitMaps);
+    ScaledBlitMapsNext = 0;
+
+    SDL3_LockSpinlock(&ScaledBlitClipCacheLock);
+    SDL3_zeroa(ScaledBlitClipCache);
+    ScaledBlitClipCacheNext = 0;
+    SDL3_UnlockSpinlock(&ScaledBlitClipCacheLock);
+}
+
+/* SDL_round(n / d), for d > 0 */
+static int RoundDiv(Sint64 n, Sint64 d)
+{
+    if (n < 0) {
+        return -(int)((2 * -n + d) / (2 * d));
+    }
+    return (int)((2 * n + d) / (2 * d));
+}
+
+/* Clip one axis of a scaled blit to the source surface and the destination clip rectangle.
+ * Destination coordinates are kept in units of 1/src_len and source coordinates in units of 1/dst_len,
+ * so an edge moves by the same amount on both sides and the math stays exact.
+ */
+static void ClipScaledBlitAxis(int src_pos, int src_len, int src_size, bool clip_src,
+                               int dst_pos, int dst_len, int clip_pos, int clip_len,
+                               int *final_src_pos, int *final_src_len, int *final_dst_pos, int *final_dst_len)
+{
+    Sint64 src0, src1, dst0, dst1, edge;
+
+    if (src_len <= 0 || dst_len <= 0) {
+        *final_src_pos = src_pos;
+        *final_dst_pos = dst_pos;
+        *final_src_len = *final_dst_len = 0;
+        return;
+    }
+
+    src0 = (Sint64)src_pos * dst_len;
+    src1 = ((Sint64)src_pos + src_len) * dst_len;
+    dst0 = (Sint64)dst_pos * src_len;
+    dst1 = ((Sint64)dst_pos + dst_len) * src_len;
+
+    if (clip_src) {
+        if (src0 < 0) {
+            dst0 -= src0;
+            src0 = 0;
+        }
+        edge = (Sint64)src_size * dst_len;
+        if (src1 > edge) {
+            dst1 -= src1 - edge;
+            src1 = edge;
+        }
+    }
+
+    edge = (Sint64)clip_pos * src_len;
+    if (dst0 < edge) {
+        src0 -= dst0 - edge;
+        dst0 = edge;
+    }
+    edge = ((Sint64)clip_pos + clip_len) * src_len;
+    if (dst1 > edge) {
+        src1 -= dst1 - edge;
+        dst1 = edge;
+    }
+
+    *final_src_pos = RoundDiv(src0, dst_len);
+    *final_src_len = RoundDiv(src1 - src0, dst_len);
+    *final_dst_pos = RoundDiv(dst0, src_len);
+    *final_dst_len = RoundDiv(dst1 - dst0, src_len);
+}
+
+static void ClipScaledBlitRects(const SDL2_Surface *src, const SDL_Rect *srcrect, const SDL2_Surface *dst, const SDL_Rect *dstrect, SDL_Rect *final_src, SDL_Rect *final_dst)
+{
+    ScaledBlitClipKey key;
+    ScaledBlitClipCacheEntry *entry;
+    SDL_Rect tmp;
+    int i;
+
+    SDL3_zero(key);
+    key.src_w = src->w;
+    key.src_h = src->h;
+    if (srcrect) {
+        key.has_srcrect = 1;
+        key.srcrect = *srcrect;
+    } else {
+        key.srcrect.w = src->w;
+        key.srcrect.h = src->h;
+    }
+    if (dstrect) {
+        key.has_dstrect = 1;
+        key.dstrect = *dstrect;
+    } else {
+        key.dstrect.w = dst->w;
+        key.dstrect.h = dst->h;
+    }
+    key.clip_rect = dst->clip_rect;
+
+    SDL3_LockSpinlock(&ScaledBlitClipCacheLock);
+    for (i = 0; i < SCALED_BLIT_CACHE_SIZE; ++i) {
+        entry = &ScaledBlitClipCache[i];
+        if (entry->valid && SDL3_memcmp(&entry->key, &key, sizeof(key)) == 0) {
+            *final_src = entry->final_src;
+            *final_dst = entry->final_dst;
+            SDL3_UnlockSpinlock(&ScaledBlitClipCacheLock);
+            return;
+        }
+    }
+    SDL3_UnlockSpinlock(&ScaledBlitClipCacheLock);
+
+    ClipScaledBlitAxis(key.srcrect.x, key.srcrect.w, src->w, key.has_srcrect,
+                       key.dstrect.x, key.dstrect.w, dst->clip_rect.x, dst->clip_rect.w,
+                       &final_src->x, &final_src->w, &final_dst->x, &final_dst->w);
+    ClipScaledBlitAxis(key.srcrect.y, key.srcrect.h, src->h, key.has_srcrect,
+                       key.dstrect.y, key.dstrect.h, dst->clip_rect.y, dst->clip_rect.h,
+                       &final_src->y, &final_src->h, &final_dst->y, &final_dst->h);
+
+    /* Clip again */
+    tmp.x = 0;
+    tmp.y = 0;
+    tmp.w = src->w;
+    tmp.h = src->h;
+    SDL3_GetRectIntersection(&tmp, final_src, final_src);
+
+    /* Clip again */
+    SDL3_GetRectIntersection(&dst->clip_rect, final_dst, final_dst);
+
+    SDL3_LockSpinlock(&ScaledBlitClipCacheLock);
+    entry = &ScaledBlitClipCache[ScaledBlitClipCacheNext];
+    ScaledBlitClipCacheNext = (ScaledBlitClipCacheNext + 1) % SCALED_BLIT_CACHE_SIZE;
+    entry->valid = true;
+    entry->key = key;
+    entry->final_src = *final_src;
+    entry->final_dst = *final_dst;
+    SDL3_UnlockSpinlock(&ScaledBlitClipCacheLock);
+}
+
+SDL_DECLSPEC int SDLCALL
+SDL_UpperBlitScaled(SDL2_Surface *src, const SDL_Rect *srcrect, SDL2_Surface *dst, SDL_Rect *dstrect)
+{
+    SDL_Rect final_src, final_dst;
+    int src_w, src_h;
+    int dst_w, dst_h;
+
+    /* Make sure the surfaces aren't locked */
+    if (!src || !dst) {
+        SDL3_InvalidParamError("SDL_UpperBlitScaled(): src/dst");
+        return -1;
+    }
+    if (src->locked || dst->locked) {
+        SDL3_SetError("Surfaces must not be locked during blit");
+        return -1;
+    }
+
+    if (!srcrect) {
+        src_w = src->w;
+        src_h = src->h;
+    } else {
+        src_w = srcrect->w;
+        src_h = srcrect->h;
+    }
+
+    if (!dstrect) {
+        dst_w = dst->w;
+        dst_h = dst->h;
+    } else {
+        dst_w = dstrect->w;
+        dst_h = dstrect->h;
+    }
+
+    if (dst_w == src_w && dst_h == src_h) {
+        /* No scaling, defer to regular blit */
+        return SDL_UpperBlit(src, srcrect, dst, dstrect);
+    }
+
+    ClipScaledBlitRects(src, srcrect, dst, dstrect, &final_src, &final_dst);
+
+    if (dstrect) {
+        *dstrect = final_dst;
+    }
+
+    if (final_dst.w == 0 || final_dst.h == 0 ||
+        final_src.w <= 0 || final_src.h <= 0) {
+        /* No-op. */
+        return 0;
+    }
+
+    return SDL_LowerBlitScaled(src, &final_src, dst, &final_dst);
+}
+
+/* Must be called with ScaledBlitLock held */
+static const ScaledBlitMap *GetScaledBlitMap(int src_w, int src_h, int dst_w, int dst_h)
+{
+    ScaledBlitMap *map;
+    int *columns;
+    Uint64 pos, inc;
+    int i;
+
+    for (i = 0; i < SCALED_BLIT_CACHE_SIZE; ++i) {
+        map = &ScaledBlitMaps[i];
+        if (map->dst_w == dst_w && map->dst_h == dst_h &&
+            map->src_w == src_w && map->src_h == src_h) {
+            return map;
+        }
+    }
+
+    map = &ScaledBlitMaps[ScaledBlitMapsNext];
+    columns = (int *)SDL3_realloc(map->columns, ((size_t)dst_w + dst_h) * sizeof(int));
+    if (!columns) {
+        return NULL;
+    }
+    ScaledBlitMapsNext = (ScaledBlitMapsNext + 1) % SCALED_BLIT_CACHE_SIZE;
+    map->columns = columns;
+    map->rows = columns + dst_w;
+    map->src_w = src_w;
+    map->src_h = src_h;
+    map->dst_w = dst_w;
+    map->dst_h = dst_h;
+
+    /* Sample exactly like SDL's nearest scaler: 16.16 fixed point, starting half a step in */
+    inc = ((Uint64)src_w << 16) / dst_w;
+    for (i = 0, pos = inc / 2; i < dst_w; ++i, pos += inc) {
+        map->columns[i] = (int)(pos >> 16);
+    }
+    inc = ((Uint64)src_h << 16) / dst_h;
+    for (i = 0, pos = inc / 2; i < dst_h; ++i, pos += inc) {
+        map->rows[i] = (int)(pos >> 16);
+    }
+    return map;
+}
+
+/* Nearest scaling of plain copies between surfaces of the same format, using the cached sampling map.
+ * Destination rows that sample the same source row as the one above are copied from it.
+ * Returns false if SDL should do the blit instead.
+ */
+static bool BlitScaledNearest(SDL_Surface *src, const SDL_Rect *srcrect, SDL_Surface *dst, const SDL_Rect *dstrect)
+{
+    const ScaledBlitMap *map;
+    const Uint8 *src_pixels;
+    Uint8 *dst_row;
+    SDL_BlendMode blend_mode;
+    Uint8 r, g, b, a;
+    int bpp, row_bytes;
+    int prev_row = -1;
+    int x, y;
+
+    if (src->format != dst->format || src->pixels == dst->pixels || !src->pixels || !dst->pixels ||
+        SDL_ISPIXELFORMAT_INDEXED(src->format) || SDL_ISPIXELFORMAT_FOURCC(src->format) ||
+        SDL_BYTESPERPIXEL(src->format) > 4 || SDL_MUSTLOCK(src) || SDL_MUSTLOCK(dst) ||
+        srcrect->w > SDL_MAX_UINT16 || srcrect->h > SDL_MAX_UINT16 ||
+        dstrect->w > SDL_MAX_UINT16 || dstrect->h > SDL_MAX_UINT16) {
+        return false;
+    }
+    if (!SDL3_GetSurfaceBlendMode(src, &blend_mode) || blend_mode != SDL_BLENDMODE_NONE ||
+        SDL3_SurfaceHasColorKey(src) ||
+        !SDL3_GetSurfaceColorMod(src, &r, &g, &b) || (r & g & b) != 0xFF ||
+        !SDL3_GetSurfaceAlphaMod(src, &a) || a != 0xFF ||
+        SDL3_GetSurfaceColorspace(src) != SDL3_GetSurfaceColorspace(dst)) {
+        return false;
+    }
+    if (!ScaledBlitLock || !SDL3_TryLockMutex(ScaledBlitLock)) {
+        return false;
+    }
+    map = GetScaledBlitMap(srcrect->w, srcrect->h, dstrect->w, dstrect->h);
+    if (!map) {
+        SDL3_UnlockMutex(ScaledBlitLock);
+        return false;
+    }
+
+    bpp = SDL_BYTESPERPIXEL(src->format);
+    row_bytes = dstrect->w * bpp;
+    src_pixels = (const Uint8 *)src->pixels + srcrect->y * src->pitch + srcrect->x * bpp;
+    dst_row = (Uint8 *)dst->pixels + dstrect->y * dst->pitch + dstrect->x * bpp;
+    for (y = 0; y < dstrect->h; ++y, dst_row += dst->pitch) {
+        const Uint8 *src_row;
+
+        if (map->rows[y] == prev_row) {
+            SDL3_memcpy(dst_row, dst_row - dst->pitch, row_bytes);
+            continue;
+        }
+        prev_row = map->rows[y];
+        src_row = src_pixels + prev_row * src->pitch;
+
+        switch (bpp) {
+        case 4:
+            for (x = 0; x < dstrect->w; ++x) {
+                ((Uint32 *)dst_row)[x] = ((const Uint32 *)src_row)[map->columns[x]];
+            }
+            break;
+        case 2:
+            for (x = 0; x < dstrect->w; ++x) {
+                ((Uint16 *)dst_row)[x] = ((const Uint16 *)src_row)[map->columns[x]];
+            }
+            break;
+        case 1:
+            for (x = 0; x < dstrect->w; ++x) {
+                dst_row[x] = src_row[map->columns[x]];
+            }
+            break;
+        default:
+            for (x = 0; x < dstrect->w; ++x) {
+                SDL3_memcpy(dst_row + x * bpp, src_row + map->columns[x] * bpp, bpp);
+            }
+            break;
+        }
+    }
+
+    SDL3_UnlockMutex(ScaledBlitLock);
+    return true;
+}
+
+SDL_DECLSPEC int SDLCALL
+SDL_LowerBlitScaled(SDL2_Surface *src2, SDL_Rect *srcrect, SDL2_Surface *dst2, SDL_Rect *dstrect)
+{
+    SDL_Surface *src = Surface2to3(src2);
+    SDL_Surface *dst = Surface2to3(dst2);
+    int result;
+    AddSurfaceDamage(dst2, dst, dstrect);
+    if (srcrect && dstrect && BlitScaledNearest(src, srcrect, dst, dstrect)) {
+        result = 0;
+    } else {
+        result = SDL3_BlitSurfaceUncheckedScaled(src, srcrect, dst, dstrect, SDL_SCALEMODE_NEAREST) ? 0 : -1;
+    }
+    SynchronizeSurface3to2(src, src2);
+    return result;
+}
+
+SDL_DECLSPEC int SDLCALL
+SDL_SoftStretch(SDL2_Surface *src, const SDL_Rect *srcrect, SDL2_Surface *dst, const SDL_Rect *dstrect)
+{
+    SDL_Surface *dst3 = Surface2to3(dst);
+    if (dst) {
+        AddSurfaceDamage(dst, dst3, dstrect);
+    }
+    return SDL3_StretchSurface(Surface2to3(src), srcrect, dst3, dstrect, SDL_SCALEMODE_NEAREST) ? 0 : -1;
+}
+
+SDL_DECLSPEC int SDLCALL
+SDL_SoftStretchLinear(SDL2_Surface *src, const SDL_Rect *srcrect, SDL2_Surface *dst, const SDL_Rect *dstrect)
+{
+    SDL_Surface *dst3 = Surface2to3(dst);
+    if (dst) {
+        AddSurfaceDamage(dst, dst3, dstrect);
+    }
+    return SDL3_StretchSurface(Surface2to3(src), srcrect, dst3, dstrect, SDL_SCALEMODE_LINEAR) ? 0 : -1;
+}
+
+/* SDL_GetTicks is 64-bit in SDL3. Clamp it for SDL2. */
+SDL_DECLSPEC Uint32 SDLCALL
+SDL_GetTicks(void)
+{
+    return (Uint32)SDL3_GetTicks();
+}
+
+/* SDL_GetTicks64 is gone in SDL3 because SDL_GetTicks is 64-bit. */
+SDL_DECLSPEC Uint64 SDLCALL
+SDL_GetTicks64(void)
+{
+    return SDL3_GetTicks();
+}
+
+SDL_DECLSPEC SDL2_bool SDLCALL SDL_GetWindowWMInfo(SDL_Window *window, SDL2_SysWMinfo *info)
+{
+    const char *driver = SDL3_GetCurrentVideoDriver();
+    SDL_PropertiesID props;
+
+    if (!driver) {
+        return SDL2_FALSE;
+    }
+    if (!window) {
+        SDL3_InvalidParamError("window");
+        return SDL2_FALSE;
+    }
+    if (!info) {
+        SDL3_InvalidParamError("info");
+        return SDL2_FALSE;
+    }
+
+    props = SDL3_GetWindowProperties(window);
+
+    if (SDL3_strcmp(driver, "android") == 0) {
+        info->subsystem = SDL2_SYSWM_ANDROID;
+        info->info.android.window = SDL3_GetPointerProperty(props, SDL_PROP_WINDOW_ANDROID_WINDOW_POINTER, NULL);
+        info->info.android.surface = SDL3_GetPointerProperty(props, SDL_PROP_WINDOW_ANDROID_SURFACE_POINTER, NULL);
+    } else if (SDL3_strcmp(driver, "cocoa") == 0) {
+        info->subsystem = SDL2_SYSWM_COCOA;
+        info->info.cocoa.window = (NSWindow *)SDL3_GetPointerProperty(props, SDL_PROP_WINDOW_COCOA_WINDOW_POINTER, NULL);
+    } else if (SDL3_strcmp(driver, "kmsdrm") == 0) {
+        info->subsystem = SDL2_SYSWM_KMSDRM;
+        info->info.kmsdrm.dev_index = (int)SDL3_GetNumberProperty(props, SDL_PROP_WINDOW_KMSDRM_DEVICE_INDEX_NUMBER, 0);
+        info->info.kmsdrm.drm_fd = (int)SDL3_GetNumberProperty(props, SDL_PROP_WINDOW_KMSDRM_DRM_FD_NUMBER, -1);
+        info->info.kmsdrm.gbm_dev = SDL3_GetPointerProperty(props, SDL_PROP_WINDOW_KMSDRM_GBM_DEVICE_POINTER, NULL);
+    } else if (SDL3_strcmp(driver, "uikit") == 0) {
+        info->subsystem = SDL2_SYSWM_UIKIT;
+        info->info.uikit.window = (UIWindow *)SDL3_GetPointerProperty(props, SDL_PROP_WINDOW_UIKIT_WINDOW_POINTER, NULL);
+        info->info.uikit.colorbuffer = 0;
+        info->info.uikit.framebuffer = 0;
+        info->info.uikit.resolveFramebuffer = 0;
+    } else if (SDL3_strcmp(driver, "vivante") == 0) {
+        info->subsystem = SDL2_SYSWM_VIVANTE;
+        info->info.vivante.display = SDL3_GetPointerProperty(props, SDL_PROP_WINDOW_VIVANTE_DISPLAY_POINTER, NULL);
+        info->info.vivante.window = SDL3_GetPointerProperty(props, SDL_PROP_WINDOW_VIVANTE_WINDOW_POINTER, NULL);
+    } else if (SDL3_strcmp(driver, "wayland") == 0) {
+        Uint32 version2 = SDL_VERSIONNUM((Uint32)info->version.major,
+                                         (Uint32)info->version.minor,
+                                         (Uint32)info->version.patch);
+
+        /* Before 2.0.6, it was possible to build an SDL with Wayland support
+         * (SDL2_SysWMinfo will be large enough to hold Wayland info), but build
+         * your app against SDL headers that didn't have Wayland support
+         * (SDL2_SysWMinfo could be smaller than Wayland needs). This would lead
+         * to an app properly using SDL_GetWindowWMInfo() but we'd accidentally
+         * overflow memory on the stack or heap. To protect against this, we've
+         * padded out the struct unconditionally in the headers and Wayland will
+         * just return an error for older apps using this function. Those apps
+         * will need to be recompiled against newer headers or not use Wayland,
+         * maybe by forcing SDL_VIDEODRIVER=x11.
+         */
+        if (version2 < SDL_VERSIONNUM(2, 0, 6)) {
+            info->subsystem = SDL2_SYSWM_UNKNOWN;
+            SDL3_SetError("Version must be 2.0.6 or newer");
+            return SDL2_FALSE;
+        }
+
+        info->subsystem = SDL2_SYSWM_WAYLAND;
+        info->info.wl.display = SDL3_GetPointerProperty(props, SDL_PROP_WINDOW_WAYLAND_DISPLAY_POINTER, NULL);
+        info->info.wl.surface = SDL3_GetPointerProperty(props, SDL_PROP_WINDOW_WAYLAND_SURFACE_POINTER, NULL);
+        info->info.wl.shell_surface = NULL; /* Deprecated */
+
+        if (version2 >= SDL_VERSIONNUM(2, 0, 15)) {
+            info->info.wl.egl_window = SDL3_GetPointerProperty(props, SDL_PROP_WINDOW_WAYLAND_EGL_WINDOW_POINTER, NULL);
+            info->info.wl.xdg_surface = SDL3_GetPointerProperty(props, SDL_PROP_WINDOW_WAYLAND_XDG_SURFACE_POINTER, NULL);
+            if (version2 >= SDL_VERSIONNUM(2, 0, 17)) {
+                info->info.wl.xdg_toplevel = SDL3_GetPointerProperty(props, SDL_PROP_WINDOW_WAYLAND_XDG_TOPLEVEL_POINTER, NULL);
+                if (version2 >= SDL_VERSIONNUM(2, 0, 22)) {
+                    info->info.wl.xdg_popup = SDL3_GetPointerProperty(props, SDL_PROP_WINDOW_WAYLAND_XDG_POPUP_POINTER, NULL);
+                    info->info.wl.xdg_positioner = SDL3_GetPointerProperty(props, SDL_PROP_WINDOW_WAYLAND_XDG_POSITIONER_POINTER, NULL);
+                }
+            }
+        }
+    } else if (SDL3_strcmp(driver, "windows") == 0) {
+
+        Uint32 version2 = SDL_VERSIONNUM((Uint32)info->version.major,
+            (Uint32)info->version.minor,
+            (Uint32)info->version.patch);
+
+        info->subsystem = SDL2_SYSWM_WINDOWS;
+        info->info.win.window = SDL3_GetPointerProperty(props, SDL_PROP_WINDOW_WIN32_HWND_POINTER, NULL);
+        if (version2 >= SDL_VERSIONNUM(2, 0, 4)) {
+            info->info.win.hdc = SDL3_GetPointerProperty(props, SDL_PROP_WINDOW_WIN32_HDC_POINTER, NULL);
+        }
+        if (version2 >= SDL_VERSIONNUM(2, 0, 5)) {
+            info->info.win.hinstance = SDL3_GetPointerProperty(props, SDL_PROP_WINDOW_WIN32_INSTANCE_POINTER, NULL);
+        }
+    } else if (SDL3_strcmp(driver, "x11") == 0) {
+        info->subsystem = SDL2_SYSWM_X11;
+        info->info.x11.display = SDL3_GetPointerProperty(props, SDL_PROP_WINDOW_X11_DISPLAY_POINTER, NULL);
+        info->info.x11.window = (unsigned long)SDL3_GetNumberProperty(props, SDL_PROP_WINDOW_X11_WINDOW_NUMBER, 0);
+    } else {
+        SDL3_SetError("Video driver '%s' has no mapping to SDL_SysWMinfo", driver);
+        info->subsystem = SDL2_SYSWM_UNKNOWN;
+        return SDL2_FALSE;
+    }
+
+    return SDL2_TRUE;
+}
+
+
+SDL_DECLSPEC int SDLCALL
+SDL_GameControllerSetSensorEnabled(SDL_GameController *gamecontroller, SDL_SensorType type, SDL2_bool enabled)
+{
+    return SDL3_SetGamepadSensorEnabled(gamecontroller, type, enabled) ? 0 : -1;
+}
+
+SDL_DECLSPEC int SDLCALL
+SDL_GameControllerGetSensorDataWithTimestamp(SDL_GameController *gamecontroller, SDL_SensorType type, Uint64 *timestamp, float *data, int num_values)
+{
+    if (!SDL3_GetGamepadSensorData(gamecontroller, type, data, num_values)) {
+        return -1;
+    }
+
+    *timestamp = GetGamepadSensorTimestamp(SDL3_GetGamepadID(gamecontroller), type);
+    return 0;
+}
+
+SDL_DECLSPEC int SDLCALL
+SDL_SensorGetDataWithTimestamp(SDL_Sensor *sensor, Uint64 *timestamp, float *data, int num_values)
+{
+    if (!SDL3_GetSensorData(sensor, data, num_values)) {
+        return -1;
+    }
+
+    *timestamp = GetSensorTimestamp(SDL3_GetSensorID(sensor));
+    return 0;
+}
+
+SDL_DECLSPEC void SDLCALL
+SDL_SensorClose(SDL_Sensor *sensor)
+{
+    const SDL_SensorID id = SDL3_GetSensorID(sensor);
+
+    SDL3_CloseSensor(sensor);
+
+    /* Sensors are refcounted, the timestamp is only stale once the last reference is gone */
+    if (id && !SDL3_GetSensorFromID(id)) {
+        RemoveSensorTimestamps(SENSOR_TIMESTAMPS, id);
+    }
+}
+
+SDL_DECLSPEC int SDLCALL
+SDL_GetNumTouchDevices(void)
+{
+    SDL3_free(TouchDevices);
+    TouchDevices = SDL3_GetTouchDevices(&NumTouchDevices);
+    return NumTouchDevices;
+}
+
+SDL_DECLSPEC SDL_TouchID SDLCALL
+SDL_GetTouchDevice(int idx)
+{
+    if ((idx < 0) || (idx >= NumTouchDevices)) {
+        SDL3_SetError("Unknown touch device index %d", idx);
+        return 0;
+    }
+    return TouchDevices[idx];
+}
+
+SDL_DECLSPEC const char* SDLCALL
+SDL_GetTouchName(int idx)
+{
+    SDL_TouchID tid = SDL_GetTouchDevice(idx);
+    return tid ? SDL3_GetTouchDeviceName(tid) : NULL;
+}
+
+SDL_DECLSPEC int SDLCALL
+SDL_GetNumTouchFingers(SDL_TouchID touchID)
+{
+    SDL3_free(TouchFingers);
+    TouchFingersDeviceID = touchID;
+    TouchFingers = SDL3_GetTouchFingers(touchID, &NumTouchFingers);
+    return NumTouchFingers;
+}
+
+SDL_DECLSPEC SDL_Finger * SDLCALL
+SDL_GetTouchFinger(SDL_TouchID touchID, int idx)
+{
+    if (touchID != TouchFingersDeviceID) {
+        SDL_GetNumTouchFingers(touchID);
+    }
+    if ((idx < 0) || (idx >= NumTouchFingers)) {
+        SDL3_SetError("Unknown touch finger");
+        return NULL;
+    }
+    return TouchFingers[idx];
+}
+
+/* Touch gestures were removed from SDL3, so this is the SDL2 implementation copied in here, and tweaked a little. */
+
+#define GESTURE_MAX_DOLLAR_PATH_SIZE 1024
+#define GESTURE_DOLLARNPOINTS 64
+#define GESTURE_DOLLARSIZE 256
+#define GESTURE_PHI        0.618033989
+
+typedef struct
+{
+    float length;
+    int numPoints;
+    SDL_FPoint p[GESTURE_MAX_DOLLAR_PATH_SIZE];
+} GestureDollarPath;
+
+typedef struct
+{
+    SDL_FPoint path[GESTURE_DOLLARNPOINTS];
+    Sint64 hash;
+} GestureDollarTemplate;
+
+typedef struct
+{
+    SDL_TouchID touchId;
+    SDL_FPoint centroid;
+    GestureDollarPath dollarPath;
+    Uint16 numDownFingers;
+    int numDollarTemplates;
+    GestureDollarTemplate *dollarTemplate;
+    SDL2_bool recording;
+} GestureTouch;
+
+static GestureTouch *GestureTouches = NULL;
+static int GestureNumTouches = 0;
+static bool GestureRecordAll = false;
+
+static GestureTouch *
+GestureAddTouch(const SDL_TouchID touchId)
+{
+    GestureTouch *gestureTouch = (GestureTouch *)SDL3_realloc(GestureTouches, (GestureNumTouches + 1) * sizeof(GestureTouch));
+    if (gestureTouch == NULL) {
+        return NULL;
+    }
+
+    GestureTouches = gestureTouch;
+    SDL3_zero(GestureTouches[GestureNumTouches]);
+    GestureTouches[GestureNumTouches].touchId = touchId;
+    return &GestureTouches[GestureNumTouches++];
+}
+
+static GestureTouch *
+GestureGetTouch(const SDL_TouchID touchId)
+{
+    int i;
+    for (i = 0; i < GestureNumTouches; i++) {
+        /* printf("%i ?= %i\n",GestureTouches[i].touchId,touchId); */
+        if (GestureTouches[i].touchId == touchId) {
+            return &GestureTouches[i];
+        }
+    }
+    return NULL;
+}
+
+SDL_DECLSPEC int SDLCALL
+SDL_RecordGesture(SDL_TouchID touchId)
+{
+    int numtouchdevs = 0;
+    SDL_TouchID *touchdevs = SDL3_GetTouchDevices(&numtouchdevs);
+    int i;
+
+    /* make sure we know about all the devices SDL3 knows about, since we aren't connected as tightly as we were in SDL2. */
+    for (i = 0; i < numtouchdevs; i++) {
+        SDL_TouchID thistouch = touchdevs[i];
+        if (!GestureGetTouch(thistouch)) {
+            if (!GestureAddTouch(thistouch)) {
+                SDL3_free(touchdevs);
+                return 0;  /* uhoh, out of memory */
+            }
+        }
+    }
+    SDL3_free(touchdevs);
+
+    if (touchId == (SDL_TouchID)-1) {
+        GestureRecordAll = true;  /* !!! FIXME: this is never set back to SDL2_FALSE anywhere, that's probably a bug. */
+        for (i = 0; i < GestureNumTouches; i++) {
+            GestureTouches[i].recording = SDL2_TRUE;
+        }
+    } else {
+        GestureTouch *touch = GestureGetTouch(touchId);
+        if (!touch) {
+            return 0;  /* bogus touchid */
+        }
+        touch->recording = SDL2_TRUE;
+    }
+
+    return 1;
+}
+
+static void
+GestureQuit(void)
+{
+    int i;
+    for (i = 0; i < GestureNumTouches; i++) {
+        SDL3_free(GestureTouches[i].dollarTemplate);
+    }
+    SDL3_free(GestureTouches);
+    GestureTouches = NULL;
+    GestureNumTouches = 0;
+}
+
+static unsigned long
+GestureHashDollar(SDL_FPoint *points)
+{
+    unsigned long hash = 5381;
+    int i;
+    for (i = 0; i < GESTURE_DOLLARNPOINTS; i++) {
+        hash = ((hash << 5) + hash) + (unsigned long)points[i].x;
+        hash = ((hash << 5) + hash) + (unsigned long)points[i].y;
+    }
+    return hash;
+}
+
+static int
+GestureSaveTemplate(GestureDollarTemplate *templ, SDL2_RWops *dst)
+{
+    if (dst == NULL) {
+        return 0;
+    }
+
+    /* No Longer storing the Hash, rehash on load */
+    /* if (SDL2_RWops.write(dst, &(templ->hash), sizeof(templ->hash), 1) != 1) return 0; */
+
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+    if (SDL_RWwrite(dst, templ->path, sizeof(templ->path[0]), GESTURE_DOLLARNPOINTS) != GESTURE_DOLLARNPOINTS) {
+        return 0;
+    }
+#else
+    {
+        GestureDollarTemplate copy = *templ;
+        SDL_FPoint *p = copy.path;
+        int i;
+        for (i = 0; i < GESTURE_DOLLARNPOINTS; i++, p++) {
+            p->x = SDL_SwapFloatLE(p->x);
+            p->y = SDL_SwapFloatLE(p->y);
+        }
+
+        if (SDL_RWwrite(dst, copy.path, sizeof(copy.path[0]), GESTURE_DOLLARNPOINTS) != GESTURE_DOLLARNPOINTS) {
+            return 0;
+        }
+    }
+#endif
+
+    return 1;
+}
+
+SDL_DECLSPEC int SDLCALL
+SDL_SaveAllDollarTemplates(SDL2_RWops *dst)
+{
+    int i, j, rtrn = 0;
+    for (i = 0; i < GestureNumTouches; i++) {
+        GestureTouch *touch = &GestureTouches[i];
+        for (j = 0; j < touch->numDollarTemplates; j++) {
+            rtrn += GestureSaveTemplate(&touch->dollarTemplate[j], dst);
+        }
+    }
+    return rtrn;
+}
+
+SDL_DECLSPEC int SDLCALL
+SDL_SaveDollarTemplate(SDL2_GestureID gestureId, SDL2_RWops *dst)
+{
+    int i, j;
+    for (i = 0; i < GestureNumTouches; i++) {
+        GestureTouch *touch = &GestureTouches[i];
+        for (j = 0; j < touch->numDollarTemplates; j++) {
+            if (touch->dollarTemplate[j].hash == gestureId) {
+                return GestureSaveTemplate(&touch->dollarTemplate[j], dst);
+            }
+        }
+    }
+    SDL3_SetError("Unknown gestureId");
+    return -1;
+}
+
+/* path is an already sampled set of points
+Returns the index of the gesture on success, or -1 */
+static int
+GestureAddDollar_one(GestureTouch *inTouch, SDL_FPoint *path)
+{
+    GestureDollarTemplate *dollarTemplate;
+    GestureDollarTemplate *templ;
+    int idx;
+
+    idx = inTouch->numDollarTemplates;
+    dollarTemplate = (GestureDollarTemplate *)SDL3_realloc(inTouch->dollarTemplate, (idx + 1) * sizeof(GestureDollarTemplate));
+    if (dollarTemplate == NULL) {
+        return -1;
+    }
+    inTouch->dollarTemplate = dollarTemplate;
+
+    templ = &inTouch->dollarTemplate[idx];
+    SDL3_memcpy(templ->path, path, GESTURE_DOLLARNPOINTS * sizeof(SDL_FPoint));
+    templ->hash = GestureHashDollar(templ->path);
+    inTouch->numDollarTemplates++;
+
+    return idx;
+}
+
+static int
+GestureAddDollar(GestureTouch *inTouch, SDL_FPoint *path)
+{
+    if (inTouch == NULL) {
+        int i, idx;
+        if (GestureNumTouches == 0) {
+            SDL3_SetError("no gesture touch devices registered");
+            return -1;
+        }
+        for (i = 0, idx = -1; i < GestureNumTouches; i++) {
+            inTouch = &GestureTouches[i];
+            idx = GestureAddDollar_one(inTouch, path);
+            if (idx < 0) {
+                return -1;
+            }
+        }
+        /* Use the index of the last one added. */
+        return idx;
+    }
+    return GestureAddDollar_one(inTouch, path);
+}
+
+SDL_DECLSPEC int SDLCALL
+SDL_LoadDollarTemplates(SDL_TouchID touchId, SDL2_RWops *src)
+{
+    int i, loaded = 0;
+    GestureTouch *touch = NULL;
+    if (src == NULL) {
+        return 0;
+    }
+    if (touchId != (SDL_TouchID)-1) {
+        for (i = 0; i < GestureNumTouches; i++) {
+            if (GestureTouches[i].touchId == touchId) {
+                touch = &GestureTouches[i];
+            }
+        }
+        if (touch == NULL) {
+            SDL3_SetError("given touch id not found");
+            return -1;
+        }
+    }
+
+    while (1) {
+        GestureDollarTemplate templ;
+
+        if (SDL_RWread(src, templ.path, sizeof(templ.path[0]), GESTURE_DOLLARNPOINTS) < GESTURE_DOLLARNPOINTS) {
+            if (loaded == 0) {
+                SDL3_SetError("could not read any dollar gesture from rwops");
+                return -1;
+            }
+            break;
+        }
+
+#if SDL_BYTEORDER != SDL_LIL_ENDIAN
+        for (i = 0; i < GESTURE_DOLLARNPOINTS; i++) {
+            SDL_FPoint *p = &templ.path[i];
+            p->x = SDL_SwapFloatLE(p->x);
+            p->y = SDL_SwapFloatLE(p->y);
+        }
+#endif
+
+        if (touchId != (SDL_TouchID)-1) {
+            /* printf("Adding loaded gesture to 1 touch\n"); */
+            if (GestureAddDollar(touch, templ.path) >= 0) {
+                loaded++;
+            }
+        } else {
+            /* printf("Adding to: %i touches\n",GestureNumTouches); */
+            for (i = 0; i < GestureNumTouches; i++) {
+                touch = &GestureTouches[i];
+                /* printf("Adding loaded gesture to + touches\n"); */
+                /* TODO: What if this fails? */
+                GestureAddDollar(touch, templ.path);
+            }
+            loaded++;
+        }
+    }
+
+    return loaded;
+}
+
+static float
+GestureDollarDifference(SDL_FPoint *points, SDL_FPoint *templ, float ang)
+{
+    /*  SDL_FPoint p[GESTURE_DOLLARNPOINTS]; */
+    float dist = 0;
+    SDL_FPoint p;
+    int i;
+    for (i = 0; i < GESTURE_DOLLARNPOINTS; i++) {
+        p.x = points[i].x * SDL3_cosf(ang) - points[i].y * SDL3_sinf(ang);
+        p.y = points[i].x * SDL3_sinf(ang) + points[i].y * SDL3_cosf(ang);
+        dist += SDL3_sqrtf((p.x - templ[i].x) * (p.x - templ[i].x) + (p.y - templ[i].y) * (p.y - templ[i].y));
+    }
+    return dist / GESTURE_DOLLARNPOINTS;
+}
+
+static float
+GestureBestDollarDifference(SDL_FPoint *points, SDL_FPoint *templ)
+{
+    /*------------BEGIN DOLLAR BLACKBOX------------------
+      -TRANSLATED DIRECTLY FROM PSUDEO-CODE AVAILABLE AT-
+      -"http://depts.washington.edu/aimgroup/proj/dollar/"
+    */
+    double ta = -SDL_PI_D / 4;
+    double tb = SDL_PI_D / 4;
+    double dt = SDL_PI_D / 90;
+    float x1 = (float)(GESTURE_PHI * ta + (1 - GESTURE_PHI) * tb);
+    float f1 = GestureDollarDifference(points, templ, x1);
+    float x2 = (float)((1 - GESTURE_PHI) * ta + GESTURE_PHI * tb);
+    float f2 = GestureDollarDifference(points, templ, x2);
+    while (SDL3_fabs(ta - tb) > dt) {
+        if (f1 < f2) {
+            tb = x2;
+            x2 = x1;
+            f2 = f1;
+            x1 = (float)(GESTURE_PHI * ta + (1 - GESTURE_PHI) * tb);
+            f1 = GestureDollarDifference(points, templ, x1);
+        } else {
+            ta = x1;
+            x1 = x2;
+            f1 = f2;
+            x2 = (float)((1 - GESTURE_PHI) * ta + GESTURE_PHI * tb);
+            f2 = GestureDollarDifference(points, templ, x2);
+        }
+    }
+    /*
+    if (f1 <= f2)
+        printf("Min angle (x1): %f\n",x1);
+    else if (f1 >  f2)
+        printf("Min angle (x2): %f\n",x2);
+    */
+    return SDL_min(f1, f2);
+}
+
+/* `path` contains raw points, plus (possibly) the calculated length */
+static int
+GestureDollarNormalize(const GestureDollarPath *path, SDL_FPoint *points, SDL2_bool is_recording)
+{
+    int i;
+    float interval;
+    float dist;
+    int numPoints = 0;
+    SDL_FPoint centroid;
+    float xmin, xmax, ymin, ymax;
+    float ang;
+    float w, h;
+    float length = path->length;
+
+    /* Calculate length if it hasn't already been done */
+    if (length <= 0) {
+        for (i = 1; i < path->numPoints; i++) {
+            const float dx = path->p[i].x - path->p[i - 1].x;
+            const float dy = path->p[i].y - path->p[i - 1].y;
+            length += SDL3_sqrtf(dx * dx + dy * dy);
+        }
+    }
+
+    /* Resample */
+    interval = length / (GESTURE_DOLLARNPOINTS - 1);
+    dist = interval;
+
+    centroid.x = 0;
+    centroid.y = 0;
+
+    /* printf("(%f,%f)\n",path->p[path->numPoints-1].x,path->p[path->numPoints-1].y); */
+    for (i = 1; i < path->numPoints; i++) {
+        const float d = SDL3_sqrtf((path->p[i - 1].x - path->p[i].x) * (path->p[i - 1].x - path->p[i].x) + (path->p[i - 1].y - path->p[i].y) * (path->p[i - 1].y - path->p[i].y));
+        /* printf("d = %f dist = %f/%f\n",d,dist,interval); */
+        while (dist + d > interval) {
+            points[numPoints].x = path->p[i - 1].x +
+                                  ((interval - dist) / d) * (path->p[i].x - path->p[i - 1].x);
+            points[numPoints].y = path->p[i - 1].y +
+                                  ((interval - dist) / d) * (path->p[i].y - path->p[i - 1].y);
+            centroid.x += points[numPoints].x;
+            centroid.y += points[numPoints].y;
+            numPoints++;
+
+            dist -= interval;
+        }
+        dist += d;
+    }
+    if (numPoints < GESTURE_DOLLARNPOINTS - 1) {
+        if (is_recording) {
+            SDL3_SetError("ERROR: NumPoints = %i", numPoints);
+        }
+        return 0;
+    }
+    /* copy the last point */
+    points[GESTURE_DOLLARNPOINTS - 1] = path->p[path->numPoints - 1];
+    numPoints = GESTURE_DOLLARNPOINTS;
+
+    centroid.x /= numPoints;
+    centroid.y /= numPoints;
+
+    /* printf("Centroid (%f,%f)",centroid.x,centroid.y); */
+    /* Rotate Points so point 0 is left of centroid and solve for the bounding box */
+    xmin = centroid.x;
+    xmax = centroid.x;
+    ymin = centroid.y;
+    ymax = centroid.y;
+
+    ang = SDL3_atan2f(centroid.y - points[0].y, centroid.x - points[0].x);
+
+    for (i = 0; i < numPoints; i++) {
+        const float px = points[i].x;
+        const float py = points[i].y;
+        points[i].x = (px - centroid.x) * SDL3_cosf(ang) - (py - centroid.y) * SDL3_sinf(ang) + centroid.x;
+        points[i].y = (px - centroid.x) * SDL3_sinf(ang) + (py - centroid.y) * SDL3_cosf(ang) + centroid.y;
+
+        if (points[i].x < xmin) {
+            xmin = points[i].x;
+        }
+        if (points[i].x > xmax) {
+            xmax = points[i].x;
+        }
+        if (points[i].y < ymin) {
+            ymin = points[i].y;
+        }
+        if (points[i].y > ymax) {
+            ymax = points[i].y;
+        }
+    }
+
+    /* Scale points to GESTURE_DOLLARSIZE, and translate to the origin */
+    w = xmax - xmin;
+    h = ymax - ymin;
+
+    for (i = 0; i < numPoints; i++) {
+        points[i].x = (points[i].x - centroid.x) * GESTURE_DOLLARSIZE / w;
+        points[i].y = (points[i].y - centroid.y) * GESTURE_DOLLARSIZE / h;
+    }
+    return numPoints;
+}
+
+static float
+GestureDollarRecognize(const GestureDollarPath *path, int *bestTempl, GestureTouch *touch)
+{
+    SDL_FPoint points[GESTURE_DOLLARNPOINTS];
+    int i;
+    float bestDiff = 10000;
+
+    SDL3_memset(points, 0, sizeof(points));
+
+    GestureDollarNormalize(path, points, SDL2_FALSE);
+
+    /* PrintPath(points); */
+    *bestTempl = -1;
+    for (i = 0; i < touch->numDollarTemplates; i++) {
+        const float diff = GestureBestDollarDifference(points, touch->dollarTemplate[i].path);
+        if (diff < bestDiff) {
+            bestDiff = diff;
+            *bestTempl = i;
+        }
+    }
+    return bestDiff;
+}
+
+static void
+GestureSendMulti(GestureTouch *touch, float dTheta, float dDist)
+{
+    if (SDL3_EventEnabled(SDL_MULTIGESTURE)) {
+        SDL2_Event event;
+        event.type = SDL_MULTIGESTURE;
+        event.common.timestamp = 0;
+        event.mgesture.touchId = touch->touchId;
+        event.mgesture.x = touch->centroid.x;
+        event.mgesture.y = touch->centroid.y;
+        event.mgesture.dTheta = dTheta;
+        event.mgesture.dDist = dDist;
+        event.mgesture.numFingers = touch->numDownFingers;
+        SDL_PushEvent(&event);
+    }
+}
+
+static void
+GestureSendDollar(GestureTouch *touch, SDL2_GestureID gestureId, float error)
+{
+    if (SDL3_EventEnabled(SDL_DOLLARGESTURE)) {
+        SDL2_Event event;
+        event.type = SDL_DOLLARGESTURE;
+        event.common.timestamp = 0;
+        event.dgesture.touchId = touch->touchId;
+        event.dgesture.x = touch->centroid.x;
+        event.dgesture.y = touch->centroid.y;
+        event.dgesture.gestureId = gestureId;
+        event.dgesture.error = error;
+        /* A finger came up to trigger this event. */
+        event.dgesture.numFingers = touch->numDownFingers + 1;
+        SDL_PushEvent(&event);
+    }
+}
+
+static void
+GestureSendDollarRecord(GestureTouch *touch, SDL2_GestureID gestureId)
+{
+    if (SDL3_EventEnabled(SDL_DOLLARRECORD)) {
+        SDL2_Event event;
+        event.type = SDL_DOLLARRECORD;
+        event.common.timestamp = 0;
+        event.dgesture.touchId = touch->touchId;
+        event.dgesture.gestureId = gestureId;
+        SDL_PushEvent(&event);
+    }
+}
+
+/* These are SDL3 events coming in from sdl2-compat's event watcher. */
+static void
+GestureProcessEvent(const SDL_Event *event3)
+{
+    float x, y;
+    int i, idx;
+    float pathDx, pathDy;
+    SDL_FPoint lastP;
+    SDL_FPoint lastCentroid;
+    float lDist;
+    float Dist;
+    float dtheta;
+    float dDist;
+
+    if (event3->type == SDL_EVENT_FINGER_MOTION || event3->type == SDL_EVENT_FINGER_DOWN || event3->type == SDL_EVENT_FINGER_UP) {
+        GestureTouch *inTouch = GestureGetTouch(event3->tfinger.touchID);
+
+        if (inTouch == NULL) {  /* we maybe didn't see this one before. */
+            inTouch = GestureAddTouch(event3->tfinger.touchID);
+            if (!inTouch) {
+                return;  /* oh well. */
+            }
+        }
+
+        x = event3->tfinger.x;
+        y = event3->tfinger.y;
+
+        /* Finger Up */
+        if (event3->type == SDL_EVENT_FINGER_UP) {
+            SDL_FPoint path[GESTURE_DOLLARNPOINTS];
+            inTouch->numDownFingers--;
+
+            if (inTouch->recording) {
+                inTouch->recording = SDL2_FALSE;
+                GestureDollarNormalize(&inTouch->dollarPath, path, SDL2_TRUE);
+                /* PrintPath(path); */
+                if (GestureRecordAll) {
+                    idx = GestureAddDollar(NULL, path);
+                    for (i = 0; i < GestureNumTouches; i++) {
+                        GestureTouches[i].recording = SDL2_FALSE;
+                    }
+                } else {
+                    idx = GestureAddDollar(inTouch, path);
+                }
+
+                if (idx >= 0) {
+                    GestureSendDollarRecord(inTouch, inTouch->dollarTemplate[idx].hash);
+                } else {
+                    GestureSendDollarRecord(inTouch, -1);
+                }
+            } else {
+                int bestTempl = -1;
+                const float error = GestureDollarRecognize(&inTouch->dollarPath, &bestTempl, inTouch);
+                if (bestTempl >= 0) {
+                    /* Send Event */
+                    Sint64 gestureId = inTouch->dollarTemplate[bestTempl].hash;
+                    GestureSendDollar(inTouch, gestureId, error);
+                    /* printf ("%s\n",);("Dollar error: %f\n",error); */
+                }
+            }
+
+            /* inTouch->gestureLast[j] = inTouch->gestureLast[inTouch->numDownFingers]; */
+            if (inTouch->numDownFingers > 0) {
+                inTouch->centroid.x = (inTouch->centroid.x * (inTouch->numDownFingers + 1) - x) / inTouch->numDownFingers;
+                inTouch->centroid.y = (inTouch->centroid.y * (inTouch->numDownFingers + 1) - y) / inTouch->numDownFingers;
+            }
+        } else if (event3->type == SDL_EVENT_FINGER_MOTION) {
+            const float dx = event3->tfinger.dx;
+            const float dy = event3->tfinger.dy;
+            GestureDollarPath *path = &inTouch->dollarPath;
+            if (path->numPoints < GESTURE_MAX_DOLLAR_PATH_SIZE) {
+                path->p[path->numPoints].x = inTouch->centroid.x;
+                path->p[path->numPoints].y = inTouch->centroid.y;
+                pathDx = (path->p[path->numPoints].x - path->p[path->numPoints - 1].x);
+                pathDy = (path->p[path->numPoints].y - path->p[path->numPoints - 1].y);
+                path->length += (float)SDL3_sqrt(pathDx * pathDx + pathDy * pathDy);
+                path->numPoints++;
+            }
+
+            lastP.x = x - dx;
+            lastP.y = y - dy;
+            lastCentroid = inTouch->centroid;
+
+            inTouch->centroid.x += dx / inTouch->numDownFingers;
+            inTouch->centroid.y += dy / inTouch->numDownFingers;
+            /* printf("Centrid : (%f,%f)\n",inTouch->centroid.x,inTouch->centroid.y); */
+            if (inTouch->numDownFingers > 1) {
+                SDL_FPoint lv; /* Vector from centroid to last x,y position */
+                SDL_FPoint v;  /* Vector from centroid to current x,y position */
+                /* lv = inTouch->gestureLast[j].cv; */
+                lv.x = lastP.x - lastCentroid.x;
+                lv.y = lastP.y - lastCentroid.y;
+                lDist = SDL3_sqrtf(lv.x * lv.x + lv.y * lv.y);
+                /* printf("lDist = %f\n",lDist); */
+                v.x = x - inTouch->centroid.x;
+                v.y = y - inTouch->centroid.y;
+                /* inTouch->gestureLast[j].cv = v; */
+                Dist = SDL3_sqrtf(v.x * v.x + v.y * v.y);
+                /* SDL3_cosf(dTheta) = (v . lv)/(|v| * |lv|) */
+
+                /* Normalize Vectors to simplify angle calculation */
+                lv.x /= lDist;
+                lv.y /= lDist;
+                v.x /= Dist;
+                v.y /= Dist;
+                dtheta = SDL3_atan2f(lv.x * v.y - lv.y * v.x, lv.x * v.x + lv.y * v.y);
+
+                dDist = (Dist - lDist);
+                if (lDist == 0) {
+                    /* To avoid impossible values */
+                    dDist = 0;
+                    dtheta = 0;
+                }
+
+                /* inTouch->gestureLast[j].dDist = dDist;
+                inTouch->gestureLast[j].dtheta = dtheta;
+
+                printf("dDist = %f, dTheta = %f\n",dDist,dtheta);
+                gdtheta = gdtheta*.9 + dtheta*.1;
+                gdDist  =  gdDist*.9 +  dDist*.1
+                knob.r += dDist/numDownFingers;
+                knob.ang += dtheta;
+                printf("thetaSum = %f, distSum = %f\n",gdtheta,gdDist);
+                printf("id: %i dTheta = %f, dDist = %f\n",j,dtheta,dDist); */
+                GestureSendMulti(inTouch, dtheta, dDist);
+            } else {
+                /* inTouch->gestureLast[j].dDist = 0;
+                inTouch->gestureLast[j].dtheta = 0;
+                inTouch->gestureLast[j].cv.x = 0;
+                inTouch->gestureLast[j].cv.y = 0; */
+            }
+            /* inTouch->gestureLast[j].f.p.x = x;
+            inTouch->gestureLast[j].f.p.y = y;
+            break;
+            pressure? */
+        } else if (event3->type == SDL_EVENT_FINGER_DOWN) {
+            inTouch->numDownFingers++;
+            inTouch->centroid.x = (inTouch->centroid.x * (inTouch->numDownFingers - 1) + x) /
+                                  inTouch->numDownFingers;
+            inTouch->centroid.y = (inTouch->centroid.y * (inTouch->numDownFingers - 1) + y) /
+                                  inTouch->numDownFingers;
+            /* printf("Finger Down: (%f,%f). Centroid: (%f,%f\n",x,y,
+                 inTouch->centroid.x,inTouch->centroid.y); */
+
+            inTouch->dollarPath.length = 0;
+            inTouch->dollarPath.p[0].x = x;
+            inTouch->dollarPath.p[0].y = y;
+            inTouch->dollarPath.numPoints = 1;
+        }
     }
-    return status;
 }
 
-SDL_DECLSPEC float SDLCALL
-SDL_GetWindowBrightness(SDL_Window *window)
+/**
+ * Shape mask paths as defined in the SDL2_SHAPE_FAST_PATHS hint, for testing and benchmarking:
+ *  - 0: the generic per-pixel path only
+ *  - 1: the per-format fast paths, without the SIMD row kernels
+ *  - 2: (default) the fast paths, with SIMD row kernels where the CPU has them
+ */
+static void SDLCALL SDL2_ShapeFastPathsChanged(void *userdata, const char *name, const char *oldValue, const char *hint)
 {
-    if (!window) {
-        SDL3_SetError("Invalid window");
-        return 1.0f;
-    }
-
-    return SDL3_GetFloatProperty(SDL3_GetWindowProperties(window), PROP_WINDOW_BRIGHTNESS, 1.0f);
+    SDL2_ShapeFastPaths = (hint && *hint) ? SDL_clamp(SDL_atoi(hint), 0, 2) : 2;
 }
 
-SDL_DECLSPEC void SDLCALL
-SDL_CalculateGammaRamp(float gamma, Uint16 *ramp)
+static Uint32 GetShapeMaskValue(const SDL_WindowShapeMode *mode, Uint8 r, Uint8 g, Uint8 b, Uint8 alpha)
 {
-    int i;
-
-    /* Input validation */
-    if (gamma < 0.0f) {
-      SDL3_InvalidParamError("gamma");
-      return;
-    }
-    if (ramp == NULL) {
-      SDL3_InvalidParamError("ramp");
-      return;
+    switch (mode->mode) {
+    case (ShapeModeDefault):
+        return (alpha >= 1 ? 0xFFFFFFFF : 0);
+    case (ShapeModeBinarizeAlpha):
+        return (alpha >= mode->parameters.binarizationCutoff ? 0xFFFFFFFF : 0);
+    case (ShapeModeReverseBinarizeAlpha):
+        return (alpha <= mode->parameters.binarizationCutoff ? 0xFFFFFFFF : 0);
+    case (ShapeModeColorKey):
+        return ((mode->parameters.colorKey.r != r || mode->parameters.colorKey.g != g || mode->parameters.colorKey.b != b) ? 0xFFFFFFFF : 0);
     }
+    return 0;
+}
 
-    /* 0.0 gamma is all black */
-    if (gamma == 0.0f) {
-        SDL3_memset(ramp, 0, 256 * sizeof(Uint16));
-        return;
-    }
-    if (gamma == 1.0f) {
-        /* 1.0 gamma is identity */
-        for (i = 0; i < 256; ++i) {
-            ramp[i] = (i << 8) | i;
-        }
-        return;
+/* The alpha modes all keep the pixels whose alpha is in [*lo, *hi] */
+static void GetShapeAlphaRange(const SDL_WindowShapeMode *mode, int *lo, int *hi)
+{
+    *lo = 0;
+    *hi = 255;
+    if (mode->mode == ShapeModeDefault) {
+        *lo = 1;
+    } else if (mode->mode == ShapeModeBinarizeAlpha) {
+        *lo = mode->parameters.binarizationCutoff;
     } else {
-        /* Calculate a real gamma ramp */
-        int value;
-        gamma = 1.0f / gamma;
-        for (i = 0; i < 256; ++i) {
-            value =
-                (int) (SDL3_pow((double) i / 256.0, gamma) * 65535.0 + 0.5);
-            if (value > 65535) {
-                value = 65535;
-            }
-            ramp[i] = (Uint16) value;
-        }
+        *hi = mode->parameters.binarizationCutoff;
     }
 }
 
-SDL_DECLSPEC int SDLCALL
-SDL_SetWindowGammaRamp(SDL_Window *window, const Uint16 *r, const Uint16 *g, const Uint16 *b)
+/* Row kernels for 32-bit formats with 8-bit channels. These are written so compilers can vectorize
+ * them, and on x86 there are SSE2 versions as well.
+ */
+static void CalculateShapeRowAlpha32(const Uint32 *src, Uint32 *dst, int w, int Ashift, int lo, int hi)
 {
-    if (!window) {
-        SDL3_SetError("Invalid window");
-        return -1;
-    }
-
-    SDL3_Unsupported();
-    return -1;
-
-#if 0 /* Leaving this code here in case we need it for a compatibility quirk */
-    Uint16 *gamma = (Uint16 *)SDL3_GetPointerProperty(SDL3_GetWindowProperties(window), PROP_WINDOW_GAMMA_RAMP, NULL);
-    if (!gamma) {
-        if (SDL_GetWindowGammaRamp(window, NULL, NULL, NULL) < 0) {
-            return -1;
-        }
-        gamma = (Uint16 *)SDL3_GetPointerProperty(SDL3_GetWindowProperties(window), PROP_WINDOW_GAMMA_RAMP, NULL);
-    }
-
-    if (r) {
-        SDL_memcpy(&gamma[0*256], r, 256*sizeof(Uint16));
-    }
-    if (g) {
-        SDL_memcpy(&gamma[1*256], g, 256*sizeof(Uint16));
+    int x;
+    for (x = 0; x < w; ++x) {
+        const int alpha = (int)((src[x] >> Ashift) & 0xFF);
+        dst[x] = (alpha >= lo && alpha <= hi) ? 0xFFFFFFFF : 0;
     }
-    if (b) {
-        SDL_memcpy(&gamma[2*256], b, 256*sizeof(Uint16));
-    }
-    return 0;
-#endif
 }
 
-static void SDLCALL CleanupFreeableProperty(void *userdata, void *value)
+static void CalculateShapeRowColorKey32(const Uint32 *src, Uint32 *dst, int w, Uint32 rgbmask, Uint32 key)
 {
-    SDL3_free(value);
+    int x;
+    for (x = 0; x < w; ++x) {
+        dst[x] = ((src[x] & rgbmask) != key) ? 0xFFFFFFFF : 0;
+    }
 }
 
-SDL_DECLSPEC int SDLCALL
-SDL_GetWindowGammaRamp(SDL_Window *window, Uint16 *red, Uint16 *blue, Uint16 *green)
+#ifdef SDL_SSE2_INTRINSICS
+static void SDL_TARGETING("sse2") CalculateShapeRowAlpha32_SSE2(const Uint32 *src, Uint32 *dst, int w, int Ashift, int lo, int hi)
 {
-    Uint16 *gamma;
-
-    if (!window) {
-        SDL3_SetError("Invalid window");
-        return -1;
-    }
-
-    gamma = (Uint16 *)SDL3_GetPointerProperty(SDL3_GetWindowProperties(window), PROP_WINDOW_GAMMA_RAMP, NULL);
-    if (!gamma) {
-        int i;
-
-        gamma = (Uint16 *)SDL3_malloc(256*3*sizeof(Uint16));
-        if (!gamma) {
-            return -1;
-        }
-
-        /* Create an identity gamma ramp */
-        for (i = 0; i < 256; ++i) {
-            Uint16 value = (Uint16)((i << 8) | i);
-
-            gamma[0*256+i] = value;
-            gamma[1*256+i] = value;
-            gamma[2*256+i] = value;
-        }
-        SDL3_SetPointerPropertyWithCleanup(SDL3_GetWindowProperties(window), PROP_WINDOW_GAMMA_RAMP, gamma, CleanupFreeableProperty, NULL);
-    }
+    const __m128i shift = _mm_cvtsi32_si128(Ashift);
+    const __m128i byte = _mm_set1_epi32(0xFF);
+    const __m128i below = _mm_set1_epi32(lo - 1);
+    const __m128i above = _mm_set1_epi32(hi + 1);
+    int x = 0;
 
-    if (red) {
-        SDL_memcpy(red, &gamma[0*256], 256*sizeof(Uint16));
-    }
-    if (green) {
-        SDL_memcpy(green, &gamma[1*256], 256*sizeof(Uint16));
-    }
-    if (blue) {
-        SDL_memcpy(blue, &gamma[2*256], 256*sizeof(Uint16));
+    for (; x + 4 <= w; x += 4) {
+        const __m128i alpha = _mm_and_si128(_mm_srl_epi32(_mm_loadu_si128((const __m128i *)&src[x]), shift), byte);
+        _mm_storeu_si128((__m128i *)&dst[x], _mm_and_si128(_mm_cmpgt_epi32(alpha, below), _mm_cmplt_epi32(alpha, above)));
     }
-    return 0;
+    CalculateShapeRowAlpha32(&src[x], &dst[x], w - x, Ashift, lo, hi);
 }
 
-SDL_DECLSPEC int SDLCALL
-SDL_GetWindowOpacity(SDL_Window *window, float *out_opacity)
+static void SDL_TARGETING("sse2") CalculateShapeRowColorKey32_SSE2(const Uint32 *src, Uint32 *dst, int w, Uint32 rgbmask, Uint32 key)
 {
-    float opacity = SDL3_GetWindowOpacity(window);
-    if (opacity < 0.0f) {
-        return -1;
-    }
-    if (out_opacity) {
-        *out_opacity = opacity;
+    const __m128i mask = _mm_set1_epi32((int)rgbmask);
+    const __m128i keys = _mm_set1_epi32((int)key);
+    const __m128i ones = _mm_set1_epi32(-1);
+    int x = 0;
+
+    for (; x + 4 <= w; x += 4) {
+        const __m128i rgb = _mm_and_si128(_mm_loadu_si128((const __m128i *)&src[x]), mask);
+        _mm_storeu_si128((__m128i *)&dst[x], _mm_xor_si128(_mm_cmpeq_epi32(rgb, keys), ones));
     }
-    return 0;
+    CalculateShapeRowColorKey32(&src[x], &dst[x], w - x, rgbmask, key);
 }
+#endif /* SDL_SSE2_INTRINSICS */
 
-SDL_DECLSPEC SDL2_Surface * SDLCALL
-SDL_ConvertSurface(SDL2_Surface *surface, const SDL2_PixelFormat *format, Uint32 flags)
+/* Returns false if the shape isn't in a format with a fast path */
+static bool CalculateShapeBitmapFast(const SDL_WindowShapeMode *mode, SDL2_Surface *shape, Uint32 *pixels, int pitch)
 {
-    SDL_Palette *palette = NULL;
-    SDL_PixelFormat pixel_format;
-    SDL2_Surface *result;
+    const SDL2_PixelFormat *format = shape->format;
+    const Uint8 *src = (const Uint8 *)shape->pixels;
+    int y;
 
-    (void) flags; /* SDL3 removed the (unused) `flags` argument */
+    if (format->BitsPerPixel == 8 && format->BytesPerPixel == 1 && format->palette) {
+        /* Work out the mask for each palette entry once, then it's a table lookup per pixel */
+        Uint32 masks[256];
+        Uint8 r, g, b, alpha;
+        int i, x;
 
-    if (!surface) {
-        SDL3_InvalidParamError("surface");
-        return NULL;
-    }
-    if (!format) {
-        SDL3_InvalidParamError("format");
-        return NULL;
+        for (i = 0; i < 256; ++i) {
+            SDL_GetRGBA((Uint32)i, format, &r, &g, &b, &alpha);
+            masks[i] = GetShapeMaskValue(mode, r, g, b, alpha);
+        }
+        for (y = 0; y < shape->h; y++) {
+            for (x = 0; x < shape->w; x++) {
+                pixels[x] = masks[src[x]];
+            }
+            src += shape->pitch;
+            pixels = (Uint32 *)((Uint8 *)pixels + pitch);
+        }
+        return true;
     }
 
-    pixel_format = SDL3_GetPixelFormatForMasks(format->BitsPerPixel, format->Rmask, format->Gmask, format->Bmask, format->Amask);
-    if (pixel_format == SDL_PIXELFORMAT_UNKNOWN) {
-        SDL3_InvalidParamError("format");
-        return NULL;
-    }
+    if (format->BytesPerPixel == 4 && mode->mode == ShapeModeColorKey) {
+        const SDL_Color key = mode->parameters.colorKey;
+        void (*kernel)(const Uint32 *, Uint32 *, int, Uint32, Uint32) = CalculateShapeRowColorKey32;
 
-    if (format->palette) {
-        // This conversion is going to assign the new surface this palette,
-        // but it might be on the stack, so always allocate a new one to be
-        // safe. Real SDL2 always allocated a new palette in this function.
-        const int ncolors = format->palette->ncolors;
-        palette = SDL3_CreatePalette(ncolors);
-        if (!palette) {
-            return NULL;
+        if (format->Rloss || format->Gloss || format->Bloss) {
+            return false;
         }
-        SDL3_SetPaletteColors(palette, format->palette->colors, 0, ncolors);
+#ifdef SDL_SSE2_INTRINSICS
+        if ((SDL2_ShapeFastPaths > 1) && SDL3_HasSSE2()) {
+            kernel = CalculateShapeRowColorKey32_SSE2;
+        }
+#endif
+        for (y = 0; y < shape->h; y++) {
+            kernel((const Uint32 *)src, pixels, shape->w, format->Rmask | format->Gmask | format->Bmask,
+                   ((Uint32)key.r << format->Rshift) | ((Uint32)key.g << format->Gshift) | ((Uint32)key.b << format->Bshift));
+            src += shape->pitch;
+            pixels = (Uint32 *)((Uint8 *)pixels + pitch);
+        }
+        return true;
     }
 
-    result = Surface3to2(SDL3_ConvertSurfaceAndColorspace(Surface2to3(surface), pixel_format, palette, SDL_COLORSPACE_SRGB, 0));
+    if (format->BytesPerPixel == 4) {
+        void (*kernel)(const Uint32 *, Uint32 *, int, int, int, int) = CalculateShapeRowAlpha32;
+        int lo, hi;
 
-    if (palette) {
-        SDL3_DestroyPalette(palette);
+        GetShapeAlphaRange(mode, &lo, &hi);
+        if (!format->Amask) {
+            /* SDL_GetRGBA() reports opaque pixels, so every pixel gets the same mask */
+            const Uint32 mask_value = (255 >= lo && 255 <= hi) ? 0xFFFFFFFF : 0;
+            int x;
+            for (y = 0; y < shape->h; y++) {
+                for (x = 0; x < shape->w; x++) {
+                    pixels[x] = mask_value;
+                }
+                pixels = (Uint32 *)((Uint8 *)pixels + pitch);
+            }
+            return true;
+        }
+        if (format->Aloss) {
+            return false;
+        }
+#ifdef SDL_SSE2_INTRINSICS
+        if ((SDL2_ShapeFastPaths > 1) && SDL3_HasSSE2()) {
+            kernel = CalculateShapeRowAlpha32_SSE2;
+        }
+#endif
+        for (y = 0; y < shape->h; y++) {
+            kernel((const Uint32 *)src, pixels, shape->w, format->Ashift, lo, hi);
+            src += shape->pitch;
+            pixels = (Uint32 *)((Uint8 *)pixels + pitch);
+        }
+        return true;
     }
-    return result;
-}
-
-SDL_DECLSPEC SDL2_Surface * SDLCALL
-SDL_DuplicateSurface(SDL2_Surface *surface)
-{
-    return Surface3to2(SDL3_DuplicateSurface(Surface2to3(surface)));
-}
-
-SDL_DECLSPEC SDL2_Surface * SDLCALL
-SDL_ConvertSurfaceFormat(SDL2_Surface *surface, Uint32 pixel_format, Uint32 flags)
-{
-    (void) flags; /* SDL3 removed the (unused) `flags` argument */
-    return Surface3to2(SDL3_ConvertSurface(Surface2to3(surface), (SDL_PixelFormat)pixel_format));
-}
-
-#define SDL_YUV_SD_THRESHOLD 576
 
-static SDL_YUV_CONVERSION_MODE SDL_YUV_ConversionMode = SDL_YUV_CONVERSION_BT601;
-
-SDL_DECLSPEC void SDLCALL
-SDL_SetYUVConversionMode(SDL_YUV_CONVERSION_MODE mode)
-{
-    SDL_YUV_ConversionMode = mode;
+    return false;
 }
 
-SDL_DECLSPEC SDL_YUV_CONVERSION_MODE SDLCALL
-SDL_GetYUVConversionMode(void)
+/* REQUIRES that bitmap point to a w-by-h bitmap with ppb pixels-per-byte. */
+static void SDL_CalculateShapeBitmap(SDL_WindowShapeMode mode, SDL2_Surface *shape, Uint32 *pixels, int pitch)
 {
-    return SDL_YUV_ConversionMode;
-}
+    int x = 0;
+    int y = 0;
+    Uint8 r = 0, g = 0, b = 0, alpha = 0;
+    Uint8 *pixel = NULL;
+    Uint32 pixel_value = 0;
 
-SDL_DECLSPEC SDL_YUV_CONVERSION_MODE SDLCALL
-SDL_GetYUVConversionModeForResolution(int width, int height)
-{
-    SDL_YUV_CONVERSION_MODE mode = SDL_GetYUVConversionMode();
-    if (mode == SDL_YUV_CONVERSION_AUTOMATIC) {
-        if (height <= SDL_YUV_SD_THRESHOLD) {
-            mode = SDL_YUV_CONVERSION_BT601;
-        } else {
-            mode = SDL_YUV_CONVERSION_BT709;
-        }
+    if (SDL2_ShapeFastPaths && CalculateShapeBitmapFast(&mode, shape, pixels, pitch)) {
+        return;
     }
-    return mode;
-}
 
-static SDL_Colorspace GetColorspaceForFormatAndSize(Uint32 format, int width, int height)
-{
-    if (SDL_ISPIXELFORMAT_FOURCC(format)) {
-        switch (SDL_GetYUVConversionModeForResolution(width, height)) {
-        case SDL_YUV_CONVERSION_JPEG:
-            return SDL_COLORSPACE_BT601_FULL;
-        case SDL_YUV_CONVERSION_BT601:
-            return SDL_COLORSPACE_BT601_LIMITED;
-        case SDL_YUV_CONVERSION_BT709:
-            return SDL_COLORSPACE_BT709_LIMITED;
-        default:
-            break;
+    for (y = 0; y < shape->h; y++) {
+        for (x = 0; x < shape->w; x++) {
+            alpha = 0;
+            pixel_value = 0;
+            pixel = (Uint8 *)(shape->pixels) + (y * shape->pitch) + (x * shape->format->BytesPerPixel);
+            switch (shape->format->BytesPerPixel) {
+            case 1:
+                pixel_value = *pixel;
+                break;
+            case 2:
+                pixel_value = *(Uint16 *)pixel;
+                break;
+            case 3:
+                pixel_value = *(Uint32 *)pixel & (~shape->format->Amask);
+                break;
+            case 4:
+                pixel_value = *(Uint32 *)pixel;
+                break;
+            }
+            SDL_GetRGBA(pixel_value, shape->format, &r, &g, &b, &alpha);
+            pixels[x] = GetShapeMaskValue(&mode, r, g, b, alpha);
         }
-    }
-    return SDL_COLORSPACE_SRGB;
-}
-
-SDL_DECLSPEC int SDLCALL
-SDL_ConvertPixels(int width, int height, Uint32 src_format, const void *src, int src_pitch, Uint32 dst_format, void *dst, int dst_pitch)
-{
-    SDL_Colorspace src_colorspace = GetColorspaceForFormatAndSize(src_format, width, height);
-    SDL_Colorspace dst_colorspace = GetColorspaceForFormatAndSize(dst_format, width, height);
-    return SDL3_ConvertPixelsAndColorspace(width, height, (SDL_PixelFormat)src_format, src_colorspace, 0, src, src_pitch, (SDL_PixelFormat)dst_format, dst_colorspace, 0, dst, dst_pitch) ? 0 : -1;
-}
-
-SDL_DECLSPEC int SDLCALL
-SDL_PremultiplyAlpha(int width, int height, Uint32 src_format, const void * src, int src_pitch, Uint32 dst_format, void * dst, int dst_pitch)
-{
-    return SDL3_PremultiplyAlpha(width, height, (SDL_PixelFormat)src_format, src, src_pitch, (SDL_PixelFormat)dst_format, dst, dst_pitch, false) ? 0 : -1;
-}
-
-SDL_DECLSPEC SDL2_Surface * SDLCALL
-SDL_CreateRGBSurface(Uint32 flags, int width, int height, int depth, Uint32 Rmask, Uint32 Gmask, Uint32 Bmask, Uint32 Amask)
-{
-    return Surface3to2(SDL3_CreateSurface(width, height, SDL3_GetPixelFormatForMasks(depth, Rmask, Gmask, Bmask, Amask)));
+        pixels = (Uint32 *)((Uint8 *)pixels + pitch);
+    }
 }
 
-SDL_DECLSPEC SDL2_Surface * SDLCALL
-SDL_CreateRGBSurfaceWithFormat(Uint32 flags, int width, int height, int depth, Uint32 format)
-{
-    return Surface3to2(SDL3_CreateSurface(width, height, (SDL_PixelFormat)format));
-}
 
-SDL_DECLSPEC SDL2_Surface * SDLCALL
-SDL_CreateRGBSurfaceFrom(void *pixels, int width, int height, int depth, int pitch, Uint32 Rmask, Uint32 Gmask, Uint32 Bmask, Uint32 Amask)
+SDL_DECLSPEC SDL_Window * SDLCALL
+SDL_CreateShapedWindow(const char *title, unsigned int x, unsigned int y, unsigned int w, unsigned int h, Uint32 flags)
 {
-    return Surface3to2(SDL3_CreateSurfaceFrom(width, height, SDL3_GetPixelFormatForMasks(depth, Rmask, Gmask, Bmask, Amask), pixels, pitch));
+    flags |= (SDL2_WINDOW_HIDDEN | SDL3_WINDOW_TRANSPARENT);
+
+    return SDL_CreateWindow(title, (int)x, (int)y, (int)w, (int)h, flags);
 }
 
-SDL_DECLSPEC SDL2_Surface * SDLCALL
-SDL_CreateRGBSurfaceWithFormatFrom(void *pixels, int width, int height, int depth, int pitch, Uint32 format)
+SDL_DECLSPEC SDL2_bool SDLCALL
+SDL_IsShapedWindow(const SDL_Window *window)
 {
-    return Surface3to2(SDL3_CreateSurfaceFrom(width, height, (SDL_PixelFormat)format, pixels, pitch));
+    if (SDL3_GetWindowFlags((SDL_Window *)window) & SDL_WINDOW_TRANSPARENT) {
+        return SDL2_TRUE;
+    }
+    return SDL2_FALSE;
 }
 
-SDL_DECLSPEC void SDLCALL
-SDL_FreeSurface(SDL2_Surface *surface)
+#define PROP_WINDOW_SHAPE_MODE_POINTER "sdl2-compat.window.shape_mode"
+
+SDL_DECLSPEC int SDLCALL
+SDL_SetWindowShape(SDL_Window *window, SDL2_Surface *shape, SDL_WindowShapeMode *shape_mode)
 {
-    if (!surface) {
-        return;
+    SDL_Surface *surface;
+    int result;
+
+    if (!SDL_IsShapedWindow(window)) {
+        return SDL_NONSHAPEABLE_WINDOW;
     }
 
-    if (surface->flags & SDL_DONTFREE) {
-        return;
+    if (shape == NULL) {
+        return SDL_INVALID_SHAPE_ARGUMENT;
     }
 
-    if (--surface->refcount > 0) {
-        return;
+    if (shape_mode == NULL) {
+        return SDL_INVALID_SHAPE_ARGUMENT;
     }
 
-    if (surface->map) {
-        SDL_Surface *surface3 = (SDL_Surface *)surface->map;
-        SDL3_DestroySurface(surface3);
-        surface->map = NULL;
+    surface = SDL3_CreateSurface(shape->w, shape->h, SDL_PIXELFORMAT_ARGB32);
+    if (!surface) {
+        return -1;
     }
 
-    if (surface->format) {
-        SDL_SetPixelFormatPalette(surface->format, NULL);
-        SDL_FreeFormat(surface->format);
-        surface->format = NULL;
+    SDL_CalculateShapeBitmap(*shape_mode, shape, (Uint32 *)surface->pixels, surface->pitch);
+
+    result = SDL3_SetWindowShape(window, surface) ? 0 : -1;
+    if (result == 0) {
+        SDL_WindowShapeMode *property = (SDL_WindowShapeMode *)SDL3_malloc(sizeof(*property));
+        if (property) {
+            SDL3_copyp(property, shape_mode);
+            result = SDL3_SetPointerPropertyWithCleanup(SDL3_GetWindowProperties(window), PROP_WINDOW_SHAPE_MODE_POINTER, property, CleanupFreeableProperty, NULL) ? 0 : -1;
+        } else {
+            result = -1;
+        }
     }
 
-    SDL3_free(surface);
-}
+    SDL3_DestroySurface(surface);
 
-SDL_DECLSPEC int SDLCALL
-SDL_FillRect(SDL2_Surface *dst, const SDL_Rect *rect, Uint32 color)
-{
-    return SDL3_FillSurfaceRect(Surface2to3(dst), rect, color) ? 0 : -1;
+    if (result == 0) {
+        SDL3_ShowWindow(window);
+    }
+
+    return result;
 }
 
 SDL_DECLSPEC int SDLCALL
-SDL_FillRects(SDL2_Surface *dst, const SDL_Rect *rects, int count, Uint32 color)
+SDL_GetShapedWindowMode(SDL_Window *window, SDL_WindowShapeMode *shape_mode)
 {
-    return SDL3_FillSurfaceRects(Surface2to3(dst), rects, count, color) ? 0 : -1;
+    SDL_WindowShapeMode *property;
+
+    if (!SDL_IsShapedWindow(window)) {
+        return SDL_NONSHAPEABLE_WINDOW;
+    }
+
+    property = (SDL_WindowShapeMode *)SDL3_GetPointerProperty(SDL3_GetWindowProperties(window), PROP_WINDOW_SHAPE_MODE_POINTER, NULL);
+    if (!shape_mode && !property) {
+        return SDL_WINDOW_LACKS_SHAPE;
+    }
+    if (shape_mode) {
+        if (property) {
+            SDL3_copyp(shape_mode, property);
+        } else {
+            /* Default parameters */
+            SDL_zerop(shape_mode);
+            shape_mode->mode = ShapeModeDefault;
+            shape_mode->parameters.binarizationCutoff = 1;
+        }
+    }
+    return 0;
 }
 
+
 SDL_DECLSPEC int SDLCALL
-SDL_UpperBlit(SDL2_Surface *src, const SDL_Rect *srcrect, SDL2_Surface *dst, SDL_Rect *dstrect)
+SDL_GetRendererInfo(SDL_Renderer *renderer, SDL2_RendererInfo *info)
 {
-    SDL_Rect r_src, r_dst;
+    const char *name;
+    SDL_PropertiesID props;
+    unsigned int i;
+    const SDL_PixelFormat *formats;
 
-    /* Make sure the surfaces aren't locked */
-    if (!src) {
-        SDL3_InvalidParamError("src");
-        return -1;
-    } else if (!dst) {
-        SDL3_InvalidParamError("dst");
-        return -1;
-    } else if (src->locked || dst->locked) {
-        SDL3_SetError("Surfaces must not be locked during blit");
+    if (!info) {
+        SDL3_InvalidParamError("info");
         return -1;
     }
 
-    /* Full src surface */
-    r_src.x = 0;
-    r_src.y = 0;
-    r_src.w = src->w;
-    r_src.h = src->h;
-
-    if (dstrect) {
-        r_dst.x = dstrect->x;
-        r_dst.y = dstrect->y;
-    } else {
-        r_dst.x = 0;
-        r_dst.y = 0;
+    name = SDL3_GetRendererName(renderer);
+    if (!name) {
+        return -1;
     }
 
-    /* clip the source rectangle to the source surface */
-    if (srcrect) {
-        SDL_Rect tmp;
-        if (!SDL3_GetRectIntersection(srcrect, &r_src, &tmp)) {
-            goto end;
-        }
+    SDL3_zerop(info);
 
-        /* Shift dstrect, if srcrect origin has changed */
-        r_dst.x += tmp.x - srcrect->x;
-        r_dst.y += tmp.y - srcrect->y;
+    props = SDL3_GetRendererProperties(renderer);
 
-        /* Update srcrect */
-        r_src = tmp;
-    }
+    info->name = name;
+    info->max_texture_width = (int)SDL3_GetNumberProperty(props, SDL_PROP_RENDERER_MAX_TEXTURE_SIZE_NUMBER, 0);
+    info->max_texture_height = info->max_texture_width;
 
-    /* There're no dstrect.w/h parameters. It's the same as srcrect */
-    r_dst.w = r_src.w;
-    r_dst.h = r_src.h;
+    if (SDL3_strcmp(info->name, SDL_SOFTWARE_RENDERER) == 0) {
+        info->flags = SDL2_RENDERER_SOFTWARE | SDL2_RENDERER_TARGETTEXTURE;
+    } else {
+        info->flags = SDL2_RENDERER_ACCELERATED | SDL2_RENDERER_TARGETTEXTURE;
+    }
+    if (SDL3_GetNumberProperty(props, SDL_PROP_RENDERER_VSYNC_NUMBER, 0)) {
+        info->flags |= SDL2_RENDERER_PRESENTVSYNC;
+    }
 
-    /* clip the destination rectangle against the clip rectangle */
-    {
-        SDL_Rect tmp;
-        if (!SDL3_GetRectIntersection(&r_dst, &dst->clip_rect, &tmp)) {
-            goto end;
-        }
+    formats = (const SDL_PixelFormat *)SDL3_GetPointerProperty(props, SDL_PROP_RENDERER_TEXTURE_FORMATS_POINTER, NULL);
+    for (i = 0; i < 16 && formats[i]; ++i) {
+        info->texture_formats[i] = formats[i];
+    }
+    info->num_texture_formats = i;
 
-        /* Shift srcrect, if dstrect has changed */
-        r_src.x += tmp.x - r_dst.x;
-        r_src.y += tmp.y - r_dst.y;
-        r_src.w = tmp.w;
-        r_src.h = tmp.h;
+    return 0;
+}
 
-        /* Update dstrect */
-        r_dst = tmp;
+SDL_DECLSPEC int SDLCALL
+SDL_GetRenderDriverInfo(int idx, SDL2_RendererInfo *info)
+{
+    const char *name = SDL3_GetRenderDriver(idx);
+    if (!name) {
+        return -1;  /* assume SDL3_GetRenderDriver set the SDL error. */
     }
 
-    if (r_dst.w > 0 && r_dst.h > 0) {
-        if (dstrect) { /* update output parameter */
-            *dstrect = r_dst;
-        }
-        return SDL_LowerBlit(src, &r_src, dst, &r_dst);
-    }
+    SDL3_zerop(info);
+    info->name = name;
 
-end:
-    if (dstrect) { /* update output parameter */
-        dstrect->w = dstrect->h = 0;
+    /* For render drivers present in SDL2, these are the exact values SDL2 returns.
+       For render drivers new to SDL3, we return only the subset of formats SDL2 supports. */
+    if ((SDL3_strcmp(name, "opengl") == 0) || (SDL3_strcmp(name, "opengles2") == 0)) {
+        info->flags = SDL2_RENDERER_ACCELERATED | SDL2_RENDERER_PRESENTVSYNC | SDL2_RENDERER_TARGETTEXTURE;
+        info->num_texture_formats = 4;
+        info->texture_formats[0] = SDL_PIXELFORMAT_ARGB8888;
+        info->texture_formats[1] = SDL_PIXELFORMAT_ABGR8888;
+        info->texture_formats[2] = SDL_PIXELFORMAT_XRGB8888;
+        info->texture_formats[3] = SDL_PIXELFORMAT_XBGR8888;
+    } else if (SDL3_strcmp(name, "opengles") == 0) {
+        info->flags = SDL2_RENDERER_ACCELERATED | SDL2_RENDERER_PRESENTVSYNC;
+        info->num_texture_formats = 1;
+        info->texture_formats[0] = SDL_PIXELFORMAT_ABGR8888;
+    } else if (SDL3_strcmp(name, "direct3d") == 0) {
+        info->flags = SDL2_RENDERER_ACCELERATED | SDL2_RENDERER_PRESENTVSYNC | SDL2_RENDERER_TARGETTEXTURE;
+        info->num_texture_formats = 1;
+        info->texture_formats[0] = SDL_PIXELFORMAT_ARGB8888;
+    } else if (SDL3_strcmp(name, "direct3d11") == 0) {
+        info->flags = SDL2_RENDERER_ACCELERATED | SDL2_RENDERER_PRESENTVSYNC | SDL2_RENDERER_TARGETTEXTURE;
+        info->num_texture_formats = 6;
+        info->texture_formats[0] = SDL_PIXELFORMAT_ARGB8888;
+        info->texture_formats[1] = SDL_PIXELFORMAT_XRGB8888;
+        info->texture_formats[2] = SDL_PIXELFORMAT_YV12;
+        info->texture_formats[3] = SDL_PIXELFORMAT_IYUV;
+        info->texture_formats[4] = SDL_PIXELFORMAT_NV12;
+        info->texture_formats[5] = SDL_PIXELFORMAT_NV21;
+    } else if (SDL3_strcmp(name, "direct3d12") == 0) {
+        info->flags = SDL2_RENDERER_ACCELERATED | SDL2_RENDERER_PRESENTVSYNC | SDL2_RENDERER_TARGETTEXTURE;
+        info->num_texture_formats = 6;
+        info->texture_formats[0] = SDL_PIXELFORMAT_ARGB8888;
+        info->texture_formats[1] = SDL_PIXELFORMAT_XRGB8888;
+        info->texture_formats[2] = SDL_PIXELFORMAT_YV12;
+        info->texture_formats[3] = SDL_PIXELFORMAT_IYUV;
+        info->texture_formats[4] = SDL_PIXELFORMAT_NV12;
+        info->texture_formats[5] = SDL_PIXELFORMAT_NV21;
+        info->max_texture_width = 16384;
+        info->max_texture_height = 16384;
+    } else if (SDL3_strcmp(name, "metal") == 0) {
+        info->flags = SDL2_RENDERER_ACCELERATED | SDL2_RENDERER_PRESENTVSYNC | SDL2_RENDERER_TARGETTEXTURE;
+        info->num_texture_formats = 6;
+        info->texture_formats[0] = SDL_PIXELFORMAT_ARGB8888;
+        info->texture_formats[1] = SDL_PIXELFORMAT_ABGR8888;
+        info->texture_formats[2] = SDL_PIXELFORMAT_YV12;
+        info->texture_formats[3] = SDL_PIXELFORMAT_IYUV;
+        info->texture_formats[4] = SDL_PIXELFORMAT_NV12;
+        info->texture_formats[5] = SDL_PIXELFORMAT_NV21;
+    } else if (SDL3_strcmp(name, "PS2 gsKit") == 0) {
+        info->flags = SDL2_RENDERER_ACCELERATED | SDL2_RENDERER_PRESENTVSYNC | SDL2_RENDERER_TARGETTEXTURE;
+        info->num_texture_formats = 2;
+        info->texture_formats[0] = SDL_PIXELFORMAT_ABGR1555;
+        info->texture_formats[1] = SDL_PIXELFORMAT_ABGR8888;
+        info->max_texture_width = 1024;
+        info->max_texture_height = 1024;
+    } else if (SDL3_strcmp(name, "PSP") == 0) {
+        info->flags = SDL2_RENDERER_ACCELERATED | SDL2_RENDERER_PRESENTVSYNC | SDL2_RENDERER_TARGETTEXTURE;
+        info->num_texture_formats = 4;
+        info->texture_formats[0] = SDL_PIXELFORMAT_BGR565;
+        info->texture_formats[1] = SDL_PIXELFORMAT_ABGR1555;
+        info->texture_formats[2] = SDL_PIXELFORMAT_ABGR4444;
+        info->texture_formats[3] = SDL_PIXELFORMAT_ABGR8888;
+        info->max_texture_width = 512;
+        info->max_texture_height = 512;
+    } else if (SDL3_strcmp(name, "VITA gxm") == 0) {
+        info->flags = SDL2_RENDERER_ACCELERATED | SDL2_RENDERER_PRESENTVSYNC | SDL2_RENDERER_TARGETTEXTURE;
+        info->num_texture_formats = 8;
+        info->texture_formats[0] = SDL_PIXELFORMAT_ABGR8888;
+        info->texture_formats[1] = SDL_PIXELFORMAT_ARGB8888;
+        info->texture_formats[2] = SDL_PIXELFORMAT_RGB565;
+        info->texture_formats[3] = SDL_PIXELFORMAT_BGR565;
+        info->texture_formats[4] = SDL_PIXELFORMAT_YV12;
+        info->texture_formats[5] = SDL_PIXELFORMAT_IYUV;
+        info->texture_formats[6] = SDL_PIXELFORMAT_NV12;
+        info->texture_formats[7] = SDL_PIXELFORMAT_NV21;
+        info->max_texture_width = 4096;
+        info->max_texture_height = 4096;
+    } else if (SDL3_strcmp(name, "vulkan") == 0) {
+        info->flags = SDL2_RENDERER_ACCELERATED | SDL2_RENDERER_PRESENTVSYNC | SDL2_RENDERER_TARGETTEXTURE;
+        info->num_texture_formats = 2;
+        info->texture_formats[0] = SDL_PIXELFORMAT_ARGB8888;
+        info->texture_formats[1] = SDL_PIXELFORMAT_ABGR8888;
+        info->max_texture_width = 16384;
+        info->max_texture_height = 16384;
+    } else if (SDL3_strcmp(name, "gpu") == 0) {
+        info->flags = SDL2_RENDERER_ACCELERATED | SDL2_RENDERER_PRESENTVSYNC | SDL2_RENDERER_TARGETTEXTURE;
+        info->num_texture_formats = 4;
+        info->texture_formats[0] = SDL_PIXELFORMAT_BGRA32;
+        info->texture_formats[1] = SDL_PIXELFORMAT_RGBA32;
+        info->texture_formats[2] = SDL_PIXELFORMAT_BGRX32;
+        info->texture_formats[3] = SDL_PIXELFORMAT_RGBX32;
+        info->max_texture_width = 16384;
+        info->max_texture_height = 16384;
+    } else if (SDL3_strcmp(name, "software") == 0) {
+        info->flags = SDL2_RENDERER_SOFTWARE | SDL2_RENDERER_PRESENTVSYNC | SDL2_RENDERER_TARGETTEXTURE;
+        info->num_texture_formats = 8;
+        info->texture_formats[0] = SDL_PIXELFORMAT_ARGB8888;
+        info->texture_formats[1] = SDL_PIXELFORMAT_ABGR8888;
+        info->texture_formats[2] = SDL_PIXELFORMAT_RGBA8888;
+        info->texture_formats[3] = SDL_PIXELFORMAT_BGRA8888;
+        info->texture_formats[4] = SDL_PIXELFORMAT_XRGB8888;
+        info->texture_formats[5] = SDL_PIXELFORMAT_XBGR8888;
+        info->texture_formats[6] = SDL_PIXELFORMAT_RGB565;
+        info->texture_formats[7] = SDL_PIXELFORMAT_XRGB1555;
+    } else {  /* this seems reasonable if something currently-unknown shows up in SDL3. */
+        info->flags = SDL2_RENDERER_ACCELERATED | SDL2_RENDERER_PRESENTVSYNC | SDL2_RENDERER_TARGETTEXTURE;
+        info->num_texture_formats = 1;
+        info->texture_formats[0] = SDL_PIXELFORMAT_ARGB8888;
     }
     return 0;
 }
 
-SDL_DECLSPEC int SDLCALL
-SDL_LowerBlit(SDL2_Surface *src2, SDL_Rect *srcrect, SDL2_Surface *dst2, SDL_Rect *dstrect)
+static void ConvertIntsToFloats(const int *src, float *dst, size_t count)
 {
-    SDL_Surface *src = Surface2to3(src2);
-    SDL_Surface *dst = Surface2to3(dst2);
-    int result = SDL3_BlitSurfaceUnchecked(src, srcrect, dst, dstrect) ? 0 : -1;
-    SynchronizeSurface3to2(src, src2);
-    return result;
+    size_t i;
+    for (i = 0; i < count; ++i) {
+        dst[i] = (float)src[i];
+    }
 }
 
-SDL_DECLSPEC int SDLCALL
-SDL_UpperBlitScaled(SDL2_Surface *src, const SDL_Rect *srcrect, SDL2_Surface *dst, SDL_Rect *dstrect)
+#ifdef SDL_SSE2_INTRINSICS
+static void SDL_TARGETING("sse2") ConvertIntsToFloats_SSE2(const int *src, float *dst, size_t count)
 {
-    double src_x0, src_y0, src_x1, src_y1;
-    double dst_x0, dst_y0, dst_x1, dst_y1;
-    SDL_Rect final_src, final_dst;
-    double scaling_w, scaling_h;
-    int src_w, src_h;
-    int dst_w, dst_h;
-
-    /* Make sure the surfaces aren't locked */
-    if (!src || !dst) {
-        SDL3_InvalidParamError("SDL_UpperBlitScaled(): src/dst");
-        return -1;
-    }
-    if (src->locked || dst->locked) {
-        SDL3_SetError("Surfaces must not be locked during blit");
-        return -1;
-    }
+    size_t i = 0;
 
-    if (!srcrect) {
-        src_w = src->w;
-        src_h = src->h;
-    } else {
-        src_w = srcrect->w;
-        src_h = srcrect->h;
+    for (; i + 8 <= count; i += 8) {
+        _mm_storeu_ps(&dst[i], _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i *)&src[i])));
+        _mm_storeu_ps(&dst[i + 4], _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i *)&src[i + 4])));
     }
+    ConvertIntsToFloats(&src[i], &dst[i], count - i);
+}
+#endif /* SDL_SSE2_INTRINSICS */
 
-    if (!dstrect) {
-        dst_w = dst->w;
-        dst_h = dst->h;
-    } else {
-        dst_w = dstrect->w;
-        dst_h = dstrect->h;
-    }
+#ifdef SDL_AVX2_INTRINSICS
+static void SDL_TARGETING("avx2") ConvertIntsToFloats_AVX2(const int *src, float *dst, size_t count)
+{
+    size_t i = 0;
 
-    if (dst_w == src_w && dst_h == src_h) {
-        /* No scaling, defer to regular blit */
-        return SDL_UpperBlit(src, srcrect, dst, dstrect);
+    for (; i + 16 <= count; i += 16) {
+        _mm256_storeu_ps(&dst[i], _mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i *)&src[i])));
+        _mm256_storeu_ps(&dst[i + 8], _mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i *)&src[i + 8])));
     }
+    ConvertIntsToFloats(&src[i], &dst[i], count - i);
+}
+#endif /* SDL_AVX2_INTRINSICS */
 
-    scaling_w = (double)dst_w / src_w;
-    scaling_h = (double)dst_h / src_h;
+#ifdef SDL_NEON_INTRINSICS
+static void ConvertIntsToFloats_NEON(const int *src, float *dst, size_t count)
+{
+    size_t i = 0;
 
-    if (!dstrect) {
-        dst_x0 = 0;
-        dst_y0 = 0;
-        dst_x1 = dst_w;
-        dst_y1 = dst_h;
-    } else {
-        dst_x0 = dstrect->x;
-        dst_y0 = dstrect->y;
-        dst_x1 = dst_x0 + dst_w;
-        dst_y1 = dst_y0 + dst_h;
+    for (; i + 8 <= count; i += 8) {
+        vst1q_f32(&dst[i], vcvtq_f32_s32(vld1q_s32(&src[i])));
+        vst1q_f32(&dst[i + 4], vcvtq_f32_s32(vld1q_s32(&src[i + 4])));
     }
+    ConvertIntsToFloats(&src[i], &dst[i], count - i);
+}
+#endif /* SDL_NEON_INTRINSICS */
 
-    if (!srcrect) {
-        src_x0 = 0;
-        src_y0 = 0;
-        src_x1 = src_w;
-        src_y1 = src_h;
-    } else {
-        src_x0 = srcrect->x;
-        src_y0 = srcrect->y;
-        src_x1 = src_x0 + src_w;
-        src_y1 = src_y0 + src_h;
-
-        /* Clip source rectangle to the source surface */
-
-        if (src_x0 < 0) {
-            dst_x0 -= src_x0 * scaling_w;
-            src_x0 = 0;
-        }
-
-        if (src_x1 > src->w) {
-            dst_x1 -= (src_x1 - src->w) * scaling_w;
-            src_x1 = src->w;
-        }
+/* Get a buffer of at least `size` bytes for converting draw call data for the renderer.
+ * It grows as needed and is kept for the next call, so drawing doesn't allocate every time.
+ * The buffer is only valid until the next call for the same renderer.
+ */
+static void *GetRendererScratch(SDL_Renderer *renderer, size_t size)
+{
+    RendererState *state = GetRendererState(renderer, true);
 
-        if (src_y0 < 0) {
-            dst_y0 -= src_y0 * scaling_h;
-            src_y0 = 0;
+    if (!state) {
+        if (renderer) {
+            SDL3_OutOfMemory();
+        } else {
+            SDL3_InvalidParamError("renderer");
         }
-
-        if (src_y1 > src->h) {
-            dst_y1 -= (src_y1 - src->h) * scaling_h;
-            src_y1 = src->h;
+        return NULL;
+    }
+    if (size > state->scratch_size) {
+        const size_t new_size = SDL_max(size, state->scratch_size * 2);
+        void *scratch = SDL3_realloc(state->scratch, new_size);
+        if (!scratch) {
+            SDL3_OutOfMemory();
+            return NULL;
         }
+        state->scratch = scratch;
+        state->scratch_size = new_size;
     }
+    return state->scratch;
+}
 
-    /* Clip destination rectangle to the clip rectangle */
-
-    /* Translate to clip space for easier calculations */
-    dst_x0 -= dst->clip_rect.x;
-    dst_x1 -= dst->clip_rect.x;
-    dst_y0 -= dst->clip_rect.y;
-    dst_y1 -= dst->clip_rect.y;
+/* SDL_Point and SDL_Rect are just runs of ints, laid out like SDL_FPoint and SDL_FRect are runs of floats.
+ * Convert `count` ints into the renderer's scratch buffer.
+ */
+static float *GetRendererFloats(SDL_Renderer *renderer, const int *values, size_t count)
+{
+    void (*convert)(const int *src, float *dst, size_t count) = ConvertIntsToFloats;
+    float *floats = (float *)GetRendererScratch(renderer, count * sizeof(float));
 
-    if (dst_x0 < 0) {
-        src_x0 -= dst_x0 / scaling_w;
-        dst_x0 = 0;
+    if (!floats) {
+        return NULL;
     }
 
-    if (dst_x1 > dst->clip_rect.w) {
-        src_x1 -= (dst_x1 - dst->clip_rect.w) / scaling_w;
-        dst_x1 = dst->clip_rect.w;
+#ifdef SDL_SSE2_INTRINSICS
+    if (SDL3_HasSSE2()) {
+        convert = ConvertIntsToFloats_SSE2;
     }
-
-    if (dst_y0 < 0) {
-        src_y0 -= dst_y0 / scaling_h;
-        dst_y0 = 0;
+#endif
+#ifdef SDL_AVX2_INTRINSICS
+    if (SDL3_HasAVX2()) {
+        convert = ConvertIntsToFloats_AVX2;
+    }
+#endif
+#ifdef SDL_NEON_INTRINSICS
+    if (SDL3_HasNEON()) {
+        convert = ConvertIntsToFloats_NEON;
     }
+#endif
+    convert(values, floats, count);
+    return floats;
+}
 
-    if (dst_y1 > dst->clip_rect.h) {
-        src_y1 -= (dst_y1 - dst->clip_rect.h) / scaling_h;
-        dst_y1 = dst->clip_rect.h;
+static int FlushRendererIfNotBatching(SDL_Renderer *renderer)
+{
+    const RendererState *state = GetRendererState(renderer, false);
+    if (!state || !state->batching) {
+        return SDL3_FlushRenderer(renderer) ? 0 : -1;
     }
+    return 0;
+}
 
-    /* Translate back to surface coordinates */
-    dst_x0 += dst->clip_rect.x;
-    dst_x1 += dst->clip_rect.x;
-    dst_y0 += dst->clip_rect.y;
-    dst_y1 += dst->clip_rect.y;
+/* Sprites are queued as quads, drawn as two triangles: top left, top right, bottom right, bottom left. */
+#define MAX_QUEUED_SPRITES 8192
 
-    final_src.x = (int)SDL_round(src_x0);
-    final_src.y = (int)SDL_round(src_y0);
-    final_src.w = (int)SDL_round(src_x1 - src_x0);
-    final_src.h = (int)SDL_round(src_y1 - src_y0);
+/* Fill in the 4 vertices that draw `srcrect` of a texture of `tex_w` by `tex_h` into `dstrect`,
+ * like SDL3_RenderTextureRotated(), so the software renderer can still turn unrotated quads back into copies.
+ */
+static void MakeSpriteVertices(SDL_Vertex *vertices, float tex_w, float tex_h, const SDL_FRect *srcrect,
+                               const SDL_FRect *dstrect, double angle, SDL_FlipMode flip, const SDL_FColor *color)
+{
+    float minu = srcrect->x / tex_w;
+    float maxu = (srcrect->x + srcrect->w) / tex_w;
+    float minv = srcrect->y / tex_h;
+    float maxv = (srcrect->y + srcrect->h) / tex_h;
+    float tmp;
+    int i;
 
-    final_dst.x = (int)SDL_round(dst_x0);
-    final_dst.y = (int)SDL_round(dst_y0);
-    final_dst.w = (int)SDL_round(dst_x1 - dst_x0);
-    final_dst.h = (int)SDL_round(dst_y1 - dst_y0);
+    if (flip & SDL_FLIP_HORIZONTAL) {
+        tmp = minu;
+        minu = maxu;
+        maxu = tmp;
+    }
+    if (flip & SDL_FLIP_VERTICAL) {
+        tmp = minv;
+        minv = maxv;
+        maxv = tmp;
+    }
+
+    vertices[0].tex_coord.x = minu;
+    vertices[0].tex_coord.y = minv;
+    vertices[1].tex_coord.x = maxu;
+    vertices[1].tex_coord.y = minv;
+    vertices[2].tex_coord.x = maxu;
+    vertices[2].tex_coord.y = maxv;
+    vertices[3].tex_coord.x = minu;
+    vertices[3].tex_coord.y = maxv;
+
+    if (angle == 0.0) {
+        vertices[0].position.x = dstrect->x;
+        vertices[0].position.y = dstrect->y;
+        vertices[1].position.x = dstrect->x + dstrect->w;
+        vertices[1].position.y = dstrect->y;
+        vertices[2].position.x = dstrect->x + dstrect->w;
+        vertices[2].position.y = dstrect->y + dstrect->h;
+        vertices[3].position.x = dstrect->x;
+        vertices[3].position.y = dstrect->y + dstrect->h;
+    } else {
+        const float radians = (float)(angle * (SDL_PI_D / 180.0));
+        const float s = SDL3_sinf(radians);
+        const float c = SDL3_cosf(radians);
+        const float cx = dstrect->w / 2.0f;
+        const float cy = dstrect->h / 2.0f;
+        const float centerx = dstrect->x + cx;
+        const float centery = dstrect->y + cy;
+        const float minx = -cx, maxx = dstrect->w - cx;
+        const float miny = -cy, maxy = dstrect->h - cy;
 
-    /* Clip again */
-    {
-        SDL_Rect tmp;
-        tmp.x = 0;
-        tmp.y = 0;
-        tmp.w = src->w;
-        tmp.h = src->h;
-        SDL3_GetRectIntersection(&tmp, &final_src, &final_src);
+        vertices[0].position.x = c * minx - s * miny + centerx;
+        vertices[0].position.y = s * minx + c * miny + centery;
+        vertices[1].position.x = c * maxx - s * miny + centerx;
+        vertices[1].position.y = s * maxx + c * miny + centery;
+        vertices[2].position.x = c * maxx - s * maxy + centerx;
+        vertices[2].position.y = s * maxx + c * maxy + centery;
+        vertices[3].position.x = c * minx - s * maxy + centerx;
+        vertices[3].position.y = s * minx + c * maxy + centery;
     }
 
-    /* Clip again */
-    SDL3_GetRectIntersection(&dst->clip_rect, &final_dst, &final_dst);
-
-    if (dstrect) {
-        *dstrect = final_dst;
+    for (i = 0; i < 4; ++i) {
+        vertices[i].color = *color;
     }
+}
 
-    if (final_dst.w == 0 || final_dst.h == 0 ||
-        final_src.w <= 0 || final_src.h <= 0) {
-        /* No-op. */
+/* Draw the queued sprites, all with the same texture, in one geometry call */
+static int FlushQueuedSprites(RendererState *state)
+{
+    const SDL_Vertex *vertices = state->sprite_vertices;
+    SDL_Texture *texture = state->sprite_texture;
+    const int count = state->num_sprites;
+
+    state->sprite_texture = NULL;
+    state->num_sprites = 0;
+    if (count == 0) {
         return 0;
     }
-
-    return SDL_LowerBlitScaled(src, &final_src, dst, &final_dst);
+    return SDL3_RenderGeometryRaw(state->renderer, texture,
+                                  &vertices->position.x, sizeof(SDL_Vertex),
+                                  &vertices->color, sizeof(SDL_Vertex),
+                                  &vertices->tex_coord.x, sizeof(SDL_Vertex),
+                                  count * 4, state->sprite_indices, count * 6, sizeof(int)) ? 0 : -1;
 }
 
-SDL_DECLSPEC int SDLCALL
-SDL_LowerBlitScaled(SDL2_Surface *src2, SDL_Rect *srcrect, SDL2_Surface *dst2, SDL_Rect *dstrect)
+/* Get room for one more sprite with `texture`, drawing the ones already queued if they use another texture.
+ * Returns the 4 vertices to fill in, or NULL on error.
+ */
+static SDL_Vertex *QueueSprite(RendererState *state, SDL_Texture *texture)
 {
-    SDL_Surface *src = Surface2to3(src2);
-    SDL_Surface *dst = Surface2to3(dst2);
-    int result = SDL3_BlitSurfaceUncheckedScaled(src, srcrect, dst, dstrect, SDL_SCALEMODE_NEAREST) ? 0 : -1;
-    SynchronizeSurface3to2(src, src2);
-    return result;
-}
+    if (state->num_sprites > 0 && (state->sprite_texture != texture || state->num_sprites == MAX_QUEUED_SPRITES)) {
+        if (FlushQueuedSprites(state) < 0) {
+            return NULL;
+        }
+    }
 
-SDL_DECLSPEC int SDLCALL
-SDL_SoftStretch(SDL2_Surface *src, const SDL_Rect *srcrect, SDL2_Surface *dst, const SDL_Rect *dstrect)
-{
-    return SDL3_StretchSurface(Surface2to3(src), srcrect, Surface2to3(dst), dstrect, SDL_SCALEMODE_NEAREST) ? 0 : -1;
-}
+    if (state->num_sprites == state->max_sprites) {
+        const int max_sprites = SDL_min(SDL_max(state->max_sprites * 2, 64), MAX_QUEUED_SPRITES);
+        SDL_Vertex *vertices;
+        int *indices;
+        int i;
 
-SDL_DECLSPEC int SDLCALL
-SDL_SoftStretchLinear(SDL2_Surface *src, const SDL_Rect *srcrect, SDL2_Surface *dst, const SDL_Rect *dstrect)
-{
-    return SDL3_StretchSurface(Surface2to3(src), srcrect, Surface2to3(dst), dstrect, SDL_SCALEMODE_LINEAR) ? 0 : -1;
-}
+        vertices = (SDL_Vertex *)SDL3_realloc(state->sprite_vertices, (size_t)max_sprites * 4 * sizeof(SDL_Vertex));
+        if (!vertices) {
+            SDL3_OutOfMemory();
+            return NULL;
+        }
+        state->sprite_vertices = vertices;
 
-/* SDL_GetTicks is 64-bit in SDL3. Clamp it for SDL2. */
-SDL_DECLSPEC Uint32 SDLCALL
-SDL_GetTicks(void)
-{
-    return (Uint32)SDL3_GetTicks();
-}
+        indices = (int *)SDL3_realloc(state->sprite_indices, (size_t)max_sprites * 6 * sizeof(int));
+        if (!indices) {
+            SDL3_OutOfMemory();
+            return NULL;
+        }
+        state->sprite_indices = indices;
+
+        /* The indices never change, so they're only written when the buffer grows */
+        for (i = state->max_sprites; i < max_sprites; ++i) {
+            indices[i * 6 + 0] = i * 4 + 0;
+            indices[i * 6 + 1] = i * 4 + 1;
+            indices[i * 6 + 2] = i * 4 + 2;
+            indices[i * 6 + 3] = i * 4 + 0;
+            indices[i * 6 + 4] = i * 4 + 2;
+            indices[i * 6 + 5] = i * 4 + 3;
+        }
+        state->max_sprites = max_sprites;
+    }
 
-/* SDL_GetTicks64 is gone in SDL3 because SDL_GetTicks is 64-bit. */
-SDL_DECLSPEC Uint64 SDLCALL
-SDL_GetTicks64(void)
-{
-    return SDL3_GetTicks();
+    state->sprite_texture = texture;
+    return &state->sprite_vertices[state->num_sprites++ * 4];
 }
 
-SDL_DECLSPEC SDL2_bool SDLCALL SDL_GetWindowWMInfo(SDL_Window *window, SDL2_SysWMinfo *info)
+/* Draw any copies that SDL_RenderCopy() queued up for the renderer. This has to be done before anything
+ * else is drawn, and before any state that the queued copies depend on changes.
+ */
+static int FlushRendererSprites(SDL_Renderer *renderer)
 {
-    const char *driver = SDL3_GetCurrentVideoDriver();
-    SDL_PropertiesID props;
+    RendererState *state;
 
-    if (!driver) {
-        return SDL2_FALSE;
-    }
-    if (!window) {
-        SDL3_InvalidParamError("window");
-        return SDL2_FALSE;
+    if (SDL3_GetAtomicInt(&NumMergingRenderers) == 0) {
+        return 0;
     }
-    if (!info) {
-        SDL3_InvalidParamError("info");
-        return SDL2_FALSE;
+    state = GetRendererState(renderer, false);
+    if (!state || state->num_sprites == 0) {
+        return 0;
     }
+    return FlushQueuedSprites(state);
+}
 
-    props = SDL3_GetWindowProperties(window);
-
-    if (SDL3_strcmp(driver, "android") == 0) {
-        info->subsystem = SDL2_SYSWM_ANDROID;
-        info->info.android.window = SDL3_GetPointerProperty(props, SDL_PROP_WINDOW_ANDROID_WINDOW_POINTER, NULL);
-        info->info.android.surface = SDL3_GetPointerProperty(props, SDL_PROP_WINDOW_ANDROID_SURFACE_POINTER, NULL);
-    } else if (SDL3_strcmp(driver, "cocoa") == 0) {
-        info->subsystem = SDL2_SYSWM_COCOA;
-        info->info.cocoa.window = (NSWindow *)SDL3_GetPointerProperty(props, SDL_PROP_WINDOW_COCOA_WINDOW_POINTER, NULL);
-    } else if (SDL3_strcmp(driver, "kmsdrm") == 0) {
-        info->subsystem = SDL2_SYSWM_KMSDRM;
-        info->info.kmsdrm.dev_index = (int)SDL3_GetNumberProperty(props, SDL_PROP_WINDOW_KMSDRM_DEVICE_INDEX_NUMBER, 0);
-        info->info.kmsdrm.drm_fd = (int)SDL3_GetNumberProperty(props, SDL_PROP_WINDOW_KMSDRM_DRM_FD_NUMBER, -1);
-        info->info.kmsdrm.gbm_dev = SDL3_GetPointerProperty(props, SDL_PROP_WINDOW_KMSDRM_GBM_DEVICE_POINTER, NULL);
-    } else if (SDL3_strcmp(driver, "uikit") == 0) {
-        info->subsystem = SDL2_SYSWM_UIKIT;
-        info->info.uikit.window = (UIWindow *)SDL3_GetPointerProperty(props, SDL_PROP_WINDOW_UIKIT_WINDOW_POINTER, NULL);
-        info->info.uikit.colorbuffer = 0;
-        info->info.uikit.framebuffer = 0;
-        info->info.uikit.resolveFramebuffer = 0;
-    } else if (SDL3_strcmp(driver, "vivante") == 0) {
-        info->subsystem = SDL2_SYSWM_VIVANTE;
-        info->info.vivante.display = SDL3_GetPointerProperty(props, SDL_PROP_WINDOW_VIVANTE_DISPLAY_POINTER, NULL);
-        info->info.vivante.window = SDL3_GetPointerProperty(props, SDL_PROP_WINDOW_VIVANTE_WINDOW_POINTER, NULL);
-    } else if (SDL3_strcmp(driver, "wayland") == 0) {
-        Uint32 version2 = SDL_VERSIONNUM((Uint32)info->version.major,
-                                         (Uint32)info->version.minor,
-                                         (Uint32)info->version.patch);
-
-        /* Before 2.0.6, it was possible to build an SDL with Wayland support
-         * (SDL2_SysWMinfo will be large enough to hold Wayland info), but build
-         * your app against SDL headers that didn't have Wayland support
-         * (SDL2_SysWMinfo could be smaller than Wayland needs). This would lead
-         * to an app properly using SDL_GetWindowWMInfo() but we'd accidentally
-         * overflow memory on the stack or heap. To protect against this, we've
-         * padded out the struct unconditionally in the headers and Wayland will
-         * just return an error for older apps using this function. Those apps
-         * will need to be recompiled against newer headers or not use Wayland,
-         * maybe by forcing SDL_VIDEODRIVER=x11.
-         */
-        if (version2 < SDL_VERSIONNUM(2, 0, 6)) {
-            info->subsystem = SDL2_SYSWM_UNKNOWN;
-            SDL3_SetError("Version must be 2.0.6 or newer");
-            return SDL2_FALSE;
-        }
-
-        info->subsystem = SDL2_SYSWM_WAYLAND;
-        info->info.wl.display = SDL3_GetPointerProperty(props, SDL_PROP_WINDOW_WAYLAND_DISPLAY_POINTER, NULL);
-        info->info.wl.surface = SDL3_GetPointerProperty(props, SDL_PROP_WINDOW_WAYLAND_SURFACE_POINTER, NULL);
-        info->info.wl.shell_surface = NULL; /* Deprecated */
-
-        if (version2 >= SDL_VERSIONNUM(2, 0, 15)) {
-            info->info.wl.egl_window = SDL3_GetPointerProperty(props, SDL_PROP_WINDOW_WAYLAND_EGL_WINDOW_POINTER, NULL);
-            info->info.wl.xdg_surface = SDL3_GetPointerProperty(props, SDL_PROP_WINDOW_WAYLAND_XDG_SURFACE_POINTER, NULL);
-            if (version2 >= SDL_VERSIONNUM(2, 0, 17)) {
-                info->info.wl.xdg_toplevel = SDL3_GetPointerProperty(props, SDL_PROP_WINDOW_WAYLAND_XDG_TOPLEVEL_POINTER, NULL);
-                if (version2 >= SDL_VERSIONNUM(2, 0, 22)) {
-                    info->info.wl.xdg_popup = SDL3_GetPointerProperty(props, SDL_PROP_WINDOW_WAYLAND_XDG_POPUP_POINTER, NULL);
-                    info->info.wl.xdg_positioner = SDL3_GetPointerProperty(props, SDL_PROP_WINDOW_WAYLAND_XDG_POSITIONER_POINTER, NULL);
-                }
-            }
-        }
-    } else if (SDL3_strcmp(driver, "windows") == 0) {
-
-        Uint32 version2 = SDL_VERSIONNUM((Uint32)info->version.major,
-            (Uint32)info->version.minor,
-            (Uint32)info->version.patch);
+/* Draw any queued copies that use the texture, before it's changed or destroyed */
+static int FlushTextureSprites(SDL_Texture *texture)
+{
+    RendererState *state;
 
-        info->subsystem = SDL2_SYSWM_WINDOWS;
-        info->info.win.window = SDL3_GetPointerProperty(props, SDL_PROP_WINDOW_WIN32_HWND_POINTER, NULL);
-        if (version2 >= SDL_VERSIONNUM(2, 0, 4)) {
-            info->info.win.hdc = SDL3_GetPointerProperty(props, SDL_PROP_WINDOW_WIN32_HDC_POINTER, NULL);
-        }
-        if (version2 >= SDL_VERSIONNUM(2, 0, 5)) {
-            info->info.win.hinstance = SDL3_GetPointerProperty(props, SDL_PROP_WINDOW_WIN32_INSTANCE_POINTER, NULL);
-        }
-    } else if (SDL3_strcmp(driver, "x11") == 0) {
-        info->subsystem = SDL2_SYSWM_X11;
-        info->info.x11.display = SDL3_GetPointerProperty(props, SDL_PROP_WINDOW_X11_DISPLAY_POINTER, NULL);
-        info->info.x11.window = (unsigned long)SDL3_GetNumberProperty(props, SDL_PROP_WINDOW_X11_WINDOW_NUMBER, 0);
-    } else {
-        SDL3_SetError("Video driver '%s' has no mapping to SDL_SysWMinfo", driver);
-        info->subsystem = SDL2_SYSWM_UNKNOWN;
-        return SDL2_FALSE;
+    if (SDL3_GetAtomicInt(&NumMergingRenderers) == 0) {
+        return 0;
+    }
+    state = GetRendererState(SDL3_GetRendererFromTexture(texture), false);
+    if (!state || state->num_sprites == 0 || state->sprite_texture != texture) {
+        return 0;
     }
-
-    return SDL2_TRUE;
+    return FlushQueuedSprites(state);
 }
 
+/* Render traces, see SDL_CompatStartRenderRecording(). A trace is a RenderTraceHeader followed by
+ * one RenderTraceRecord per call, each followed by `size` bytes: the call's fixed size arguments
+ * and then its variable size data, like points or pixels. Everything is in native byte order and layout.
+ *
+ * Renderers and textures are defined by their own records the first time a call uses them, and the
+ * renderer's view and draw state is written whenever it changed since the last traced call.
+ */
+#define RENDER_TRACE_MAGIC "SDL2RNTR"
+#define RENDER_TRACE_VERSION 2
+#define RENDER_TRACE_MAX_RECORD_SIZE (256 * 1024 * 1024)
+#define RENDER_TRACE_MAX_TEXTURES (1024 * 1024)  /* texture IDs in a trace are below this */
+
+#define PROP_TEXTURE_TRACE_ID "sdl2-compat.texture.trace_id"
+#define PROP_TEXTURE_TRACE_LOCK "sdl2-compat.texture.trace_lock"
+
+typedef enum RenderTraceCall
+{
+    RENDER_TRACE_RENDERER = 1,      /* RenderTraceRenderer */
+    RENDER_TRACE_STATE,             /* RenderTraceState */
+    RENDER_TRACE_TEXTURE,           /* RenderTraceTexture */
+    RENDER_TRACE_DESTROY_TEXTURE,
+    RENDER_TRACE_CREATE_TEXTURE_FROM_SURFACE,  /* RenderTraceUpdate, then the pixels */
+    RENDER_TRACE_UPDATE_TEXTURE,    /* RenderTraceUpdate, then the pixels */
+    RENDER_TRACE_UPDATE_YUV_TEXTURE,  /* RenderTraceUpdate, then the Y, U and V planes */
+    RENDER_TRACE_UPDATE_NV_TEXTURE, /* RenderTraceUpdate, then the Y and UV planes */
+    RENDER_TRACE_UNLOCK_TEXTURE,    /* RenderTraceUpdate, then the pixels that were locked */
+    RENDER_TRACE_SET_RENDER_TARGET,
+    RENDER_TRACE_CLEAR,
+    RENDER_TRACE_COPY,              /* RenderTraceCopy */
+    RENDER_TRACE_COPY_F,
+    RENDER_TRACE_COPY_EX,
+    RENDER_TRACE_COPY_EX_F,
+    RENDER_TRACE_RENDER_SPRITES,    /* RenderTraceCount, then that many RenderTraceSprite */
+    RENDER_TRACE_DRAW_POINT,        /* RenderTraceCount, then the points, lines or rects */
+    RENDER_TRACE_DRAW_POINTS,
+    RENDER_TRACE_DRAW_POINT_F,
+    RENDER_TRACE_DRAW_POINTS_F,
+    RENDER_TRACE_DRAW_LINE,
+    RENDER_TRACE_DRAW_LINES,
+    RENDER_TRACE_DRAW_LINE_F,
+    RENDER_TRACE_DRAW_LINES_F,
+    RENDER_TRACE_DRAW_RECT,
+    RENDER_TRACE_DRAW_RECTS,
+    RENDER_TRACE_DRAW_RECT_F,
+    RENDER_TRACE_DRAW_RECTS_F,
+    RENDER_TRACE_FILL_RECT,
+    RENDER_TRACE_FILL_RECTS,
+    RENDER_TRACE_FILL_RECT_F,
+    RENDER_TRACE_FILL_RECTS_F,
+    RENDER_TRACE_GEOMETRY,          /* RenderTraceGeometry, then positions, colors, texture coordinates and indices */
+    RENDER_TRACE_GEOMETRY_RAW,
+    RENDER_TRACE_READ_PIXELS,       /* RenderTraceReadPixels */
+    RENDER_TRACE_PRESENT,
+    RENDER_TRACE_NUM_CALLS
+} RenderTraceCall;
+
+/* The SDL2 function for each call, NULL for the records that don't stand for one */
+static const char *RenderTraceCallNames[RENDER_TRACE_NUM_CALLS] = {
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    "SDL_CreateTextureFromSurface",
+    "SDL_UpdateTexture",
+    "SDL_UpdateYUVTexture",
+    "SDL_UpdateNVTexture",
+    "SDL_UnlockTexture",
+    "SDL_SetRenderTarget",
+    "SDL_RenderClear",
+    "SDL_RenderCopy",
+    "SDL_RenderCopyF",
+    "SDL_RenderCopyEx",
+    "SDL_RenderCopyExF",
+    "SDL_CompatRenderSprites",
+    "SDL_RenderDrawPoint",
+    "SDL_RenderDrawPoints",
+    "SDL_RenderDrawPointF",
+    "SDL_RenderDrawPointsF",
+    "SDL_RenderDrawLine",
+    "SDL_RenderDrawLines",
+    "SDL_RenderDrawLineF",
+    "SDL_RenderDrawLinesF",
+    "SDL_RenderDrawRect",
+    "SDL_RenderDrawRects",
+    "SDL_RenderDrawRectF",
+    "SDL_RenderDrawRectsF",
+    "SDL_RenderFillRect",
+    "SDL_RenderFillRects",
+    "SDL_RenderFillRectF",
+    "SDL_RenderFillRectsF",
+    "SDL_RenderGeometry",
+    "SDL_RenderGeometryRaw",
+    "SDL_RenderReadPixels",
+    "SDL_RenderPresent"
+};
+
+/* RenderTraceRecord flags */
+#define RENDER_TRACE_HAS_SRCRECT  0x01
+#define RENDER_TRACE_HAS_DSTRECT  0x02
+#define RENDER_TRACE_HAS_CENTER   0x04
+#define RENDER_TRACE_HAS_RECT     0x08
+#define RENDER_TRACE_HAS_DATA     0x10
+#define RENDER_TRACE_HAS_UV       0x20
+#define RENDER_TRACE_HAS_INDICES  0x40
 
-SDL_DECLSPEC int SDLCALL
-SDL_GameControllerSetSensorEnabled(SDL_GameController *gamecontroller, SDL_SensorType type, SDL2_bool enabled)
+typedef struct RenderTraceHeader
+{
+    char magic[8];
+    Uint32 version;
+    Uint32 record_size;
+} RenderTraceHeader;
+
+typedef struct RenderTraceRecord
+{
+    Uint16 call;          /* RenderTraceCall */
+    Uint16 flags;         /* RENDER_TRACE_HAS_* */
+    Uint32 size;          /* bytes of arguments and data after this record */
+    Uint32 texture;       /* trace ID of the texture the call uses, or 0 */
+    Uint32 padding;
+    Uint64 duration_ns;   /* time spent in the call */
+} RenderTraceRecord;
+
+typedef struct RenderTraceRenderer
 {
-    return SDL3_SetGamepadSensorEnabled(gamecontroller, type, enabled) ? 0 : -1;
-}
+    Sint32 w, h;          /* output size */
+    Uint8 batching;
+    Uint8 merge_copies;
+    Uint8 padding[2];
+} RenderTraceRenderer;
 
-SDL_DECLSPEC int SDLCALL
-SDL_GameControllerGetSensorDataWithTimestamp(SDL_GameController *gamecontroller, SDL_SensorType type, Uint64 *timestamp, float *data, int num_values)
+typedef struct RenderTraceTexture
 {
-    if (!SDL3_GetGamepadSensorData(gamecontroller, type, data, num_values)) {
-        return -1;
-    }
+    Uint32 format;
+    Sint32 access;
+    Sint32 w, h;
+} RenderTraceTexture;
 
-    *timestamp = SDL3_GetNumberProperty(SDL3_GetGamepadProperties(gamecontroller), GetGamepadSensorTimestampPropertyName(type), 0);
-    return 0;
-}
+typedef struct RenderTraceTextureState
+{
+    Uint8 color[4];       /* color and alpha mod */
+    Sint32 blend_mode;
+    Sint32 scale_mode;
+} RenderTraceTextureState;
 
-SDL_DECLSPEC int SDLCALL
-SDL_SensorGetDataWithTimestamp(SDL_Sensor *sensor, Uint64 *timestamp, float *data, int num_values)
+typedef struct RenderTraceUpdate
 {
-    if (!SDL3_GetSensorData(sensor, data, num_values)) {
-        return -1;
-    }
+    SDL_Rect rect;        /* with RENDER_TRACE_HAS_RECT */
+    Sint32 pitch;         /* of the pixels in the trace, or of their Y plane, which are only there with RENDER_TRACE_HAS_DATA */
+    Sint32 rows;
+} RenderTraceUpdate;
 
-    *timestamp = SDL3_GetNumberProperty(SDL3_GetSensorProperties(sensor), SDL_PROP_SENSOR_TIMESTAMP, 0);
-    return 0;
-}
+typedef struct RenderTraceCopy
+{
+    double angle;
+    RenderTraceTextureState texture_state;
+    SDL_Rect srcrect;     /* with RENDER_TRACE_HAS_SRCRECT */
+    SDL_FRect dstrect;    /* with RENDER_TRACE_HAS_DSTRECT */
+    SDL_FPoint center;    /* with RENDER_TRACE_HAS_CENTER */
+    Sint32 flip;
+    Sint32 padding;
+} RenderTraceCopy;
 
-SDL_DECLSPEC int SDLCALL
-SDL_GetNumTouchDevices(void)
+typedef struct RenderTraceSprite
 {
-    SDL3_free(TouchDevices);
-    TouchDevices = SDL3_GetTouchDevices(&NumTouchDevices);
-    return NumTouchDevices;
+    double angle;
+    RenderTraceTextureState texture_state;
+    SDL_Rect srcrect;
+    SDL_FRect dstrect;
+    Uint32 texture;       /* trace ID */
+    Sint32 flip;
+    Uint8 color[4];
+} RenderTraceSprite;
+
+typedef struct RenderTraceCount
+{
+    Sint32 count;         /* the call's count, the data has that many items with RENDER_TRACE_HAS_DATA */
+} RenderTraceCount;
+
+typedef struct RenderTraceGeometry
+{
+    RenderTraceTextureState texture_state;
+    Sint32 num_vertices;  /* the data has this many vertices with RENDER_TRACE_HAS_DATA */
+    Sint32 num_indices;   /* ints, with RENDER_TRACE_HAS_INDICES */
+} RenderTraceGeometry;
+
+typedef struct RenderTraceReadPixels
+{
+    SDL_Rect rect;        /* with RENDER_TRACE_HAS_RECT */
+    Uint32 format;
+} RenderTraceReadPixels;
+
+typedef struct RenderTrace
+{
+    Uint64 start_ns;
+    Uint32 texture;
+} RenderTrace;
+
+/* Where a texture was locked while recording, so SDL_UnlockTexture() can trace what was written there */
+typedef struct TextureTraceLock
+{
+    Uint32 generation;    /* RenderTraceGeneration when it was locked */
+    bool locked;
+    bool has_rect;
+    SDL_Rect rect;
+    void *pixels;
+    int pitch;
+} TextureTraceLock;
+
+static SDL_IOStream *RenderTraceStream = NULL;  /* only changed with RenderTraceLock held. */
+static Uint32 RenderTraceGeneration = 0;        /* changes with each recording, so old trace IDs aren't used */
+static Uint32 RenderTraceNextTexture = 1;
+static SDL_Renderer *RenderTraceLastRenderer = NULL;  /* the renderer of the last STATE record */
+static int RenderTraceDepth = 0;                /* so calls made by other traced calls aren't traced, rendering is single threaded */
+static void *RenderTraceScratch = NULL;
+static size_t RenderTraceScratchSize = 0;
+
+static void WriteRenderTrace(RenderTraceCall call, Uint16 flags, Uint32 texture, Uint64 duration_ns,
+                             const void *args, size_t args_size, const void *data, size_t data_size)
+{
+    RenderTraceRecord record;
+
+    if (!RenderTraceStream) {
+        return;
+    }
+
+    SDL3_zero(record);
+    record.call = (Uint16)call;
+    record.flags = flags;
+    record.size = (Uint32)(args_size + data_size);
+    record.texture = texture;
+    record.duration_ns = duration_ns;
+    if (SDL3_WriteIO(RenderTraceStream, &record, sizeof (record)) != sizeof (record) ||
+        (args_size && SDL3_WriteIO(RenderTraceStream, args, args_size) != args_size) ||
+        (data_size && SDL3_WriteIO(RenderTraceStream, data, data_size) != data_size)) {
+        SDL3_CloseIO(RenderTraceStream);  /* disk full or something, give up instead of writing a truncated trace. */
+        RenderTraceStream = NULL;
+    }
 }
 
-SDL_DECLSPEC SDL_TouchID SDLCALL
-SDL_GetTouchDevice(int idx)
+/* Get the trace ID of a texture, defining it in the trace if this is the first time it's used. Call with RenderTraceLock held. */
+static Uint32 GetTextureTraceID(SDL_Texture *texture)
 {
-    if ((idx < 0) || (idx >= NumTouchDevices)) {
-        SDL3_SetError("Unknown touch device index %d", idx);
+    SDL_PropertiesID props;
+    RenderTraceTexture define;
+    Sint64 value;
+    Uint32 id;
+
+    props = SDL3_GetTextureProperties(texture);
+    if (!props) {
         return 0;
     }
-    return TouchDevices[idx];
+    value = SDL3_GetNumberProperty(props, PROP_TEXTURE_TRACE_ID, 0);
+    if ((Uint32)(value >> 32) == RenderTraceGeneration && (Uint32)value != 0) {
+        return (Uint32)value;
+    }
+
+    /* A replay would reject the trace as corrupt, so calls with any more textures are traced without theirs */
+    if (RenderTraceNextTexture >= RENDER_TRACE_MAX_TEXTURES) {
+        return 0;
+    }
+    id = RenderTraceNextTexture++;
+    SDL3_SetNumberProperty(props, PROP_TEXTURE_TRACE_ID, ((Sint64)RenderTraceGeneration << 32) | id);
+
+    SDL3_zero(define);
+    define.format = (Uint32)SDL3_GetNumberProperty(props, SDL_PROP_TEXTURE_FORMAT_NUMBER, SDL_PIXELFORMAT_UNKNOWN);
+    define.access = (Sint32)SDL3_GetNumberProperty(props, SDL_PROP_TEXTURE_ACCESS_NUMBER, SDL_TEXTUREACCESS_STATIC);
+    define.w = (Sint32)SDL3_GetNumberProperty(props, SDL_PROP_TEXTURE_WIDTH_NUMBER, 0);
+    define.h = (Sint32)SDL3_GetNumberProperty(props, SDL_PROP_TEXTURE_HEIGHT_NUMBER, 0);
+    WriteRenderTrace(RENDER_TRACE_TEXTURE, 0, id, 0, &define, sizeof (define), NULL, 0);
+    return id;
 }
 
-SDL_DECLSPEC const char* SDLCALL
-SDL_GetTouchName(int idx)
+/* Write the renderer's definition if it's new to this trace, and its state if that changed. Call with RenderTraceLock held. */
+static void TraceRendererState(SDL_Renderer *renderer)
 {
-    SDL_TouchID tid = SDL_GetTouchDevice(idx);
-    return tid ? SDL3_GetTouchDeviceName(tid) : NULL;
+    RendererState *state = GetRendererState(renderer, true);
+    RenderTraceState current;
+    SDL_RendererLogicalPresentation mode = SDL_LOGICAL_PRESENTATION_DISABLED;
+    SDL_BlendMode blend_mode = SDL_BLENDMODE_NONE;
+    int w = 0, h = 0;
+
+    if (!state) {
+        return;
+    }
+
+    if (state->trace_generation != RenderTraceGeneration) {
+        RenderTraceRenderer define;
+
+        SDL3_GetRenderOutputSize(renderer, &w, &h);
+        SDL3_zero(define);
+        define.w = w;
+        define.h = h;
+        define.batching = state->batching ? 1 : 0;
+        define.merge_copies = state->merge_copies ? 1 : 0;
+        WriteRenderTrace(RENDER_TRACE_RENDERER, 0, 0, 0, &define, sizeof (define), NULL, 0);
+        state->trace_generation = RenderTraceGeneration;
+    }
+
+    SDL3_zero(current);
+    SDL3_GetRenderLogicalPresentation(renderer, &w, &h, &mode);
+    current.logical_w = w;
+    current.logical_h = h;
+    current.logical_mode = (Sint32)mode;
+    SDL3_GetRenderScale(renderer, &current.scale_x, &current.scale_y);
+    SDL3_GetRenderViewport(renderer, &current.viewport);
+    if (SDL3_RenderClipEnabled(renderer)) {
+        SDL3_GetRenderClipRect(renderer, &current.clip);
+    }
+    SDL3_GetRenderDrawColor(renderer, &current.draw_color[0], &current.draw_color[1], &current.draw_color[2], &current.draw_color[3]);
+    SDL3_GetRenderDrawBlendMode(renderer, &blend_mode);
+    current.draw_blend_mode = (Sint32)blend_mode;
+
+    /* A replay draws everything with one renderer, so switching renderers needs the state too */
+    if (renderer != RenderTraceLastRenderer || SDL3_memcmp(&current, &state->trace_state, sizeof (current)) != 0) {
+        WriteRenderTrace(RENDER_TRACE_STATE, 0, 0, 0, &current, sizeof (current), NULL, 0);
+        state->trace_state = current;
+        RenderTraceLastRenderer = renderer;
+    }
 }
 
-SDL_DECLSPEC int SDLCALL
-SDL_GetNumTouchFingers(SDL_TouchID touchID)
+static void GetTextureTraceState(SDL_Texture *texture, RenderTraceTextureState *texture_state)
 {
-    SDL3_free(TouchFingers);
-    TouchFingersDeviceID = touchID;
-    TouchFingers = SDL3_GetTouchFingers(touchID, &NumTouchFingers);
-    return NumTouchFingers;
+    SDL_BlendMode blend_mode = SDL_BLENDMODE_NONE;
+    SDL_ScaleMode scale_mode = SDL_SCALEMODE_LINEAR;
+
+    SDL3_zerop(texture_state);
+    if (!texture) {
+        return;
+    }
+    SDL3_GetTextureColorMod(texture, &texture_state->color[0], &texture_state->color[1], &texture_state->color[2]);
+    SDL3_GetTextureAlphaMod(texture, &texture_state->color[3]);
+    SDL3_GetTextureBlendMode(texture, &blend_mode);
+    SDL3_GetTextureScaleMode(texture, &scale_mode);
+    texture_state->blend_mode = (Sint32)blend_mode;
+    texture_state->scale_mode = (Sint32)scale_mode;
 }
 
-SDL_DECLSPEC SDL_Finger * SDLCALL
-SDL_GetTouchFinger(SDL_TouchID touchID, int idx)
+/* Returns true if the call should be traced, and then EndRenderTrace() has to be called after it. */
+static bool BeginRenderTrace(RenderTrace *trace, SDL_Renderer *renderer, SDL_Texture *texture)
 {
-    if (touchID != TouchFingersDeviceID) {
-        SDL_GetNumTouchFingers(touchID);
+    if (!SDL3_GetAtomicPointer((void **)&RenderTraceStream) || RenderTraceDepth > 0) {
+        return false;
     }
-    if ((idx < 0) || (idx >= NumTouchFingers)) {
-        SDL3_SetError("Unknown touch finger");
-        return NULL;
+    ++RenderTraceDepth;
+
+    trace->texture = 0;
+    SDL3_LockMutex(RenderTraceLock);
+    if (RenderTraceStream) {
+        TraceRendererState(renderer);
+        if (texture) {
+            trace->texture = GetTextureTraceID(texture);
+        }
     }
-    return TouchFingers[idx];
+    SDL3_UnlockMutex(RenderTraceLock);
+
+    trace->start_ns = SDL3_GetTicksNS();
+    return true;
 }
 
-/* Touch gestures were removed from SDL3, so this is the SDL2 implementation copied in here, and tweaked a little. */
+/* `end_ns` is when the call returned, so gathering its data for the trace doesn't count as part of it */
+static void EndRenderTrace(const RenderTrace *trace, Uint64 end_ns, RenderTraceCall call, Uint16 flags,
+                           const void *args, size_t args_size, const void *data, size_t data_size)
+{
+    /* A replay would reject the record as corrupt, so leave out data that's too big for it */
+    if (args_size + data_size > RENDER_TRACE_MAX_RECORD_SIZE) {
+        flags &= ~RENDER_TRACE_HAS_DATA;
+        data_size = 0;
+    }
 
-#define GESTURE_MAX_DOLLAR_PATH_SIZE 1024
-#define GESTURE_DOLLARNPOINTS 64
-#define GESTURE_DOLLARSIZE 256
-#define GESTURE_PHI        0.618033989
+    SDL3_LockMutex(RenderTraceLock);
+    WriteRenderTrace(call, flags, trace->texture, end_ns - trace->start_ns, args, args_size, data, data_size);
+    SDL3_UnlockMutex(RenderTraceLock);
+    --RenderTraceDepth;
+}
 
-typedef struct
+/* A buffer for gathering trace data, only used between BeginRenderTrace() and EndRenderTrace() */
+static void *GetRenderTraceScratch(size_t size)
 {
-    float length;
-    int numPoints;
-    SDL_FPoint p[GESTURE_MAX_DOLLAR_PATH_SIZE];
-} GestureDollarPath;
+    if (size > RenderTraceScratchSize) {
+        const size_t new_size = SDL_max(size, RenderTraceScratchSize * 2);
+        void *scratch = SDL3_realloc(RenderTraceScratch, new_size);
+        if (!scratch) {
+            return NULL;
+        }
+        RenderTraceScratch = scratch;
+        RenderTraceScratchSize = new_size;
+    }
+    return RenderTraceScratch;
+}
 
-typedef struct
+/* Trace a call that draws `count` points, lines or rects of `item_size` bytes each */
+static int EndRenderTraceItems(const RenderTrace *trace, RenderTraceCall call, const void *items, int count, size_t item_size, int retval)
 {
-    SDL_FPoint path[GESTURE_DOLLARNPOINTS];
-    Sint64 hash;
-} GestureDollarTemplate;
+    const Uint64 end_ns = SDL3_GetTicksNS();
+    RenderTraceCount args;
+    const bool has_data = (items && count > 0);
 
-typedef struct
+    args.count = count;
+    EndRenderTrace(trace, end_ns, call, has_data ? RENDER_TRACE_HAS_DATA : 0, &args, sizeof (args), items, has_data ? (size_t)count * item_size : 0);
+    return retval;
+}
+
+static int EndRenderTraceCopy(const RenderTrace *trace, RenderTraceCall call, SDL_Texture *texture,
+                              const SDL_Rect *srcrect, const SDL_FRect *dstrect, double angle,
+                              const SDL_FPoint *center, SDL_FlipMode flip, int retval)
 {
-    SDL_TouchID touchId;
-    SDL_FPoint centroid;
-    GestureDollarPath dollarPath;
-    Uint16 numDownFingers;
-    int numDollarTemplates;
-    GestureDollarTemplate *dollarTemplate;
-    SDL2_bool recording;
-} GestureTouch;
+    const Uint64 end_ns = SDL3_GetTicksNS();
+    RenderTraceCopy args;
+    Uint16 flags = 0;
 
-static GestureTouch *GestureTouches = NULL;
-static int GestureNumTouches = 0;
-static bool GestureRecordAll = false;
+    SDL3_zero(args);
+    GetTextureTraceState(texture, &args.texture_state);
+    if (srcrect) {
+        args.srcrect = *srcrect;
+        flags |= RENDER_TRACE_HAS_SRCRECT;
+    }
+    if (dstrect) {
+        args.dstrect = *dstrect;
+        flags |= RENDER_TRACE_HAS_DSTRECT;
+    }
+    if (center) {
+        args.center = *center;
+        flags |= RENDER_TRACE_HAS_CENTER;
+    }
+    args.angle = angle;
+    args.flip = (Sint32)flip;
+    EndRenderTrace(trace, end_ns, call, flags, &args, sizeof (args), NULL, 0);
+    return retval;
+}
 
-static GestureTouch *
-GestureAddTouch(const SDL_TouchID touchId)
+/* Trace a batch of sprites, each with the trace ID and state of its texture */
+static int EndRenderTraceSprites(const RenderTrace *trace, const SDL2_CompatSprite *sprites, int count, int retval)
 {
-    GestureTouch *gestureTouch = (GestureTouch *)SDL3_realloc(GestureTouches, (GestureNumTouches + 1) * sizeof(GestureTouch));
-    if (gestureTouch == NULL) {
-        return NULL;
+    const Uint64 end_ns = SDL3_GetTicksNS();
+    RenderTraceCount args;
+    RenderTraceSprite *data = NULL;
+    RenderTraceTextureState texture_state;
+    SDL_Texture *texture = NULL;
+    Uint32 id = 0;
+    int i;
+
+    args.count = count;
+    if (sprites && count > 0) {
+        data = (RenderTraceSprite *)GetRenderTraceScratch((size_t)count * sizeof(*data));
+    }
+    if (!data) {
+        EndRenderTrace(trace, end_ns, RENDER_TRACE_RENDER_SPRITES, 0, &args, sizeof (args), NULL, 0);
+        return retval;
     }
 
-    GestureTouches = gestureTouch;
-    SDL3_zero(GestureTouches[GestureNumTouches]);
-    GestureTouches[GestureNumTouches].touchId = touchId;
-    return &GestureTouches[GestureNumTouches++];
+    SDL3_zero(texture_state);
+    for (i = 0; i < count; ++i) {
+        const SDL2_CompatSprite *sprite = &sprites[i];
+
+        if (sprite->texture != texture) {
+            texture = sprite->texture;
+            SDL3_LockMutex(RenderTraceLock);
+            id = (texture && RenderTraceStream) ? GetTextureTraceID(texture) : 0;
+            SDL3_UnlockMutex(RenderTraceLock);
+            GetTextureTraceState(texture, &texture_state);
+        }
+        SDL3_zero(data[i]);
+        data[i].angle = sprite->angle;
+        data[i].texture_state = texture_state;
+        data[i].srcrect = sprite->srcrect;
+        data[i].dstrect = sprite->dstrect;
+        data[i].texture = id;
+        data[i].flip = (Sint32)sprite->flip;
+        data[i].color[0] = sprite->color.r;
+        data[i].color[1] = sprite->color.g;
+        data[i].color[2] = sprite->color.b;
+        data[i].color[3] = sprite->color.a;
+    }
+    EndRenderTrace(trace, end_ns, RENDER_TRACE_RENDER_SPRITES, RENDER_TRACE_HAS_DATA, &args, sizeof (args), data, (size_t)count * sizeof(*data));
+    return retval;
 }
 
-static GestureTouch *
-GestureGetTouch(const SDL_TouchID touchId)
+/* Trace an upload of `pixels`, or of the area `rect` of them. The pixels are only kept for formats with whole bytes per pixel. */
+static void EndRenderTraceUpdate(const RenderTrace *trace, Uint64 end_ns, RenderTraceCall call, SDL_Texture *texture,
+                                 const SDL_Rect *rect, const void *pixels, int pitch)
 {
-    int i;
-    for (i = 0; i < GestureNumTouches; i++) {
-        /* printf("%i ?= %i\n",GestureTouches[i].touchId,touchId); */
-        if (GestureTouches[i].touchId == touchId) {
-            return &GestureTouches[i];
+    const SDL_PropertiesID props = SDL3_GetTextureProperties(texture);
+    const SDL_PixelFormat format = (SDL_PixelFormat)SDL3_GetNumberProperty(props, SDL_PROP_TEXTURE_FORMAT_NUMBER, SDL_PIXELFORMAT_UNKNOWN);
+    RenderTraceUpdate args;
+    Uint16 flags = 0;
+    Uint8 *data = NULL;
+    int w, h, y;
+
+    SDL3_zero(args);
+    if (rect) {
+        args.rect = *rect;
+        flags |= RENDER_TRACE_HAS_RECT;
+        w = rect->w;
+        h = rect->h;
+    } else {
+        w = (int)SDL3_GetNumberProperty(props, SDL_PROP_TEXTURE_WIDTH_NUMBER, 0);
+        h = (int)SDL3_GetNumberProperty(props, SDL_PROP_TEXTURE_HEIGHT_NUMBER, 0);
+    }
+
+    if (pixels && w > 0 && h > 0 && !SDL_ISPIXELFORMAT_FOURCC(format) && SDL_BYTESPERPIXEL(format) > 0) {
+        args.pitch = w * SDL_BYTESPERPIXEL(format);
+        args.rows = h;
+        data = (Uint8 *)GetRenderTraceScratch((size_t)args.pitch * h);
+    }
+    if (data) {
+        for (y = 0; y < h; ++y) {
+            SDL3_memcpy(data + (size_t)y * args.pitch, (const Uint8 *)pixels + (size_t)y * pitch, args.pitch);
         }
+        flags |= RENDER_TRACE_HAS_DATA;
+    } else {
+        args.pitch = 0;
+        args.rows = 0;
     }
-    return NULL;
+    EndRenderTrace(trace, end_ns, call, flags, &args, sizeof (args), data, data ? (size_t)args.pitch * h : 0);
 }
 
-SDL_DECLSPEC int SDLCALL
-SDL_RecordGesture(SDL_TouchID touchId)
+/* Get the width in bytes and the height of each plane of a YUV (3 planes) or NV (2 planes) update of w x h pixels */
+static void GetRenderTracePlanes(int num_planes, int w, int h, int *widths, int *heights)
 {
-    int numtouchdevs = 0;
-    SDL_TouchID *touchdevs = SDL3_GetTouchDevices(&numtouchdevs);
-    int i;
+    widths[0] = w;
+    heights[0] = h;
+    widths[1] = (num_planes == 3) ? (w + 1) / 2 : ((w + 1) / 2) * 2;
+    heights[1] = (h + 1) / 2;
+    widths[2] = (w + 1) / 2;
+    heights[2] = (h + 1) / 2;
+}
 
-    /* make sure we know about all the devices SDL3 knows about, since we aren't connected as tightly as we were in SDL2. */
-    for (i = 0; i < numtouchdevs; i++) {
-        SDL_TouchID thistouch = touchdevs[i];
-        if (!GestureGetTouch(thistouch)) {
-            if (!GestureAddTouch(thistouch)) {
-                SDL3_free(touchdevs);
-                return 0;  /* uhoh, out of memory */
-            }
-        }
+/* Trace a YUV or NV upload with its planes packed one after another. They're only kept for the 8-bit formats those calls take. */
+static void EndRenderTracePlanes(const RenderTrace *trace, Uint64 end_ns, RenderTraceCall call, SDL_Texture *texture,
+                                 const SDL_Rect *rect, const Uint8 *const *planes, const int *pitches)
+{
+    const SDL_PropertiesID props = SDL3_GetTextureProperties(texture);
+    const SDL_PixelFormat format = (SDL_PixelFormat)SDL3_GetNumberProperty(props, SDL_PROP_TEXTURE_FORMAT_NUMBER, SDL_PIXELFORMAT_UNKNOWN);
+    const int num_planes = (call == RENDER_TRACE_UPDATE_YUV_TEXTURE) ? 3 : 2;
+    RenderTraceUpdate args;
+    Uint16 flags = 0;
+    Uint8 *data = NULL;
+    size_t size = 0;
+    int widths[3], heights[3];
+    int w, h, i, y;
+    bool supported;
+
+    SDL3_zero(args);
+    if (rect) {
+        args.rect = *rect;
+        flags |= RENDER_TRACE_HAS_RECT;
+        w = rect->w;
+        h = rect->h;
+    } else {
+        w = (int)SDL3_GetNumberProperty(props, SDL_PROP_TEXTURE_WIDTH_NUMBER, 0);
+        h = (int)SDL3_GetNumberProperty(props, SDL_PROP_TEXTURE_HEIGHT_NUMBER, 0);
     }
-    SDL3_free(touchdevs);
 
-    if (touchId == (SDL_TouchID)-1) {
-        GestureRecordAll = true;  /* !!! FIXME: this is never set back to SDL2_FALSE anywhere, that's probably a bug. */
-        for (i = 0; i < GestureNumTouches; i++) {
-            GestureTouches[i].recording = SDL2_TRUE;
-        }
+    if (call == RENDER_TRACE_UPDATE_YUV_TEXTURE) {
+        supported = (format == SDL_PIXELFORMAT_IYUV || format == SDL_PIXELFORMAT_YV12);
     } else {
-        GestureTouch *touch = GestureGetTouch(touchId);
-        if (!touch) {
-            return 0;  /* bogus touchid */
+        supported = (format == SDL_PIXELFORMAT_NV12 || format == SDL_PIXELFORMAT_NV21);
+    }
+    if (planes && supported && w > 0 && h > 0) {
+        GetRenderTracePlanes(num_planes, w, h, widths, heights);
+        for (i = 0; i < num_planes; ++i) {
+            size += (size_t)widths[i] * heights[i];
         }
-        touch->recording = SDL2_TRUE;
+        data = (Uint8 *)GetRenderTraceScratch(size);
     }
+    if (data) {
+        Uint8 *dst = data;
 
-    return 1;
+        for (i = 0; i < num_planes; ++i) {
+            for (y = 0; y < heights[i]; ++y) {
+                SDL3_memcpy(dst, planes[i] + (size_t)y * pitches[i], widths[i]);
+                dst += widths[i];
+            }
+        }
+        args.pitch = w;
+        args.rows = h;
+        flags |= RENDER_TRACE_HAS_DATA;
+    }
+    EndRenderTrace(trace, end_ns, call, flags, &args, sizeof (args), data, data ? size : 0);
 }
 
-static void
-GestureQuit(void)
+/* Trace the vertices as packed positions, colors, texture coordinates and 32-bit indices */
+static int EndRenderTraceGeometry(const RenderTrace *trace, RenderTraceCall call, SDL_Texture *texture,
+                                  const float *xy, int xy_stride, const SDL_Color *color, int color_stride,
+                                  const float *uv, int uv_stride, int num_vertices,
+                                  const void *indices, int num_indices, int size_indices, int retval)
 {
+    const Uint64 end_ns = SDL3_GetTicksNS();
+    RenderTraceGeometry args;
+    Uint16 flags = 0;
+    size_t size = 0;
+    Uint8 *data = NULL;
     int i;
-    for (i = 0; i < GestureNumTouches; i++) {
-        SDL3_free(GestureTouches[i].dollarTemplate);
+
+    SDL3_zero(args);
+    GetTextureTraceState(texture, &args.texture_state);
+    args.num_vertices = num_vertices;
+    args.num_indices = num_indices;
+    if (xy && color && num_vertices > 0) {
+        flags |= RENDER_TRACE_HAS_DATA;
+        size += (size_t)num_vertices * (2 * sizeof(float) + sizeof(SDL_Color));
+        if (uv) {
+            flags |= RENDER_TRACE_HAS_UV;
+            size += (size_t)num_vertices * 2 * sizeof(float);
+        }
+        if (indices && num_indices > 0 && (size_indices == 1 || size_indices == 2 || size_indices == 4)) {
+            flags |= RENDER_TRACE_HAS_INDICES;
+            size += (size_t)num_indices * sizeof(Sint32);
+        }
+        data = (Uint8 *)GetRenderTraceScratch(size);
     }
-    SDL3_free(GestureTouches);
-    GestureTouches = NULL;
-    GestureNumTouches = 0;
-}
 
-static unsigned long
-GestureHashDollar(SDL_FPoint *points)
-{
-    unsigned long hash = 5381;
-    int i;
-    for (i = 0; i < GESTURE_DOLLARNPOINTS; i++) {
-        hash = ((hash << 5) + hash) + (unsigned long)points[i].x;
-        hash = ((hash << 5) + hash) + (unsigned long)points[i].y;
+    if (!data) {
+        EndRenderTrace(trace, end_ns, call, 0, &args, sizeof (args), NULL, 0);
+        return retval;
     }
-    return hash;
+
+    {
+        float *out_xy = (float *)data;
+        SDL_Color *out_color = (SDL_Color *)(out_xy + 2 * num_vertices);
+        float *out_uv = (float *)(out_color + num_vertices);
+        Sint32 *out_indices = (Sint32 *)(out_uv + ((flags & RENDER_TRACE_HAS_UV) ? 2 * num_vertices : 0));
+
+        for (i = 0; i < num_vertices; ++i) {
+            const float *v = (const float *)((const Uint8 *)xy + (size_t)i * xy_stride);
+            out_xy[i * 2] = v[0];
+            out_xy[i * 2 + 1] = v[1];
+            out_color[i] = *(const SDL_Color *)((const Uint8 *)color + (size_t)i * color_stride);
+            if (flags & RENDER_TRACE_HAS_UV) {
+                const float *t = (const float *)((const Uint8 *)uv + (size_t)i * uv_stride);
+                out_uv[i * 2] = t[0];
+                out_uv[i * 2 + 1] = t[1];
+            }
+        }
+        if (flags & RENDER_TRACE_HAS_INDICES) {
+            for (i = 0; i < num_indices; ++i) {
+                if (size_indices == 4) {
+                    out_indices[i] = ((const Sint32 *)indices)[i];
+                } else if (size_indices == 2) {
+                    out_indices[i] = ((const Uint16 *)indices)[i];
+                } else {
+                    out_indices[i] = ((const Uint8 *)indices)[i];
+                }
+            }
+        }
+    }
+    EndRenderTrace(trace, end_ns, call, flags, &args, sizeof (args), data, size);
+    return retval;
 }
 
-static int
-GestureSaveTemplate(GestureDollarTemplate *templ, SDL2_RWops *dst)
+/* Called before a texture is destroyed, so a replay can destroy it at the same point */
+static void TraceDestroyTexture(SDL_Texture *texture)
 {
-    if (dst == NULL) {
-        return 0;
+    SDL_PropertiesID props;
+    Sint64 value;
+
+    if (!SDL3_GetAtomicPointer((void **)&RenderTraceStream)) {
+        return;
+    }
+    props = SDL3_GetTextureProperties(texture);
+    value = props ? SDL3_GetNumberProperty(props, PROP_TEXTURE_TRACE_ID, 0) : 0;
+    SDL3_LockMutex(RenderTraceLock);
+    if ((Uint32)(value >> 32) == RenderTraceGeneration && (Uint32)value != 0) {
+        WriteRenderTrace(RENDER_TRACE_DESTROY_TEXTURE, 0, (Uint32)value, 0, NULL, 0, NULL, 0);
     }
+    SDL3_UnlockMutex(RenderTraceLock);
+}
 
-    /* No Longer storing the Hash, rehash on load */
-    /* if (SDL2_RWops.write(dst, &(templ->hash), sizeof(templ->hash), 1) != 1) return 0; */
+/* Called after a texture is locked, so the unlock can be traced with what was written to the lock */
+static void TraceLockTexture(SDL_Texture *texture, const SDL_Rect *rect, void *pixels, int pitch)
+{
+    SDL_PropertiesID props;
+    TextureTraceLock *lock;
 
-#if SDL_BYTEORDER == SDL_LIL_ENDIAN
-    if (SDL_RWwrite(dst, templ->path, sizeof(templ->path[0]), GESTURE_DOLLARNPOINTS) != GESTURE_DOLLARNPOINTS) {
-        return 0;
+    if (!SDL3_GetAtomicPointer((void **)&RenderTraceStream)) {
+        return;
     }
-#else
-    {
-        GestureDollarTemplate copy = *templ;
-        SDL_FPoint *p = copy.path;
-        int i;
-        for (i = 0; i < GESTURE_DOLLARNPOINTS; i++, p++) {
-            p->x = SDL_SwapFloatLE(p->x);
-            p->y = SDL_SwapFloatLE(p->y);
+    props = SDL3_GetTextureProperties(texture);
+    lock = (TextureTraceLock *)SDL3_GetPointerProperty(props, PROP_TEXTURE_TRACE_LOCK, NULL);
+    if (!lock) {
+        lock = (TextureTraceLock *)SDL3_calloc(1, sizeof(*lock));
+        if (!lock) {
+            return;
         }
-
-        if (SDL_RWwrite(dst, copy.path, sizeof(copy.path[0]), GESTURE_DOLLARNPOINTS) != GESTURE_DOLLARNPOINTS) {
-            return 0;
+        if (!SDL3_SetPointerPropertyWithCleanup(props, PROP_TEXTURE_TRACE_LOCK, lock, CleanupFreeableProperty, NULL)) {
+            return;
         }
     }
-#endif
 
-    return 1;
+    SDL3_LockMutex(RenderTraceLock);
+    lock->generation = RenderTraceGeneration;
+    SDL3_UnlockMutex(RenderTraceLock);
+    lock->locked = true;
+    lock->has_rect = (rect != NULL);
+    if (rect) {
+        lock->rect = *rect;
+    }
+    lock->pixels = pixels;
+    lock->pitch = pitch;
 }
 
-SDL_DECLSPEC int SDLCALL
-SDL_SaveAllDollarTemplates(SDL2_RWops *dst)
+/* Get the lock that's about to be undone, if it was made while recording the current trace */
+static TextureTraceLock *GetTextureTraceLock(SDL_Texture *texture)
 {
-    int i, j, rtrn = 0;
-    for (i = 0; i < GestureNumTouches; i++) {
-        GestureTouch *touch = &GestureTouches[i];
-        for (j = 0; j < touch->numDollarTemplates; j++) {
-            rtrn += GestureSaveTemplate(&touch->dollarTemplate[j], dst);
-        }
+    TextureTraceLock *lock;
+    bool current;
+
+    if (!SDL3_GetAtomicPointer((void **)&RenderTraceStream)) {
+        return NULL;
     }
-    return rtrn;
+    lock = (TextureTraceLock *)SDL3_GetPointerProperty(SDL3_GetTextureProperties(texture), PROP_TEXTURE_TRACE_LOCK, NULL);
+    if (!lock || !lock->locked) {
+        return NULL;
+    }
+    lock->locked = false;
+
+    SDL3_LockMutex(RenderTraceLock);
+    current = (lock->generation == RenderTraceGeneration);
+    SDL3_UnlockMutex(RenderTraceLock);
+    return current ? lock : NULL;
 }
 
-SDL_DECLSPEC int SDLCALL
-SDL_SaveDollarTemplate(SDL2_GestureID gestureId, SDL2_RWops *dst)
+/* Copy the pixels of a lock out, packed, before the unlock. Returns NULL if their format doesn't have whole bytes per pixel. */
+static void *CopyTextureTraceLock(SDL_Texture *texture, const TextureTraceLock *lock, int *pitch)
 {
-    int i, j;
-    for (i = 0; i < GestureNumTouches; i++) {
-        GestureTouch *touch = &GestureTouches[i];
-        for (j = 0; j < touch->numDollarTemplates; j++) {
-            if (touch->dollarTemplate[j].hash == gestureId) {
-                return GestureSaveTemplate(&touch->dollarTemplate[j], dst);
-            }
-        }
+    const SDL_PropertiesID props = SDL3_GetTextureProperties(texture);
+    const SDL_PixelFormat format = (SDL_PixelFormat)SDL3_GetNumberProperty(props, SDL_PROP_TEXTURE_FORMAT_NUMBER, SDL_PIXELFORMAT_UNKNOWN);
+    Uint8 *pixels;
+    int w, h, y;
+
+    if (lock->has_rect) {
+        w = lock->rect.w;
+        h = lock->rect.h;
+    } else {
+        w = (int)SDL3_GetNumberProperty(props, SDL_PROP_TEXTURE_WIDTH_NUMBER, 0);
+        h = (int)SDL3_GetNumberProperty(props, SDL_PROP_TEXTURE_HEIGHT_NUMBER, 0);
     }
-    SDL3_SetError("Unknown gestureId");
-    return -1;
+    if (!lock->pixels || w <= 0 || h <= 0 || SDL_ISPIXELFORMAT_FOURCC(format) || SDL_BYTESPERPIXEL(format) == 0) {
+        return NULL;
+    }
+
+    *pitch = w * SDL_BYTESPERPIXEL(format);
+    pixels = (Uint8 *)SDL3_malloc((size_t)*pitch * h);
+    if (!pixels) {
+        return NULL;
+    }
+    for (y = 0; y < h; ++y) {
+        SDL3_memcpy(pixels + (size_t)y * *pitch, (const Uint8 *)lock->pixels + (size_t)y * lock->pitch, *pitch);
+    }
+    return pixels;
 }
 
-/* path is an already sampled set of points
-Returns the index of the gesture on success, or -1 */
-static int
-GestureAddDollar_one(GestureTouch *inTouch, SDL_FPoint *path)
+SDL_DECLSPEC int SDLCALL
+SDL_CompatStartRenderRecording(const char *file)
 {
-    GestureDollarTemplate *dollarTemplate;
-    GestureDollarTemplate *templ;
-    int idx;
+    RenderTraceHeader header;
+    SDL_IOStream *io;
 
-    idx = inTouch->numDollarTemplates;
-    dollarTemplate = (GestureDollarTemplate *)SDL3_realloc(inTouch->dollarTemplate, (idx + 1) * sizeof(GestureDollarTemplate));
-    if (dollarTemplate == NULL) {
+    if (!file) {
+        SDL3_InvalidParamError("file");
         return -1;
     }
-    inTouch->dollarTemplate = dollarTemplate;
 
-    templ = &inTouch->dollarTemplate[idx];
-    SDL3_memcpy(templ->path, path, GESTURE_DOLLARNPOINTS * sizeof(SDL_FPoint));
-    templ->hash = GestureHashDollar(templ->path);
-    inTouch->numDollarTemplates++;
+    io = SDL3_IOFromFile(file, "wb");
+    if (!io) {
+        return -1;
+    }
 
-    return idx;
+    SDL3_zero(header);
+    SDL3_memcpy(header.magic, RENDER_TRACE_MAGIC, sizeof (header.magic));
+    header.version = RENDER_TRACE_VERSION;
+    header.record_size = (Uint32) sizeof (RenderTraceRecord);
+    if (SDL3_WriteIO(io, &header, sizeof (header)) != sizeof (header)) {
+        SDL3_CloseIO(io);
+        return -1;
+    }
+
+    SDL_CompatStopRenderRecording();
+    SDL3_LockMutex(RenderTraceLock);
+    ++RenderTraceGeneration;
+    RenderTraceNextTexture = 1;
+    RenderTraceLastRenderer = NULL;
+    RenderTraceStream = io;
+    SDL3_UnlockMutex(RenderTraceLock);
+    return 0;
 }
 
-static int
-GestureAddDollar(GestureTouch *inTouch, SDL_FPoint *path)
+SDL_DECLSPEC void SDLCALL
+SDL_CompatStopRenderRecording(void)
 {
-    if (inTouch == NULL) {
-        int i, idx;
-        if (GestureNumTouches == 0) {
-            SDL3_SetError("no gesture touch devices registered");
-            return -1;
-        }
-        for (i = 0, idx = -1; i < GestureNumTouches; i++) {
-            inTouch = &GestureTouches[i];
-            idx = GestureAddDollar_one(inTouch, path);
-            if (idx < 0) {
-                return -1;
-            }
-        }
-        /* Use the index of the last one added. */
-        return idx;
+    SDL3_LockMutex(RenderTraceLock);
+    if (RenderTraceStream) {
+        SDL3_CloseIO(RenderTraceStream);
+        RenderTraceStream = NULL;
     }
-    return GestureAddDollar_one(inTouch, path);
+    SDL3_UnlockMutex(RenderTraceLock);
 }
 
-SDL_DECLSPEC int SDLCALL
-SDL_LoadDollarTemplates(SDL_TouchID touchId, SDL2_RWops *src)
+static void SDLCALL SDL2_RenderRecordChanged(void *userdata, const char *name, const char *oldValue, const char *hint)
 {
-    int i, loaded = 0;
-    GestureTouch *touch = NULL;
-    if (src == NULL) {
-        return 0;
-    }
-    if (touchId != (SDL_TouchID)-1) {
-        for (i = 0; i < GestureNumTouches; i++) {
-            if (GestureTouches[i].touchId == touchId) {
-                touch = &GestureTouches[i];
-            }
-        }
-        if (touch == NULL) {
-            SDL3_SetError("given touch id not found");
-            return -1;
-        }
+    if (hint && *hint) {
+        SDL_CompatStartRenderRecording(hint);
+    } else {
+        SDL_CompatStopRenderRecording();
     }
+}
 
-    while (1) {
-        GestureDollarTemplate templ;
+static void FreeRenderTraceScratch(void)
+{
+    SDL3_free(RenderTraceScratch);
+    RenderTraceScratch = NULL;
+    RenderTraceScratchSize = 0;
+}
 
-        if (SDL_RWread(src, templ.path, sizeof(templ.path[0]), GESTURE_DOLLARNPOINTS) < GESTURE_DOLLARNPOINTS) {
-            if (loaded == 0) {
-                SDL3_SetError("could not read any dollar gesture from rwops");
-                return -1;
+/* Second parameter changed from an index to a string in SDL3. */
+SDL_DECLSPEC SDL_Renderer *SDLCALL
+SDL_CreateRenderer(SDL_Window *window, int idx, Uint32 flags)
+{
+    RendererState *state;
+    SDL_Renderer *renderer;
+    const char *name = NULL;
+    char *namecpy = NULL;
+
+    if (idx == -1) {
+        /* SDL2, if given a bogus render driver name in a hint, would find no match, and then try everything.
+           SDL3 reports failure in this case. PCem tries to create a renderer named "auto" so we need to deal
+           with this. */
+        name = SDL3_GetHint(SDL_HINT_RENDER_DRIVER);
+        if (name) {
+            const int total = SDL3_GetNumRenderDrivers();
+            int i;
+            for (i = 0; i < total; i++) {
+                if (SDL3_strcasecmp(name, SDL3_GetRenderDriver(i)) == 0) {
+                    break;
+                }
+            }
+            if (i == total) {
+                namecpy = SDL3_strdup(name);
+                if (!namecpy) {
+                    return NULL;
+                }
+                name = NULL;  /* set it to NULL so SDL3 will choose a default. */
+                SDL3_SetHint(SDL_HINT_RENDER_DRIVER, NULL);
             }
-            break;
         }
 
-#if SDL_BYTEORDER != SDL_LIL_ENDIAN
-        for (i = 0; i < GESTURE_DOLLARNPOINTS; i++) {
-            SDL_FPoint *p = &templ.path[i];
-            p->x = SDL_SwapFloatLE(p->x);
-            p->y = SDL_SwapFloatLE(p->y);
+        /* A valid render driver specified by idx or hint takes precedence over flags */
+        if (!name && (flags & SDL2_RENDERER_SOFTWARE)) {
+            name = SDL_SOFTWARE_RENDERER;
         }
-#endif
+    } else {
+        name = SDL3_GetRenderDriver(idx);
+        if (!name) {
+            return NULL;  /* assume SDL3_GetRenderDriver set the SDL error. */
+        }
+    }
 
-        if (touchId != (SDL_TouchID)-1) {
-            /* printf("Adding loaded gesture to 1 touch\n"); */
-            if (GestureAddDollar(touch, templ.path) >= 0) {
-                loaded++;
-            }
-        } else {
-            /* printf("Adding to: %i touches\n",GestureNumTouches); */
-            for (i = 0; i < GestureNumTouches; i++) {
-                touch = &GestureTouches[i];
-                /* printf("Adding loaded gesture to + touches\n"); */
-                /* TODO: What if this fails? */
-                GestureAddDollar(touch, templ.path);
-            }
-            loaded++;
+    renderer = SDL3_CreateRenderer(window, name);
+    state = GetRendererState(renderer, true);
+    if (state) {
+        state->batching = SDL3_GetHintBoolean("SDL_RENDER_BATCHING", (name == NULL));
+        state->relative_scaling = SDL3_GetHintBoolean("SDL_MOUSE_RELATIVE_SCALING", true);
+        state->merge_copies = state->batching && SDL3_GetHintBoolean("SDL2_RENDER_MERGE_COPIES", false);
+        if (state->merge_copies) {
+            SDL3_AddAtomicInt(&NumMergingRenderers, 1);
         }
     }
+    if (flags & SDL2_RENDERER_PRESENTVSYNC) {
+        SDL3_SetRenderVSync(renderer, 1);
+    }
 
-    return loaded;
+    /* restore original hint. */
+    if (namecpy) {
+        SDL3_SetHint(SDL_HINT_RENDER_DRIVER, namecpy);
+        SDL3_free(namecpy);
+    }
+
+    return renderer;
 }
 
-static float
-GestureDollarDifference(SDL_FPoint *points, SDL_FPoint *templ, float ang)
+SDL_DECLSPEC SDL2_bool SDLCALL
+SDL_RenderTargetSupported(SDL_Renderer *renderer)
 {
-    /*  SDL_FPoint p[GESTURE_DOLLARNPOINTS]; */
-    float dist = 0;
-    SDL_FPoint p;
-    int i;
-    for (i = 0; i < GESTURE_DOLLARNPOINTS; i++) {
-        p.x = points[i].x * SDL3_cosf(ang) - points[i].y * SDL3_sinf(ang);
-        p.y = points[i].x * SDL3_sinf(ang) + points[i].y * SDL3_cosf(ang);
-        dist += SDL3_sqrtf((p.x - templ[i].x) * (p.x - templ[i].x) + (p.y - templ[i].y) * (p.y - templ[i].y));
-    }
-    return dist / GESTURE_DOLLARNPOINTS;
+    /* All SDL3 renderers support target textures */
+    return SDL2_TRUE;
 }
 
-static float
-GestureBestDollarDifference(SDL_FPoint *points, SDL_FPoint *templ)
+SDL_DECLSPEC void SDLCALL
+SDL_RenderGetViewport(SDL_Renderer *renderer, SDL_Rect *rect)
 {
-    /*------------BEGIN DOLLAR BLACKBOX------------------
-      -TRANSLATED DIRECTLY FROM PSUDEO-CODE AVAILABLE AT-
-      -"http://depts.washington.edu/aimgroup/proj/dollar/"
-    */
-    double ta = -SDL_PI_D / 4;
-    double tb = SDL_PI_D / 4;
-    double dt = SDL_PI_D / 90;
-    float x1 = (float)(GESTURE_PHI * ta + (1 - GESTURE_PHI) * tb);
-    float f1 = GestureDollarDifference(points, templ, x1);
-    float x2 = (float)((1 - GESTURE_PHI) * ta + GESTURE_PHI * tb);
-    float f2 = GestureDollarDifference(points, templ, x2);
-    while (SDL3_fabs(ta - tb) > dt) {
-        if (f1 < f2) {
-            tb = x2;
-            x2 = x1;
-            f2 = f1;
-            x1 = (float)(GESTURE_PHI * ta + (1 - GESTURE_PHI) * tb);
-            f1 = GestureDollarDifference(points, templ, x1);
-        } else {
-            ta = x1;
-            x1 = x2;
-            f1 = f2;
-            x2 = (float)((1 - GESTURE_PHI) * ta + GESTURE_PHI * tb);
-            f2 = GestureDollarDifference(points, templ, x2);
-        }
-    }
-    /*
-    if (f1 <= f2)
-        printf("Min angle (x1): %f\n",x1);
-    else if (f1 >  f2)
-        printf("Min angle (x2): %f\n",x2);
-    */
-    return SDL_min(f1, f2);
+    SDL3_GetRenderViewport(renderer, rect);
 }
 
-/* `path` contains raw points, plus (possibly) the calculated length */
-static int
-GestureDollarNormalize(const GestureDollarPath *path, SDL_FPoint *points, SDL2_bool is_recording)
-{
-    int i;
-    float interval;
-    float dist;
-    int numPoints = 0;
-    SDL_FPoint centroid;
-    float xmin, xmax, ymin, ymax;
-    float ang;
-    float w, h;
-    float length = path->length;
+SDL_DECLSPEC SDL2_bool SDLCALL
+SDL_SetClipRect(SDL2_Surface *surface, const SDL_Rect *rect)
+{
+    SDL_Rect full_rect;
+
+    /* Don't do anything if there's no surface to act on */
+    if (!surface) {
+        return SDL2_FALSE;
+    }
+
+    SDL3_SetSurfaceClipRect(Surface2to3(surface), rect);
 
-    /* Calculate length if it hasn't already been done */
-    if (length <= 0) {
-        for (i = 1; i < path->numPoints; i++) {
-            const float dx = path->p[i].x - path->p[i - 1].x;
-            const float dy = path->p[i].y - path->p[i - 1].y;
-            length += SDL3_sqrtf(dx * dx + dy * dy);
-        }
+    /* Set up the full surface rectangle */
+    full_rect.x = 0;
+    full_rect.y = 0;
+    full_rect.w = surface->w;
+    full_rect.h = surface->h;
+
+    /* Set the clipping rectangle */
+    if (!rect) {
+        surface->clip_rect = full_rect;
+        return SDL2_TRUE;
     }
+    return SDL3_GetRectIntersection(rect, &full_rect, &surface->clip_rect) ? SDL2_TRUE : SDL2_FALSE;
+}
 
-    /* Resample */
-    interval = length / (GESTURE_DOLLARNPOINTS - 1);
-    dist = interval;
+SDL_DECLSPEC void SDLCALL
+SDL_RenderGetClipRect(SDL_Renderer *renderer, SDL_Rect *rect)
+{
+    SDL3_GetRenderClipRect(renderer, rect);
+}
 
-    centroid.x = 0;
-    centroid.y = 0;
+SDL_DECLSPEC void SDLCALL
+SDL_RenderGetScale(SDL_Renderer *renderer, float *scaleX, float *scaleY)
+{
+    int w = 0, h = 0;
+    SDL_FRect rect;
 
-    /* printf("(%f,%f)\n",path->p[path->numPoints-1].x,path->p[path->numPoints-1].y); */
-    for (i = 1; i < path->numPoints; i++) {
-        const float d = SDL3_sqrtf((path->p[i - 1].x - path->p[i].x) * (path->p[i - 1].x - path->p[i].x) + (path->p[i - 1].y - path->p[i].y) * (path->p[i - 1].y - path->p[i].y));
-        /* printf("d = %f dist = %f/%f\n",d,dist,interval); */
-        while (dist + d > interval) {
-            points[numPoints].x = path->p[i - 1].x +
-                                  ((interval - dist) / d) * (path->p[i].x - path->p[i - 1].x);
-            points[numPoints].y = path->p[i - 1].y +
-                                  ((interval - dist) / d) * (path->p[i].y - path->p[i - 1].y);
-            centroid.x += points[numPoints].x;
-            centroid.y += points[numPoints].y;
-            numPoints++;
+    SDL3_GetRenderScale(renderer, scaleX, scaleY);
 
-            dist -= interval;
-        }
-        dist += d;
+    /* Include the logical scale */
+    SDL3_GetRenderLogicalPresentation(renderer, &w, &h, NULL);
+    SDL3_GetRenderLogicalPresentationRect(renderer, &rect);
+    if (scaleX && w > 0) {
+        *scaleX *= rect.w / w;
     }
-    if (numPoints < GESTURE_DOLLARNPOINTS - 1) {
-        if (is_recording) {
-            SDL3_SetError("ERROR: NumPoints = %i", numPoints);
-        }
-        return 0;
+    if (scaleY && h > 0) {
+        *scaleY *= rect.h / h;
     }
-    /* copy the last point */
-    points[GESTURE_DOLLARNPOINTS - 1] = path->p[path->numPoints - 1];
-    numPoints = GESTURE_DOLLARNPOINTS;
-
-    centroid.x /= numPoints;
-    centroid.y /= numPoints;
+}
 
-    /* printf("Centroid (%f,%f)",centroid.x,centroid.y); */
-    /* Rotate Points so point 0 is left of centroid and solve for the bounding box */
-    xmin = centroid.x;
-    xmax = centroid.x;
-    ymin = centroid.y;
-    ymax = centroid.y;
+SDL_DECLSPEC void SDLCALL
+SDL_RenderWindowToLogical(SDL_Renderer *renderer,
+                          int windowX, int windowY,
+                          float *logicalX, float *logicalY)
+{
+    SDL3_RenderCoordinatesFromWindow(renderer, (float)windowX, (float)windowY, logicalX, logicalY);
+}
 
-    ang = SDL3_atan2f(centroid.y - points[0].y, centroid.x - points[0].x);
+SDL_DECLSPEC void SDLCALL
+SDL_RenderLogicalToWindow(SDL_Renderer *renderer,
+                          float logicalX, float logicalY,
+                          int *windowX, int *windowY)
+{
+    float x, y;
+    SDL3_RenderCoordinatesToWindow(renderer, logicalX, logicalY, &x, &y);
+    if (windowX) *windowX = (int)x;
+    if (windowY) *windowY = (int)y;
+}
 
-    for (i = 0; i < numPoints; i++) {
-        const float px = points[i].x;
-        const float py = points[i].y;
-        points[i].x = (px - centroid.x) * SDL3_cosf(ang) - (py - centroid.y) * SDL3_sinf(ang) + centroid.x;
-        points[i].y = (px - centroid.x) * SDL3_sinf(ang) + (py - centroid.y) * SDL3_cosf(ang) + centroid.y;
+SDL_DECLSPEC int SDLCALL
+SDL_RenderSetLogicalSize(SDL_Renderer *renderer, int w, int h)
+{
+    const RendererState *state = GetRendererState(renderer, false);
+    int retval;
+    SDL_RendererLogicalPresentation mode;
 
-        if (points[i].x < xmin) {
-            xmin = points[i].x;
-        }
-        if (points[i].x > xmax) {
-            xmax = points[i].x;
-        }
-        if (points[i].y < ymin) {
-            ymin = points[i].y;
-        }
-        if (points[i].y > ymax) {
-            ymax = points[i].y;
+    if (w == 0 && h == 0) {
+        mode = SDL_LOGICAL_PRESENTATION_DISABLED;
+    } else if (state && state->integer_scale) {
+        mode = SDL_LOGICAL_PRESENTATION_INTEGER_SCALE;
+    } else {
+        const char *hint = SDL3_GetHint("SDL_RENDER_LOGICAL_SIZE_MODE");
+        if (hint && (*hint == '1' || SDL3_strcasecmp(hint, "overscan") == 0)) {
+            mode = SDL_LOGICAL_PRESENTATION_OVERSCAN;
+        } else {
+            mode = SDL_LOGICAL_PRESENTATION_LETTERBOX;
         }
     }
 
-    /* Scale points to GESTURE_DOLLARSIZE, and translate to the origin */
-    w = xmax - xmin;
-    h = ymax - ymin;
+    retval = (FlushRendererSprites(renderer) == 0 && SDL3_SetRenderLogicalPresentation(renderer, w, h, mode)) ? 0 : -1;
+    return retval < 0 ? retval : FlushRendererIfNotBatching(renderer);
+}
 
-    for (i = 0; i < numPoints; i++) {
-        points[i].x = (points[i].x - centroid.x) * GESTURE_DOLLARSIZE / w;
-        points[i].y = (points[i].y - centroid.y) * GESTURE_DOLLARSIZE / h;
-    }
-    return numPoints;
+SDL_DECLSPEC void SDLCALL
+SDL_RenderGetLogicalSize(SDL_Renderer *renderer, int *w, int *h)
+{
+    SDL3_GetRenderLogicalPresentation(renderer, w, h, NULL);
 }
 
-static float
-GestureDollarRecognize(const GestureDollarPath *path, int *bestTempl, GestureTouch *touch)
+SDL_DECLSPEC int SDLCALL
+SDL_RenderSetIntegerScale(SDL_Renderer *renderer, SDL2_bool enable)
 {
-    SDL_FPoint points[GESTURE_DOLLARNPOINTS];
-    int i;
-    float bestDiff = 10000;
+    RendererState *state = GetRendererState(renderer, true);
+    int w = 0, h = 0;
 
-    SDL3_memset(points, 0, sizeof(points));
+    if (!state) {
+        return -1;
+    }
+    state->integer_scale = enable ? true : false;
+    SDL_RenderGetLogicalSize(renderer, &w, &h);
+    return SDL_RenderSetLogicalSize(renderer, w, h);
+}
 
-    GestureDollarNormalize(path, points, SDL2_FALSE);
+SDL_DECLSPEC SDL2_bool SDLCALL
+SDL_RenderGetIntegerScale(SDL_Renderer *renderer)
+{
+    const RendererState *state = GetRendererState(renderer, false);
+    return (state && state->integer_scale) ? SDL2_TRUE : SDL2_FALSE;
+}
 
-    /* PrintPath(points); */
-    *bestTempl = -1;
-    for (i = 0; i < touch->numDollarTemplates; i++) {
-        const float diff = GestureBestDollarDifference(points, touch->dollarTemplate[i].path);
-        if (diff < bestDiff) {
-            bestDiff = diff;
-            *bestTempl = i;
-        }
-    }
-    return bestDiff;
+SDL_DECLSPEC int SDLCALL
+SDL_RenderSetViewport(SDL_Renderer *renderer, const SDL_Rect *rect)
+{
+    const int retval = (FlushRendererSprites(renderer) == 0 && SDL3_SetRenderViewport(renderer, rect)) ? 0 : -1;
+    return retval < 0 ? retval : FlushRendererIfNotBatching(renderer);
 }
 
-static void
-GestureSendMulti(GestureTouch *touch, float dTheta, float dDist)
+SDL_DECLSPEC int SDLCALL
+SDL_RenderSetClipRect(SDL_Renderer *renderer, const SDL_Rect *rect)
 {
-    if (SDL3_EventEnabled(SDL_MULTIGESTURE)) {
-        SDL2_Event event;
-        event.type = SDL_MULTIGESTURE;
-        event.common.timestamp = 0;
-        event.mgesture.touchId = touch->touchId;
-        event.mgesture.x = touch->centroid.x;
-        event.mgesture.y = touch->centroid.y;
-        event.mgesture.dTheta = dTheta;
-        event.mgesture.dDist = dDist;
-        event.mgesture.numFingers = touch->numDownFingers;
-        SDL_PushEvent(&event);
-    }
+    const int retval = (FlushRendererSprites(renderer) == 0 && SDL3_SetRenderClipRect(renderer, rect)) ? 0 : -1;
+    return retval < 0 ? retval : FlushRendererIfNotBatching(renderer);
 }
 
-static void
-GestureSendDollar(GestureTouch *touch, SDL2_GestureID gestureId, float error)
+static int
+SetRenderTarget(SDL_Renderer *renderer, SDL_Texture *texture)
 {
-    if (SDL3_EventEnabled(SDL_DOLLARGESTURE)) {
-        SDL2_Event event;
-        event.type = SDL_DOLLARGESTURE;
-        event.common.timestamp = 0;
-        event.dgesture.touchId = touch->touchId;
-        event.dgesture.x = touch->centroid.x;
-        event.dgesture.y = touch->centroid.y;
-        event.dgesture.gestureId = gestureId;
-        event.dgesture.error = error;
-        /* A finger came up to trigger this event. */
-        event.dgesture.numFingers = touch->numDownFingers + 1;
-        SDL_PushEvent(&event);
+    if (FlushRendererSprites(renderer) < 0 || !SDL3_SetRenderTarget(renderer, texture)) {
+        return -1;
+    }
+
+    /* SDL2 reset the viewport, scale, and logical presentation for textures.
+        If moving from the backbuffer to a texture, it makes a backup of that
+        state and restores it when moving back to the backbuffer...but SDL3
+        already tracks this state (its "view") separately, so we don't need
+        to reproduce the backup efforts here; the backbuffer view state isn't
+        lost. */
+    if (texture) {
+        SDL_Rect viewport;
+        float w = 0.0f;
+        float h = 0.0f;
+        SDL3_GetTextureSize(texture, &w, &h);
+        viewport.x = 0;
+        viewport.y = 0;
+        viewport.w = (int) w;
+        viewport.h = (int) h;
+        SDL3_SetRenderViewport(renderer, &viewport);
+        SDL3_SetRenderClipRect(renderer, NULL);
+        SDL3_SetRenderScale(renderer, 1.0f, 1.0f);
+        SDL3_SetRenderLogicalPresentation(renderer, w, h, SDL_LOGICAL_PRESENTATION_DISABLED);
     }
+
+    return FlushRendererIfNotBatching(renderer);
 }
 
-static void
-GestureSendDollarRecord(GestureTouch *touch, SDL2_GestureID gestureId)
+SDL_DECLSPEC int SDLCALL
+SDL_SetRenderTarget(SDL_Renderer *renderer, SDL_Texture *texture)
 {
-    if (SDL3_EventEnabled(SDL_DOLLARRECORD)) {
-        SDL2_Event event;
-        event.type = SDL_DOLLARRECORD;
-        event.common.timestamp = 0;
-        event.dgesture.touchId = touch->touchId;
-        event.dgesture.gestureId = gestureId;
-        SDL_PushEvent(&event);
+    RenderTrace trace;
+    Uint64 end_ns;
+    int retval;
+
+    if (!BeginRenderTrace(&trace, renderer, texture)) {
+        return SetRenderTarget(renderer, texture);
     }
+    retval = SetRenderTarget(renderer, texture);
+    end_ns = SDL3_GetTicksNS();
+    EndRenderTrace(&trace, end_ns, RENDER_TRACE_SET_RENDER_TARGET, 0, NULL, 0, NULL, 0);
+    return retval;
+}
+
+static int
+RenderClear(SDL_Renderer *renderer)
+{
+    const int retval = (FlushRendererSprites(renderer) == 0 && SDL3_RenderClear(renderer)) ? 0 : -1;
+    return retval < 0 ? retval : FlushRendererIfNotBatching(renderer);
 }
 
-/* These are SDL3 events coming in from sdl2-compat's event watcher. */
-static void
-GestureProcessEvent(const SDL_Event *event3)
+SDL_DECLSPEC int SDLCALL
+SDL_RenderClear(SDL_Renderer *renderer)
 {
-    float x, y;
-    int i, idx;
-    float pathDx, pathDy;
-    SDL_FPoint lastP;
-    SDL_FPoint lastCentroid;
-    float lDist;
-    float Dist;
-    float dtheta;
-    float dDist;
+    RenderTrace trace;
+    Uint64 end_ns;
+    int retval;
 
-    if (event3->type == SDL_EVENT_FINGER_MOTION || event3->type == SDL_EVENT_FINGER_DOWN || event3->type == SDL_EVENT_FINGER_UP) {
-        GestureTouch *inTouch = GestureGetTouch(event3->tfinger.touchID);
+    if (!BeginRenderTrace(&trace, renderer, NULL)) {
+        return RenderClear(renderer);
+    }
+    retval = RenderClear(renderer);
+    end_ns = SDL3_GetTicksNS();
+    EndRenderTrace(&trace, end_ns, RENDER_TRACE_CLEAR, 0, NULL, 0, NULL, 0);
+    return retval;
+}
 
-        if (inTouch == NULL) {  /* we maybe didn't see this one before. */
-            inTouch = GestureAddTouch(event3->tfinger.touchID);
-            if (!inTouch) {
-                return;  /* oh well. */
-            }
-        }
+static int
+RenderDrawPointF(SDL_Renderer *renderer, float x, float y)
+{
+    int retval;
+    SDL_FPoint fpoint;
+    fpoint.x = x;
+    fpoint.y = y;
+    retval = (FlushRendererSprites(renderer) == 0 && SDL3_RenderPoints(renderer, &fpoint, 1)) ? 0 : -1;
+    return retval < 0 ? retval : FlushRendererIfNotBatching(renderer);
+}
 
-        x = event3->tfinger.x;
-        y = event3->tfinger.y;
+SDL_DECLSPEC int SDLCALL
+SDL_RenderDrawPointF(SDL_Renderer *renderer, float x, float y)
+{
+    RenderTrace trace;
+    SDL_FPoint point;
+    int retval;
 
-        /* Finger Up */
-        if (event3->type == SDL_EVENT_FINGER_UP) {
-            SDL_FPoint path[GESTURE_DOLLARNPOINTS];
-            inTouch->numDownFingers--;
+    if (!BeginRenderTrace(&trace, renderer, NULL)) {
+        return RenderDrawPointF(renderer, x, y);
+    }
+    point.x = x;
+    point.y = y;
+    retval = RenderDrawPointF(renderer, x, y);
+    return EndRenderTraceItems(&trace, RENDER_TRACE_DRAW_POINT_F, &point, 1, sizeof (SDL_FPoint), retval);
+}
 
-            if (inTouch->recording) {
-                inTouch->recording = SDL2_FALSE;
-                GestureDollarNormalize(&inTouch->dollarPath, path, SDL2_TRUE);
-                /* PrintPath(path); */
-                if (GestureRecordAll) {
-                    idx = GestureAddDollar(NULL, path);
-                    for (i = 0; i < GestureNumTouches; i++) {
-                        GestureTouches[i].recording = SDL2_FALSE;
-                    }
-                } else {
-                    idx = GestureAddDollar(inTouch, path);
-                }
+static int
+RenderDrawPoint(SDL_Renderer *renderer, int x, int y)
+{
+    return RenderDrawPointF(renderer, (float)x, (float)y);
+}
 
-                if (idx >= 0) {
-                    GestureSendDollarRecord(inTouch, inTouch->dollarTemplate[idx].hash);
-                } else {
-                    GestureSendDollarRecord(inTouch, -1);
-                }
-            } else {
-                int bestTempl = -1;
-                const float error = GestureDollarRecognize(&inTouch->dollarPath, &bestTempl, inTouch);
-                if (bestTempl >= 0) {
-                    /* Send Event */
-                    Sint64 gestureId = inTouch->dollarTemplate[bestTempl].hash;
-                    GestureSendDollar(inTouch, gestureId, error);
-                    /* printf ("%s\n",);("Dollar error: %f\n",error); */
-                }
-            }
+SDL_DECLSPEC int SDLCALL
+SDL_RenderDrawPoint(SDL_Renderer *renderer, int x, int y)
+{
+    RenderTrace trace;
+    SDL_Point point;
+    int retval;
 
-            /* inTouch->gestureLast[j] = inTouch->gestureLast[inTouch->numDownFingers]; */
-            if (inTouch->numDownFingers > 0) {
-                inTouch->centroid.x = (inTouch->centroid.x * (inTouch->numDownFingers + 1) - x) / inTouch->numDownFingers;
-                inTouch->centroid.y = (inTouch->centroid.y * (inTouch->numDownFingers + 1) - y) / inTouch->numDownFingers;
-            }
-        } else if (event3->type == SDL_EVENT_FINGER_MOTION) {
-            const float dx = event3->tfinger.dx;
-            const float dy = event3->tfinger.dy;
-            GestureDollarPath *path = &inTouch->dollarPath;
-            if (path->numPoints < GESTURE_MAX_DOLLAR_PATH_SIZE) {
-                path->p[path->numPoints].x = inTouch->centroid.x;
-                path->p[path->numPoints].y = inTouch->centroid.y;
-                pathDx = (path->p[path->numPoints].x - path->p[path->numPoints - 1].x);
-                pathDy = (path->p[path->numPoints].y - path->p[path->numPoints - 1].y);
-                path->length += (float)SDL3_sqrt(pathDx * pathDx + pathDy * pathDy);
-                path->numPoints++;
-            }
+    if (!BeginRenderTrace(&trace, renderer, NULL)) {
+        return RenderDrawPoint(renderer, x, y);
+    }
+    point.x = x;
+    point.y = y;
+    retval = RenderDrawPoint(renderer, x, y);
+    return EndRenderTraceItems(&trace, RENDER_TRACE_DRAW_POINT, &point, 1, sizeof (SDL_Point), retval);
+}
 
-            lastP.x = x - dx;
-            lastP.y = y - dy;
-            lastCentroid = inTouch->centroid;
+static int
+RenderDrawPoints(SDL_Renderer *renderer,
+                 const SDL_Point *points, int count)
+{
+    const SDL_FPoint *fpoints;
+    int retval;
 
-            inTouch->centroid.x += dx / inTouch->numDownFingers;
-            inTouch->centroid.y += dy / inTouch->numDownFingers;
-            /* printf("Centrid : (%f,%f)\n",inTouch->centroid.x,inTouch->centroid.y); */
-            if (inTouch->numDownFingers > 1) {
-                SDL_FPoint lv; /* Vector from centroid to last x,y position */
-                SDL_FPoint v;  /* Vector from centroid to current x,y position */
-                /* lv = inTouch->gestureLast[j].cv; */
-                lv.x = lastP.x - lastCentroid.x;
-                lv.y = lastP.y - lastCentroid.y;
-                lDist = SDL3_sqrtf(lv.x * lv.x + lv.y * lv.y);
-                /* printf("lDist = %f\n",lDist); */
-                v.x = x - inTouch->centroid.x;
-                v.y = y - inTouch->centroid.y;
-                /* inTouch->gestureLast[j].cv = v; */
-                Dist = SDL3_sqrtf(v.x * v.x + v.y * v.y);
-                /* SDL3_cosf(dTheta) = (v . lv)/(|v| * |lv|) */
+    if (points == NULL) {
+        SDL3_InvalidParamError("points");
+        return -1;
+    }
+    if (count < 1) {
+        return 0;
+    }
 
-                /* Normalize Vectors to simplify angle calculation */
-                lv.x /= lDist;
-                lv.y /= lDist;
-                v.x /= Dist;
-                v.y /= Dist;
-                dtheta = SDL3_atan2f(lv.x * v.y - lv.y * v.x, lv.x * v.x + lv.y * v.y);
+    fpoints = (const SDL_FPoint *)GetRendererFloats(renderer, (const int *)points, (size_t)count * 2);
+    if (fpoints == NULL) {
+        return -1;
+    }
 
-                dDist = (Dist - lDist);
-                if (lDist == 0) {
-                    /* To avoid impossible values */
-                    dDist = 0;
-                    dtheta = 0;
-                }
+    retval = (FlushRendererSprites(renderer) == 0 && SDL3_RenderPoints(renderer, fpoints, count)) ? 0 : -1;
 
-                /* inTouch->gestureLast[j].dDist = dDist;
-                inTouch->gestureLast[j].dtheta = dtheta;
+    return retval < 0 ? retval : FlushRendererIfNotBatching(renderer);
+}
 
-                printf("dDist = %f, dTheta = %f\n",dDist,dtheta);
-                gdtheta = gdtheta*.9 + dtheta*.1;
-                gdDist  =  gdDist*.9 +  dDist*.1
-                knob.r += dDist/numDownFingers;
-                knob.ang += dtheta;
-                printf("thetaSum = %f, distSum = %f\n",gdtheta,gdDist);
-                printf("id: %i dTheta = %f, dDist = %f\n",j,dtheta,dDist); */
-                GestureSendMulti(inTouch, dtheta, dDist);
-            } else {
-                /* inTouch->gestureLast[j].dDist = 0;
-                inTouch->gestureLast[j].dtheta = 0;
-                inTouch->gestureLast[j].cv.x = 0;
-                inTouch->gestureLast[j].cv.y = 0; */
-            }
-            /* inTouch->gestureLast[j].f.p.x = x;
-            inTouch->gestureLast[j].f.p.y = y;
-            break;
-            pressure? */
-        } else if (event3->type == SDL_EVENT_FINGER_DOWN) {
-            inTouch->numDownFingers++;
-            inTouch->centroid.x = (inTouch->centroid.x * (inTouch->numDownFingers - 1) + x) /
-                                  inTouch->numDownFingers;
-            inTouch->centroid.y = (inTouch->centroid.y * (inTouch->numDownFingers - 1) + y) /
-                                  inTouch->numDownFingers;
-            /* printf("Finger Down: (%f,%f). Centroid: (%f,%f\n",x,y,
-                 inTouch->centroid.x,inTouch->centroid.y); */
+SDL_DECLSPEC int SDLCALL
+SDL_RenderDrawPoints(SDL_Renderer *renderer, const SDL_Point *points, int count)
+{
+    RenderTrace trace;
+    int retval;
 
-            inTouch->dollarPath.length = 0;
-            inTouch->dollarPath.p[0].x = x;
-            inTouch->dollarPath.p[0].y = y;
-            inTouch->dollarPath.numPoints = 1;
-        }
+    if (!BeginRenderTrace(&trace, renderer, NULL)) {
+        return RenderDrawPoints(renderer, points, count);
     }
+    retval = RenderDrawPoints(renderer, points, count);
+    return EndRenderTraceItems(&trace, RENDER_TRACE_DRAW_POINTS, points, count, sizeof (SDL_Point), retval);
 }
 
+static int
+RenderDrawPointsF(SDL_Renderer *renderer, const SDL_FPoint *points, int count)
+{
+    const int retval = (FlushRendererSprites(renderer) == 0 && SDL3_RenderPoints(renderer, points, count)) ? 0 : -1;
+    return retval < 0 ? retval : FlushRendererIfNotBatching(renderer);
+}
 
-/* REQUIRES that bitmap point to a w-by-h bitmap with ppb pixels-per-byte. */
-static void SDL_CalculateShapeBitmap(SDL_WindowShapeMode mode, SDL2_Surface *shape, Uint32 *pixels, int pitch)
+SDL_DECLSPEC int SDLCALL
+SDL_RenderDrawPointsF(SDL_Renderer *renderer, const SDL_FPoint *points, int count)
 {
-    int x = 0;
-    int y = 0;
-    Uint8 r = 0, g = 0, b = 0, alpha = 0;
-    Uint8 *pixel = NULL;
-    Uint32 pixel_value = 0, mask_value = 0;
-    SDL_Color key;
+    RenderTrace trace;
+    int retval;
 
-    for (y = 0; y < shape->h; y++) {
-        for (x = 0; x < shape->w; x++) {
-            alpha = 0;
-            pixel_value = 0;
-            pixel = (Uint8 *)(shape->pixels) + (y * shape->pitch) + (x * shape->format->BytesPerPixel);
-            switch (shape->format->BytesPerPixel) {
-            case 1:
-                pixel_value = *pixel;
-                break;
-            case 2:
-                pixel_value = *(Uint16 *)pixel;
-                break;
-            case 3:
-                pixel_value = *(Uint32 *)pixel & (~shape->format->Amask);
-                break;
-            case 4:
-                pixel_value = *(Uint32 *)pixel;
-                break;
-            }
-            SDL_GetRGBA(pixel_value, shape->format, &r, &g, &b, &alpha);
-            switch (mode.mode) {
-            case (ShapeModeDefault):
-                mask_value = (alpha >= 1 ? 0xFFFFFFFF : 0);
-                break;
-            case (ShapeModeBinarizeAlpha):
-                mask_value = (alpha >= mode.parameters.binarizationCutoff ? 0xFFFFFFFF : 0);
-                break;
-            case (ShapeModeReverseBinarizeAlpha):
-                mask_value = (alpha <= mode.parameters.binarizationCutoff ? 0xFFFFFFFF : 0);
-                break;
-            case (ShapeModeColorKey):
-                key = mode.parameters.colorKey;
-                mask_value = ((key.r != r || key.g != g || key.b != b) ? 0xFFFFFFFF : 0);
-                break;
-            }
-            pixels[x] = mask_value;
-        }
-        pixels = (Uint32 *)((Uint8 *)pixels + pitch);
+    if (!BeginRenderTrace(&trace, renderer, NULL)) {
+        return RenderDrawPointsF(renderer, points, count);
     }
+    retval = RenderDrawPointsF(renderer, points, count);
+    return EndRenderTraceItems(&trace, RENDER_TRACE_DRAW_POINTS_F, points, count, sizeof (SDL_FPoint), retval);
 }
 
-
-SDL_DECLSPEC SDL_Window * SDLCALL
-SDL_CreateShapedWindow(const char *title, unsigned int x, unsigned int y, unsigned int w, unsigned int h, Uint32 flags)
+static int
+RenderDrawLineF(SDL_Renderer *renderer, float x1, float y1, float x2, float y2)
 {
-    flags |= (SDL2_WINDOW_HIDDEN | SDL3_WINDOW_TRANSPARENT);
-
-    return SDL_CreateWindow(title, (int)x, (int)y, (int)w, (int)h, flags);
+    int retval;
+    SDL_FPoint points[2];
+    points[0].x = (float)x1;
+    points[0].y = (float)y1;
+    points[1].x = (float)x2;
+    points[1].y = (float)y2;
+    retval = (FlushRendererSprites(renderer) == 0 && SDL3_RenderLines(renderer, points, 2)) ? 0 : -1;
+    return retval < 0 ? retval : FlushRendererIfNotBatching(renderer);
 }
 
-SDL_DECLSPEC SDL2_bool SDLCALL
-SDL_IsShapedWindow(const SDL_Window *window)
+SDL_DECLSPEC int SDLCALL
+SDL_RenderDrawLineF(SDL_Renderer *renderer, float x1, float y1, float x2, float y2)
 {
-    if (SDL3_GetWindowFlags((SDL_Window *)window) & SDL_WINDOW_TRANSPARENT) {
-        return SDL2_TRUE;
+    RenderTrace trace;
+    SDL_FPoint points[2];
+    int retval;
+
+    if (!BeginRenderTrace(&trace, renderer, NULL)) {
+        return RenderDrawLineF(renderer, x1, y1, x2, y2);
     }
-    return SDL2_FALSE;
+    points[0].x = x1;
+    points[0].y = y1;
+    points[1].x = x2;
+    points[1].y = y2;
+    retval = RenderDrawLineF(renderer, x1, y1, x2, y2);
+    return EndRenderTraceItems(&trace, RENDER_TRACE_DRAW_LINE_F, points, 2, sizeof (SDL_FPoint), retval);
 }
 
-#define PROP_WINDOW_SHAPE_MODE_POINTER "sdl2-compat.window.shape_mode"
+static int
+RenderDrawLine(SDL_Renderer *renderer, int x1, int y1, int x2, int y2)
+{
+    return RenderDrawLineF(renderer, (float) x1, (float) y1, (float) x2, (float) y2);
+}
 
 SDL_DECLSPEC int SDLCALL
-SDL_SetWindowShape(SDL_Window *window, SDL2_Surface *shape, SDL_WindowShapeMode *shape_mode)
+SDL_RenderDrawLine(SDL_Renderer *renderer, int x1, int y1, int x2, int y2)
 {
-    SDL_Surface *surface;
-    int result;
+    RenderTrace trace;
+    SDL_Point points[2];
+    int retval;
 
-    if (!SDL_IsShapedWindow(window)) {
-        return SDL_NONSHAPEABLE_WINDOW;
+    if (!BeginRenderTrace(&trace, renderer, NULL)) {
+        return RenderDrawLine(renderer, x1, y1, x2, y2);
     }
+    points[0].x = x1;
+    points[0].y = y1;
+    points[1].x = x2;
+    points[1].y = y2;
+    retval = RenderDrawLine(renderer, x1, y1, x2, y2);
+    return EndRenderTraceItems(&trace, RENDER_TRACE_DRAW_LINE, points, 2, sizeof (SDL_Point), retval);
+}
 
-    if (shape == NULL) {
-        return SDL_INVALID_SHAPE_ARGUMENT;
-    }
+static int
+RenderDrawLines(SDL_Renderer *renderer, const SDL_Point *points, int count)
+{
+    const SDL_FPoint *fpoints;
+    int retval;
 
-    if (shape_mode == NULL) {
-        return SDL_INVALID_SHAPE_ARGUMENT;
+    if (points == NULL) {
+        SDL3_InvalidParamError("points");
+        return -1;
+    }
+    if (count < 2) {
+        return 0;
     }
 
-    surface = SDL3_CreateSurface(shape->w, shape->h, SDL_PIXELFORMAT_ARGB32);
-    if (!surface) {
+    fpoints = (const SDL_FPoint *)GetRendererFloats(renderer, (const int *)points, (size_t)count * 2);
+    if (fpoints == NULL) {
         return -1;
     }
 
-    SDL_CalculateShapeBitmap(*shape_mode, shape, (Uint32 *)surface->pixels, surface->pitch);
+    retval = (FlushRendererSprites(renderer) == 0 && SDL3_RenderLines(renderer, fpoints, count)) ? 0 : -1;
 
-    result = SDL3_SetWindowShape(window, surface) ? 0 : -1;
-    if (result == 0) {
-        SDL_WindowShapeMode *property = (SDL_WindowShapeMode *)SDL3_malloc(sizeof(*property));
-        if (property) {
-            SDL3_copyp(property, shape_mode);
-            result = SDL3_SetPointerPropertyWithCleanup(SDL3_GetWindowProperties(window), PROP_WINDOW_SHAPE_MODE_POINTER, property, CleanupFreeableProperty, NULL) ? 0 : -1;
-        } else {
-            result = -1;
-        }
-    }
+    return retval < 0 ? retval : FlushRendererIfNotBatching(renderer);
+}
 
-    SDL3_DestroySurface(surface);
+SDL_DECLSPEC int SDLCALL
+SDL_RenderDrawLines(SDL_Renderer *renderer, const SDL_Point *points, int count)
+{
+    RenderTrace trace;
+    int retval;
 
-    if (result == 0) {
-        SDL3_ShowWindow(window);
+    if (!BeginRenderTrace(&trace, renderer, NULL)) {
+        return RenderDrawLines(renderer, points, count);
     }
+    retval = RenderDrawLines(renderer, points, count);
+    return EndRenderTraceItems(&trace, RENDER_TRACE_DRAW_LINES, points, count, sizeof (SDL_Point), retval);
+}
 
-    return result;
+static int
+RenderDrawLinesF(SDL_Renderer *renderer, const SDL_FPoint *points, int count)
+{
+    const int retval = (FlushRendererSprites(renderer) == 0 && SDL3_RenderLines(renderer, points, count)) ? 0 : -1;
+    return retval < 0 ? retval : FlushRendererIfNotBatching(renderer);
 }
 
 SDL_DECLSPEC int SDLCALL
-SDL_GetShapedWindowMode(SDL_Window *window, SDL_WindowShapeMode *shape_mode)
+SDL_RenderDrawLinesF(SDL_Renderer *renderer, const SDL_FPoint *points, int count)
 {
-    SDL_WindowShapeMode *property;
+    RenderTrace trace;
+    int retval;
 
-    if (!SDL_IsShapedWindow(window)) {
-        return SDL_NONSHAPEABLE_WINDOW;
+    if (!BeginRenderTrace(&trace, renderer, NULL)) {
+        return RenderDrawLinesF(renderer, points, count);
     }
+    retval = RenderDrawLinesF(renderer, points, count);
+    return EndRenderTraceItems(&trace, RENDER_TRACE_DRAW_LINES_F, points, count, sizeof (SDL_FPoint), retval);
+}
 
-    property = (SDL_WindowShapeMode *)SDL3_GetPointerProperty(SDL3_GetWindowProperties(window), PROP_WINDOW_SHAPE_MODE_POINTER, NULL);
-    if (!shape_mode && !property) {
-        return SDL_WINDOW_LACKS_SHAPE;
-    }
-    if (shape_mode) {
-        if (property) {
-            SDL3_copyp(shape_mode, property);
-        } else {
-            /* Default parameters */
-            SDL_zerop(shape_mode);
-            shape_mode->mode = ShapeModeDefault;
-            shape_mode->parameters.binarizationCutoff = 1;
-        }
+static int
+RenderDrawRect(SDL_Renderer *renderer, const SDL_Rect *rect)
+{
+    int retval;
+    SDL_FRect frect;
+    SDL_FRect *prect = NULL;
+
+    if (rect) {
+        frect.x = (float)rect->x;
+        frect.y = (float)rect->y;
+        frect.w = (float)rect->w;
+        frect.h = (float)rect->h;
+        prect = &frect;
     }
-    return 0;
-}
 
+    retval = (FlushRendererSprites(renderer) == 0 && SDL3_RenderRect(renderer, prect)) ? 0 : -1;
+    return retval < 0 ? retval : FlushRendererIfNotBatching(renderer);
+}
 
 SDL_DECLSPEC int SDLCALL
-SDL_GetRendererInfo(SDL_Renderer *renderer, SDL2_RendererInfo *info)
+SDL_RenderDrawRect(SDL_Renderer *renderer, const SDL_Rect *rect)
 {
-    const char *name;
-    SDL_PropertiesID props;
-    unsigned int i;
-    const SDL_PixelFormat *formats;
+    RenderTrace trace;
+    int retval;
 
-    if (!info) {
-        SDL3_InvalidParamError("info");
-        return -1;
+    if (!BeginRenderTrace(&trace, renderer, NULL)) {
+        return RenderDrawRect(renderer, rect);
     }
+    retval = RenderDrawRect(renderer, rect);
+    return EndRenderTraceItems(&trace, RENDER_TRACE_DRAW_RECT, rect, 1, sizeof (SDL_Rect), retval);
+}
 
-    name = SDL3_GetRendererName(renderer);
-    if (!name) {
+static int
+RenderDrawRects(SDL_Renderer *renderer, const SDL_Rect *rects, int count)
+{
+    const SDL_FRect *frects;
+    int retval;
+
+    if (rects == NULL) {
+        SDL3_InvalidParamError("rects");
         return -1;
     }
+    if (count < 1) {
+        return 0;
+    }
 
-    SDL3_zerop(info);
+    frects = (const SDL_FRect *)GetRendererFloats(renderer, (const int *)rects, (size_t)count * 4);
+    if (frects == NULL) {
+        return -1;
+    }
 
-    props = SDL3_GetRendererProperties(renderer);
+    retval = (FlushRendererSprites(renderer) == 0 && SDL3_RenderRects(renderer, frects, count)) ? 0 : -1;
 
-    info->name = name;
-    info->max_texture_width = (int)SDL3_GetNumberProperty(props, SDL_PROP_RENDERER_MAX_TEXTURE_SIZE_NUMBER, 0);
-    info->max_texture_height = info->max_texture_width;
+    return retval < 0 ? retval : FlushRendererIfNotBatching(renderer);
+}
 
-    if (SDL3_strcmp(info->name, SDL_SOFTWARE_RENDERER) == 0) {
-        info->flags = SDL2_RENDERER_SOFTWARE | SDL2_RENDERER_TARGETTEXTURE;
-    } else {
-        info->flags = SDL2_RENDERER_ACCELERATED | SDL2_RENDERER_TARGETTEXTURE;
-    }
-    if (SDL3_GetNumberProperty(props, SDL_PROP_RENDERER_VSYNC_NUMBER, 0)) {
-        info->flags |= SDL2_RENDERER_PRESENTVSYNC;
-    }
+SDL_DECLSPEC int SDLCALL
+SDL_RenderDrawRects(SDL_Renderer *renderer, const SDL_Rect *rects, int count)
+{
+    RenderTrace trace;
+    int retval;
 
-    formats = (const SDL_PixelFormat *)SDL3_GetPointerProperty(props, SDL_PROP_RENDERER_TEXTURE_FORMATS_POINTER, NULL);
-    for (i = 0; i < 16 && formats[i]; ++i) {
-        info->texture_formats[i] = formats[i];
+    if (!BeginRenderTrace(&trace, renderer, NULL)) {
+        return RenderDrawRects(renderer, rects, count);
     }
-    info->num_texture_formats = i;
+    retval = RenderDrawRects(renderer, rects, count);
+    return EndRenderTraceItems(&trace, RENDER_TRACE_DRAW_RECTS, rects, count, sizeof (SDL_Rect), retval);
+}
 
-    return 0;
+static int
+RenderDrawRectF(SDL_Renderer *renderer, const SDL_FRect *rect)
+{
+    const int retval = (FlushRendererSprites(renderer) == 0 && SDL3_RenderRect(renderer, rect)) ? 0 : -1;
+    return retval < 0 ? retval : FlushRendererIfNotBatching(renderer);
 }
 
 SDL_DECLSPEC int SDLCALL
-SDL_GetRenderDriverInfo(int idx, SDL2_RendererInfo *info)
+SDL_RenderDrawRectF(SDL_Renderer *renderer, const SDL_FRect *rect)
 {
-    const char *name = SDL3_GetRenderDriver(idx);
-    if (!name) {
-        return -1;  /* assume SDL3_GetRenderDriver set the SDL error. */
-    }
+    RenderTrace trace;
+    int retval;
 
-    SDL3_zerop(info);
-    info->name = name;
+    if (!BeginRenderTrace(&trace, renderer, NULL)) {
+        return RenderDrawRectF(renderer, rect);
+    }
+    retval = RenderDrawRectF(renderer, rect);
+    return EndRenderTraceItems(&trace, RENDER_TRACE_DRAW_RECT_F, rect, 1, sizeof (SDL_FRect), retval);
+}
 
-    /* For render drivers present in SDL2, these are the exact values SDL2 returns.
-       For render drivers new to SDL3, we return only the subset of formats SDL2 supports. */
-    if ((SDL3_strcmp(name, "opengl") == 0) || (SDL3_strcmp(name, "opengles2") == 0)) {
-        info->flags = SDL2_RENDERER_ACCELERATED | SDL2_RENDERER_PRESENTVSYNC | SDL2_RENDERER_TARGETTEXTURE;
-        info->num_texture_formats = 4;
-        info->texture_formats[0] = SDL_PIXELFORMAT_ARGB8888;
-        info->texture_formats[1] = SDL_PIXELFORMAT_ABGR8888;
-        info->texture_formats[2] = SDL_PIXELFORMAT_XRGB8888;
-        info->texture_formats[3] = SDL_PIXELFORMAT_XBGR8888;
-    } else if (SDL3_strcmp(name, "opengles") == 0) {
-        info->flags = SDL2_RENDERER_ACCELERATED | SDL2_RENDERER_PRESENTVSYNC;
-        info->num_texture_formats = 1;
-        info->texture_formats[0] = SDL_PIXELFORMAT_ABGR8888;
-    } else if (SDL3_strcmp(name, "direct3d") == 0) {
-        info->flags = SDL2_RENDERER_ACCELERATED | SDL2_RENDERER_PRESENTVSYNC | SDL2_RENDERER_TARGETTEXTURE;
-        info->num_texture_formats = 1;
-        info->texture_formats[0] = SDL_PIXELFORMAT_ARGB8888;
-    } else if (SDL3_strcmp(name, "direct3d11") == 0) {
-        info->flags = SDL2_RENDERER_ACCELERATED | SDL2_RENDERER_PRESENTVSYNC | SDL2_RENDERER_TARGETTEXTURE;
-        info->num_texture_formats = 6;
-        info->texture_formats[0] = SDL_PIXELFORMAT_ARGB8888;
-        info->texture_formats[1] = SDL_PIXELFORMAT_XRGB8888;
-        info->texture_formats[2] = SDL_PIXELFORMAT_YV12;
-        info->texture_formats[3] = SDL_PIXELFORMAT_IYUV;
-        info->texture_formats[4] = SDL_PIXELFORMAT_NV12;
-        info->texture_formats[5] = SDL_PIXELFORMAT_NV21;
-    } else if (SDL3_strcmp(name, "direct3d12") == 0) {
-        info->flags = SDL2_RENDERER_ACCELERATED | SDL2_RENDERER_PRESENTVSYNC | SDL2_RENDERER_TARGETTEXTURE;
-        info->num_texture_formats = 6;
-        info->texture_formats[0] = SDL_PIXELFORMAT_ARGB8888;
-        info->texture_formats[1] = SDL_PIXELFORMAT_XRGB8888;
-        info->texture_formats[2] = SDL_PIXELFORMAT_YV12;
-        info->texture_formats[3] = SDL_PIXELFORMAT_IYUV;
-        info->texture_formats[4] = SDL_PIXELFORMAT_NV12;
-        info->texture_formats[5] = SDL_PIXELFORMAT_NV21;
-        info->max_texture_width = 16384;
-        info->max_texture_height = 16384;
-    } else if (SDL3_strcmp(name, "metal") == 0) {
-        info->flags = SDL2_RENDERER_ACCELERATED | SDL2_RENDERER_PRESENTVSYNC | SDL2_RENDERER_TARGETTEXTURE;
-        info->num_texture_formats = 6;
-        info->texture_formats[0] = SDL_PIXELFORMAT_ARGB8888;
-        info->texture_formats[1] = SDL_PIXELFORMAT_ABGR8888;
-        info->texture_formats[2] = SDL_PIXELFORMAT_YV12;
-        info->texture_formats[3] = SDL_PIXELFORMAT_IYUV;
-        info->texture_formats[4] = SDL_PIXELFORMAT_NV12;
-        info->texture_formats[5] = SDL_PIXELFORMAT_NV21;
-    } else if (SDL3_strcmp(name, "PS2 gsKit") == 0) {
-        info->flags = SDL2_RENDERER_ACCELERATED | SDL2_RENDERER_PRESENTVSYNC | SDL2_RENDERER_TARGETTEXTURE;
-        info->num_texture_formats = 2;
-        info->texture_formats[0] = SDL_PIXELFORMAT_ABGR1555;
-        info->texture_formats[1] = SDL_PIXELFORMAT_ABGR8888;
-        info->max_texture_width = 1024;
-        info->max_texture_height = 1024;
-    } else if (SDL3_strcmp(name, "PSP") == 0) {
-        info->flags = SDL2_RENDERER_ACCELERATED | SDL2_RENDERER_PRESENTVSYNC | SDL2_RENDERER_TARGETTEXTURE;
-        info->num_texture_formats = 4;
-        info->texture_formats[0] = SDL_PIXELFORMAT_BGR565;
-        info->texture_formats[1] = SDL_PIXELFORMAT_ABGR1555;
-        info->texture_formats[2] = SDL_PIXELFORMAT_ABGR4444;
-        info->texture_formats[3] = SDL_PIXELFORMAT_ABGR8888;
-        info->max_texture_width = 512;
-        info->max_texture_height = 512;
-    } else if (SDL3_strcmp(name, "VITA gxm") == 0) {
-        info->flags = SDL2_RENDERER_ACCELERATED | SDL2_RENDERER_PRESENTVSYNC | SDL2_RENDERER_TARGETTEXTURE;
-        info->num_texture_formats = 8;
-        info->texture_formats[0] = SDL_PIXELFORMAT_ABGR8888;
-        info->texture_formats[1] = SDL_PIXELFORMAT_ARGB8888;
-        info->texture_formats[2] = SDL_PIXELFORMAT_RGB565;
-        info->texture_formats[3] = SDL_PIXELFORMAT_BGR565;
-        info->texture_formats[4] = SDL_PIXELFORMAT_YV12;
-        info->texture_formats[5] = SDL_PIXELFORMAT_IYUV;
-        info->texture_formats[6] = SDL_PIXELFORMAT_NV12;
-        info->texture_formats[7] = SDL_PIXELFORMAT_NV21;
-        info->max_texture_width = 4096;
-        info->max_texture_height = 4096;
-    } else if (SDL3_strcmp(name, "vulkan") == 0) {
-        info->flags = SDL2_RENDERER_ACCELERATED | SDL2_RENDERER_PRESENTVSYNC | SDL2_RENDERER_TARGETTEXTURE;
-        info->num_texture_formats = 2;
-        info->texture_formats[0] = SDL_PIXELFORMAT_ARGB8888;
-        info->texture_formats[1] = SDL_PIXELFORMAT_ABGR8888;
-        info->max_texture_width = 16384;
-        info->max_texture_height = 16384;
-    } else if (SDL3_strcmp(name, "gpu") == 0) {
-        info->flags = SDL2_RENDERER_ACCELERATED | SDL2_RENDERER_PRESENTVSYNC | SDL2_RENDERER_TARGETTEXTURE;
-        info->num_texture_formats = 4;
-        info->texture_formats[0] = SDL_PIXELFORMAT_BGRA32;
-        info->texture_formats[1] = SDL_PIXELFORMAT_RGBA32;
-        info->texture_formats[2] = SDL_PIXELFORMAT_BGRX32;
-        info->texture_formats[3] = SDL_PIXELFORMAT_RGBX32;
-        info->max_texture_width = 16384;
-        info->max_texture_height = 16384;
-    } else if (SDL3_strcmp(name, "software") == 0) {
-        info->flags = SDL2_RENDERER_SOFTWARE | SDL2_RENDERER_PRESENTVSYNC | SDL2_RENDERER_TARGETTEXTURE;
-        info->num_texture_formats = 8;
-        info->texture_formats[0] = SDL_PIXELFORMAT_ARGB8888;
-        info->texture_formats[1] = SDL_PIXELFORMAT_ABGR8888;
-        info->texture_formats[2] = SDL_PIXELFORMAT_RGBA8888;
-        info->texture_formats[3] = SDL_PIXELFORMAT_BGRA8888;
-        info->texture_formats[4] = SDL_PIXELFORMAT_XRGB8888;
-        info->texture_formats[5] = SDL_PIXELFORMAT_XBGR8888;
-        info->texture_formats[6] = SDL_PIXELFORMAT_RGB565;
-        info->texture_formats[7] = SDL_PIXELFORMAT_XRGB1555;
-    } else {  /* this seems reasonable if something currently-unknown shows up in SDL3. */
-        info->flags = SDL2_RENDERER_ACCELERATED | SDL2_RENDERER_PRESENTVSYNC | SDL2_RENDERER_TARGETTEXTURE;
-        info->num_texture_formats = 1;
-        info->texture_formats[0] = SDL_PIXELFORMAT_ARGB8888;
+static int
+RenderDrawRectsF(SDL_Renderer *renderer, const SDL_FRect *rects, int count)
+{
+    const int retval = (FlushRendererSprites(renderer) == 0 && SDL3_RenderRects(renderer, rects, count)) ? 0 : -1;
+    return retval < 0 ? retval : FlushRendererIfNotBatching(renderer);
+}
+
+SDL_DECLSPEC int SDLCALL
+SDL_RenderDrawRectsF(SDL_Renderer *renderer, const SDL_FRect *rects, int count)
+{
+    RenderTrace trace;
+    int retval;
+
+    if (!BeginRenderTrace(&trace, renderer, NULL)) {
+        return RenderDrawRectsF(renderer, rects, count);
     }
-    return 0;
+    retval = RenderDrawRectsF(renderer, rects, count);
+    return EndRenderTraceItems(&trace, RENDER_TRACE_DRAW_RECTS_F, rects, count, sizeof (SDL_FRect), retval);
 }
 
-static int FlushRendererIfNotBatching(SDL_Renderer *renderer)
+static int
+RenderFillRect(SDL_Renderer *renderer, const SDL_Rect *rect)
 {
-    const SDL_PropertiesID props = SDL3_GetRendererProperties(renderer);
-    if (!SDL3_GetBooleanProperty(props, PROP_RENDERER_BATCHING, false)) {
-        return SDL3_FlushRenderer(renderer) ? 0 : -1;
+    int retval;
+    SDL_FRect frect;
+    if (rect) {
+        frect.x = (float)rect->x;
+        frect.y = (float)rect->y;
+        frect.w = (float)rect->w;
+        frect.h = (float)rect->h;
+        retval = (FlushRendererSprites(renderer) == 0 && SDL3_RenderFillRect(renderer, &frect)) ? 0 : -1;
+    } else {
+        retval = (FlushRendererSprites(renderer) == 0 && SDL3_RenderFillRect(renderer, NULL)) ? 0 : -1;
     }
-    return 0;
+    return retval < 0 ? retval : FlushRendererIfNotBatching(renderer);
 }
 
-/* Second parameter changed from an index to a string in SDL3. */
-SDL_DECLSPEC SDL_Renderer *SDLCALL
-SDL_CreateRenderer(SDL_Window *window, int idx, Uint32 flags)
+SDL_DECLSPEC int SDLCALL
+SDL_RenderFillRect(SDL_Renderer *renderer, const SDL_Rect *rect)
 {
-    SDL_PropertiesID props;
-    SDL_Renderer *renderer;
-    const char *name = NULL;
-    char *namecpy = NULL;
+    RenderTrace trace;
+    int retval;
 
-    if (idx == -1) {
-        /* SDL2, if given a bogus render driver name in a hint, would find no match, and then try everything.
-           SDL3 reports failure in this case. PCem tries to create a renderer named "auto" so we need to deal
-           with this. */
-        name = SDL3_GetHint(SDL_HINT_RENDER_DRIVER);
-        if (name) {
-            const int total = SDL3_GetNumRenderDrivers();
-            int i;
-            for (i = 0; i < total; i++) {
-                if (SDL3_strcasecmp(name, SDL3_GetRenderDriver(i)) == 0) {
-                    break;
-                }
-            }
-            if (i == total) {
-                namecpy = SDL3_strdup(name);
-                if (!namecpy) {
-                    return NULL;
-                }
-                name = NULL;  /* set it to NULL so SDL3 will choose a default. */
-                SDL3_SetHint(SDL_HINT_RENDER_DRIVER, NULL);
-            }
-        }
+    if (!BeginRenderTrace(&trace, renderer, NULL)) {
+        return RenderFillRect(renderer, rect);
+    }
+    retval = RenderFillRect(renderer, rect);
+    return EndRenderTraceItems(&trace, RENDER_TRACE_FILL_RECT, rect, 1, sizeof (SDL_Rect), retval);
+}
 
-        /* A valid render driver specified by idx or hint takes precedence over flags */
-        if (!name && (flags & SDL2_RENDERER_SOFTWARE)) {
-            name = SDL_SOFTWARE_RENDERER;
-        }
-    } else {
-        name = SDL3_GetRenderDriver(idx);
-        if (!name) {
-            return NULL;  /* assume SDL3_GetRenderDriver set the SDL error. */
-        }
+static int
+RenderFillRects(SDL_Renderer *renderer, const SDL_Rect *rects, int count)
+{
+    const SDL_FRect *frects;
+    int retval;
+
+    if (rects == NULL) {
+        SDL3_InvalidParamError("rects");
+        return -1;
+    }
+    if (count < 1) {
+        return 0;
     }
 
-    renderer = SDL3_CreateRenderer(window, name);
-    props = SDL3_GetRendererProperties(renderer);
-    if (props) {
-        SDL3_SetBooleanProperty(props, PROP_RENDERER_BATCHING, SDL3_GetHintBoolean("SDL_RENDER_BATCHING", (name == NULL)));
-        SDL3_SetBooleanProperty(props, PROP_RENDERER_RELATIVE_SCALING, SDL3_GetHintBoolean("SDL_MOUSE_RELATIVE_SCALING", true));
+    frects = (const SDL_FRect *)GetRendererFloats(renderer, (const int *)rects, (size_t)count * 4);
+    if (frects == NULL) {
+        return -1;
     }
-    if (flags & SDL2_RENDERER_PRESENTVSYNC) {
-        SDL3_SetRenderVSync(renderer, 1);
+
+    retval = (FlushRendererSprites(renderer) == 0 && SDL3_RenderFillRects(renderer, frects, count)) ? 0 : -1;
+
+    return retval < 0 ? retval : FlushRendererIfNotBatching(renderer);
+}
+
+SDL_DECLSPEC int SDLCALL
+SDL_RenderFillRects(SDL_Renderer *renderer, const SDL_Rect *rects, int count)
+{
+    RenderTrace trace;
+    int retval;
+
+    if (!BeginRenderTrace(&trace, renderer, NULL)) {
+        return RenderFillRects(renderer, rects, count);
     }
+    retval = RenderFillRects(renderer, rects, count);
+    return EndRenderTraceItems(&trace, RENDER_TRACE_FILL_RECTS, rects, count, sizeof (SDL_Rect), retval);
+}
 
-    /* restore original hint. */
-    if (namecpy) {
-        SDL3_SetHint(SDL_HINT_RENDER_DRIVER, namecpy);
-        SDL3_free(namecpy);
+static int
+RenderFillRectF(SDL_Renderer *renderer, const SDL_FRect *rect)
+{
+    const int retval = (FlushRendererSprites(renderer) == 0 && SDL3_RenderFillRect(renderer, rect)) ? 0 : -1;
+    return retval < 0 ? retval : FlushRendererIfNotBatching(renderer);
+}
+
+SDL_DECLSPEC int SDLCALL
+SDL_RenderFillRectF(SDL_Renderer *renderer, const SDL_FRect *rect)
+{
+    RenderTrace trace;
+    int retval;
+
+    if (!BeginRenderTrace(&trace, renderer, NULL)) {
+        return RenderFillRectF(renderer, rect);
     }
+    retval = RenderFillRectF(renderer, rect);
+    return EndRenderTraceItems(&trace, RENDER_TRACE_FILL_RECT_F, rect, 1, sizeof (SDL_FRect), retval);
+}
 
-    return renderer;
+static int
+RenderFillRectsF(SDL_Renderer *renderer, const SDL_FRect *rects, int count)
+{
+    const int retval = (FlushRendererSprites(renderer) == 0 && SDL3_RenderFillRects(renderer, rects, count)) ? 0 : -1;
+    return retval < 0 ? retval : FlushRendererIfNotBatching(renderer);
 }
 
-SDL_DECLSPEC SDL2_bool SDLCALL
-SDL_RenderTargetSupported(SDL_Renderer *renderer)
+SDL_DECLSPEC int SDLCALL
+SDL_RenderFillRectsF(SDL_Renderer *renderer, const SDL_FRect *rects, int count)
 {
-    /* All SDL3 renderers support target textures */
-    return SDL2_TRUE;
+    RenderTrace trace;
+    int retval;
+
+    if (!BeginRenderTrace(&trace, renderer, NULL)) {
+        return RenderFillRectsF(renderer, rects, count);
+    }
+    retval = RenderFillRectsF(renderer, rects, count);
+    return EndRenderTraceItems(&trace, RENDER_TRACE_FILL_RECTS_F, rects, count, sizeof (SDL_FRect), retval);
 }
 
-SDL_DECLSPEC void SDLCALL
-SDL_RenderGetViewport(SDL_Renderer *renderer, SDL_Rect *rect)
+/* Clip the source rectangle to the texture, without changing the destination, like SDL3_RenderTexture() does.
+ * Returns false if there's nothing left to draw.
+ */
+static bool GetSpriteSource(const SDL_Rect *srcrect, float tex_w, float tex_h, SDL_FRect *src)
 {
-    SDL3_GetRenderViewport(renderer, rect);
+    SDL_FRect rect;
+
+    src->x = 0.0f;
+    src->y = 0.0f;
+    src->w = tex_w;
+    src->h = tex_h;
+    if (!srcrect) {
+        return true;
+    }
+    rect.x = (float)srcrect->x;
+    rect.y = (float)srcrect->y;
+    rect.w = (float)srcrect->w;
+    rect.h = (float)srcrect->h;
+    return SDL3_GetRectIntersectionFloat(&rect, src, src);
 }
 
-SDL_DECLSPEC SDL2_bool SDLCALL
-SDL_SetClipRect(SDL2_Surface *surface, const SDL_Rect *rect)
+/* With SDL2_RENDER_MERGE_COPIES, copies are queued so the ones in a row with the same texture are drawn together.
+ * Returns 1 if the copy was queued, 0 if it should be drawn right away, or -1 on error.
+ */
+static int QueueRenderCopy(SDL_Renderer *renderer, SDL_Texture *texture, const SDL_Rect *srcrect, const SDL_FRect *dstrect)
 {
-    SDL_Rect full_rect;
+    RendererState *state;
+    SDL_Vertex *vertices;
+    SDL_FRect src;
+    SDL_FColor color;
+    float tex_w = 0.0f, tex_h = 0.0f;
+    Uint8 r = 255, g = 255, b = 255, a = 255;
 
-    /* Don't do anything if there's no surface to act on */
-    if (!surface) {
-        return SDL2_FALSE;
+    /* A NULL destination is the whole viewport, which SDL3 works out when the copy is drawn */
+    if (!dstrect || SDL3_GetAtomicInt(&NumMergingRenderers) == 0) {
+        return 0;
+    }
+    state = GetRendererState(renderer, false);
+    if (!state || !state->merge_copies || SDL3_GetRendererFromTexture(texture) != renderer) {
+        return 0;
     }
 
-    SDL3_SetSurfaceClipRect(Surface2to3(surface), rect);
+    SDL3_GetTextureSize(texture, &tex_w, &tex_h);
+    if (!GetSpriteSource(srcrect, tex_w, tex_h, &src)) {
+        return 1;
+    }
 
-    /* Set up the full surface rectangle */
-    full_rect.x = 0;
-    full_rect.y = 0;
-    full_rect.w = surface->w;
-    full_rect.h = surface->h;
+    /* The texture's color and alpha mod can change before the copy is drawn, so they go in the vertices */
+    SDL3_GetTextureColorMod(texture, &r, &g, &b);
+    SDL3_GetTextureAlphaMod(texture, &a);
+    color.r = r / 255.0f;
+    color.g = g / 255.0f;
+    color.b = b / 255.0f;
+    color.a = a / 255.0f;
 
-    /* Set the clipping rectangle */
-    if (!rect) {
-        surface->clip_rect = full_rect;
-        return SDL2_TRUE;
+    vertices = QueueSprite(state, texture);
+    if (!vertices) {
+        return -1;
     }
-    return SDL3_GetRectIntersection(rect, &full_rect, &surface->clip_rect) ? SDL2_TRUE : SDL2_FALSE;
+    MakeSpriteVertices(vertices, tex_w, tex_h, &src, dstrect, 0.0, SDL_FLIP_NONE, &color);
+    return 1;
 }
 
-SDL_DECLSPEC void SDLCALL
-SDL_RenderGetClipRect(SDL_Renderer *renderer, SDL_Rect *rect)
+static int
+RenderCopy(SDL_Renderer *renderer, SDL_Texture *texture, const SDL_Rect *srcrect, const SDL_Rect *dstrect)
 {
-    SDL3_GetRenderClipRect(renderer, rect);
+    int retval;
+    SDL_FRect srcfrect;
+    SDL_FRect *psrcfrect = NULL;
+    SDL_FRect dstfrect;
+    SDL_FRect *pdstfrect = NULL;
+    if (srcrect) {
+        srcfrect.x = (float)srcrect->x;
+        srcfrect.y = (float)srcrect->y;
+        srcfrect.w = (float)srcrect->w;
+        srcfrect.h = (float)srcrect->h;
+        psrcfrect = &srcfrect;
+    }
+    if (dstrect) {
+        dstfrect.x = (float)dstrect->x;
+        dstfrect.y = (float)dstrect->y;
+        dstfrect.w = (float)dstrect->w;
+        dstfrect.h = (float)dstrect->h;
+        pdstfrect = &dstfrect;
+    }
+    retval = QueueRenderCopy(renderer, texture, srcrect, pdstfrect);
+    if (retval != 0) {
+        return retval < 0 ? retval : 0;
+    }
+    retval = (FlushRendererSprites(renderer) == 0 && SDL3_RenderTexture(renderer, texture, psrcfrect, pdstfrect)) ? 0 : -1;
+    return retval < 0 ? retval : FlushRendererIfNotBatching(renderer);
 }
 
-SDL_DECLSPEC void SDLCALL
-SDL_RenderGetScale(SDL_Renderer *renderer, float *scaleX, float *scaleY)
+SDL_DECLSPEC int SDLCALL
+SDL_RenderCopy(SDL_Renderer *renderer, SDL_Texture *texture, const SDL_Rect *srcrect, const SDL_Rect *dstrect)
 {
-    int w = 0, h = 0;
-    SDL_FRect rect;
+    RenderTrace trace;
+    SDL_FRect dstfrect;
+    int retval;
 
-    SDL3_GetRenderScale(renderer, scaleX, scaleY);
+    if (!BeginRenderTrace(&trace, renderer, texture)) {
+        return RenderCopy(renderer, texture, srcrect, dstrect);
+    }
+    retval = RenderCopy(renderer, texture, srcrect, dstrect);
+    if (dstrect) {
+        dstfrect.x = (float)dstrect->x;
+        dstfrect.y = (float)dstrect->y;
+        dstfrect.w = (float)dstrect->w;
+        dstfrect.h = (float)dstrect->h;
+    }
+    return EndRenderTraceCopy(&trace, RENDER_TRACE_COPY, texture, srcrect, dstrect ? &dstfrect : NULL, 0.0, NULL, SDL_FLIP_NONE, retval);
+}
 
-    /* Include the logical scale */
-    SDL3_GetRenderLogicalPresentation(renderer, &w, &h, NULL);
-    SDL3_GetRenderLogicalPresentationRect(renderer, &rect);
-    if (scaleX && w > 0) {
-        *scaleX *= rect.w / w;
+static int
+RenderCopyF(SDL_Renderer *renderer, SDL_Texture *texture, const SDL_Rect *srcrect, const SDL_FRect *dstrect)
+{
+    int retval;
+    SDL_FRect srcfrect;
+    SDL_FRect *psrcfrect = NULL;
+
+    retval = QueueRenderCopy(renderer, texture, srcrect, dstrect);
+    if (retval != 0) {
+        return retval < 0 ? retval : 0;
     }
-    if (scaleY && h > 0) {
-        *scaleY *= rect.h / h;
+    if (srcrect) {
+        srcfrect.x = (float)srcrect->x;
+        srcfrect.y = (float)srcrect->y;
+        srcfrect.w = (float)srcrect->w;
+        srcfrect.h = (float)srcrect->h;
+        psrcfrect = &srcfrect;
     }
+    retval = (FlushRendererSprites(renderer) == 0 && SDL3_RenderTexture(renderer, texture, psrcfrect, dstrect)) ? 0 : -1;
+    return retval < 0 ? retval : FlushRendererIfNotBatching(renderer);
 }
 
-SDL_DECLSPEC void SDLCALL
-SDL_RenderWindowToLogical(SDL_Renderer *renderer,
-                          int windowX, int windowY,
-                          float *logicalX, float *logicalY)
+SDL_DECLSPEC int SDLCALL
+SDL_RenderCopyF(SDL_Renderer *renderer, SDL_Texture *texture, const SDL_Rect *srcrect, const SDL_FRect *dstrect)
 {
-    SDL3_RenderCoordinatesFromWindow(renderer, (float)windowX, (float)windowY, logicalX, logicalY);
+    RenderTrace trace;
+    int retval;
+
+    if (!BeginRenderTrace(&trace, renderer, texture)) {
+        return RenderCopyF(renderer, texture, srcrect, dstrect);
+    }
+    retval = RenderCopyF(renderer, texture, srcrect, dstrect);
+    return EndRenderTraceCopy(&trace, RENDER_TRACE_COPY_F, texture, srcrect, dstrect, 0.0, NULL, SDL_FLIP_NONE, retval);
+}
+
+static int
+RenderCopyEx(SDL_Renderer *renderer, SDL_Texture *texture,
+             const SDL_Rect *srcrect, const SDL_Rect *dstrect,
+             const double angle, const SDL_Point *center, const SDL_FlipMode flip)
+{
+    int retval;
+    SDL_FRect srcfrect;
+    SDL_FRect *psrcfrect = NULL;
+    SDL_FRect dstfrect;
+    SDL_FRect *pdstfrect = NULL;
+    SDL_FPoint fcenter;
+    SDL_FPoint *pfcenter = NULL;
+
+    if (srcrect) {
+        srcfrect.x = (float)srcrect->x;
+        srcfrect.y = (float)srcrect->y;
+        srcfrect.w = (float)srcrect->w;
+        srcfrect.h = (float)srcrect->h;
+        psrcfrect = &srcfrect;
+    }
+
+    if (dstrect) {
+        dstfrect.x = (float)dstrect->x;
+        dstfrect.y = (float)dstrect->y;
+        dstfrect.w = (float)dstrect->w;
+        dstfrect.h = (float)dstrect->h;
+        pdstfrect = &dstfrect;
+    }
+
+    if (center) {
+        fcenter.x = (float)center->x;
+        fcenter.y = (float)center->y;
+        pfcenter = &fcenter;
+    }
+
+    retval = (FlushRendererSprites(renderer) == 0 && SDL3_RenderTextureRotated(renderer, texture, psrcfrect, pdstfrect, angle, pfcenter, flip)) ? 0 : -1;
+    return retval < 0 ? retval : FlushRendererIfNotBatching(renderer);
 }
 
-SDL_DECLSPEC void SDLCALL
-SDL_RenderLogicalToWindow(SDL_Renderer *renderer,
-                          float logicalX, float logicalY,
-                          int *windowX, int *windowY)
+SDL_DECLSPEC int SDLCALL
+SDL_RenderCopyEx(SDL_Renderer *renderer, SDL_Texture *texture,
+                 const SDL_Rect *srcrect, const SDL_Rect *dstrect,
+                 const double angle, const SDL_Point *center, const SDL_FlipMode flip)
 {
-    float x, y;
-    SDL3_RenderCoordinatesToWindow(renderer, logicalX, logicalY, &x, &y);
-    if (windowX) *windowX = (int)x;
-    if (windowY) *windowY = (int)y;
+    RenderTrace trace;
+    SDL_FRect dstfrect;
+    SDL_FPoint fcenter;
+    int retval;
+
+    if (!BeginRenderTrace(&trace, renderer, texture)) {
+        return RenderCopyEx(renderer, texture, srcrect, dstrect, angle, center, flip);
+    }
+    retval = RenderCopyEx(renderer, texture, srcrect, dstrect, angle, center, flip);
+    if (dstrect) {
+        dstfrect.x = (float)dstrect->x;
+        dstfrect.y = (float)dstrect->y;
+        dstfrect.w = (float)dstrect->w;
+        dstfrect.h = (float)dstrect->h;
+    }
+    if (center) {
+        fcenter.x = (float)center->x;
+        fcenter.y = (float)center->y;
+    }
+    return EndRenderTraceCopy(&trace, RENDER_TRACE_COPY_EX, texture, srcrect, dstrect ? &dstfrect : NULL, angle, center ? &fcenter : NULL, flip, retval);
 }
 
-SDL_DECLSPEC int SDLCALL
-SDL_RenderSetLogicalSize(SDL_Renderer *renderer, int w, int h)
+static int
+RenderCopyExF(SDL_Renderer *renderer, SDL_Texture *texture,
+              const SDL_Rect *srcrect, const SDL_FRect *dstrect,
+              const double angle, const SDL_FPoint *center, const SDL_FlipMode flip)
 {
     int retval;
-    SDL_RendererLogicalPresentation mode;
+    SDL_FRect srcfrect;
+    SDL_FRect *psrcfrect = NULL;
 
-    if (w == 0 && h == 0) {
-        mode = SDL_LOGICAL_PRESENTATION_DISABLED;
-    } else if (SDL3_GetBooleanProperty(SDL3_GetRendererProperties(renderer), PROP_RENDERER_INTEGER_SCALE, false)) {
-        mode = SDL_LOGICAL_PRESENTATION_INTEGER_SCALE;
-    } else {
-        const char *hint = SDL3_GetHint("SDL_RENDER_LOGICAL_SIZE_MODE");
-        if (hint && (*hint == '1' || SDL3_strcasecmp(hint, "overscan") == 0)) {
-            mode = SDL_LOGICAL_PRESENTATION_OVERSCAN;
-        } else {
-            mode = SDL_LOGICAL_PRESENTATION_LETTERBOX;
-        }
+    if (srcrect) {
+        srcfrect.x = (float)srcrect->x;
+        srcfrect.y = (float)srcrect->y;
+        srcfrect.w = (float)srcrect->w;
+        srcfrect.h = (float)srcrect->h;
+        psrcfrect = &srcfrect;
     }
 
-    retval = SDL3_SetRenderLogicalPresentation(renderer, w, h, mode) ? 0 : -1;
+    retval = (FlushRendererSprites(renderer) == 0 && SDL3_RenderTextureRotated(renderer, texture, psrcfrect, dstrect, angle, center, flip)) ? 0 : -1;
     return retval < 0 ? retval : FlushRendererIfNotBatching(renderer);
 }
 
-SDL_DECLSPEC void SDLCALL
-SDL_RenderGetLogicalSize(SDL_Renderer *renderer, int *w, int *h)
+SDL_DECLSPEC int SDLCALL
+SDL_RenderCopyExF(SDL_Renderer *renderer, SDL_Texture *texture,
+                  const SDL_Rect *srcrect, const SDL_FRect *dstrect,
+                  const double angle, const SDL_FPoint *center, const SDL_FlipMode flip)
 {
-    SDL3_GetRenderLogicalPresentation(renderer, w, h, NULL);
+    RenderTrace trace;
+    int retval;
+
+    if (!BeginRenderTrace(&trace, renderer, texture)) {
+        return RenderCopyExF(renderer, texture, srcrect, dstrect, angle, center, flip);
+    }
+    retval = RenderCopyExF(renderer, texture, srcrect, dstrect, angle, center, flip);
+    return EndRenderTraceCopy(&trace, RENDER_TRACE_COPY_EX_F, texture, srcrect, dstrect, angle, center, flip, retval);
 }
 
-SDL_DECLSPEC int SDLCALL
-SDL_RenderSetIntegerScale(SDL_Renderer *renderer, SDL2_bool enable)
+/* SDL_Color as a little endian Uint32, whatever its alignment */
+static Uint32 LoadColor32(const Uint8 *color)
 {
-    int w = 0, h = 0;
-
-    SDL3_SetBooleanProperty(SDL3_GetRendererProperties(renderer), PROP_RENDERER_INTEGER_SCALE, enable);
-    SDL_RenderGetLogicalSize(renderer, &w, &h);
-    return SDL_RenderSetLogicalSize(renderer, w, h);
+    return (Uint32)color[0] | ((Uint32)color[1] << 8) | ((Uint32)color[2] << 16) | ((Uint32)color[3] << 24);
 }
 
-SDL_DECLSPEC SDL2_bool SDLCALL
-SDL_RenderGetIntegerScale(SDL_Renderer *renderer)
+static void ConvertColorsToFloats(const Uint8 *src, int stride, SDL_FColor *dst, int count)
 {
-    return SDL3_GetBooleanProperty(SDL3_GetRendererProperties(renderer), PROP_RENDERER_INTEGER_SCALE, false) ? SDL2_TRUE : SDL2_FALSE;
+    int i;
+    for (i = 0; i < count; ++i, src += stride) {
+        dst[i].r = src[0] / 255.0f;
+        dst[i].g = src[1] / 255.0f;
+        dst[i].b = src[2] / 255.0f;
+        dst[i].a = src[3] / 255.0f;
+    }
 }
 
-SDL_DECLSPEC int SDLCALL
-SDL_RenderSetViewport(SDL_Renderer *renderer, const SDL_Rect *rect)
+/* These divide, rather than multiply by 1/255, so the results are exactly the same as ConvertColorsToFloats() */
+#ifdef SDL_SSE2_INTRINSICS
+static void SDL_TARGETING("sse2") ConvertColorsToFloats_SSE2(const Uint8 *src, int stride, SDL_FColor *dst, int count)
 {
-    const int retval = SDL3_SetRenderViewport(renderer, rect) ? 0 : -1;
-    return retval < 0 ? retval : FlushRendererIfNotBatching(renderer);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 scale = _mm_set1_ps(255.0f);
+    float *out = &dst->r;
+    int i = 0;
+
+    for (; i + 4 <= count; i += 4, src += 4 * stride, out += 16) {
+        const __m128i colors = _mm_setr_epi32((int)LoadColor32(src), (int)LoadColor32(src + stride),
+                                              (int)LoadColor32(src + 2 * stride), (int)LoadColor32(src + 3 * stride));
+        const __m128i lo = _mm_unpacklo_epi8(colors, zero);
+        const __m128i hi = _mm_unpackhi_epi8(colors, zero);
+
+        _mm_storeu_ps(out, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), scale));
+        _mm_storeu_ps(out + 4, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), scale));
+        _mm_storeu_ps(out + 8, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), scale));
+        _mm_storeu_ps(out + 12, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), scale));
+    }
+    ConvertColorsToFloats(src, stride, &dst[i], count - i);
 }
+#endif /* SDL_SSE2_INTRINSICS */
 
-SDL_DECLSPEC int SDLCALL
-SDL_RenderSetClipRect(SDL_Renderer *renderer, const SDL_Rect *rect)
+#if defined(SDL_NEON_INTRINSICS) && (defined(__aarch64__) || defined(_M_ARM64))
+#define HAVE_COLOR_NEON
+
+static void ConvertColorsToFloats_NEON(const Uint8 *src, int stride, SDL_FColor *dst, int count)
 {
-    const int retval = SDL3_SetRenderClipRect(renderer, rect) ? 0 : -1;
-    return retval < 0 ? retval : FlushRendererIfNotBatching(renderer);
+    const float32x4_t scale = vdupq_n_f32(255.0f);
+    float *out = &dst->r;
+    int i = 0;
+
+    for (; i + 4 <= count; i += 4, src += 4 * stride, out += 16) {
+        uint32x4_t colors = vdupq_n_u32(LoadColor32(src));
+        uint16x8_t lo, hi;
+
+        colors = vsetq_lane_u32(LoadColor32(src + stride), colors, 1);
+        colors = vsetq_lane_u32(LoadColor32(src + 2 * stride), colors, 2);
+        colors = vsetq_lane_u32(LoadColor32(src + 3 * stride), colors, 3);
+        lo = vmovl_u8(vget_low_u8(vreinterpretq_u8_u32(colors)));
+        hi = vmovl_u8(vget_high_u8(vreinterpretq_u8_u32(colors)));
+
+        vst1q_f32(out, vdivq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(lo))), scale));
+        vst1q_f32(out + 4, vdivq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(lo))), scale));
+        vst1q_f32(out + 8, vdivq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(hi))), scale));
+        vst1q_f32(out + 12, vdivq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(hi))), scale));
+    }
+    ConvertColorsToFloats(src, stride, &dst[i], count - i);
 }
+#endif /* HAVE_COLOR_NEON */
 
-SDL_DECLSPEC int SDLCALL
-SDL_SetRenderTarget(SDL_Renderer *renderer, SDL_Texture *texture)
+/* Convert the vertex colors into the renderer's scratch buffer. If every vertex has the same color,
+ * which is common for UI and sprites, that color is converted once and copied.
+ */
+static const SDL_FColor *GetRendererColors(SDL_Renderer *renderer, const SDL_Color *color, int color_stride, int num_vertices)
 {
-    if (!SDL3_SetRenderTarget(renderer, texture)) {
-        return -1;
+    void (*convert)(const Uint8 *src, int stride, SDL_FColor *dst, int count) = ConvertColorsToFloats;
+    const Uint8 *src = (const Uint8 *)color;
+    const Uint8 *next;
+    SDL_FColor *colors;
+    Uint32 first;
+    int i;
+
+    colors = (SDL_FColor *)GetRendererScratch(renderer, (size_t)num_vertices * sizeof(SDL_FColor));
+    if (!colors) {
+        return NULL;
     }
 
-    /* SDL2 reset the viewport, scale, and logical presentation for textures.
-        If moving from the backbuffer to a texture, it makes a backup of that
-        state and restores it when moving back to the backbuffer...but SDL3
-        already tracks this state (its "view") separately, so we don't need
-        to reproduce the backup efforts here; the backbuffer view state isn't
-        lost. */
-    if (texture) {
-        SDL_Rect viewport;
-        float w = 0.0f;
-        float h = 0.0f;
-        SDL3_GetTextureSize(texture, &w, &h);
-        viewport.x = 0;
-        viewport.y = 0;
-        viewport.w = (int) w;
-        viewport.h = (int) h;
-        SDL3_SetRenderViewport(renderer, &viewport);
-        SDL3_SetRenderClipRect(renderer, NULL);
-        SDL3_SetRenderScale(renderer, 1.0f, 1.0f);
-        SDL3_SetRenderLogicalPresentation(renderer, w, h, SDL_LOGICAL_PRESENTATION_DISABLED);
+    first = LoadColor32(src);
+    for (i = 1, next = src + color_stride; i < num_vertices; ++i, next += color_stride) {
+        if (LoadColor32(next) != first) {
+            break;
+        }
+    }
+    if (i == num_vertices) {
+        ConvertColorsToFloats(src, 0, colors, 1);
+        for (i = 1; i < num_vertices; ++i) {
+            colors[i] = colors[0];
+        }
+        return colors;
     }
 
-    return FlushRendererIfNotBatching(renderer);
+#ifdef SDL_SSE2_INTRINSICS
+    if (SDL3_HasSSE2()) {
+        convert = ConvertColorsToFloats_SSE2;
+    }
+#endif
+#ifdef HAVE_COLOR_NEON
+    if (SDL3_HasNEON()) {
+        convert = ConvertColorsToFloats_NEON;
+    }
+#endif
+    convert(src, color_stride, colors, num_vertices);
+    return colors;
 }
 
-SDL_DECLSPEC int SDLCALL
-SDL_RenderClear(SDL_Renderer *renderer)
+static int
+RenderGeometry(SDL_Renderer *renderer, SDL_Texture *texture, const SDL2_Vertex *vertices, int num_vertices, const int *indices, int num_indices)
 {
-    const int retval = SDL3_RenderClear(renderer) ? 0 : -1;
-    return retval < 0 ? retval : FlushRendererIfNotBatching(renderer);
+    if (vertices) {
+        const float *xy = &vertices->position.x;
+        int xy_stride = sizeof(SDL2_Vertex);
+        const SDL_Color *color = &vertices->color;
+        int color_stride = sizeof(SDL2_Vertex);
+        const float *uv = &vertices->tex_coord.x;
+        int uv_stride = sizeof(SDL2_Vertex);
+        int size_indices = 4;
+        return SDL_RenderGeometryRaw(renderer, texture, xy, xy_stride, color, color_stride, uv, uv_stride, num_vertices, indices, num_indices, size_indices);
+    }
+    SDL3_InvalidParamError("vertices");
+    return -1;
 }
 
 SDL_DECLSPEC int SDLCALL
-SDL_RenderDrawPointF(SDL_Renderer *renderer, float x, float y)
+SDL_RenderGeometry(SDL_Renderer *renderer, SDL_Texture *texture, const SDL2_Vertex *vertices, int num_vertices, const int *indices, int num_indices)
 {
+    RenderTrace trace;
     int retval;
-    SDL_FPoint fpoint;
-    fpoint.x = x;
-    fpoint.y = y;
-    retval = SDL3_RenderPoints(renderer, &fpoint, 1) ? 0 : -1;
-    return retval < 0 ? retval : FlushRendererIfNotBatching(renderer);
-}
 
-SDL_DECLSPEC int SDLCALL
-SDL_RenderDrawPoint(SDL_Renderer *renderer, int x, int y)
-{
-    return SDL_RenderDrawPointF(renderer, (float)x, (float)y);
+    if (!BeginRenderTrace(&trace, renderer, texture)) {
+        return RenderGeometry(renderer, texture, vertices, num_vertices, indices, num_indices);
+    }
+    retval = RenderGeometry(renderer, texture, vertices, num_vertices, indices, num_indices);
+    return EndRenderTraceGeometry(&trace, RENDER_TRACE_GEOMETRY, texture,
+                                  vertices ? &vertices->position.x : NULL, sizeof(SDL2_Vertex),
+                                  vertices ? &vertices->color : NULL, sizeof(SDL2_Vertex),
+                                  vertices ? &vertices->tex_coord.x : NULL, sizeof(SDL2_Vertex),
+                                  num_vertices, indices, num_indices, 4, retval);
 }
 
-SDL_DECLSPEC int SDLCALL
-SDL_RenderDrawPoints(SDL_Renderer *renderer,
-                     const SDL_Point *points, int count)
+static int
+RenderGeometryRaw(SDL_Renderer *renderer, SDL_Texture *texture, const float *xy, int xy_stride, const SDL_Color *color, int color_stride, const float *uv, int uv_stride, int num_vertices, const void *indices, int num_indices, int size_indices)
 {
-    SDL_FPoint *fpoints;
-    int i;
+    const SDL_FColor *color3;
     int retval;
-    int isstack;
 
-    if (points == NULL) {
-        SDL3_InvalidParamError("points");
+    if (num_vertices <= 0) {
+        SDL3_InvalidParamError("num_vertices");
         return -1;
     }
-
-    fpoints = SDL3_small_alloc(SDL_FPoint, count, &isstack);
-    if (fpoints == NULL) {
+    if (!color) {
+        SDL3_InvalidParamError("color");
         return -1;
     }
 
-    for (i = 0; i < count; ++i) {
-        fpoints[i].x = (float)points[i].x;
-        fpoints[i].y = (float)points[i].y;
+    color3 = GetRendererColors(renderer, color, color_stride, num_vertices);
+    if (!color3) {
+        return -1;
     }
 
-    retval = SDL3_RenderPoints(renderer, fpoints, count) ? 0 : -1;
-
-    SDL3_small_free(fpoints, isstack);
-
-    return retval < 0 ? retval : FlushRendererIfNotBatching(renderer);
-}
-
-SDL_DECLSPEC int SDLCALL
-SDL_RenderDrawPointsF(SDL_Renderer *renderer, const SDL_FPoint *points, int count)
-{
-    const int retval = SDL3_RenderPoints(renderer, points, count) ? 0 : -1;
+    color_stride = sizeof(SDL_FColor);
+    retval = (FlushRendererSprites(renderer) == 0 && SDL3_RenderGeometryRaw(renderer, texture, xy, xy_stride, color3, color_stride, uv, uv_stride, num_vertices, indices, num_indices, size_indices)) ? 0 : -1;
     return retval < 0 ? retval : FlushRendererIfNotBatching(renderer);
 }
 
 SDL_DECLSPEC int SDLCALL
-SDL_RenderDrawLineF(SDL_Renderer *renderer, float x1, float y1, float x2, float y2)
+SDL_RenderGeometryRaw(SDL_Renderer *renderer, SDL_Texture *texture, const float *xy, int xy_stride, const SDL_Color *color, int color_stride, const float *uv, int uv_stride, int num_vertices, const void *indices, int num_indices, int size_indices)
 {
+    RenderTrace trace;
     int retval;
-    SDL_FPoint points[2];
-    points[0].x = (float)x1;
-    points[0].y = (float)y1;
-    points[1].x = (float)x2;
-    points[1].y = (float)y2;
-    retval = SDL3_RenderLines(renderer, points, 2) ? 0 : -1;
-    return retval < 0 ? retval : FlushRendererIfNotBatching(renderer);
-}
 
-SDL_DECLSPEC int SDLCALL
-SDL_RenderDrawLine(SDL_Renderer *renderer, int x1, int y1, int x2, int y2)
-{
-    return SDL_RenderDrawLineF(renderer, (float) x1, (float) y1, (float) x2, (float) y2);
+    if (!BeginRenderTrace(&trace, renderer, texture)) {
+        return RenderGeometryRaw(renderer, texture, xy, xy_stride, color, color_stride, uv, uv_stride, num_vertices, indices, num_indices, size_indices);
+    }
+    retval = RenderGeometryRaw(renderer, texture, xy, xy_stride, color, color_stride, uv, uv_stride, num_vertices, indices, num_indices, size_indices);
+    return EndRenderTraceGeometry(&trace, RENDER_TRACE_GEOMETRY_RAW, texture, xy, xy_stride, color, color_stride, uv, uv_stride,
+                                  num_vertices, indices, num_indices, size_indices, retval);
 }
 
-SDL_DECLSPEC int SDLCALL
-SDL_RenderDrawLines(SDL_Renderer *renderer, const SDL_Point *points, int count)
+static int
+RenderSprites(SDL_Renderer *renderer, const SDL2_CompatSprite *sprites, int count)
 {
-    SDL_FPoint *fpoints;
+    RendererState *state;
+    SDL_Texture *texture = NULL;
+    float tex_w = 0.0f, tex_h = 0.0f;
+    int retval = 0;
     int i;
-    int retval;
-    int isstack;
 
-    if (points == NULL) {
-        SDL3_InvalidParamError("points");
+    if (count < 0) {
+        SDL3_InvalidParamError("count");
         return -1;
     }
-    if (count < 2) {
-        return 0;
+    if (!sprites && count > 0) {
+        SDL3_InvalidParamError("sprites");
+        return -1;
     }
 
-    fpoints = SDL3_small_alloc(SDL_FPoint, count, &isstack);
-    if (fpoints == NULL) {
+    state = GetRendererState(renderer, true);
+    if (!state) {
+        if (renderer) {
+            SDL3_OutOfMemory();
+        } else {
+            SDL3_InvalidParamError("renderer");
+        }
         return -1;
     }
 
-    for (i = 0; i < count; ++i) {
-        fpoints[i].x = (float)points[i].x;
-        fpoints[i].y = (float)points[i].y;
+    /* Copies queued by SDL_RenderCopy() go first */
+    if (FlushQueuedSprites(state) < 0) {
+        return -1;
     }
 
-    retval = SDL3_RenderLines(renderer, fpoints, count) ? 0 : -1;
+    for (i = 0; i < count; ++i) {
+        const SDL2_CompatSprite *sprite = &sprites[i];
+        const SDL_Rect *srcrect = (sprite->srcrect.w && sprite->srcrect.h) ? &sprite->srcrect : NULL;
+        SDL_Vertex *vertices;
+        SDL_FRect src;
+        SDL_FColor color;
+
+        if (sprite->texture != texture) {
+            if (SDL3_GetRendererFromTexture(sprite->texture) != renderer) {
+                SDL3_SetError("Texture of sprite %d was not created with this renderer", i);
+                retval = -1;
+                break;
+            }
+            texture = sprite->texture;
+            SDL3_GetTextureSize(texture, &tex_w, &tex_h);
+        }
+        if (!GetSpriteSource(srcrect, tex_w, tex_h, &src)) {
+            continue;
+        }
 
-    SDL3_small_free(fpoints, isstack);
+        color.r = sprite->color.r / 255.0f;
+        color.g = sprite->color.g / 255.0f;
+        color.b = sprite->color.b / 255.0f;
+        color.a = sprite->color.a / 255.0f;
 
-    return retval < 0 ? retval : FlushRendererIfNotBatching(renderer);
-}
+        vertices = QueueSprite(state, texture);
+        if (!vertices) {
+            retval = -1;
+            break;
+        }
+        MakeSpriteVertices(vertices, tex_w, tex_h, &src, &sprite->dstrect, sprite->angle, sprite->flip, &color);
+    }
 
-SDL_DECLSPEC int SDLCALL
-SDL_RenderDrawLinesF(SDL_Renderer *renderer, const SDL_FPoint *points, int count)
-{
-    const int retval = SDL3_RenderLines(renderer, points, count) ? 0 : -1;
+    /* Draw what was queued even after an error, so nothing is left behind for a later flush */
+    if (FlushQueuedSprites(state) < 0) {
+        retval = -1;
+    }
     return retval < 0 ? retval : FlushRendererIfNotBatching(renderer);
 }
 
 SDL_DECLSPEC int SDLCALL
-SDL_RenderDrawRect(SDL_Renderer *renderer, const SDL_Rect *rect)
+SDL_CompatRenderSprites(SDL_Renderer *renderer, const SDL2_CompatSprite *sprites, int count)
 {
+    RenderTrace trace;
     int retval;
-    SDL_FRect frect;
-    SDL_FRect *prect = NULL;
 
-    if (rect) {
-        frect.x = (float)rect->x;
-        frect.y = (float)rect->y;
-        frect.w = (float)rect->w;
-        frect.h = (float)rect->h;
-        prect = &frect;
+    if (!BeginRenderTrace(&trace, renderer, NULL)) {
+        return RenderSprites(renderer, sprites, count);
     }
-
-    retval = SDL3_RenderRect(renderer, prect) ? 0 : -1;
-    return retval < 0 ? retval : FlushRendererIfNotBatching(renderer);
+    retval = RenderSprites(renderer, sprites, count);
+    return EndRenderTraceSprites(&trace, sprites, count, retval);
 }
 
-SDL_DECLSPEC int SDLCALL
-SDL_RenderDrawRects(SDL_Renderer *renderer, const SDL_Rect *rects, int count)
+static int
+RenderReadPixels(SDL_Renderer * renderer, const SDL_Rect * rect, Uint32 format, void *pixels, int pitch)
 {
-    SDL_FRect *frects;
-    int i;
-    int retval;
-    int isstack;
+    int result = -1;
+    SDL_Texture* target;
+    SDL_Surface *surface;
 
-    if (rects == NULL) {
-        SDL3_InvalidParamError("rects");
+    if (FlushRendererSprites(renderer) < 0) {
         return -1;
     }
-    if (count < 1) {
-        return 0;
+    surface = SDL3_RenderReadPixels(renderer, rect);
+    if (!surface) {
+        return -1;
     }
 
-    frects = SDL3_small_alloc(SDL_FRect, count, &isstack);
-    if (frects == NULL) {
-        return -1;
+    if (!format) {
+        target = SDL3_GetRenderTarget(renderer);
+        if (target) {
+            format = SDL3_GetNumberProperty(SDL3_GetTextureProperties(target), SDL_PROP_TEXTURE_FORMAT_NUMBER, 0);
+        } else {
+            format = SDL3_GetWindowPixelFormat((SDL_Window *)SDL3_GetPointerProperty(SDL3_GetRendererProperties(renderer), SDL_PROP_RENDERER_WINDOW_POINTER, NULL));
+        }
     }
 
-    for (i = 0; i < count; ++i) {
-        frects[i].x = (float)rects[i].x;
-        frects[i].y = (float)rects[i].y;
-        frects[i].w = (float)rects[i].w;
-        frects[i].h = (float)rects[i].h;
+    if (SDL3_ConvertPixelsAndColorspace(surface->w, surface->h, surface->format, SDL3_GetSurfaceColorspace(surface), SDL3_GetSurfaceProperties(surface), surface->pixels, surface->pitch, (SDL_PixelFormat)format, SDL_COLORSPACE_SRGB, 0, pixels, pitch)) {
+        result = 0;
     }
 
-    retval = SDL3_RenderRects(renderer, frects, count) ? 0 : -1;
-
-    SDL3_small_free(frects, isstack);
+    SDL3_DestroySurface(surface);
 
-    return retval < 0 ? retval : FlushRendererIfNotBatching(renderer);
+    return result;
 }
 
 SDL_DECLSPEC int SDLCALL
-SDL_RenderDrawRectF(SDL_Renderer *renderer, const SDL_FRect *rect)
+SDL_RenderReadPixels(SDL_Renderer *renderer, const SDL_Rect *rect, Uint32 format, void *pixels, int pitch)
 {
-    const int retval = SDL3_RenderRect(renderer, rect) ? 0 : -1;
-    return retval < 0 ? retval : FlushRendererIfNotBatching(renderer);
+    RenderTrace trace;
+    RenderTraceReadPixels args;
+    Uint64 end_ns;
+    int retval;
+
+    if (!BeginRenderTrace(&trace, renderer, NULL)) {
+        return RenderReadPixels(renderer, rect, format, pixels, pitch);
+    }
+    retval = RenderReadPixels(renderer, rect, format, pixels, pitch);
+    end_ns = SDL3_GetTicksNS();
+    SDL3_zero(args);
+    if (rect) {
+        args.rect = *rect;
+    }
+    args.format = format;
+    EndRenderTrace(&trace, end_ns, RENDER_TRACE_READ_PIXELS, rect ? RENDER_TRACE_HAS_RECT : 0, &args, sizeof (args), NULL, 0);
+    return retval;
 }
 
-SDL_DECLSPEC int SDLCALL
-SDL_RenderDrawRectsF(SDL_Renderer *renderer, const SDL_FRect *rects, int count)
+static void
+RenderPresent(SDL_Renderer *renderer)
 {
-    const int retval = SDL3_RenderRects(renderer, rects, count) ? 0 : -1;
-    return retval < 0 ? retval : FlushRendererIfNotBatching(renderer);
+    FlushRendererSprites(renderer);
+    if (SDL3_GetAtomicInt(&NumGammaRampWindows) > 0) {
+        ApplyRenderGamma(renderer);
+    }
+    SDL3_RenderPresent(renderer);
+    SetRendererSurfaceDamaged(renderer);
 }
 
-SDL_DECLSPEC int SDLCALL
-SDL_RenderFillRect(SDL_Renderer *renderer, const SDL_Rect *rect)
+SDL_DECLSPEC void SDLCALL
+SDL_RenderPresent(SDL_Renderer *renderer)
 {
-    int retval;
-    SDL_FRect frect;
-    if (rect) {
-        frect.x = (float)rect->x;
-        frect.y = (float)rect->y;
-        frect.w = (float)rect->w;
-        frect.h = (float)rect->h;
-        retval = SDL3_RenderFillRect(renderer, &frect) ? 0 : -1;
-    } else {
-        retval = SDL3_RenderFillRect(renderer, NULL) ? 0 : -1;
+    RenderTrace trace;
+
+    if (!BeginRenderTrace(&trace, renderer, NULL)) {
+        RenderPresent(renderer);
+        return;
     }
-    return retval < 0 ? retval : FlushRendererIfNotBatching(renderer);
+    RenderPresent(renderer);
+    EndRenderTrace(&trace, SDL3_GetTicksNS(), RENDER_TRACE_PRESENT, 0, NULL, 0, NULL, 0);
 }
 
 SDL_DECLSPEC int SDLCALL
-SDL_RenderFillRects(SDL_Renderer *renderer, const SDL_Rect *rects, int count)
+SDL_RenderFlush(SDL_Renderer *renderer)
 {
-    SDL_FRect *frects;
-    int i;
-    int retval;
-    int isstack;
-
-    if (rects == NULL) {
-        SDL3_InvalidParamError("rects");
+    if (FlushRendererSprites(renderer) < 0 || !SDL3_FlushRenderer(renderer)) {
         return -1;
     }
-    if (count < 1) {
+    SetRendererSurfaceDamaged(renderer);
+    return 0;
+}
+
+SDL_DECLSPEC int SDLCALL
+SDL_RenderSetScale(SDL_Renderer *renderer, float scaleX, float scaleY)
+{
+    return (FlushRendererSprites(renderer) == 0 && SDL3_SetRenderScale(renderer, scaleX, scaleY)) ? 0 : -1;
+}
+
+/* Render trace replay, see SDL_CompatReplayRenderRecording() */
+typedef struct RenderReplay
+{
+    SDL_Surface *surface;
+    SDL_Renderer *renderer;
+    SDL_Texture **textures;   /* by trace ID */
+    Uint32 num_textures;
+    SDL2_Vertex *vertices;    /* for SDL_RenderGeometry() */
+    size_t vertices_size;
+    SDL2_CompatSprite *sprites;  /* for SDL_CompatRenderSprites() */
+    size_t sprites_size;
+    void *pixels;             /* for SDL_RenderReadPixels() */
+    size_t pixels_size;
+    char *frames;             /* the SDL2_RENDER_REPLAY_FRAMES prefix, or NULL */
+    int num_frames;
+} RenderReplay;
+
+static size_t GetRenderTraceArgsSize(RenderTraceCall call)
+{
+    switch (call) {
+    case RENDER_TRACE_RENDERER:
+        return sizeof (RenderTraceRenderer);
+    case RENDER_TRACE_STATE:
+        return sizeof (RenderTraceState);
+    case RENDER_TRACE_TEXTURE:
+        return sizeof (RenderTraceTexture);
+    case RENDER_TRACE_CREATE_TEXTURE_FROM_SURFACE:
+    case RENDER_TRACE_UPDATE_TEXTURE:
+    case RENDER_TRACE_UPDATE_YUV_TEXTURE:
+    case RENDER_TRACE_UPDATE_NV_TEXTURE:
+    case RENDER_TRACE_UNLOCK_TEXTURE:
+        return sizeof (RenderTraceUpdate);
+    case RENDER_TRACE_COPY:
+    case RENDER_TRACE_COPY_F:
+    case RENDER_TRACE_COPY_EX:
+    case RENDER_TRACE_COPY_EX_F:
+        return sizeof (RenderTraceCopy);
+    case RENDER_TRACE_GEOMETRY:
+    case RENDER_TRACE_GEOMETRY_RAW:
+        return sizeof (RenderTraceGeometry);
+    case RENDER_TRACE_READ_PIXELS:
+        return sizeof (RenderTraceReadPixels);
+    case RENDER_TRACE_DESTROY_TEXTURE:
+    case RENDER_TRACE_SET_RENDER_TARGET:
+    case RENDER_TRACE_CLEAR:
+    case RENDER_TRACE_PRESENT:
         return 0;
+    default:
+        return sizeof (RenderTraceCount);
+    }
+}
+
+/* The size of one point, line end or rect in the data of a RenderTraceCount call */
+static size_t GetRenderTraceItemSize(RenderTraceCall call)
+{
+    switch (call) {
+    case RENDER_TRACE_DRAW_POINT:
+    case RENDER_TRACE_DRAW_POINTS:
+    case RENDER_TRACE_DRAW_LINE:
+    case RENDER_TRACE_DRAW_LINES:
+        return sizeof (SDL_Point);
+    case RENDER_TRACE_DRAW_POINT_F:
+    case RENDER_TRACE_DRAW_POINTS_F:
+    case RENDER_TRACE_DRAW_LINE_F:
+    case RENDER_TRACE_DRAW_LINES_F:
+        return sizeof (SDL_FPoint);
+    case RENDER_TRACE_DRAW_RECT:
+    case RENDER_TRACE_DRAW_RECTS:
+    case RENDER_TRACE_FILL_RECT:
+    case RENDER_TRACE_FILL_RECTS:
+        return sizeof (SDL_Rect);
+    default:
+        return sizeof (SDL_FRect);
     }
+}
 
-    frects = SDL3_small_alloc(SDL_FRect, count, &isstack);
-    if (frects == NULL) {
-        return -1;
-    }
+static SDL_Texture *GetReplayTexture(const RenderReplay *replay, Uint32 id)
+{
+    return (id < replay->num_textures) ? replay->textures[id] : NULL;
+}
 
-    for (i = 0; i < count; ++i) {
-        frects[i].x = (float)rects[i].x;
-        frects[i].y = (float)rects[i].y;
-        frects[i].w = (float)rects[i].w;
-        frects[i].h = (float)rects[i].h;
+static bool CreateReplayTexture(RenderReplay *replay, Uint32 id, const RenderTraceTexture *define)
+{
+    if (id == 0 || id >= RENDER_TRACE_MAX_TEXTURES) {
+        return SDL3_SetError("Corrupt render trace");
+    }
+    if (id >= replay->num_textures) {
+        const Uint32 num_textures = SDL_min(SDL_max(id + 1, replay->num_textures * 2), RENDER_TRACE_MAX_TEXTURES);
+        SDL_Texture **textures = (SDL_Texture **)SDL3_realloc(replay->textures, num_textures * sizeof(*textures));
+        if (!textures) {
+            return false;
+        }
+        SDL3_memset(&textures[replay->num_textures], 0, (num_textures - replay->num_textures) * sizeof(*textures));
+        replay->textures = textures;
+        replay->num_textures = num_textures;
     }
 
-    retval = SDL3_RenderFillRects(renderer, frects, count) ? 0 : -1;
+    /* Formats the software renderer can't do stay NULL, and the calls that use them are skipped */
+    if (replay->textures[id]) {
+        SDL_DestroyTexture(replay->textures[id]);
+    }
+    replay->textures[id] = SDL3_CreateTexture(replay->renderer, (SDL_PixelFormat)define->format, (SDL_TextureAccess)define->access, define->w, define->h);
+    return true;
+}
 
-    SDL3_small_free(frects, isstack);
+/* Write what was presented to "<prefix><n>.bmp", for the SDL2_RENDER_REPLAY_FRAMES hint */
+static void SaveReplayFrame(RenderReplay *replay)
+{
+    char file[1024];
 
-    return retval < 0 ? retval : FlushRendererIfNotBatching(renderer);
+    (void)SDL3_snprintf(file, sizeof(file), "%s%d.bmp", replay->frames, replay->num_frames++);
+    SDL3_SaveBMP_IO(replay->surface, SDL3_IOFromFile(file, "wb"), true);
 }
 
-SDL_DECLSPEC int SDLCALL
-SDL_RenderFillRectF(SDL_Renderer *renderer, const SDL_FRect *rect)
+static void ApplyReplayState(SDL_Renderer *renderer, const RenderTraceState *state)
 {
-    const int retval = SDL3_RenderFillRect(renderer, rect) ? 0 : -1;
-    return retval < 0 ? retval : FlushRendererIfNotBatching(renderer);
+    SDL3_SetRenderLogicalPresentation(renderer, state->logical_w, state->logical_h, (SDL_RendererLogicalPresentation)state->logical_mode);
+    SDL3_SetRenderScale(renderer, state->scale_x, state->scale_y);
+    SDL3_SetRenderViewport(renderer, &state->viewport);
+    SDL3_SetRenderClipRect(renderer, SDL_RectEmpty(&state->clip) ? NULL : &state->clip);
+    SDL3_SetRenderDrawColor(renderer, state->draw_color[0], state->draw_color[1], state->draw_color[2], state->draw_color[3]);
+    SDL3_SetRenderDrawBlendMode(renderer, (SDL_BlendMode)state->draw_blend_mode);
 }
 
-SDL_DECLSPEC int SDLCALL
-SDL_RenderFillRectsF(SDL_Renderer *renderer, const SDL_FRect *rects, int count)
+static void ApplyReplayTextureState(SDL_Texture *texture, const RenderTraceTextureState *texture_state)
 {
-    const int retval = SDL3_RenderFillRects(renderer, rects, count) ? 0 : -1;
-    return retval < 0 ? retval : FlushRendererIfNotBatching(renderer);
+    SDL3_SetTextureColorMod(texture, texture_state->color[0], texture_state->color[1], texture_state->color[2]);
+    SDL3_SetTextureAlphaMod(texture, texture_state->color[3]);
+    SDL3_SetTextureBlendMode(texture, (SDL_BlendMode)texture_state->blend_mode);
+    SDL3_SetTextureScaleMode(texture, (SDL_ScaleMode)texture_state->scale_mode);
 }
 
-SDL_DECLSPEC int SDLCALL
-SDL_RenderCopy(SDL_Renderer *renderer, SDL_Texture *texture, const SDL_Rect *srcrect, const SDL_Rect *dstrect)
-{
-    int retval;
-    SDL_FRect srcfrect;
-    SDL_FRect *psrcfrect = NULL;
-    SDL_FRect dstfrect;
-    SDL_FRect *pdstfrect = NULL;
-    if (srcrect) {
-        srcfrect.x = (float)srcrect->x;
-        srcfrect.y = (float)srcrect->y;
-        srcfrect.w = (float)srcrect->w;
-        srcfrect.h = (float)srcrect->h;
-        psrcfrect = &srcfrect;
+/* Replay one record, with its arguments in `args` and `data_size` bytes of data after them.
+ * Sets `duration_ns` to the time the call took, or 0 if it was skipped.
+ * Returns false, with the error set, if the record is corrupt or the replay can't go on.
+ */
+static bool ReplayRenderCall(RenderReplay *replay, const RenderTraceRecord *record, const void *args, size_t data_size, Uint64 *duration_ns)
+{
+    const RenderTraceCall call = (RenderTraceCall)record->call;
+    const Uint8 *data = (const Uint8 *)args + GetRenderTraceArgsSize(call);
+    SDL_Renderer *renderer = replay->renderer;
+    SDL_Texture *texture = GetReplayTexture(replay, record->texture);
+    const bool has_data = (record->flags & RENDER_TRACE_HAS_DATA) != 0;
+    const void *items = NULL;
+    const Sint32 *indices = NULL;
+    int count = 0;
+    Uint64 start_ns;
+    int num_indices = 0;
+    size_t size;
+
+    *duration_ns = 0;
+
+    /* Set up everything that isn't part of the call */
+    switch (call) {
+    case RENDER_TRACE_RENDERER:
+        if (!renderer) {
+            const RenderTraceRenderer *define = (const RenderTraceRenderer *)args;
+            RendererState *state;
+
+            replay->surface = SDL3_CreateSurface(SDL_max(define->w, 1), SDL_max(define->h, 1), SDL_PIXELFORMAT_XRGB8888);
+            if (!replay->surface) {
+                return false;
+            }
+            replay->renderer = SDL3_CreateSoftwareRenderer(replay->surface);
+            state = GetRendererState(replay->renderer, true);
+            if (!state) {
+                return false;
+            }
+            state->batching = (define->batching != 0);
+            state->merge_copies = (define->batching != 0 && define->merge_copies != 0);
+            if (state->merge_copies) {
+                SDL3_AddAtomicInt(&NumMergingRenderers, 1);
+            }
+        }
+        return true;
+
+    case RENDER_TRACE_STATE:
+        if (renderer) {
+            ApplyReplayState(renderer, (const RenderTraceState *)args);
+        }
+        return true;
+
+    case RENDER_TRACE_TEXTURE:
+        return renderer ? CreateReplayTexture(replay, record->texture, (const RenderTraceTexture *)args) : true;
+
+    case RENDER_TRACE_DESTROY_TEXTURE:
+        if (texture) {
+            SDL_DestroyTexture(texture);
+            replay->textures[record->texture] = NULL;
+        }
+        return true;
+
+    case RENDER_TRACE_CREATE_TEXTURE_FROM_SURFACE:
+    case RENDER_TRACE_UPDATE_TEXTURE:
+    case RENDER_TRACE_UNLOCK_TEXTURE:
+    {
+        const RenderTraceUpdate *update = (const RenderTraceUpdate *)args;
+        const SDL_PropertiesID props = SDL3_GetTextureProperties(texture);
+        const SDL_PixelFormat format = (SDL_PixelFormat)SDL3_GetNumberProperty(props, SDL_PROP_TEXTURE_FORMAT_NUMBER, SDL_PIXELFORMAT_UNKNOWN);
+        int w, h;
+
+        if (has_data && (update->pitch < 0 || update->rows < 0 || (Uint64)update->pitch * update->rows > data_size)) {
+            return SDL3_SetError("Corrupt render trace");
+        }
+        if (!texture || !has_data) {
+            return true;  /* the contents weren't recorded */
+        }
+
+        /* The pixels have to cover the whole area, or the update would read past them */
+        if (record->flags & RENDER_TRACE_HAS_RECT) {
+            w = update->rect.w;
+            h = update->rect.h;
+        } else {
+            w = (int)SDL3_GetNumberProperty(props, SDL_PROP_TEXTURE_WIDTH_NUMBER, 0);
+            h = (int)SDL3_GetNumberProperty(props, SDL_PROP_TEXTURE_HEIGHT_NUMBER, 0);
+        }
+        if (update->rows != h || update->pitch != w * SDL_BYTESPERPIXEL(format)) {
+            return SDL3_SetError("Corrupt render trace");
+        }
+
+        /* Write the pixels to a lock, so only the unlock is timed, like it was when recording */
+        if (call == RENDER_TRACE_UNLOCK_TEXTURE) {
+            void *pixels;
+            int pitch, y;
+
+            if (SDL_LockTexture(texture, (record->flags & RENDER_TRACE_HAS_RECT) ? &update->rect : NULL, &pixels, &pitch) < 0) {
+                return true;
+            }
+            for (y = 0; y < h; ++y) {
+                SDL3_memcpy((Uint8 *)pixels + (size_t)y * pitch, data + (size_t)y * update->pitch, update->pitch);
+            }
+        }
+        break;
     }
-    if (dstrect) {
-        dstfrect.x = (float)dstrect->x;
-        dstfrect.y = (float)dstrect->y;
-        dstfrect.w = (float)dstrect->w;
-        dstfrect.h = (float)dstrect->h;
-        pdstfrect = &dstfrect;
+
+    case RENDER_TRACE_UPDATE_YUV_TEXTURE:
+    case RENDER_TRACE_UPDATE_NV_TEXTURE:
+    {
+        const RenderTraceUpdate *update = (const RenderTraceUpdate *)args;
+        const SDL_PropertiesID props = SDL3_GetTextureProperties(texture);
+        int widths[3], heights[3];
+        Uint64 planes_size = 0;
+        int w, h, i;
+
+        if (has_data) {
+            if (update->pitch <= 0 || update->rows <= 0) {
+                return SDL3_SetError("Corrupt render trace");
+            }
+            GetRenderTracePlanes((call == RENDER_TRACE_UPDATE_YUV_TEXTURE) ? 3 : 2, update->pitch, update->rows, widths, heights);
+            for (i = 0; i < ((call == RENDER_TRACE_UPDATE_YUV_TEXTURE) ? 3 : 2); ++i) {
+                planes_size += (Uint64)widths[i] * heights[i];
+            }
+            if (planes_size > data_size) {
+                return SDL3_SetError("Corrupt render trace");
+            }
+        }
+        if (!texture || !has_data) {
+            return true;
+        }
+
+        if (record->flags & RENDER_TRACE_HAS_RECT) {
+            w = update->rect.w;
+            h = update->rect.h;
+        } else {
+            w = (int)SDL3_GetNumberProperty(props, SDL_PROP_TEXTURE_WIDTH_NUMBER, 0);
+            h = (int)SDL3_GetNumberProperty(props, SDL_PROP_TEXTURE_HEIGHT_NUMBER, 0);
+        }
+        if (update->pitch != w || update->rows != h) {
+            return SDL3_SetError("Corrupt render trace");
+        }
+        break;
     }
-    retval = SDL3_RenderTexture(renderer, texture, psrcfrect, pdstfrect) ? 0 : -1;
-    return retval < 0 ? retval : FlushRendererIfNotBatching(renderer);
-}
 
-SDL_DECLSPEC int SDLCALL
-SDL_RenderCopyF(SDL_Renderer *renderer, SDL_Texture *texture, const SDL_Rect *srcrect, const SDL_FRect *dstrect)
-{
-    int retval;
-    SDL_FRect srcfrect;
-    SDL_FRect *psrcfrect = NULL;
-    if (srcrect) {
-        srcfrect.x = (float)srcrect->x;
-        srcfrect.y = (float)srcrect->y;
-        srcfrect.w = (float)srcrect->w;
-        srcfrect.h = (float)srcrect->h;
-        psrcfrect = &srcfrect;
+    case RENDER_TRACE_SET_RENDER_TARGET:
+        if (!renderer || (record->texture && !texture)) {
+            return true;
+        }
+        break;
+
+    case RENDER_TRACE_COPY:
+    case RENDER_TRACE_COPY_F:
+    case RENDER_TRACE_COPY_EX:
+    case RENDER_TRACE_COPY_EX_F:
+        if (!renderer || !texture) {
+            return true;
+        }
+        ApplyReplayTextureState(texture, &((const RenderTraceCopy *)args)->texture_state);
+        break;
+
+    case RENDER_TRACE_RENDER_SPRITES:
+    {
+        RenderTraceSprite traced;
+        SDL_Texture *last = NULL;
+        int num_sprites = 0;
+        int i;
+
+        count = ((const RenderTraceCount *)args)->count;
+        if (has_data && (count <= 0 || (size_t)count * sizeof(RenderTraceSprite) > data_size)) {
+            return SDL3_SetError("Corrupt render trace");
+        }
+        if (!renderer || !has_data) {
+            return true;
+        }
+        if ((size_t)count * sizeof(SDL2_CompatSprite) > replay->sprites_size) {
+            SDL2_CompatSprite *new_sprites = (SDL2_CompatSprite *)SDL3_realloc(replay->sprites, (size_t)count * sizeof(SDL2_CompatSprite));
+            if (!new_sprites) {
+                return false;
+            }
+            replay->sprites = new_sprites;
+            replay->sprites_size = (size_t)count * sizeof(SDL2_CompatSprite);
+        }
+
+        /* Sprites with textures the replay doesn't have are left out. The data isn't aligned for the doubles in them, so they're copied out. */
+        for (i = 0; i < count; ++i) {
+            SDL2_CompatSprite *sprite = &replay->sprites[num_sprites];
+
+            SDL3_memcpy(&traced, data + (size_t)i * sizeof(traced), sizeof(traced));
+            sprite->texture = GetReplayTexture(replay, traced.texture);
+            if (!sprite->texture) {
+                continue;
+            }
+            if (sprite->texture != last) {
+                ApplyReplayTextureState(sprite->texture, &traced.texture_state);
+                last = sprite->texture;
+            }
+            sprite->srcrect = traced.srcrect;
+            sprite->dstrect = traced.dstrect;
+            sprite->angle = traced.angle;
+            sprite->flip = (SDL_FlipMode)traced.flip;
+            sprite->color.r = traced.color[0];
+            sprite->color.g = traced.color[1];
+            sprite->color.b = traced.color[2];
+            sprite->color.a = traced.color[3];
+            ++num_sprites;
+        }
+        count = num_sprites;
+        break;
     }
-    retval = SDL3_RenderTexture(renderer, texture, psrcfrect, dstrect) ? 0 : -1;
-    return retval < 0 ? retval : FlushRendererIfNotBatching(renderer);
-}
 
-SDL_DECLSPEC int SDLCALL
-SDL_RenderCopyEx(SDL_Renderer *renderer, SDL_Texture *texture,
-                 const SDL_Rect *srcrect, const SDL_Rect *dstrect,
-                 const double angle, const SDL_Point *center, const SDL_FlipMode flip)
-{
-    int retval;
-    SDL_FRect srcfrect;
-    SDL_FRect *psrcfrect = NULL;
-    SDL_FRect dstfrect;
-    SDL_FRect *pdstfrect = NULL;
-    SDL_FPoint fcenter;
-    SDL_FPoint *pfcenter = NULL;
+    case RENDER_TRACE_GEOMETRY:
+    case RENDER_TRACE_GEOMETRY_RAW:
+    {
+        const RenderTraceGeometry *geometry = (const RenderTraceGeometry *)args;
+
+        if (has_data) {
+            count = geometry->num_vertices;
+            num_indices = (record->flags & RENDER_TRACE_HAS_INDICES) ? geometry->num_indices : 0;
+            size = (size_t)count * (((record->flags & RENDER_TRACE_HAS_UV) ? 4 : 2) * sizeof(float) + sizeof(SDL_Color));
+            if (count <= 0 || num_indices < 0 || size + (size_t)num_indices * sizeof(Sint32) > data_size) {
+                return SDL3_SetError("Corrupt render trace");
+            }
+            if (num_indices > 0) {
+                indices = (const Sint32 *)(data + size);
+            }
+        }
+        if (!renderer || (record->texture && !texture) || !has_data) {
+            return true;
+        }
+        if (texture) {
+            ApplyReplayTextureState(texture, &geometry->texture_state);
+        }
 
-    if (srcrect) {
-        srcfrect.x = (float)srcrect->x;
-        srcfrect.y = (float)srcrect->y;
-        srcfrect.w = (float)srcrect->w;
-        srcfrect.h = (float)srcrect->h;
-        psrcfrect = &srcfrect;
+        /* SDL_RenderGeometry() takes whole vertices, so put them back together */
+        if (call == RENDER_TRACE_GEOMETRY) {
+            const float *xy = (const float *)data;
+            const SDL_Color *color = (const SDL_Color *)(xy + 2 * count);
+            const float *uv = (const float *)(color + count);
+            int i;
+
+            if ((size_t)count * sizeof(SDL2_Vertex) > replay->vertices_size) {
+                SDL2_Vertex *vertices = (SDL2_Vertex *)SDL3_realloc(replay->vertices, (size_t)count * sizeof(SDL2_Vertex));
+                if (!vertices) {
+                    return false;
+                }
+                replay->vertices = vertices;
+                replay->vertices_size = (size_t)count * sizeof(SDL2_Vertex);
+            }
+            for (i = 0; i < count; ++i) {
+                replay->vertices[i].position.x = xy[i * 2];
+                replay->vertices[i].position.y = xy[i * 2 + 1];
+                replay->vertices[i].color = color[i];
+                if (record->flags & RENDER_TRACE_HAS_UV) {
+                    replay->vertices[i].tex_coord.x = uv[i * 2];
+                    replay->vertices[i].tex_coord.y = uv[i * 2 + 1];
+                } else {
+                    replay->vertices[i].tex_coord.x = 0.0f;
+                    replay->vertices[i].tex_coord.y = 0.0f;
+                }
+            }
+        }
+        break;
+    }
+
+    case RENDER_TRACE_READ_PIXELS:
+    {
+        const RenderTraceReadPixels *read = (const RenderTraceReadPixels *)args;
+        const SDL_PixelFormat format = read->format ? (SDL_PixelFormat)read->format : SDL_PIXELFORMAT_ARGB8888;
+        SDL_Rect rect;
+
+        if (!renderer) {
+            return true;
+        }
+        if (record->flags & RENDER_TRACE_HAS_RECT) {
+            rect = read->rect;
+        } else {
+            SDL3_GetRenderViewport(renderer, &rect);
+        }
+        if (rect.w <= 0 || rect.h <= 0) {
+            return true;
+        }
+        size = (size_t)rect.w * rect.h * (SDL_ISPIXELFORMAT_FOURCC(format) ? 4 : SDL_max(SDL_BYTESPERPIXEL(format), 1));
+        if (size > replay->pixels_size) {
+            void *pixels = SDL3_realloc(replay->pixels, size);
+            if (!pixels) {
+                return false;
+            }
+            replay->pixels = pixels;
+            replay->pixels_size = size;
+        }
+        break;
+    }
+
+    case RENDER_TRACE_CLEAR:
+    case RENDER_TRACE_PRESENT:
+        if (!renderer) {
+            return true;
+        }
+        break;
+
+    default:
+    {
+        /* The calls that take a count of points, lines or rects */
+        count = ((const RenderTraceCount *)args)->count;
+        if (has_data) {
+            if (count <= 0 || (size_t)count * GetRenderTraceItemSize(call) > data_size) {
+                return SDL3_SetError("Corrupt render trace");
+            }
+            items = data;
+        }
+        if (!renderer) {
+            return true;
+        }
+        break;
+    }
+    }
+
+    start_ns = SDL3_GetTicksNS();
+    switch (call) {
+    case RENDER_TRACE_CREATE_TEXTURE_FROM_SURFACE:
+    case RENDER_TRACE_UPDATE_TEXTURE:
+    {
+        const RenderTraceUpdate *update = (const RenderTraceUpdate *)args;
+        SDL_UpdateTexture(texture, (record->flags & RENDER_TRACE_HAS_RECT) ? &update->rect : NULL, data, update->pitch);
+        break;
+    }
+    case RENDER_TRACE_UPDATE_YUV_TEXTURE:
+    case RENDER_TRACE_UPDATE_NV_TEXTURE:
+    {
+        const RenderTraceUpdate *update = (const RenderTraceUpdate *)args;
+        const SDL_Rect *rect = (record->flags & RENDER_TRACE_HAS_RECT) ? &update->rect : NULL;
+        const Uint8 *chroma = data + (size_t)update->pitch * update->rows;
+        int widths[3], heights[3];
+
+        if (call == RENDER_TRACE_UPDATE_YUV_TEXTURE) {
+            GetRenderTracePlanes(3, update->pitch, update->rows, widths, heights);
+            SDL_UpdateYUVTexture(texture, rect, data, widths[0], chroma, widths[1], chroma + (size_t)widths[1] * heights[1], widths[2]);
+        } else {
+            GetRenderTracePlanes(2, update->pitch, update->rows, widths, heights);
+            SDL_UpdateNVTexture(texture, rect, data, widths[0], chroma, widths[1]);
+        }
+        break;
+    }
+    case RENDER_TRACE_UNLOCK_TEXTURE:
+        SDL_UnlockTexture(texture);
+        break;
+    case RENDER_TRACE_SET_RENDER_TARGET:
+        SDL_SetRenderTarget(renderer, texture);
+        break;
+    case RENDER_TRACE_CLEAR:
+        SDL_RenderClear(renderer);
+        break;
+    case RENDER_TRACE_COPY:
+    case RENDER_TRACE_COPY_EX:
+    {
+        const RenderTraceCopy *copy = (const RenderTraceCopy *)args;
+        SDL_Rect dstrect;
+        SDL_Point center;
+
+        dstrect.x = (int)copy->dstrect.x;
+        dstrect.y = (int)copy->dstrect.y;
+        dstrect.w = (int)copy->dstrect.w;
+        dstrect.h = (int)copy->dstrect.h;
+        center.x = (int)copy->center.x;
+        center.y = (int)copy->center.y;
+        if (call == RENDER_TRACE_COPY) {
+            SDL_RenderCopy(renderer, texture,
+                           (record->flags & RENDER_TRACE_HAS_SRCRECT) ? &copy->srcrect : NULL,
+                           (record->flags & RENDER_TRACE_HAS_DSTRECT) ? &dstrect : NULL);
+        } else {
+            SDL_RenderCopyEx(renderer, texture,
+                             (record->flags & RENDER_TRACE_HAS_SRCRECT) ? &copy->srcrect : NULL,
+                             (record->flags & RENDER_TRACE_HAS_DSTRECT) ? &dstrect : NULL,
+                             copy->angle, (record->flags & RENDER_TRACE_HAS_CENTER) ? &center : NULL, (SDL_FlipMode)copy->flip);
+        }
+        break;
+    }
+    case RENDER_TRACE_COPY_F:
+    case RENDER_TRACE_COPY_EX_F:
+    {
+        const RenderTraceCopy *copy = (const RenderTraceCopy *)args;
+        if (call == RENDER_TRACE_COPY_F) {
+            SDL_RenderCopyF(renderer, texture,
+                            (record->flags & RENDER_TRACE_HAS_SRCRECT) ? &copy->srcrect : NULL,
+                            (record->flags & RENDER_TRACE_HAS_DSTRECT) ? &copy->dstrect : NULL);
+        } else {
+            SDL_RenderCopyExF(renderer, texture,
+                              (record->flags & RENDER_TRACE_HAS_SRCRECT) ? &copy->srcrect : NULL,
+                              (record->flags & RENDER_TRACE_HAS_DSTRECT) ? &copy->dstrect : NULL,
+                              copy->angle, (record->flags & RENDER_TRACE_HAS_CENTER) ? &copy->center : NULL, (SDL_FlipMode)copy->flip);
+        }
+        break;
     }
+    case RENDER_TRACE_RENDER_SPRITES:
+        SDL_CompatRenderSprites(renderer, replay->sprites, count);
+        break;
+    case RENDER_TRACE_DRAW_POINT:
+        if (items) {
+            SDL_RenderDrawPoint(renderer, ((const SDL_Point *)items)->x, ((const SDL_Point *)items)->y);
+        }
+        break;
+    case RENDER_TRACE_DRAW_POINTS:
+        SDL_RenderDrawPoints(renderer, (const SDL_Point *)items, count);
+        break;
+    case RENDER_TRACE_DRAW_POINT_F:
+        if (items) {
+            SDL_RenderDrawPointF(renderer, ((const SDL_FPoint *)items)->x, ((const SDL_FPoint *)items)->y);
+        }
+        break;
+    case RENDER_TRACE_DRAW_POINTS_F:
+        SDL_RenderDrawPointsF(renderer, (const SDL_FPoint *)items, count);
+        break;
+    case RENDER_TRACE_DRAW_LINE:
+        if (items && count >= 2) {
+            const SDL_Point *points = (const SDL_Point *)items;
+            SDL_RenderDrawLine(renderer, points[0].x, points[0].y, points[1].x, points[1].y);
+        }
+        break;
+    case RENDER_TRACE_DRAW_LINES:
+        SDL_RenderDrawLines(renderer, (const SDL_Point *)items, count);
+        break;
+    case RENDER_TRACE_DRAW_LINE_F:
+        if (items && count >= 2) {
+            const SDL_FPoint *points = (const SDL_FPoint *)items;
+            SDL_RenderDrawLineF(renderer, points[0].x, points[0].y, points[1].x, points[1].y);
+        }
+        break;
+    case RENDER_TRACE_DRAW_LINES_F:
+        SDL_RenderDrawLinesF(renderer, (const SDL_FPoint *)items, count);
+        break;
+    case RENDER_TRACE_DRAW_RECT:
+        SDL_RenderDrawRect(renderer, (const SDL_Rect *)items);
+        break;
+    case RENDER_TRACE_DRAW_RECTS:
+        SDL_RenderDrawRects(renderer, (const SDL_Rect *)items, count);
+        break;
+    case RENDER_TRACE_DRAW_RECT_F:
+        SDL_RenderDrawRectF(renderer, (const SDL_FRect *)items);
+        break;
+    case RENDER_TRACE_DRAW_RECTS_F:
+        SDL_RenderDrawRectsF(renderer, (const SDL_FRect *)items, count);
+        break;
+    case RENDER_TRACE_FILL_RECT:
+        SDL_RenderFillRect(renderer, (const SDL_Rect *)items);
+        break;
+    case RENDER_TRACE_FILL_RECTS:
+        SDL_RenderFillRects(renderer, (const SDL_Rect *)items, count);
+        break;
+    case RENDER_TRACE_FILL_RECT_F:
+        SDL_RenderFillRectF(renderer, (const SDL_FRect *)items);
+        break;
+    case RENDER_TRACE_FILL_RECTS_F:
+        SDL_RenderFillRectsF(renderer, (const SDL_FRect *)items, count);
+        break;
+    case RENDER_TRACE_GEOMETRY:
+        SDL_RenderGeometry(renderer, texture, replay->vertices, count, (const int *)indices, num_indices);
+        break;
+    case RENDER_TRACE_GEOMETRY_RAW:
+    {
+        const float *xy = (const float *)data;
+        const SDL_Color *color = (const SDL_Color *)(xy + 2 * count);
+        const float *uv = (record->flags & RENDER_TRACE_HAS_UV) ? (const float *)(color + count) : NULL;
 
-    if (dstrect) {
-        dstfrect.x = (float)dstrect->x;
-        dstfrect.y = (float)dstrect->y;
-        dstfrect.w = (float)dstrect->w;
-        dstfrect.h = (float)dstrect->h;
-        pdstfrect = &dstfrect;
+        SDL_RenderGeometryRaw(renderer, texture, xy, 2 * sizeof(float), color, sizeof(SDL_Color), uv, 2 * sizeof(float),
+                              count, indices, num_indices, indices ? 4 : 0);
+        break;
     }
+    case RENDER_TRACE_READ_PIXELS:
+    {
+        const RenderTraceReadPixels *read = (const RenderTraceReadPixels *)args;
+        const SDL_PixelFormat format = read->format ? (SDL_PixelFormat)read->format : SDL_PIXELFORMAT_ARGB8888;
+        SDL_Rect rect;
+        int pitch;
 
-    if (center) {
-        fcenter.x = (float)center->x;
-        fcenter.y = (float)center->y;
-        pfcenter = &fcenter;
+        if (record->flags & RENDER_TRACE_HAS_RECT) {
+            rect = read->rect;
+        } else {
+            SDL3_GetRenderViewport(renderer, &rect);
+        }
+        pitch = rect.w * (SDL_ISPIXELFORMAT_FOURCC(format) ? 4 : SDL_max(SDL_BYTESPERPIXEL(format), 1));
+        SDL_RenderReadPixels(renderer, (record->flags & RENDER_TRACE_HAS_RECT) ? &rect : NULL, format, replay->pixels, pitch);
+        break;
     }
-
-    retval = SDL3_RenderTextureRotated(renderer, texture, psrcfrect, pdstfrect, angle, pfcenter, flip) ? 0 : -1;
-    return retval < 0 ? retval : FlushRendererIfNotBatching(renderer);
-}
-
-SDL_DECLSPEC int SDLCALL
-SDL_RenderCopyExF(SDL_Renderer *renderer, SDL_Texture *texture,
-                  const SDL_Rect *srcrect, const SDL_FRect *dstrect,
-                  const double angle, const SDL_FPoint *center, const SDL_FlipMode flip)
-{
-    int retval;
-    SDL_FRect srcfrect;
-    SDL_FRect *psrcfrect = NULL;
-
-    if (srcrect) {
-        srcfrect.x = (float)srcrect->x;
-        srcfrect.y = (float)srcrect->y;
-        srcfrect.w = (float)srcrect->w;
-        srcfrect.h = (float)srcrect->h;
-        psrcfrect = &srcfrect;
+    case RENDER_TRACE_PRESENT:
+        SDL_RenderPresent(renderer);
+        break;
+    default:
+        break;
     }
+    *duration_ns = SDL3_GetTicksNS() - start_ns;
 
-    retval = SDL3_RenderTextureRotated(renderer, texture, psrcfrect, dstrect, angle, center, flip) ? 0 : -1;
-    return retval < 0 ? retval : FlushRendererIfNotBatching(renderer);
-}
-
-SDL_DECLSPEC int SDLCALL
-SDL_RenderGeometry(SDL_Renderer *renderer, SDL_Texture *texture, const SDL2_Vertex *vertices, int num_vertices, const int *indices, int num_indices)
-{
-    if (vertices) {
-        const float *xy = &vertices->position.x;
-        int xy_stride = sizeof(SDL2_Vertex);
-        const SDL_Color *color = &vertices->color;
-        int color_stride = sizeof(SDL2_Vertex);
-        const float *uv = &vertices->tex_coord.x;
-        int uv_stride = sizeof(SDL2_Vertex);
-        int size_indices = 4;
-        return SDL_RenderGeometryRaw(renderer, texture, xy, xy_stride, color, color_stride, uv, uv_stride, num_vertices, indices, num_indices, size_indices);
+    if (call == RENDER_TRACE_PRESENT && replay->frames) {
+        SaveReplayFrame(replay);
     }
-    SDL3_InvalidParamError("vertices");
-    return -1;
+    return true;
 }
 
 SDL_DECLSPEC int SDLCALL
-SDL_RenderGeometryRaw(SDL_Renderer *renderer, SDL_Texture *texture, const float *xy, int xy_stride, const SDL_Color *color, int color_stride, const float *uv, int uv_stride, int num_vertices, const void *indices, int num_indices, int size_indices)
+SDL_CompatReplayRenderRecording(const char *file, SDL2_CompatRenderCallStats *stats, int maxstats)
 {
-    int i, retval, isstack;
-    const char *color2 = (const char *) color;
-    SDL_FColor *color3;
+    SDL2_CompatRenderCallStats totals[RENDER_TRACE_NUM_CALLS];
+    RenderReplay replay;
+    RenderTraceHeader header;
+    RenderTraceRecord record;
+    SDL_IOStream *io;
+    const char *hint;
+    void *payload = NULL;
+    size_t payload_size = 0;
+    int retval = -1;
+    int num_stats = 0;
+    Uint32 i;
 
-    if (num_vertices <= 0) {
-        SDL3_InvalidParamError("num_vertices");
+    if (!file) {
+        SDL3_InvalidParamError("file");
         return -1;
     }
-    if (!color) {
-        SDL3_InvalidParamError("color");
+    if (maxstats < 0 || (maxstats > 0 && !stats)) {
+        SDL3_InvalidParamError("stats");
         return -1;
     }
 
-    color3 = SDL3_small_alloc(SDL_FColor, num_vertices, &isstack);
-    if (!color3) {
-        SDL3_OutOfMemory();
+    io = SDL3_IOFromFile(file, "rb");
+    if (!io) {
+        return -1;
+    }
+    if (SDL3_ReadIO(io, &header, sizeof (header)) != sizeof (header) ||
+        SDL3_memcmp(header.magic, RENDER_TRACE_MAGIC, sizeof (header.magic)) != 0) {
+        SDL3_SetError("Not an sdl2-compat render trace");
+        SDL3_CloseIO(io);
         return -1;
     }
-    for (i = 0; i < num_vertices; ++i) {
-        color3[i].r = color->r / 255.0f;
-        color3[i].g = color->g / 255.0f;
-        color3[i].b = color->b / 255.0f;
-        color3[i].a = color->a / 255.0f;
-        color2 += color_stride;
-        color = (const SDL_Color *) color2;
+    if (header.version != RENDER_TRACE_VERSION || header.record_size != (Uint32) sizeof (RenderTraceRecord)) {
+        SDL3_SetError("Render trace was recorded by an incompatible build");
+        SDL3_CloseIO(io);
+        return -1;
     }
 
-    color_stride = sizeof(SDL_FColor);
-    retval = SDL3_RenderGeometryRaw(renderer, texture, xy, xy_stride, color3, color_stride, uv, uv_stride, num_vertices, indices, num_indices, size_indices) ? 0 : -1;
-    SDL3_small_free(color3, isstack);
-    return retval < 0 ? retval : FlushRendererIfNotBatching(renderer);
-}
+    SDL3_zero(replay);
+    SDL3_zeroa(totals);
+    hint = SDL3_GetHint("SDL2_RENDER_REPLAY_FRAMES");
+    if (hint && *hint) {
+        replay.frames = SDL3_strdup(hint);
+    }
 
-SDL_DECLSPEC int SDLCALL
-SDL_RenderReadPixels(SDL_Renderer * renderer, const SDL_Rect * rect, Uint32 format, void *pixels, int pitch)
-{
-    int result = -1;
-    SDL_Texture* target;
+    /* A trace that was cut short, by a crash or something, replays up to its last whole record */
+    while (SDL3_ReadIO(io, &record, sizeof (record)) == sizeof (record)) {
+        Uint64 duration_ns;
 
-    SDL_Surface *surface = SDL3_RenderReadPixels(renderer, rect);
-    if (!surface) {
-        return -1;
-    }
+        if (record.call == 0 || record.call >= RENDER_TRACE_NUM_CALLS || record.size > RENDER_TRACE_MAX_RECORD_SIZE ||
+            record.size < GetRenderTraceArgsSize((RenderTraceCall)record.call)) {
+            SDL3_SetError("Corrupt render trace");
+            goto done;
+        }
+        if (record.size > payload_size) {
+            void *new_payload = SDL3_realloc(payload, record.size);
+            if (!new_payload) {
+                goto done;
+            }
+            payload = new_payload;
+            payload_size = record.size;
+        }
+        if (record.size && SDL3_ReadIO(io, payload, record.size) != record.size) {
+            break;
+        }
 
-    if (!format) {
-        target = SDL3_GetRenderTarget(renderer);
-        if (target) {
-            format = SDL3_GetNumberProperty(SDL3_GetTextureProperties(target), SDL_PROP_TEXTURE_FORMAT_NUMBER, 0);
-        } else {
-            format = SDL3_GetWindowPixelFormat((SDL_Window *)SDL3_GetPointerProperty(SDL3_GetRendererProperties(renderer), SDL_PROP_RENDERER_WINDOW_POINTER, NULL));
+        if (!ReplayRenderCall(&replay, &record, payload, record.size - GetRenderTraceArgsSize((RenderTraceCall)record.call), &duration_ns)) {
+            goto done;
+        }
+        if (RenderTraceCallNames[record.call]) {
+            SDL2_CompatRenderCallStats *total = &totals[record.call];
+            total->count++;
+            total->bytes += sizeof (record) + record.size;
+            total->recorded_ns += record.duration_ns;
+            total->replayed_ns += duration_ns;
         }
     }
 
-    if (SDL3_ConvertPixelsAndColorspace(surface->w, surface->h, surface->format, SDL3_GetSurfaceColorspace(surface), SDL3_GetSurfaceProperties(surface), surface->pixels, surface->pitch, (SDL_PixelFormat)format, SDL_COLORSPACE_SRGB, 0, pixels, pitch)) {
-        result = 0;
+    for (i = 0; i < RENDER_TRACE_NUM_CALLS; ++i) {
+        if (totals[i].count) {
+            if (num_stats < maxstats) {
+                stats[num_stats] = totals[i];
+                stats[num_stats].name = RenderTraceCallNames[i];
+            }
+            ++num_stats;
+        }
     }
+    retval = num_stats;
 
-    SDL3_DestroySurface(surface);
-
-    return result;
-}
-
-SDL_DECLSPEC void SDLCALL
-SDL_RenderPresent(SDL_Renderer *renderer)
-{
-    SDL3_RenderPresent(renderer);
+done:
+    for (i = 0; i < replay.num_textures; ++i) {
+        if (replay.textures[i]) {
+            SDL_DestroyTexture(replay.textures[i]);
+        }
+    }
+    SDL3_free(replay.textures);
+    if (replay.renderer) {
+        SDL3_DestroyRenderer(replay.renderer);
+    }
+    SDL3_DestroySurface(replay.surface);
+    SDL3_free(replay.vertices);
+    SDL3_free(replay.sprites);
+    SDL3_free(replay.frames);
+    SDL3_free(replay.pixels);
+    SDL3_free(payload);
+    SDL3_CloseIO(io);
+    return retval;
 }
 
 static SDL_ScaleMode SDL_GetScaleMode(void)
@@ -6451,8 +12348,8 @@ SDL_CreateTexture(SDL_Renderer * renderer, Uint32 format, int access, int w, int
     return texture;
 }
 
-SDL_DECLSPEC SDL_Texture * SDLCALL
-SDL_CreateTextureFromSurface(SDL_Renderer *renderer, SDL2_Surface *surface)
+static SDL_Texture *
+CreateTextureFromSurface(SDL_Renderer *renderer, SDL2_Surface *surface)
 {
     SDL_Texture *texture = SDL3_CreateTextureFromSurface(renderer, Surface2to3(surface));
     if (texture) {
@@ -6461,6 +12358,35 @@ SDL_CreateTextureFromSurface(SDL_Renderer *renderer, SDL2_Surface *surface)
     return texture;
 }
 
+SDL_DECLSPEC SDL_Texture * SDLCALL
+SDL_CreateTextureFromSurface(SDL_Renderer *renderer, SDL2_Surface *surface)
+{
+    RenderTrace trace;
+    SDL_Texture *texture;
+    SDL_Surface *converted = NULL;
+    Uint64 end_ns;
+
+    if (!BeginRenderTrace(&trace, renderer, NULL)) {
+        return CreateTextureFromSurface(renderer, surface);
+    }
+    texture = CreateTextureFromSurface(renderer, surface);
+    end_ns = SDL3_GetTicksNS();
+    if (!texture) {
+        EndRenderTrace(&trace, end_ns, RENDER_TRACE_CREATE_TEXTURE_FROM_SURFACE, 0, NULL, 0, NULL, 0);
+        return NULL;
+    }
+
+    /* Trace the contents like an update with pixels in the texture's format, which SDL3 picked */
+    SDL3_LockMutex(RenderTraceLock);
+    trace.texture = GetTextureTraceID(texture);
+    SDL3_UnlockMutex(RenderTraceLock);
+    converted = SDL3_ConvertSurface(Surface2to3(surface), (SDL_PixelFormat)SDL3_GetNumberProperty(SDL3_GetTextureProperties(texture), SDL_PROP_TEXTURE_FORMAT_NUMBER, SDL_PIXELFORMAT_UNKNOWN));
+    EndRenderTraceUpdate(&trace, end_ns, RENDER_TRACE_CREATE_TEXTURE_FROM_SURFACE, texture, NULL,
+                         converted ? converted->pixels : NULL, converted ? converted->pitch : 0);
+    SDL3_DestroySurface(converted);
+    return texture;
+}
+
 SDL_DECLSPEC int SDLCALL
 SDL_QueryTexture(SDL_Texture *texture, Uint32 *format, int *access, int *w, int *h)
 {
@@ -6484,10 +12410,151 @@ SDL_QueryTexture(SDL_Texture *texture, Uint32 *format, int *access, int *w, int
     return 0;
 }
 
+static int
+UpdateTexture(SDL_Texture *texture, const SDL_Rect *rect, const void *pixels, int pitch)
+{
+    return (FlushTextureSprites(texture) == 0 && SDL3_UpdateTexture(texture, rect, pixels, pitch)) ? 0 : -1;
+}
+
+SDL_DECLSPEC int SDLCALL
+SDL_UpdateTexture(SDL_Texture *texture, const SDL_Rect *rect, const void *pixels, int pitch)
+{
+    RenderTrace trace;
+    Uint64 end_ns;
+    int retval;
+
+    if (!BeginRenderTrace(&trace, SDL3_GetRendererFromTexture(texture), texture)) {
+        return UpdateTexture(texture, rect, pixels, pitch);
+    }
+    retval = UpdateTexture(texture, rect, pixels, pitch);
+    end_ns = SDL3_GetTicksNS();
+    EndRenderTraceUpdate(&trace, end_ns, RENDER_TRACE_UPDATE_TEXTURE, texture, rect, (retval == 0) ? pixels : NULL, pitch);
+    return retval;
+}
+
+static int
+UpdateYUVTexture(SDL_Texture *texture, const SDL_Rect *rect,
+                 const Uint8 *Yplane, int Ypitch,
+                 const Uint8 *Uplane, int Upitch,
+                 const Uint8 *Vplane, int Vpitch)
+{
+    return (FlushTextureSprites(texture) == 0 && SDL3_UpdateYUVTexture(texture, rect, Yplane, Ypitch, Uplane, Upitch, Vplane, Vpitch)) ? 0 : -1;
+}
+
+SDL_DECLSPEC int SDLCALL
+SDL_UpdateYUVTexture(SDL_Texture *texture, const SDL_Rect *rect,
+                     const Uint8 *Yplane, int Ypitch,
+                     const Uint8 *Uplane, int Upitch,
+                     const Uint8 *Vplane, int Vpitch)
+{
+    RenderTrace trace;
+    const Uint8 *planes[3];
+    int pitches[3];
+    Uint64 end_ns;
+    int retval;
+
+    if (!BeginRenderTrace(&trace, SDL3_GetRendererFromTexture(texture), texture)) {
+        return UpdateYUVTexture(texture, rect, Yplane, Ypitch, Uplane, Upitch, Vplane, Vpitch);
+    }
+    retval = UpdateYUVTexture(texture, rect, Yplane, Ypitch, Uplane, Upitch, Vplane, Vpitch);
+    end_ns = SDL3_GetTicksNS();
+    planes[0] = Yplane;
+    planes[1] = Uplane;
+    planes[2] = Vplane;
+    pitches[0] = Ypitch;
+    pitches[1] = Upitch;
+    pitches[2] = Vpitch;
+    EndRenderTracePlanes(&trace, end_ns, RENDER_TRACE_UPDATE_YUV_TEXTURE, texture, rect, (retval == 0) ? planes : NULL, pitches);
+    return retval;
+}
+
+static int
+UpdateNVTexture(SDL_Texture *texture, const SDL_Rect *rect,
+                const Uint8 *Yplane, int Ypitch,
+                const Uint8 *UVplane, int UVpitch)
+{
+    return (FlushTextureSprites(texture) == 0 && SDL3_UpdateNVTexture(texture, rect, Yplane, Ypitch, UVplane, UVpitch)) ? 0 : -1;
+}
+
+SDL_DECLSPEC int SDLCALL
+SDL_UpdateNVTexture(SDL_Texture *texture, const SDL_Rect *rect,
+                    const Uint8 *Yplane, int Ypitch,
+                    const Uint8 *UVplane, int UVpitch)
+{
+    RenderTrace trace;
+    const Uint8 *planes[2];
+    int pitches[2];
+    Uint64 end_ns;
+    int retval;
+
+    if (!BeginRenderTrace(&trace, SDL3_GetRendererFromTexture(texture), texture)) {
+        return UpdateNVTexture(texture, rect, Yplane, Ypitch, UVplane, UVpitch);
+    }
+    retval = UpdateNVTexture(texture, rect, Yplane, Ypitch, UVplane, UVpitch);
+    end_ns = SDL3_GetTicksNS();
+    planes[0] = Yplane;
+    planes[1] = UVplane;
+    pitches[0] = Ypitch;
+    pitches[1] = UVpitch;
+    EndRenderTracePlanes(&trace, end_ns, RENDER_TRACE_UPDATE_NV_TEXTURE, texture, rect, (retval == 0) ? planes : NULL, pitches);
+    return retval;
+}
+
+SDL_DECLSPEC int SDLCALL
+SDL_LockTexture(SDL_Texture *texture, const SDL_Rect *rect, void **pixels, int *pitch)
+{
+    if (FlushTextureSprites(texture) < 0 || !SDL3_LockTexture(texture, rect, pixels, pitch)) {
+        return -1;
+    }
+    TraceLockTexture(texture, rect, *pixels, *pitch);
+    return 0;
+}
+
+SDL_DECLSPEC void SDLCALL
+SDL_UnlockTexture(SDL_Texture *texture)
+{
+    TextureTraceLock *lock = GetTextureTraceLock(texture);
+    RenderTrace trace;
+    void *pixels = NULL;
+    int pitch = 0;
+    Uint64 end_ns;
+
+    if (!lock || !BeginRenderTrace(&trace, SDL3_GetRendererFromTexture(texture), texture)) {
+        SDL3_UnlockTexture(texture);
+        return;
+    }
+
+    /* The locked pixels are gone after the unlock, so they're copied out first, without counting that as part of the call */
+    pixels = CopyTextureTraceLock(texture, lock, &pitch);
+    trace.start_ns = SDL3_GetTicksNS();
+    SDL3_UnlockTexture(texture);
+    end_ns = SDL3_GetTicksNS();
+    EndRenderTraceUpdate(&trace, end_ns, RENDER_TRACE_UNLOCK_TEXTURE, texture, lock->has_rect ? &lock->rect : NULL, pixels, pitch);
+    SDL3_free(pixels);
+}
+
+SDL_DECLSPEC void SDLCALL
+SDL_DestroyTexture(SDL_Texture *texture)
+{
+    FlushTextureSprites(texture);
+    TraceDestroyTexture(texture);
+    SDL3_DestroyTexture(texture);
+}
+
+SDL_DECLSPEC int SDLCALL
+SDL_SetTextureBlendMode(SDL_Texture *texture, SDL_BlendMode blendMode)
+{
+    return (FlushTextureSprites(texture) == 0 && SDL3_SetTextureBlendMode(texture, blendMode)) ? 0 : -1;
+}
+
 SDL_DECLSPEC int SDLCALL
 SDL_SetTextureScaleMode(SDL_Texture *texture, SDL_ScaleMode scaleMode)
 {
     SDL_PropertiesID props = SDL3_GetTextureProperties(texture);
+
+    if (FlushTextureSprites(texture) < 0) {
+        return -1;
+    }
     if (props) {
         SDL3_SetNumberProperty(props, PROP_TEXTURE_SCALE_MODE, scaleMode);
     }
@@ -7207,6 +13274,9 @@ SDL_Quit(void)
     TouchFingers = NULL;
     NumTouchFingers = 0;
 
+    FreePendingWindowEvents();
+    FreeSensorTimestamps();
+
     if (timers) {
         SDL3_DestroyProperties(timers);
         timers = 0;
@@ -9295,18 +15365,69 @@ SDL_GetPixelFormatName(Uint32 format)
     }
 }
 
+/* Like SDL2, non-palettized formats are shared: every SDL_AllocFormat() of the same pixel format
+ * returns the same refcounted object. Unlike SDL2, they stay in the list when the last reference
+ * goes away, so surfaces that come and go don't allocate a format each time. There are only a few
+ * dozen pixel formats, so this can't grow much.
+ *
+ * Palettized formats are never shared, as in SDL2: SDL_SetPixelFormatPalette() changes the format
+ * in place, and every surface sets its own palette on its format. Sharing them by format and
+ * palette wouldn't help either, because surfaces get their format before their palette, and
+ * copy-on-write can't work when the caller keeps the pointer it had.
+ */
+static SDL_SpinLock FormatsLock = 0;
+static SDL2_PixelFormat *Formats = NULL;
+
+static void FreeFormats(void)
+{
+    SDL2_PixelFormat *format;
+    SDL2_PixelFormat *next;
+
+    SDL3_LockSpinlock(&FormatsLock);
+    for (format = Formats; format; format = next) {
+        next = format->next;
+        if (format->refcount > 0) {
+            /* Still in use, leak it rather than leave the app with a dangling pointer */
+            format->next = NULL;
+            continue;
+        }
+        if (format->palette) {
+            SDL_FreePalette(format->palette);
+        }
+        SDL3_free(format);
+    }
+    Formats = NULL;
+    SDL3_UnlockSpinlock(&FormatsLock);
+}
+
 SDL_DECLSPEC SDL2_PixelFormat * SDLCALL
 SDL_AllocFormat(Uint32 pixel_format)
 {
     SDL2_PixelFormat *format;
+    const SDL_PixelFormatDetails *details;
+
+    /* Look it up in our list of previously allocated formats */
+    SDL3_LockSpinlock(&FormatsLock);
+    for (format = Formats; format; format = format->next) {
+        if (format->format == pixel_format) {
+            ++format->refcount;
+            SDL3_UnlockSpinlock(&FormatsLock);
+            return format;
+        }
+    }
+    SDL3_UnlockSpinlock(&FormatsLock);
 
-    const SDL_PixelFormatDetails *details = SDL3_GetPixelFormatDetails((SDL_PixelFormat)pixel_format);
+    details = SDL3_GetPixelFormatDetails((SDL_PixelFormat)pixel_format);
     if (!details) {
         return NULL;
     }
 
     /* Allocate an empty pixel format structure, and initialize it */
     format = (SDL2_PixelFormat *)SDL3_calloc(1, sizeof(*format));
+    if (!format) {
+        SDL3_OutOfMemory();
+        return NULL;
+    }
     format->format = details->format;
     format->BitsPerPixel = details->bits_per_pixel;
     format->BytesPerPixel = details->bytes_per_pixel;
@@ -9324,6 +15445,29 @@ SDL_AllocFormat(Uint32 pixel_format)
     format->Ashift = details->Ashift;
     format->refcount = 1;
 
+    if (!SDL_ISPIXELFORMAT_INDEXED(format->format)) {
+        SDL2_PixelFormat *existing;
+
+        SDL3_LockSpinlock(&FormatsLock);
+        /* Another thread might have added it in the meantime */
+        for (existing = Formats; existing; existing = existing->next) {
+            if (existing->format == format->format) {
+                break;
+            }
+        }
+        if (existing) {
+            ++existing->refcount;
+        } else {
+            format->next = Formats;
+            Formats = format;
+        }
+        SDL3_UnlockSpinlock(&FormatsLock);
+
+        if (existing) {
+            SDL3_free(format);
+            format = existing;
+        }
+    }
     return format;
 }
 
@@ -9335,6 +15479,20 @@ SDL_FreeFormat(SDL2_PixelFormat *format)
         return;
     }
 
+    if (!SDL_ISPIXELFORMAT_INDEXED(format->format)) {
+        /* Shared formats stay in the list for the next SDL_AllocFormat() */
+        SDL3_LockSpinlock(&FormatsLock);
+        if (format->refcount > 0) {
+            --format->refcount;
+        }
+        SDL3_UnlockSpinlock(&FormatsLock);
+        return;
+    }
+
+    if (--format->refcount > 0) {
+        return;
+    }
+
     if (format->palette) {
         SDL_FreePalette(format->palette);
     }
@@ -9575,6 +15733,7 @@ SDL_GL_BindTexture(SDL_Texture *texture, float *texw, float *texh)
     }
 
     /* always flush the renderer here; good enough. SDL2 only flushed if the texture might have changed, but we'll be conservative. */
+    FlushRendererSprites(renderer);
     SDL3_FlushRenderer(renderer);
 
     if ((tex = SDL3_GetNumberProperty(props, SDL_PROP_TEXTURE_OPENGL_TEXTURE_NUMBER, -1)) != -1) {  // opengl renderer.
@@ -9832,7 +15991,21 @@ SDL_GetRGBA(Uint32 pixel, const SDL2_PixelFormat *format2, Uint8 * r, Uint8 * g,
 SDL_DECLSPEC SDL_Renderer * SDLCALL
 SDL_CreateSoftwareRenderer(SDL2_Surface *surface)
 {
-    return SDL3_CreateSoftwareRenderer(Surface2to3(surface));
+    SDL_Surface *surface3 = Surface2to3(surface);
+    SDL_Renderer *renderer = SDL3_CreateSoftwareRenderer(surface3);
+    RendererState *state;
+
+    /* Remember a window surface, see SetRendererSurfaceDamaged() */
+    if (renderer && (surface->flags & SDL_DONTFREE)) {
+        state = GetRendererState(renderer, true);
+        if (state && !state->damage_surface) {
+            /* Keep it alive, the window may replace its surface before the renderer goes away */
+            ++surface3->refcount;
+            state->damage_surface = surface3;
+        }
+        SetSurfaceDamaged(surface3);
+    }
+    return renderer;
 }
 
 SDL_DECLSPEC int SDLCALL
@@ -9860,6 +16033,7 @@ SDL_LockSurface(SDL2_Surface *surface)
         if (!SDL3_LockSurface(surface3)) {
             return -1;
         }
+        AddSurfaceDamage(surface, surface3, NULL);
         surface->pixels = surface3->pixels;
         surface->pitch = surface3->pitch;
     }
@@ -9985,14 +16159,14 @@ SDL_GetWindowSurface(SDL_Window *window)
     SDL_Surface *surface = SDL3_GetWindowSurface(window);
     SDL2_Surface *surface2 = NULL;
     if (surface) {
-        surface2 = (SDL2_Surface *)SDL3_GetPointerProperty(SDL3_GetSurfaceProperties(surface), PROP_SURFACE2, NULL);
+        surface2 = FindSurface2(surface);
         if (!surface2) {
             /* See if we can reuse an existing surface */
             surface2 = (SDL2_Surface *)SDL3_GetPointerProperty(SDL3_GetWindowProperties(window), PROP_SURFACE2, NULL);
             if (surface2) {
                 /* Link the new window surface to the SDL2 window surface */
                 surface2->map = (SDL_BlitMap *)surface;
-                SDL3_SetPointerProperty(SDL3_GetSurfaceProperties(surface), PROP_SURFACE2, surface2);
+                LinkSurfaces(surface, surface2);
 
                 surface2->flags = (surface->flags & SHARED_SURFACE_FLAGS) | SDL_DONTFREE;
                 surface2->w = surface->w;
@@ -10014,13 +16188,44 @@ SDL_GetWindowSurface(SDL_Window *window)
     return surface2;
 }
 
+SDL_DECLSPEC int SDLCALL
+SDL_UpdateWindowSurface(SDL_Window *window)
+{
+    if (SDL2_WindowSurfaceDamage && window && SDL3_WindowHasSurface(window)) {
+        SDL_Surface *surface = SDL3_GetWindowSurface(window);
+        SurfaceDamage *damage = surface ? GetSurfaceDamage(surface) : NULL;
+        int result;
+
+        if (damage && !damage->full) {
+            if (damage->num_rects == 0) {
+                return 0;  /* nothing changed since the last update */
+            }
+            result = UpdateWindowSurfaceWithGamma(window, damage->rects, damage->num_rects);
+            damage->num_rects = 0;
+            return result;
+        }
+        if (damage) {
+            damage->full = false;
+            damage->num_rects = 0;
+        }
+    }
+    return UpdateWindowSurfaceWithGamma(window, NULL, 0);
+}
+
+SDL_DECLSPEC int SDLCALL
+SDL_UpdateWindowSurfaceRects(SDL_Window *window, const SDL_Rect *rects, int numrects)
+{
+    return UpdateWindowSurfaceWithGamma(window, rects, numrects);
+}
+
 SDL_DECLSPEC int SDLCALL
 SDL_LockTextureToSurface(SDL_Texture *texture, const SDL_Rect *rect, SDL2_Surface **surface)
 {
     SDL_Surface *surface3 = NULL;
-    if (!SDL3_LockTextureToSurface(texture, rect, &surface3)) {
+    if (FlushTextureSprites(texture) < 0 || !SDL3_LockTextureToSurface(texture, rect, &surface3)) {
         return -1;
     }
+    TraceLockTexture(texture, rect, surface3->pixels, surface3->pitch);
     *surface = Surface3to2(surface3);
     return 0;
 }
@@ -10132,6 +16337,11 @@ SDL_EventState(Uint32 type, int state)
 #endif
         }
         SDL3_SetEventEnabled(type, false);
+        if (type == SDL2_WINDOWEVENT) {
+            ResetPendingWindowEvents();  /* disabling the event dropped any queued ones. */
+        } else if (type == SDL_EVENT_MOUSE_MOTION) {
+            ResetPendingMouseMotion();
+        }
     }
     return retval;
 }
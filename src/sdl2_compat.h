@@ -1560,6 +1560,43 @@ typedef struct SDL2_VirtualJoystickDesc
     int (SDLCALL *SendEffect)(void *userdata, const void *data, int size); /**< Implements SDL_SendJoystickEffect() */
 } SDL2_VirtualJoystickDesc;
 
+/* sdl2-compat extensions, see include/SDL2/SDL_compat.h */
+#define SDL2_COMPAT_EVENT_LATENCY_BUCKETS 24
+#define SDL2_COMPAT_EVENT_UNSUPPORTED 0xFFFFFFFFu
+
+typedef struct SDL2_CompatEventStats
+{
+    Uint32 type;
+    Uint32 padding;
+    Uint64 count;
+    Uint64 dropped;
+    Uint64 coalesced;
+    Uint64 delivered;
+    Uint64 bridge_ns;
+    Uint64 gesture_ns;
+    Uint64 dispatch_ns;
+    Uint64 latency[SDL2_COMPAT_EVENT_LATENCY_BUCKETS];
+} SDL2_CompatEventStats;
+
+typedef struct SDL2_CompatSprite
+{
+    SDL_Texture *texture;
+    SDL_Rect srcrect;
+    SDL_FRect dstrect;
+    double angle;
+    SDL_FlipMode flip;
+    SDL_Color color;
+} SDL2_CompatSprite;
+
+typedef struct SDL2_CompatRenderCallStats
+{
+    const char *name;
+    Uint64 count;
+    Uint64 bytes;
+    Uint64 recorded_ns;
+    Uint64 replayed_ns;
+} SDL2_CompatRenderCallStats;
+
 typedef int SDL2_TimerID;
 typedef Uint32 (SDLCALL * SDL2_TimerCallback) (Uint32 interval, void *param);
 
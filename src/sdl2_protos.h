@@ -962,6 +962,21 @@ SDL2_PROTO(int,GDKGetDefaultUser,(XUserHandle *a))
 #endif
 SDL2_PROTO(Uint64,GameControllerGetSteamHandle,(SDL_GameController *a))
 
+/* sdl2-compat extensions, see include/SDL2/SDL_compat.h */
+SDL2_PROTO(int,CompatPollEvents,(SDL2_Event *a, int b))
+SDL2_PROTO(int,CompatGetEventStats,(SDL2_CompatEventStats *a, int b))
+SDL2_PROTO(void,CompatResetEventStats,(void))
+SDL2_PROTO(int,CompatStartEventRecording,(const char *a))
+SDL2_PROTO(void,CompatStopEventRecording,(void))
+SDL2_PROTO(int,CompatStartEventReplay,(const char *a, SDL2_bool b))
+SDL2_PROTO(SDL2_bool,CompatIsEventReplayDone,(void))
+SDL2_PROTO(int,CompatStopEventReplay,(void))
+SDL2_PROTO(int,CompatBlitSurfaces,(SDL2_Surface *a, const SDL_Rect *b, SDL2_Surface *c, SDL_Rect *d, int e))
+SDL2_PROTO(int,CompatRenderSprites,(SDL_Renderer *a, const SDL2_CompatSprite *b, int c))
+SDL2_PROTO(int,CompatStartRenderRecording,(const char *a))
+SDL2_PROTO(void,CompatStopRenderRecording,(void))
+SDL2_PROTO(int,CompatReplayRenderRecording,(const char *a, SDL2_CompatRenderCallStats *b, int c))
+
 #ifdef __cplusplus
 }
 #endif
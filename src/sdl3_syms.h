@@ -131,6 +131,7 @@ SDL3_SYM(bool,ClearError,(void),(),return)
 SDL3_SYM(bool,ClearProperty,(SDL_PropertiesID a, const char *b),(a,b),return)
 SDL3_SYM(void,CloseAudioDevice,(SDL_AudioDeviceID a),(a),)
 SDL3_SYM(bool,CloseIO,(SDL_IOStream *a),(a),return)
+SDL3_SYM(void,CloseSensor,(SDL_Sensor *a),(a),)
 SDL3_SYM_PASSTHROUGH(SDL_BlendMode,ComposeCustomBlendMode,(SDL_BlendFactor a, SDL_BlendFactor b, SDL_BlendOperation c, SDL_BlendFactor d, SDL_BlendFactor e, SDL_BlendOperation f),(a,b,c,d,e,f),return)
 SDL3_SYM(bool,ConvertEventToRenderCoordinates,(SDL_Renderer *a, SDL_Event *b),(a,b),return)
 SDL3_SYM(bool,ConvertPixelsAndColorspace,(int a, int b, SDL_PixelFormat c, SDL_Colorspace d, SDL_PropertiesID e, const void *f, int g, SDL_PixelFormat h, SDL_Colorspace i, SDL_PropertiesID j, void *k, int l),(a,b,c,d,e,f,g,h,i,j,k,l),return)
@@ -159,6 +160,7 @@ SDL3_SYM(SDL_Window*,CreateWindowWithProperties,(SDL_PropertiesID a),(a),return)
 SDL3_SYM(bool,CursorVisible,(void),(),return)
 SDL3_SYM(void,RemoveHintCallback,(const char *a, SDL_HintCallback b, void *c),(a,b,c),)
 SDL3_SYM_PASSTHROUGH(void,Delay,(Uint32 a),(a),)
+SDL3_SYM(void,DelayNS,(Uint64 a),(a),)
 SDL3_SYM(void,DestroyAudioStream,(SDL_AudioStream *a),(a),)
 SDL3_SYM_RENAMED(void,DestroyCond,DestroyCondition,(SDL_Condition *a),(a),)
 SDL3_SYM(void,DestroyEnvironment,(SDL_Environment *a),(a),)
@@ -168,7 +170,7 @@ SDL3_SYM(void,DestroyProperties,(SDL_PropertiesID a),(a),)
 SDL3_SYM_PASSTHROUGH(void,DestroyRenderer,(SDL_Renderer *a),(a),)
 SDL3_SYM_PASSTHROUGH(void,DestroySemaphore,(SDL_Semaphore *a),(a),)
 SDL3_SYM(void,DestroySurface,(SDL_Surface *a),(a),)
-SDL3_SYM_PASSTHROUGH(void,DestroyTexture,(SDL_Texture *a),(a),)
+SDL3_SYM(void,DestroyTexture,(SDL_Texture *a),(a),)
 SDL3_SYM_PASSTHROUGH(void,DestroyWindow,(SDL_Window *a),(a),)
 SDL3_SYM_PASSTHROUGH_RETCODE(bool,DestroyWindowSurface,(SDL_Window *a),(a),return)
 SDL3_SYM_PASSTHROUGH(void,DetachThread,(SDL_Thread *a),(a),)
@@ -184,8 +186,8 @@ SDL3_SYM(bool,FillSurfaceRects,(SDL_Surface *a, const SDL_Rect *b, int c, Uint32
 SDL3_SYM(void,FilterEvents,(SDL_EventFilter a, void *b),(a,b),)
 SDL3_SYM_PASSTHROUGH_RETCODE(bool,FlashWindow,(SDL_Window *a, SDL_FlashOperation b),(a,b),return)
 SDL3_SYM(bool,FlushAudioStream,(SDL_AudioStream *a),(a),return)
-SDL3_SYM_PASSTHROUGH(void,FlushEvent,(Uint32 a),(a),)
-SDL3_SYM_PASSTHROUGH(void,FlushEvents,(Uint32 a, Uint32 b),(a,b),)
+SDL3_SYM(void,FlushEvent,(Uint32 a),(a),)
+SDL3_SYM(void,FlushEvents,(Uint32 a, Uint32 b),(a,b),)
 SDL3_SYM_RENAMED(void,FreeCursor,DestroyCursor,(SDL_Cursor *a),(a),)
 SDL3_SYM_PASSTHROUGH(SDL_GLContext,GL_CreateContext,(SDL_Window *a),(a),return)
 SDL3_SYM(bool,GL_DestroyContext,(SDL_GLContext a),(a),return)
@@ -400,6 +402,7 @@ SDL3_SYM(bool,GetTextureSize,(SDL_Texture *a, float *b, float *c),(a,b),return)
 SDL3_SYM(Uint64,GetThreadID,(SDL_Thread *a),(a),return)
 SDL3_SYM_PASSTHROUGH(const char*,GetThreadName,(SDL_Thread *a),(a),return)
 SDL3_SYM(Uint64,GetTicks,(void),(),return)
+SDL3_SYM(Uint64,GetTicksNS,(void),(),return)
 SDL3_SYM(const char*,GetTouchDeviceName,(SDL_TouchID a),(a),return)
 SDL3_SYM_PASSTHROUGH(SDL_TouchDeviceType,GetTouchDeviceType,(SDL_TouchID a),(a),return)
 SDL3_SYM(SDL_TouchID*,GetTouchDevices,(int *a),(a),return)
@@ -526,7 +529,7 @@ SDL3_SYM(bool,LoadWAV_IO,(SDL_IOStream *a, bool b, SDL_AudioSpec *c, Uint8 **d,
 SDL3_SYM(bool,LockAudioStream,(SDL_AudioStream *a),(a),return)
 SDL3_SYM(void,LockMutex,(SDL_Mutex *a),(a),)
 SDL3_SYM(bool,LockSurface,(SDL_Surface *a),(a),return)
-SDL3_SYM_PASSTHROUGH_RETCODE(bool,LockTexture,(SDL_Texture *a, const SDL_Rect *b, void **c, int *d),(a,b,c,d),return)
+SDL3_SYM(bool,LockTexture,(SDL_Texture *a, const SDL_Rect *b, void **c, int *d),(a,b,c,d),return)
 SDL3_SYM(bool,LockTextureToSurface,(SDL_Texture *a, const SDL_Rect *b, SDL_Surface **c),(a,b,c),return)
 SDL3_SYM(void,GetLogOutputFunction,(SDL_LogOutputFunction *a, void **b),(a,b),)
 SDL3_SYM(SDL_LogPriority,GetLogPriority,(int a),(a),return)
@@ -579,7 +582,7 @@ SDL3_SYM(bool,RenderCoordinatesFromWindow,(SDL_Renderer *a, float b, float c, fl
 SDL3_SYM(bool,RenderCoordinatesToWindow,(SDL_Renderer *a, float b, float c, float *d, float *e),(a,b,c,d,e),return)
 SDL3_SYM(bool,RenderFillRect,(SDL_Renderer *a, const SDL_FRect *b),(a,b),return)
 SDL3_SYM(bool,RenderFillRects,(SDL_Renderer *a, const SDL_FRect *b, int c),(a,b,c),return)
-SDL3_SYM_RENAMED_RETCODE(bool,RenderFlush,FlushRenderer,(SDL_Renderer *a),(a),return)
+SDL3_SYM(bool,FlushRenderer,(SDL_Renderer *a),(a),return)
 SDL3_SYM(bool,RenderGeometryRaw,(SDL_Renderer *a, SDL_Texture *b, const float *c, int d, const SDL_FColor *e, int f, const float *g, int h, int i, const void *j, int k, int l),(a,b,c,d,e,f,g,h,i,j,k,l),return)
 SDL3_SYM_RENAMED(void*,RenderGetMetalCommandEncoder,GetRenderMetalCommandEncoder,(SDL_Renderer *a),(a),return)
 SDL3_SYM_RENAMED(void*,RenderGetMetalLayer,GetRenderMetalLayer,(SDL_Renderer *a),(a),return)
@@ -591,10 +594,11 @@ SDL3_SYM(bool,RenderPresent,(SDL_Renderer *a),(a),return)
 SDL3_SYM(SDL_Surface *,RenderReadPixels,(SDL_Renderer *a, const SDL_Rect *b),(a,b),return)
 SDL3_SYM(bool,RenderRect,(SDL_Renderer *a, const SDL_FRect *b),(a,b),return)
 SDL3_SYM(bool,RenderRects,(SDL_Renderer *a, const SDL_FRect *b, int c),(a,b,c),return)
-SDL3_SYM_RENAMED_RETCODE(bool,RenderSetScale,SetRenderScale,(SDL_Renderer *a, float b, float c),(a,b,c),return)
+SDL3_SYM(bool,SetRenderScale,(SDL_Renderer *a, float b, float c),(a,b,c),return)
 SDL3_SYM_RENAMED_RETCODE(bool,RenderSetVSync,SetRenderVSync,(SDL_Renderer *a, int b),(a,b),return)
 SDL3_SYM(bool,RenderTexture,(SDL_Renderer *a, SDL_Texture *b, const SDL_FRect *c, const SDL_FRect *d),(a,b,c,d),return)
 SDL3_SYM(bool,RenderTextureRotated,(SDL_Renderer *a, SDL_Texture *b, const SDL_FRect *c, const SDL_FRect *d, double e, const SDL_FPoint *f, SDL_FlipMode g),(a,b,c,d,e,f,g),return)
+SDL3_SYM(bool,RenderViewportSet,(SDL_Renderer *a),(a),return)
 SDL3_SYM_PASSTHROUGH(SDL_AssertState,ReportAssertion,(SDL_AssertData *a, const char *b, const char *c, int d),(a,b,c,d),return)
 SDL3_SYM_PASSTHROUGH(void,ResetAssertionReport,(void),(),)
 SDL3_SYM(bool,ResetHint,(const char *a),(a),return)
@@ -607,7 +611,6 @@ SDL3_SYM_RENAMED(size_t,SIMDGetAlignment,GetSIMDAlignment,(void),(),return)
 SDL3_SYM(bool,SaveBMP_IO,(SDL_Surface *a, SDL_IOStream *b, bool c),(a,b,c),return)
 SDL3_SYM(Sint64,SeekIO,(SDL_IOStream *a, Sint64 b, SDL_IOWhence c),(a,b,c),return)
 SDL3_SYM_RENAMED(Uint32,SemValue,GetSemaphoreValue,(SDL_Semaphore *a),(a),return)
-SDL3_SYM_RENAMED(void,SensorClose,CloseSensor,(SDL_Sensor *a),(a),)
 SDL3_SYM_RENAMED_RETCODE(bool,SensorGetData,GetSensorData,(SDL_Sensor *a, float *b, int c),(a,b,c),return)
 SDL3_SYM_RENAMED(const char*,SensorGetName,GetSensorName,(SDL_Sensor *a),(a),return)
 SDL3_SYM_RENAMED(int,SensorGetNonPortableType,GetSensorNonPortableType,(SDL_Sensor *a),(a),return)
@@ -651,12 +654,13 @@ SDL3_SYM(bool,SetSurfaceBlendMode,(SDL_Surface *a, SDL_BlendMode b),(a,b),return
 SDL3_SYM(bool,SetSurfaceClipRect,(SDL_Surface *a, const SDL_Rect *b),(a,b),return)
 SDL3_SYM(bool,SetSurfaceColorKey,(SDL_Surface *a, bool b, Uint32 c),(a,b,c),return)
 SDL3_SYM(bool,SetSurfaceColorMod,(SDL_Surface *a, Uint8 b, Uint8 c, Uint8 d),(a,b,c,d),return)
+SDL3_SYM(bool,SetSurfaceColorspace,(SDL_Surface *a, SDL_Colorspace b),(a,b),return)
 SDL3_SYM(bool,SetSurfacePalette,(SDL_Surface *a, SDL_Palette *b),(a,b),return)
 SDL3_SYM(bool,SetSurfaceRLE,(SDL_Surface *a, bool b),(a,b),return)
 SDL3_SYM(bool,SetTLS,(SDL_TLSID *a, const void *b, SDL_TLSDestructorCallback c),(a,b,c),return)
 SDL3_SYM(bool,SetTextInputArea,(SDL_Window *a, const SDL_Rect *b, int c),(a,b,c),return)
 SDL3_SYM_PASSTHROUGH_RETCODE(bool,SetTextureAlphaMod,(SDL_Texture *a, Uint8 b),(a,b),return)
-SDL3_SYM_PASSTHROUGH_RETCODE(bool,SetTextureBlendMode,(SDL_Texture *a, SDL_BlendMode b),(a,b),return)
+SDL3_SYM(bool,SetTextureBlendMode,(SDL_Texture *a, SDL_BlendMode b),(a,b),return)
 SDL3_SYM_PASSTHROUGH_RETCODE(bool,SetTextureColorMod,(SDL_Texture *a, Uint8 b, Uint8 c, Uint8 d),(a,b,c,d),return)
 SDL3_SYM(bool,SetTextureScaleMode,(SDL_Texture *a, SDL_ScaleMode b),(a,b),return)
 SDL3_SYM_RENAMED_RETCODE(bool,SetThreadPriority,SetCurrentThreadPriority,(SDL_ThreadPriority a),(a),return)
@@ -704,14 +708,14 @@ SDL3_SYM(void,UnloadObject,(SDL_SharedObject *a),(a),)
 SDL3_SYM(bool,UnlockAudioStream,(SDL_AudioStream *a),(a),return)
 SDL3_SYM(void,UnlockMutex,(SDL_Mutex *a),(a),)
 SDL3_SYM(void,UnlockSurface,(SDL_Surface *a),(a),)
-SDL3_SYM_PASSTHROUGH(void,UnlockTexture,(SDL_Texture *a),(a),)
+SDL3_SYM(void,UnlockTexture,(SDL_Texture *a),(a),)
 SDL3_SYM(bool,UnsetEnvironmentVariable,(SDL_Environment *a, const char *b),(a,b),return)
 SDL3_SYM(bool,UpdateHapticEffect,(SDL_Haptic *a, int b, const SDL_HapticEffect *c),(a,b,c),return)
-SDL3_SYM_PASSTHROUGH_RETCODE(bool,UpdateNVTexture,(SDL_Texture *a, const SDL_Rect *b, const Uint8 *c, int d, const Uint8 *e, int f),(a,b,c,d,e,f),return)
-SDL3_SYM_PASSTHROUGH_RETCODE(bool,UpdateTexture,(SDL_Texture *a, const SDL_Rect *b, const void *c, int d),(a,b,c,d),return)
-SDL3_SYM_PASSTHROUGH_RETCODE(bool,UpdateWindowSurface,(SDL_Window *a),(a),return)
-SDL3_SYM_PASSTHROUGH_RETCODE(bool,UpdateWindowSurfaceRects,(SDL_Window *a, const SDL_Rect *b, int c),(a,b,c),return)
-SDL3_SYM_PASSTHROUGH_RETCODE(bool,UpdateYUVTexture,(SDL_Texture *a, const SDL_Rect *b, const Uint8 *c, int d, const Uint8 *e, int f, const Uint8 *g, int h),(a,b,c,d,e,f,g,h),return)
+SDL3_SYM(bool,UpdateNVTexture,(SDL_Texture *a, const SDL_Rect *b, const Uint8 *c, int d, const Uint8 *e, int f),(a,b,c,d,e,f),return)
+SDL3_SYM(bool,UpdateTexture,(SDL_Texture *a, const SDL_Rect *b, const void *c, int d),(a,b,c,d),return)
+SDL3_SYM(bool,UpdateWindowSurface,(SDL_Window *a),(a),return)
+SDL3_SYM(bool,UpdateWindowSurfaceRects,(SDL_Window *a, const SDL_Rect *b, int c),(a,b,c),return)
+SDL3_SYM(bool,UpdateYUVTexture,(SDL_Texture *a, const SDL_Rect *b, const Uint8 *c, int d, const Uint8 *e, int f, const Uint8 *g, int h),(a,b,c,d,e,f,g,h),return)
 SDL3_SYM(bool,Vulkan_CreateSurface,(SDL_Window *a, VkInstance b, const struct VkAllocationCallbacks *c, VkSurfaceKHR *d),(a,b,c,d),return)
 SDL3_SYM(char const* const* ,Vulkan_GetInstanceExtensions,(Uint32 *a),(a),return)
 SDL3_SYM_PASSTHROUGH(void*,Vulkan_GetVkGetInstanceProcAddr,(void),(),return)
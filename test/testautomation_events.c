@@ -5,6 +5,7 @@
 #include <stdio.h>
 
 #include "SDL.h"
+#include "SDL_compat.h"
 #include "SDL_test.h"
 
 /* ================= Test Case Implementation ================== */
@@ -174,6 +175,581 @@ int events_addDelEventWatchWithUserdata(void *arg)
     return TEST_COMPLETED;
 }
 
+/* Event watch that scribbles over the event it was handed */
+int SDLCALL _events_mutatingEventWatch(void *userdata, SDL_Event *event)
+{
+    if (event->type == SDL_USEREVENT) {
+        event->user.code = ~event->user.code;
+        event->user.data1 = NULL;
+    }
+    return 0;
+}
+
+/* Code the checking event watch saw, for events_eventWatchesSeeOriginalEvent */
+Sint32 _eventWatchSeenCode = 0;
+void *_eventWatchSeenData1 = NULL;
+
+/* Event watch that records the user event it was handed */
+int SDLCALL _events_recordingEventWatch(void *userdata, SDL_Event *event)
+{
+    if (event->type == SDL_USEREVENT) {
+        _eventWatchSeenCode = event->user.code;
+        _eventWatchSeenData1 = event->user.data1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Checks that an event watch modifying its event doesn't affect the other watches
+ *
+ * @sa http://wiki.libsdl.org/SDL_AddEventWatch
+ * @sa http://wiki.libsdl.org/SDL_DelEventWatch
+ *
+ */
+int events_eventWatchesSeeOriginalEvent(void *arg)
+{
+    SDL_Event event;
+
+    /* Create user event */
+    event.type = SDL_USEREVENT;
+    event.user.code = SDLTest_RandomSint32();
+    event.user.data1 = (void *)&_userdataValue1;
+    event.user.data2 = (void *)&_userdataValue2;
+
+    /* Watches are called newest first, so sandwich the recorder between two mutating watches */
+    SDL_AddEventWatch(_events_mutatingEventWatch, NULL);
+    SDL_AddEventWatch(_events_recordingEventWatch, NULL);
+    SDL_AddEventWatch(_events_mutatingEventWatch, &_userdataValue);
+    SDLTest_AssertPass("Call to SDL_AddEventWatch()");
+
+    _eventWatchSeenCode = ~event.user.code;
+    _eventWatchSeenData1 = NULL;
+
+    /* Push a user event onto the queue and force queue update */
+    SDL_PushEvent(&event);
+    SDLTest_AssertPass("Call to SDL_PushEvent()");
+    SDL_PumpEvents();
+    SDLTest_AssertPass("Call to SDL_PumpEvents()");
+    SDLTest_AssertCheck(_eventWatchSeenCode == event.user.code, "Check event code seen by watch, expected: %d, got: %d", (int)event.user.code, (int)_eventWatchSeenCode);
+    SDLTest_AssertCheck(_eventWatchSeenData1 == event.user.data1, "Check event data1 seen by watch");
+
+    SDL_DelEventWatch(_events_mutatingEventWatch, &_userdataValue);
+    SDL_DelEventWatch(_events_recordingEventWatch, NULL);
+    SDL_DelEventWatch(_events_mutatingEventWatch, NULL);
+    SDLTest_AssertPass("Call to SDL_DelEventWatch()");
+
+    while (SDL_PollEvent(&event)) {
+    }
+
+    return TEST_COMPLETED;
+}
+
+/**
+ * @brief Drains several user events in one call
+ *
+ * @sa SDL_CompatPollEvents
+ */
+int events_compatPollEvents(void *arg)
+{
+    SDL_Event event;
+    SDL_Event events[200];
+    const int numevents = (int)SDL_arraysize(events);
+    Sint32 code;
+    int result;
+    int i;
+
+    /* Start from an empty queue */
+    while (SDL_PollEvent(&event)) {
+    }
+
+    /* Push more user events than fit in one conversion batch */
+    code = SDLTest_RandomIntegerInRange(-1024, 1024);
+    for (i = 0; i < numevents; i++) {
+        event.type = SDL_USEREVENT;
+        event.user.code = code + i;
+        event.user.data1 = (void *)&_userdataValue1;
+        event.user.data2 = (void *)&_userdataValue2;
+        SDL_PushEvent(&event);
+    }
+    SDLTest_AssertPass("Call to SDL_PushEvent() x%d", numevents);
+
+    result = SDL_CompatPollEvents(events, numevents - 1);
+    SDLTest_AssertPass("Call to SDL_CompatPollEvents()");
+    SDLTest_AssertCheck(result == numevents - 1, "Check result from SDL_CompatPollEvents, expected: %d, got: %d", numevents - 1, result);
+    for (i = 0; i < result; i++) {
+        if (events[i].type != SDL_USEREVENT || events[i].user.code != code + i) {
+            break;
+        }
+    }
+    SDLTest_AssertCheck(i == result, "Check events are returned in queue order, first mismatch at: %d", i);
+
+    /* Only the last one should be left */
+    result = SDL_CompatPollEvents(events, numevents);
+    SDLTest_AssertCheck(result == 1, "Check result from SDL_CompatPollEvents, expected: 1, got: %d", result);
+    SDLTest_AssertCheck(events[0].user.code == code + numevents - 1, "Check last event code");
+
+    result = SDL_CompatPollEvents(events, numevents);
+    SDLTest_AssertCheck(result == 0, "Check result from SDL_CompatPollEvents on empty queue, expected: 0, got: %d", result);
+
+    return TEST_COMPLETED;
+}
+
+/* Event watch that does nothing, so events go through sdl2-compat's event filter */
+int SDLCALL _events_idleEventWatch(void *userdata, SDL_Event *event)
+{
+    return 1;
+}
+
+/**
+ * Counts user events with SDL_CompatGetEventStats()
+ */
+int events_compatEventStats(void *arg)
+{
+    SDL_Event event;
+    SDL_CompatEventStats stats[64];
+    const SDL_CompatEventStats *user = NULL;
+    const int numevents = 10;
+    Uint64 latencies = 0;
+    int result;
+    int i;
+
+    /* Start from an empty queue, and make sure events go through sdl2-compat's event filter */
+    while (SDL_PollEvent(&event)) {
+    }
+    SDL_AddEventWatch(_events_idleEventWatch, NULL);
+    SDL_SetHint("SDL2_EVENT_STATS", "1");
+    SDL_CompatResetEventStats();
+    SDLTest_AssertPass("Call to SDL_CompatResetEventStats()");
+
+    result = SDL_CompatGetEventStats(NULL, 0);
+    SDLTest_AssertCheck(result == 0, "Check result from SDL_CompatGetEventStats after reset, expected: 0, got: %d", result);
+
+    for (i = 0; i < numevents; i++) {
+        event.type = SDL_USEREVENT;
+        event.user.code = i;
+        SDL_PushEvent(&event);
+    }
+    /* Take all but one off the queue */
+    for (i = 0; i < numevents - 1; i++) {
+        SDL_PollEvent(&event);
+    }
+
+    result = SDL_CompatGetEventStats(stats, (int)SDL_arraysize(stats));
+    SDLTest_AssertPass("Call to SDL_CompatGetEventStats()");
+    SDLTest_AssertCheck(result >= 1, "Check result from SDL_CompatGetEventStats, expected: >=1, got: %d", result);
+    for (i = 0; i < SDL_min(result, (int)SDL_arraysize(stats)); i++) {
+        if (i > 0) {
+            SDLTest_AssertCheck(stats[i - 1].type < stats[i].type, "Check stats are sorted by type");
+        }
+        if (stats[i].type == SDL_USEREVENT) {
+            user = &stats[i];
+        }
+    }
+    SDLTest_AssertCheck(user != NULL, "Check SDL_USEREVENT has stats");
+    if (user) {
+        for (i = 0; i < SDL_COMPAT_EVENT_LATENCY_BUCKETS; i++) {
+            latencies += user->latency[i];
+        }
+        SDLTest_AssertCheck(user->count == (Uint64)numevents, "Check count, expected: %d, got: %d", numevents, (int)user->count);
+        SDLTest_AssertCheck(user->dropped == 0, "Check dropped, expected: 0, got: %d", (int)user->dropped);
+        SDLTest_AssertCheck(user->delivered == (Uint64)(numevents - 1), "Check delivered, expected: %d, got: %d", numevents - 1, (int)user->delivered);
+        SDLTest_AssertCheck(latencies == user->delivered, "Check latency histogram covers every delivered event, got: %d", (int)latencies);
+    }
+
+    SDL_FlushEvent(SDL_USEREVENT);
+    SDL_DelEventWatch(_events_idleEventWatch, NULL);
+    SDL_SetHint("SDL2_EVENT_STATS", NULL);
+    SDL_CompatResetEventStats();
+
+    return TEST_COMPLETED;
+}
+
+/**
+ * Counts a window event under SDL_WINDOWEVENT with SDL_CompatGetEventStats()
+ */
+int events_compatEventStatsWindowEvent(void *arg)
+{
+    SDL_Window *window;
+    SDL_Event event;
+    SDL_CompatEventStats stats[64];
+    const SDL_CompatEventStats *windowstats = NULL;
+    int moved = 0;
+    int result;
+    int i;
+
+    window = SDL_CreateWindow("events_compatEventStatsWindowEvent", 0, 0, 100, 100, 0);
+    SDLTest_AssertPass("Call to SDL_CreateWindow()");
+    SDLTest_AssertCheck(window != NULL, "Check SDL_CreateWindow result");
+    if (!window) {
+        return TEST_ABORTED;
+    }
+
+    /* Start from an empty queue, and make sure events go through sdl2-compat's event filter */
+    SDL_AddEventWatch(_events_idleEventWatch, NULL);
+    SDL_PumpEvents();
+    while (SDL_PollEvent(&event)) {
+    }
+    SDL_SetHint("SDL2_EVENT_STATS", "1");
+    SDL_CompatResetEventStats();
+
+    SDL_SetWindowPosition(window, 30, 40);
+    SDLTest_AssertPass("Call to SDL_SetWindowPosition()");
+    while (SDL_PollEvent(&event)) {
+        if (event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_MOVED) {
+            moved++;
+        }
+    }
+    SDLTest_AssertCheck(moved == 1, "Check number of move events, expected: 1, got: %d", moved);
+
+    result = SDL_CompatGetEventStats(stats, (int)SDL_arraysize(stats));
+    SDLTest_AssertPass("Call to SDL_CompatGetEventStats()");
+    for (i = 0; i < SDL_min(result, (int)SDL_arraysize(stats)); i++) {
+        /* SDL3's window and display events are numbered right after SDL_WINDOWEVENT and SDL_DISPLAYEVENT */
+        SDLTest_AssertCheck(!(stats[i].type > SDL_DISPLAYEVENT && stats[i].type < SDL_WINDOWEVENT) &&
+                            !(stats[i].type > SDL_SYSWMEVENT && stats[i].type < SDL_KEYDOWN),
+                            "Check stats are kept under SDL2 event types, got: 0x%x", (unsigned int)stats[i].type);
+        if (stats[i].type == SDL_WINDOWEVENT) {
+            windowstats = &stats[i];
+        }
+    }
+    SDLTest_AssertCheck(windowstats != NULL, "Check SDL_WINDOWEVENT has stats");
+    if (windowstats) {
+        SDLTest_AssertCheck(windowstats->count >= (Uint64)moved, "Check count, expected: >=%d, got: %d", moved, (int)windowstats->count);
+        SDLTest_AssertCheck(windowstats->delivered >= (Uint64)moved, "Check delivered, expected: >=%d, got: %d", moved, (int)windowstats->delivered);
+        SDLTest_AssertCheck(windowstats->delivered <= windowstats->count, "Check delivered <= count, got: %d <= %d", (int)windowstats->delivered, (int)windowstats->count);
+    }
+
+    SDL_DelEventWatch(_events_idleEventWatch, NULL);
+    SDL_SetHint("SDL2_EVENT_STATS", NULL);
+    SDL_CompatResetEventStats();
+    SDL_DestroyWindow(window);
+    while (SDL_PollEvent(&event)) {
+    }
+
+    return TEST_COMPLETED;
+}
+
+/**
+ * Counts SDL3 events without an SDL2 version as dropped with SDL_CompatGetEventStats()
+ */
+int events_compatEventStatsUnsupported(void *arg)
+{
+    SDL_Event event;
+    SDL_CompatEventStats stats[64];
+    const SDL_CompatEventStats *unsupported = NULL;
+    SDL_bool textediting_ext = SDL_FALSE;
+    int result;
+    int i;
+
+    /* Start from an empty queue, and make sure events go through sdl2-compat's event filter */
+    while (SDL_PollEvent(&event)) {
+    }
+    SDL_AddEventWatch(_events_idleEventWatch, NULL);
+    SDL_SetHint("SDL2_EVENT_STATS", "1");
+    SDL_CompatResetEventStats();
+
+    /* SDL3's SDL_EVENT_KEYBOARD_REMOVED, right after the number SDL2 uses for SDL_TEXTEDITING_EXT and SDL3 for SDL_EVENT_KEYBOARD_ADDED */
+    SDL_zero(event);
+    event.type = SDL_TEXTEDITING_EXT + 1;
+    SDL_ClearError();
+    result = SDL_PushEvent(&event);
+    SDLTest_AssertCheck(result == 0, "Check result from SDL_PushEvent, expected: 0, got: %d", result);
+    SDLTest_AssertCheck(SDL_PollEvent(&event) == 0, "Check the event didn't reach the queue");
+
+    result = SDL_CompatGetEventStats(stats, (int)SDL_arraysize(stats));
+    SDLTest_AssertPass("Call to SDL_CompatGetEventStats()");
+    for (i = 0; i < SDL_min(result, (int)SDL_arraysize(stats)); i++) {
+        if (stats[i].type == SDL_COMPAT_EVENT_UNSUPPORTED) {
+            unsupported = &stats[i];
+        } else if (stats[i].type == SDL_TEXTEDITING_EXT) {
+            textediting_ext = SDL_TRUE;
+        }
+    }
+    SDLTest_AssertCheck(unsupported != NULL, "Check SDL_COMPAT_EVENT_UNSUPPORTED has stats");
+    if (unsupported) {
+        SDLTest_AssertCheck(unsupported->count == 1, "Check count, expected: 1, got: %d", (int)unsupported->count);
+        SDLTest_AssertCheck(unsupported->dropped == 1, "Check dropped, expected: 1, got: %d", (int)unsupported->dropped);
+        SDLTest_AssertCheck(unsupported->delivered == 0, "Check delivered, expected: 0, got: %d", (int)unsupported->delivered);
+    }
+    SDLTest_AssertCheck(!textediting_ext, "Check nothing was counted as SDL_TEXTEDITING_EXT");
+
+    SDL_DelEventWatch(_events_idleEventWatch, NULL);
+    SDL_SetHint("SDL2_EVENT_STATS", NULL);
+    SDL_CompatResetEventStats();
+
+    return TEST_COMPLETED;
+}
+
+/**
+ * Records a window event and user events to a trace and replays them
+ */
+int events_compatRecordAndReplay(void *arg)
+{
+    const char *file = "testautomation_events.trace";
+    SDL_Window *window;
+    SDL_Event event;
+    Sint32 codes[8];
+    const int numevents = (int)SDL_arraysize(codes);
+    Uint32 windowID;
+    Uint32 start;
+    int moved = 0;
+    int result;
+    int i;
+
+    window = SDL_CreateWindow("events_compatRecordAndReplay", 0, 0, 100, 100, 0);
+    SDLTest_AssertPass("Call to SDL_CreateWindow()");
+    SDLTest_AssertCheck(window != NULL, "Check SDL_CreateWindow result");
+    if (!window) {
+        return TEST_ABORTED;
+    }
+    windowID = SDL_GetWindowID(window);
+
+    /* Start from an empty queue */
+    SDL_PumpEvents();
+    while (SDL_PollEvent(&event)) {
+    }
+
+    result = SDL_CompatStartEventRecording(file);
+    SDLTest_AssertPass("Call to SDL_CompatStartEventRecording()");
+    SDLTest_AssertCheck(result == 0, "Check result from SDL_CompatStartEventRecording, expected: 0, got: %d", result);
+
+    /* The app sees SDL3's window event and the SDL_WINDOWEVENT made from it, only the second is recorded */
+    SDL_SetWindowPosition(window, 30, 40);
+    SDLTest_AssertPass("Call to SDL_SetWindowPosition()");
+    while (SDL_PollEvent(&event)) {
+    }
+
+    for (i = 0; i < numevents; i++) {
+        codes[i] = SDLTest_RandomIntegerInRange(-1024, 1024);
+        event.type = SDL_USEREVENT;
+        event.user.code = codes[i];
+        event.user.data1 = (void *)&_userdataValue1;
+        SDL_PushEvent(&event);
+    }
+    while (SDL_PollEvent(&event)) {
+    }
+
+    SDL_CompatStopEventRecording();
+    SDLTest_AssertPass("Call to SDL_CompatStopEventRecording()");
+
+    result = SDL_CompatStartEventReplay(file, SDL_FALSE);
+    SDLTest_AssertPass("Call to SDL_CompatStartEventReplay()");
+    SDLTest_AssertCheck(result == 0, "Check result from SDL_CompatStartEventReplay, expected: 0, got: %d", result);
+
+    start = SDL_GetTicks();
+    while (!SDL_CompatIsEventReplayDone() && !SDL_TICKS_PASSED(SDL_GetTicks(), start + 5000)) {
+        SDL_Delay(1);
+    }
+    SDLTest_AssertCheck(SDL_CompatIsEventReplayDone(), "Check replay is done");
+
+    result = SDL_CompatStopEventReplay();
+    SDLTest_AssertCheck(result > numevents, "Check result from SDL_CompatStopEventReplay, expected: >%d, got: %d", numevents, result);
+
+    i = 0;
+    while (SDL_PollEvent(&event)) {
+        if (event.type == SDL_WINDOWEVENT && event.window.windowID == windowID && event.window.event == SDL_WINDOWEVENT_MOVED) {
+            if (event.window.data1 == 30 && event.window.data2 == 40) {
+                moved++;
+            }
+        } else if (event.type == SDL_USEREVENT && i >= 0 && i < numevents) {
+            if (event.user.code == codes[i] && event.user.data1 == NULL) {
+                i++;
+            } else {
+                SDLTest_AssertCheck(SDL_FALSE, "Check replayed user events match the recording, first mismatch at: %d", i);
+                i = -1;
+            }
+        }
+    }
+    SDLTest_AssertCheck(i == numevents, "Check all replayed user events match the recording, expected: %d, got: %d", numevents, i);
+    SDLTest_AssertCheck(moved == 1, "Check the move event was replayed once, expected: 1, got: %d", moved);
+
+    SDL_DestroyWindow(window);
+    while (SDL_PollEvent(&event)) {
+    }
+    (void)remove(file);
+
+    return TEST_COMPLETED;
+}
+
+static void _events_pushMouseMotion(int x, int y, int xrel, int yrel)
+{
+    SDL_Event event;
+    SDL_zero(event);
+    event.type = SDL_MOUSEMOTION;
+    event.motion.windowID = 1;
+    event.motion.which = 0;
+    event.motion.x = x;
+    event.motion.y = y;
+    event.motion.xrel = xrel;
+    event.motion.yrel = yrel;
+    SDL_PushEvent(&event);
+}
+
+/**
+ * Checks that SDL2_COALESCE_MOUSE_MOTION merges queued mouse motion without reordering it
+ */
+int events_coalesceMouseMotion(void *arg)
+{
+    SDL_Event event;
+    int result;
+
+    /* Start from an empty queue, and make sure events go through sdl2-compat's event filter */
+    while (SDL_PollEvent(&event)) {
+    }
+    SDL_AddEventWatch(_events_idleEventWatch, NULL);
+    SDL_SetHint("SDL2_COALESCE_MOUSE_MOTION", "1");
+
+    _events_pushMouseMotion(10, 10, 1, 2);
+    _events_pushMouseMotion(11, 12, 1, 2);
+    _events_pushMouseMotion(13, 15, 2, 3);
+    SDL_zero(event);
+    event.type = SDL_MOUSEBUTTONDOWN;
+    event.button.windowID = 1;
+    event.button.button = SDL_BUTTON_LEFT;
+    event.button.state = SDL_PRESSED;
+    SDL_PushEvent(&event);
+    _events_pushMouseMotion(20, 20, 7, 5);
+    _events_pushMouseMotion(21, 22, 1, 2);
+    SDLTest_AssertPass("Call to SDL_PushEvent() with motion, button and motion events");
+
+    result = SDL_PeepEvents(NULL, 0, SDL_PEEKEVENT, SDL_MOUSEMOTION, SDL_MOUSEWHEEL);
+    SDLTest_AssertCheck(result == 3, "Check number of queued mouse events, expected: 3, got: %d", result);
+
+    result = SDL_PollEvent(&event);
+    SDLTest_AssertCheck(result == 1 && event.type == SDL_MOUSEMOTION, "Check first event is mouse motion");
+    SDLTest_AssertCheck(event.motion.x == 13 && event.motion.y == 15, "Check merged position, expected: 13,15, got: %d,%d", event.motion.x, event.motion.y);
+    SDLTest_AssertCheck(event.motion.xrel == 4 && event.motion.yrel == 7, "Check merged relative motion, expected: 4,7, got: %d,%d", event.motion.xrel, event.motion.yrel);
+
+    result = SDL_PollEvent(&event);
+    SDLTest_AssertCheck(result == 1 && event.type == SDL_MOUSEBUTTONDOWN, "Check second event is the button press");
+
+    result = SDL_PollEvent(&event);
+    SDLTest_AssertCheck(result == 1 && event.type == SDL_MOUSEMOTION, "Check third event is mouse motion");
+    SDLTest_AssertCheck(event.motion.x == 21 && event.motion.y == 22, "Check merged position, expected: 21,22, got: %d,%d", event.motion.x, event.motion.y);
+    SDLTest_AssertCheck(event.motion.xrel == 8 && event.motion.yrel == 7, "Check merged relative motion, expected: 8,7, got: %d,%d", event.motion.xrel, event.motion.yrel);
+
+    SDL_SetHint("SDL2_COALESCE_MOUSE_MOTION", NULL);
+    SDL_DelEventWatch(_events_idleEventWatch, NULL);
+    while (SDL_PollEvent(&event)) {
+    }
+
+    return TEST_COMPLETED;
+}
+
+/**
+ * Checks that superseded size and move events are replaced, in the order SDL2 delivered them
+ */
+int events_coalesceWindowEvents(void *arg)
+{
+    SDL_Window *window;
+    SDL_Event event;
+    Uint8 types[8];
+    Sint32 data1[8];
+    int count = 0;
+    Uint32 windowID;
+
+    window = SDL_CreateWindow("events_coalesceWindowEvents", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, 100, 100, SDL_WINDOW_RESIZABLE);
+    SDLTest_AssertPass("Call to SDL_CreateWindow()");
+    SDLTest_AssertCheck(window != NULL, "Check SDL_CreateWindow result");
+    if (!window) {
+        return TEST_ABORTED;
+    }
+    windowID = SDL_GetWindowID(window);
+
+    /* Start from an empty queue, and make sure events go through sdl2-compat's event filter */
+    SDL_AddEventWatch(_events_idleEventWatch, NULL);
+    SDL_PumpEvents();
+    while (SDL_PollEvent(&event)) {
+    }
+
+    /* A requested size only gets a size change, which the resize to the new minimum size supersedes */
+    SDL_SetWindowSize(window, 120, 120);
+    SDL_SetWindowMinimumSize(window, 150, 150);
+    SDL_SetWindowPosition(window, 10, 10);
+    SDL_SetWindowPosition(window, 20, 20);
+    SDLTest_AssertPass("Call to SDL_SetWindowSize(), SDL_SetWindowMinimumSize() and SDL_SetWindowPosition()");
+
+    while (SDL_PollEvent(&event)) {
+        if (event.type != SDL_WINDOWEVENT || event.window.windowID != windowID) {
+            continue;
+        }
+        if (event.window.event == SDL_WINDOWEVENT_RESIZED ||
+            event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED ||
+            event.window.event == SDL_WINDOWEVENT_MOVED) {
+            if (count < (int)SDL_arraysize(types)) {
+                types[count] = event.window.event;
+                data1[count] = event.window.data1;
+            }
+            count++;
+        }
+    }
+
+    SDLTest_AssertCheck(count == 3, "Check number of size and move events, expected: 3, got: %d", count);
+    if (count == 3) {
+        SDLTest_AssertCheck(types[0] == SDL_WINDOWEVENT_RESIZED && data1[0] == 150, "Check first event, expected: RESIZED to 150, got: %d to %d", (int)types[0], (int)data1[0]);
+        SDLTest_AssertCheck(types[1] == SDL_WINDOWEVENT_SIZE_CHANGED && data1[1] == 150, "Check second event, expected: SIZE_CHANGED to 150, got: %d to %d", (int)types[1], (int)data1[1]);
+        SDLTest_AssertCheck(types[2] == SDL_WINDOWEVENT_MOVED && data1[2] == 20, "Check third event, expected: MOVED to 20, got: %d to %d", (int)types[2], (int)data1[2]);
+    }
+
+    SDL_DelEventWatch(_events_idleEventWatch, NULL);
+    SDL_DestroyWindow(window);
+    while (SDL_PollEvent(&event)) {
+    }
+
+    return TEST_COMPLETED;
+}
+
+/**
+ * Checks that mouse motion queued after a flush isn't merged into the flushed motion
+ */
+int events_coalesceMouseMotionFlush(void *arg)
+{
+    SDL_Event event;
+    int result;
+    int i;
+
+    /* Start from an empty queue, and make sure events go through sdl2-compat's event filter */
+    while (SDL_PollEvent(&event)) {
+    }
+    SDL_AddEventWatch(_events_idleEventWatch, NULL);
+    SDL_SetHint("SDL2_COALESCE_MOUSE_MOTION", "1");
+
+    for (i = 0; i < 3; i++) {
+        _events_pushMouseMotion(10, 10, 5, 6);
+        switch (i) {
+        case 0:
+            SDL_FlushEvent(SDL_MOUSEMOTION);
+            SDLTest_AssertPass("Call to SDL_FlushEvent(SDL_MOUSEMOTION)");
+            break;
+        case 1:
+            SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+            SDLTest_AssertPass("Call to SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT)");
+            break;
+        case 2:
+            SDL_EventState(SDL_MOUSEMOTION, SDL_DISABLE);
+            SDL_EventState(SDL_MOUSEMOTION, SDL_ENABLE);
+            SDLTest_AssertPass("Call to SDL_EventState(SDL_MOUSEMOTION, SDL_DISABLE)");
+            break;
+        }
+        _events_pushMouseMotion(12, 13, 2, 3);
+
+        result = SDL_PollEvent(&event);
+        SDLTest_AssertCheck(result == 1 && event.type == SDL_MOUSEMOTION, "Check mouse motion is queued after the flush");
+        SDLTest_AssertCheck(event.motion.x == 12 && event.motion.y == 13, "Check position, expected: 12,13, got: %d,%d", event.motion.x, event.motion.y);
+        SDLTest_AssertCheck(event.motion.xrel == 2 && event.motion.yrel == 3, "Check relative motion, expected: 2,3, got: %d,%d", event.motion.xrel, event.motion.yrel);
+
+        result = SDL_PeepEvents(NULL, 0, SDL_PEEKEVENT, SDL_MOUSEMOTION, SDL_MOUSEMOTION);
+        SDLTest_AssertCheck(result == 0, "Check no mouse motion is left in the queue, got: %d", result);
+    }
+
+    SDL_SetHint("SDL2_COALESCE_MOUSE_MOTION", NULL);
+    SDL_DelEventWatch(_events_idleEventWatch, NULL);
+    while (SDL_PollEvent(&event)) {
+    }
+
+    return TEST_COMPLETED;
+}
+
 /* ================= Test References ================== */
 
 /* Events test cases */
@@ -189,9 +765,45 @@ static const SDLTest_TestCaseReference eventsTest3 = {
     (SDLTest_TestCaseFp)events_addDelEventWatchWithUserdata, "events_addDelEventWatchWithUserdata", "Adds and deletes an event watch function with userdata", TEST_ENABLED
 };
 
+static const SDLTest_TestCaseReference eventsTest4 = {
+    (SDLTest_TestCaseFp)events_eventWatchesSeeOriginalEvent, "events_eventWatchesSeeOriginalEvent", "Checks that an event watch modifying its event doesn't affect other watches", TEST_ENABLED
+};
+
+static const SDLTest_TestCaseReference eventsTest5 = {
+    (SDLTest_TestCaseFp)events_compatPollEvents, "events_compatPollEvents", "Drains several user events in one call", TEST_ENABLED
+};
+
+static const SDLTest_TestCaseReference eventsTest6 = {
+    (SDLTest_TestCaseFp)events_compatEventStats, "events_compatEventStats", "Counts user events with SDL_CompatGetEventStats", TEST_ENABLED
+};
+
+static const SDLTest_TestCaseReference eventsTest7 = {
+    (SDLTest_TestCaseFp)events_compatRecordAndReplay, "events_compatRecordAndReplay", "Records a window event and user events to a trace and replays them", TEST_ENABLED
+};
+
+static const SDLTest_TestCaseReference eventsTest8 = {
+    (SDLTest_TestCaseFp)events_coalesceMouseMotion, "events_coalesceMouseMotion", "Checks that SDL2_COALESCE_MOUSE_MOTION merges queued mouse motion without reordering it", TEST_ENABLED
+};
+
+static const SDLTest_TestCaseReference eventsTest9 = {
+    (SDLTest_TestCaseFp)events_coalesceWindowEvents, "events_coalesceWindowEvents", "Checks that superseded size and move events are replaced, in the order SDL2 delivered them", TEST_ENABLED
+};
+
+static const SDLTest_TestCaseReference eventsTest10 = {
+    (SDLTest_TestCaseFp)events_compatEventStatsWindowEvent, "events_compatEventStatsWindowEvent", "Counts a window event under SDL_WINDOWEVENT with SDL_CompatGetEventStats", TEST_ENABLED
+};
+
+static const SDLTest_TestCaseReference eventsTest11 = {
+    (SDLTest_TestCaseFp)events_coalesceMouseMotionFlush, "events_coalesceMouseMotionFlush", "Checks that mouse motion queued after a flush isn't merged into the flushed motion", TEST_ENABLED
+};
+
+static const SDLTest_TestCaseReference eventsTest12 = {
+    (SDLTest_TestCaseFp)events_compatEventStatsUnsupported, "events_compatEventStatsUnsupported", "Counts dropped SDL3 events without an SDL2 version", TEST_ENABLED
+};
+
 /* Sequence of Events test cases */
 static const SDLTest_TestCaseReference *eventsTests[] = {
-    &eventsTest1, &eventsTest2, &eventsTest3, NULL
+    &eventsTest1, &eventsTest2, &eventsTest3, &eventsTest4, &eventsTest5, &eventsTest6, &eventsTest7, &eventsTest8, &eventsTest9, &eventsTest10, &eventsTest11, &eventsTest12, NULL
 };
 
 /* Events test suite (global) */
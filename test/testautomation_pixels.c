@@ -206,6 +206,47 @@ int pixels_allocFreeFormat(void *arg)
     return TEST_COMPLETED;
 }
 
+/**
+ * @brief Check that SDL_AllocFormat shares formats like SDL2 does
+ *
+ * @sa http://wiki.libsdl.org/SDL_AllocFormat
+ * @sa http://wiki.libsdl.org/SDL_FreeFormat
+ */
+int pixels_sharedFormat(void *arg)
+{
+    SDL_PixelFormat *format1;
+    SDL_PixelFormat *format2;
+    SDL_Surface *surface;
+
+    /* RGB formats are shared */
+    format1 = SDL_AllocFormat(SDL_PIXELFORMAT_ARGB8888);
+    format2 = SDL_AllocFormat(SDL_PIXELFORMAT_ARGB8888);
+    SDLTest_AssertPass("Call to SDL_AllocFormat() twice");
+    SDLTest_AssertCheck(format1 != NULL && format1 == format2, "Verify both calls returned the same format");
+    if (format1 != NULL && format1 == format2) {
+        SDLTest_AssertCheck(format1->refcount == 2, "Verify refcount; expected: 2, got %d", format1->refcount);
+
+        surface = SDL_CreateRGBSurfaceWithFormat(0, 8, 8, 32, SDL_PIXELFORMAT_ARGB8888);
+        SDLTest_AssertPass("Call to SDL_CreateRGBSurfaceWithFormat()");
+        SDLTest_AssertCheck(surface != NULL && surface->format == format1, "Verify the surface uses the same format");
+        SDL_FreeSurface(surface);
+
+        SDL_FreeFormat(format2);
+        SDLTest_AssertCheck(format1->refcount == 1, "Verify refcount after SDL_FreeFormat(); expected: 1, got %d", format1->refcount);
+        SDL_FreeFormat(format1);
+    }
+
+    /* Palettized formats each get their own palette, so they aren't */
+    format1 = SDL_AllocFormat(SDL_PIXELFORMAT_INDEX8);
+    format2 = SDL_AllocFormat(SDL_PIXELFORMAT_INDEX8);
+    SDLTest_AssertPass("Call to SDL_AllocFormat(SDL_PIXELFORMAT_INDEX8) twice");
+    SDLTest_AssertCheck(format1 != NULL && format2 != NULL && format1 != format2, "Verify the calls returned different formats");
+    SDL_FreeFormat(format1);
+    SDL_FreeFormat(format2);
+
+    return TEST_COMPLETED;
+}
+
 /**
  * @brief Call to SDL_GetPixelFormatName
  *
@@ -486,9 +527,12 @@ static const SDLTest_TestCaseReference pixelsTest3 =
 static const SDLTest_TestCaseReference pixelsTest4 =
         { (SDLTest_TestCaseFp)pixels_getPixelFormatName, "pixels_getPixelFormatName", "Call to SDL_GetPixelFormatName", TEST_ENABLED };
 
+static const SDLTest_TestCaseReference pixelsTest5 =
+        { (SDLTest_TestCaseFp)pixels_sharedFormat, "pixels_sharedFormat", "Check that SDL_AllocFormat shares formats", TEST_ENABLED };
+
 /* Sequence of Pixels test cases */
 static const SDLTest_TestCaseReference *pixelsTests[] =  {
-    &pixelsTest1, &pixelsTest2, &pixelsTest3, &pixelsTest4, NULL
+    &pixelsTest1, &pixelsTest2, &pixelsTest3, &pixelsTest4, &pixelsTest5, NULL
 };
 
 /* Pixels test suite (global) */
@@ -7,6 +7,7 @@
 
 #include "SDL.h"
 #include "SDL_test.h"
+#include "SDL_compat.h"
 
 /* ================= Test Case Implementation ================== */
 
@@ -941,6 +942,602 @@ int render_testGetSetTextureScaleMode(void *arg)
     return TEST_COMPLETED;
 }
 
+/**
+ * @brief Tests setting and getting integer scaling, on a renderer from SDL_CreateRenderer() and a software renderer.
+ *
+ * \sa
+ * http://wiki.libsdl.org/SDL2/SDL_RenderSetIntegerScale
+ * http://wiki.libsdl.org/SDL2/SDL_RenderGetIntegerScale
+ */
+int render_testIntegerScale(void *arg)
+{
+    SDL_Renderer *renderers[2];
+    SDL_Surface *surface;
+    int i, result, w, h;
+
+    surface = SDL_CreateRGBSurfaceWithFormat(0, TESTRENDER_SCREEN_W, TESTRENDER_SCREEN_H, 32, RENDER_COMPARE_FORMAT);
+    SDLTest_AssertCheck(surface != NULL, "Verify SDL_CreateRGBSurfaceWithFormat() result");
+    if (surface == NULL) {
+        return TEST_ABORTED;
+    }
+    renderers[0] = renderer;
+    renderers[1] = SDL_CreateSoftwareRenderer(surface);
+    SDLTest_AssertCheck(renderers[1] != NULL, "Verify SDL_CreateSoftwareRenderer() result");
+    if (renderers[1] == NULL) {
+        SDL_FreeSurface(surface);
+        return TEST_ABORTED;
+    }
+
+    for (i = 0; i < (int)SDL_arraysize(renderers); i++) {
+        SDLTest_AssertCheck(SDL_RenderGetIntegerScale(renderers[i]) == SDL_FALSE, "Verify integer scaling starts off");
+
+        result = SDL_RenderSetLogicalSize(renderers[i], 40, 30);
+        SDLTest_AssertCheck(result == 0, "SDL_RenderSetLogicalSize must return 0, actual %d", result);
+        result = SDL_RenderSetIntegerScale(renderers[i], SDL_TRUE);
+        SDLTest_AssertCheck(result == 0, "SDL_RenderSetIntegerScale must return 0, actual %d", result);
+        SDLTest_AssertCheck(SDL_RenderGetIntegerScale(renderers[i]) == SDL_TRUE, "Verify integer scaling is on");
+
+        w = h = 0;
+        SDL_RenderGetLogicalSize(renderers[i], &w, &h);
+        SDLTest_AssertCheck(w == 40 && h == 30, "Verify logical size is kept, expected 40x30, got %dx%d", w, h);
+
+        result = SDL_RenderSetIntegerScale(renderers[i], SDL_FALSE);
+        SDLTest_AssertCheck(result == 0, "SDL_RenderSetIntegerScale must return 0, actual %d", result);
+        SDLTest_AssertCheck(SDL_RenderGetIntegerScale(renderers[i]) == SDL_FALSE, "Verify integer scaling is off");
+        SDL_RenderSetLogicalSize(renderers[i], 0, 0);
+    }
+
+    SDL_DestroyRenderer(renderers[1]);
+    SDL_FreeSurface(surface);
+    return TEST_COMPLETED;
+}
+
+/**
+ * @brief Tests that the integer point, line and rect APIs draw the same as their float versions.
+ *
+ * \sa
+ * http://wiki.libsdl.org/SDL2/SDL_RenderDrawPoints
+ * http://wiki.libsdl.org/SDL2/SDL_RenderDrawLines
+ * http://wiki.libsdl.org/SDL2/SDL_RenderDrawRects
+ * http://wiki.libsdl.org/SDL2/SDL_RenderFillRects
+ */
+int render_testIntegerDrawAPIs(void *arg)
+{
+    /* Few enough to fit the scratch buffer right away, then enough to make it grow */
+    static const int counts[] = { 3, 37, 5000 };
+    SDL_Point *points;
+    SDL_FPoint *fpoints;
+    SDL_Rect *rects;
+    SDL_FRect *frects;
+    Uint32 *pixels, *fpixels;
+    SDL_Rect rect;
+    int c, i, n, ret;
+
+    points = (SDL_Point *)SDL_malloc(counts[2] * sizeof(*points));
+    fpoints = (SDL_FPoint *)SDL_malloc(counts[2] * sizeof(*fpoints));
+    rects = (SDL_Rect *)SDL_malloc(counts[2] * sizeof(*rects));
+    frects = (SDL_FRect *)SDL_malloc(counts[2] * sizeof(*frects));
+    pixels = (Uint32 *)SDL_malloc(TESTRENDER_SCREEN_W * TESTRENDER_SCREEN_H * 4);
+    fpixels = (Uint32 *)SDL_malloc(TESTRENDER_SCREEN_W * TESTRENDER_SCREEN_H * 4);
+    SDLTest_AssertCheck(points && fpoints && rects && frects && pixels && fpixels, "Validate allocated buffers");
+    if (!points || !fpoints || !rects || !frects || !pixels || !fpixels) {
+        SDL_free(points);
+        SDL_free(fpoints);
+        SDL_free(rects);
+        SDL_free(frects);
+        SDL_free(pixels);
+        SDL_free(fpixels);
+        return TEST_ABORTED;
+    }
+
+    for (i = 0; i < counts[2]; i++) {
+        points[i].x = SDLTest_RandomIntegerInRange(-10, TESTRENDER_SCREEN_W + 10);
+        points[i].y = SDLTest_RandomIntegerInRange(-10, TESTRENDER_SCREEN_H + 10);
+        fpoints[i].x = (float)points[i].x;
+        fpoints[i].y = (float)points[i].y;
+        rects[i].x = points[i].x;
+        rects[i].y = points[i].y;
+        rects[i].w = SDLTest_RandomIntegerInRange(0, 10);
+        rects[i].h = SDLTest_RandomIntegerInRange(0, 10);
+        frects[i].x = (float)rects[i].x;
+        frects[i].y = (float)rects[i].y;
+        frects[i].w = (float)rects[i].w;
+        frects[i].h = (float)rects[i].h;
+    }
+
+    rect.x = 0;
+    rect.y = 0;
+    rect.w = TESTRENDER_SCREEN_W;
+    rect.h = TESTRENDER_SCREEN_H;
+    for (c = 0; c < (int)SDL_arraysize(counts); c++) {
+        n = counts[c];
+
+        _clearScreen();
+        SDL_SetRenderDrawColor(renderer, 255, 0, 0, SDL_ALPHA_OPAQUE);
+        ret = SDL_RenderFillRects(renderer, rects, n);
+        SDLTest_AssertCheck(ret == 0, "Validate result from SDL_RenderFillRects, expected: 0, got: %i", ret);
+        SDL_SetRenderDrawColor(renderer, 0, 255, 0, SDL_ALPHA_OPAQUE);
+        ret = SDL_RenderDrawRects(renderer, rects, n);
+        SDLTest_AssertCheck(ret == 0, "Validate result from SDL_RenderDrawRects, expected: 0, got: %i", ret);
+        SDL_SetRenderDrawColor(renderer, 0, 0, 255, SDL_ALPHA_OPAQUE);
+        ret = SDL_RenderDrawLines(renderer, points, SDL_min(n, 20));
+        SDLTest_AssertCheck(ret == 0, "Validate result from SDL_RenderDrawLines, expected: 0, got: %i", ret);
+        SDL_SetRenderDrawColor(renderer, 255, 255, 255, SDL_ALPHA_OPAQUE);
+        ret = SDL_RenderDrawPoints(renderer, points, n);
+        SDLTest_AssertCheck(ret == 0, "Validate result from SDL_RenderDrawPoints, expected: 0, got: %i", ret);
+        ret = SDL_RenderReadPixels(renderer, &rect, RENDER_COMPARE_FORMAT, pixels, TESTRENDER_SCREEN_W * 4);
+        SDLTest_AssertCheck(ret == 0, "Validate result from SDL_RenderReadPixels, expected: 0, got: %i", ret);
+
+        _clearScreen();
+        SDL_SetRenderDrawColor(renderer, 255, 0, 0, SDL_ALPHA_OPAQUE);
+        SDL_RenderFillRectsF(renderer, frects, n);
+        SDL_SetRenderDrawColor(renderer, 0, 255, 0, SDL_ALPHA_OPAQUE);
+        SDL_RenderDrawRectsF(renderer, frects, n);
+        SDL_SetRenderDrawColor(renderer, 0, 0, 255, SDL_ALPHA_OPAQUE);
+        SDL_RenderDrawLinesF(renderer, fpoints, SDL_min(n, 20));
+        SDL_SetRenderDrawColor(renderer, 255, 255, 255, SDL_ALPHA_OPAQUE);
+        SDL_RenderDrawPointsF(renderer, fpoints, n);
+        ret = SDL_RenderReadPixels(renderer, &rect, RENDER_COMPARE_FORMAT, fpixels, TESTRENDER_SCREEN_W * 4);
+        SDLTest_AssertCheck(ret == 0, "Validate result from SDL_RenderReadPixels, expected: 0, got: %i", ret);
+
+        SDLTest_AssertCheck(SDL_memcmp(pixels, fpixels, TESTRENDER_SCREEN_W * TESTRENDER_SCREEN_H * 4) == 0,
+                            "Verify %d primitives drawn with ints match the same drawn with floats", n);
+    }
+
+    SDL_free(points);
+    SDL_free(fpoints);
+    SDL_free(rects);
+    SDL_free(frects);
+    SDL_free(pixels);
+    SDL_free(fpixels);
+    return TEST_COMPLETED;
+}
+
+/**
+ * @brief Tests that SDL_RenderGeometryRaw() gets the vertex colors right for every color layout.
+ *
+ * \sa
+ * http://wiki.libsdl.org/SDL2/SDL_RenderGeometry
+ * http://wiki.libsdl.org/SDL2/SDL_RenderGeometryRaw
+ */
+int render_testGeometryColors(void *arg)
+{
+    static const int indices[] = { 0, 1, 2, 2, 1, 3 };
+    SDL_Vertex verts[4];
+    float xy[8];
+    SDL_Color colors[4];
+    Uint32 *expected, *actual;
+    SDL_Rect rect;
+    int i, pass, ret;
+
+    expected = (Uint32 *)SDL_malloc(TESTRENDER_SCREEN_W * TESTRENDER_SCREEN_H * 4);
+    actual = (Uint32 *)SDL_malloc(TESTRENDER_SCREEN_W * TESTRENDER_SCREEN_H * 4);
+    SDLTest_AssertCheck(expected != NULL && actual != NULL, "Validate allocated buffers");
+    if (expected == NULL || actual == NULL) {
+        SDL_free(expected);
+        SDL_free(actual);
+        return TEST_ABORTED;
+    }
+
+    rect.x = 0;
+    rect.y = 0;
+    rect.w = TESTRENDER_SCREEN_W;
+    rect.h = TESTRENDER_SCREEN_H;
+    for (i = 0; i < 4; i++) {
+        verts[i].position.x = xy[i * 2] = (i & 1) ? (float)(TESTRENDER_SCREEN_W - 5) : 5.0f;
+        verts[i].position.y = xy[i * 2 + 1] = (i & 2) ? (float)(TESTRENDER_SCREEN_H - 5) : 5.0f;
+        verts[i].tex_coord.x = 0.0f;
+        verts[i].tex_coord.y = 0.0f;
+    }
+
+    /* Pass 0 has a different color per vertex, pass 1 the same color everywhere */
+    for (pass = 0; pass < 2; pass++) {
+        for (i = 0; i < 4; i++) {
+            colors[i].r = pass ? 17 : (Uint8)(i * 80);
+            colors[i].g = pass ? 99 : (Uint8)(255 - i * 60);
+            colors[i].b = pass ? 201 : (Uint8)(i * 33 + 7);
+            colors[i].a = SDL_ALPHA_OPAQUE;
+            verts[i].color = colors[i];
+        }
+
+        _clearScreen();
+        ret = SDL_RenderGeometry(renderer, NULL, verts, 4, indices, 6);
+        SDLTest_AssertCheck(ret == 0, "Validate result from SDL_RenderGeometry, expected: 0, got: %i", ret);
+        ret = SDL_RenderReadPixels(renderer, &rect, RENDER_COMPARE_FORMAT, expected, TESTRENDER_SCREEN_W * 4);
+        SDLTest_AssertCheck(ret == 0, "Validate result from SDL_RenderReadPixels, expected: 0, got: %i", ret);
+
+        _clearScreen();
+        ret = SDL_RenderGeometryRaw(renderer, NULL, xy, 2 * sizeof(float), colors, sizeof(SDL_Color), xy, 2 * sizeof(float), 4, indices, 6, sizeof(int));
+        SDLTest_AssertCheck(ret == 0, "Validate result from SDL_RenderGeometryRaw, expected: 0, got: %i", ret);
+        ret = SDL_RenderReadPixels(renderer, &rect, RENDER_COMPARE_FORMAT, actual, TESTRENDER_SCREEN_W * 4);
+        SDLTest_AssertCheck(ret == 0, "Validate result from SDL_RenderReadPixels, expected: 0, got: %i", ret);
+        SDLTest_AssertCheck(SDL_memcmp(expected, actual, TESTRENDER_SCREEN_W * TESTRENDER_SCREEN_H * 4) == 0,
+                            "Verify packed colors draw like SDL_Vertex colors (pass %d)", pass);
+
+        if (pass == 1) {
+            /* A color stride of 0 repeats the first color */
+            _clearScreen();
+            ret = SDL_RenderGeometryRaw(renderer, NULL, xy, 2 * sizeof(float), colors, 0, xy, 2 * sizeof(float), 4, indices, 6, sizeof(int));
+            SDLTest_AssertCheck(ret == 0, "Validate result from SDL_RenderGeometryRaw, expected: 0, got: %i", ret);
+            ret = SDL_RenderReadPixels(renderer, &rect, RENDER_COMPARE_FORMAT, actual, TESTRENDER_SCREEN_W * 4);
+            SDLTest_AssertCheck(ret == 0, "Validate result from SDL_RenderReadPixels, expected: 0, got: %i", ret);
+            SDLTest_AssertCheck(SDL_memcmp(expected, actual, TESTRENDER_SCREEN_W * TESTRENDER_SCREEN_H * 4) == 0,
+                                "Verify a color stride of 0 draws like SDL_Vertex colors");
+        }
+    }
+
+    SDL_free(expected);
+    SDL_free(actual);
+    return TEST_COMPLETED;
+}
+
+/**
+ * @brief Tests that SDL_CompatRenderSprites(), and SDL_RenderCopy() with SDL2_RENDER_MERGE_COPIES, draw like separate copies.
+ *
+ * \sa
+ * http://wiki.libsdl.org/SDL2/SDL_RenderCopy
+ */
+int render_testSprites(void *arg)
+{
+    SDL_CompatSprite sprites[8];
+    SDL_Renderer *renderers[2];
+    SDL_Texture *textures[2];
+    Uint32 *results[2];
+    SDL_Window *window2 = NULL;
+    SDL_Renderer *renderer2 = NULL;
+    SDL_Texture *tface, *tface2 = NULL;
+    SDL_Surface *face;
+    SDL_Rect rect, fill;
+    int tw = 0, th = 0;
+    int i, r, ret;
+
+    tface = _loadTestFace();
+    SDLTest_AssertCheck(tface != NULL, "Verify _loadTestFace() result");
+    if (tface == NULL) {
+        return TEST_ABORTED;
+    }
+    results[0] = (Uint32 *)SDL_malloc(TESTRENDER_SCREEN_W * TESTRENDER_SCREEN_H * 4);
+    results[1] = (Uint32 *)SDL_malloc(TESTRENDER_SCREEN_W * TESTRENDER_SCREEN_H * 4);
+    SDLTest_AssertCheck(results[0] != NULL && results[1] != NULL, "Validate allocated buffers");
+    if (results[0] == NULL || results[1] == NULL) {
+        SDL_free(results[0]);
+        SDL_free(results[1]);
+        SDL_DestroyTexture(tface);
+        return TEST_ABORTED;
+    }
+
+    rect.x = 0;
+    rect.y = 0;
+    rect.w = TESTRENDER_SCREEN_W;
+    rect.h = TESTRENDER_SCREEN_H;
+    SDL_QueryTexture(tface, NULL, NULL, &tw, &th);
+    SDL_SetTextureBlendMode(tface, SDL_BLENDMODE_BLEND);
+    for (i = 0; i < (int)SDL_arraysize(sprites); i++) {
+        sprites[i].texture = tface;
+        sprites[i].srcrect.x = (i & 1) ? tw / 4 : 0;
+        sprites[i].srcrect.y = (i & 2) ? th / 4 : 0;
+        sprites[i].srcrect.w = (i == 0) ? 0 : tw / 2;
+        sprites[i].srcrect.h = (i == 0) ? 0 : th / 2;
+        sprites[i].dstrect.x = (float)(i * 7);
+        sprites[i].dstrect.y = (float)(i * 5);
+        sprites[i].dstrect.w = 32.0f;
+        sprites[i].dstrect.h = 24.0f;
+        sprites[i].angle = 0.0;
+        sprites[i].flip = SDL_FLIP_NONE;
+        sprites[i].color.r = (Uint8)(255 - i * 20);
+        sprites[i].color.g = 255;
+        sprites[i].color.b = (Uint8)(i * 30);
+        sprites[i].color.a = (Uint8)(255 - i * 10);
+    }
+
+    /* Each sprite as its own copy, with the sprite color as the texture color */
+    _clearScreen();
+    for (i = 0; i < (int)SDL_arraysize(sprites); i++) {
+        SDL_SetTextureColorMod(tface, sprites[i].color.r, sprites[i].color.g, sprites[i].color.b);
+        SDL_SetTextureAlphaMod(tface, sprites[i].color.a);
+        ret = SDL_RenderCopyF(renderer, tface, sprites[i].srcrect.w ? &sprites[i].srcrect : NULL, &sprites[i].dstrect);
+        SDLTest_AssertCheck(ret == 0, "Validate result from SDL_RenderCopyF, expected: 0, got: %i", ret);
+    }
+    ret = SDL_RenderReadPixels(renderer, &rect, RENDER_COMPARE_FORMAT, results[0], TESTRENDER_SCREEN_W * 4);
+    SDLTest_AssertCheck(ret == 0, "Validate result from SDL_RenderReadPixels, expected: 0, got: %i", ret);
+    SDL_SetTextureColorMod(tface, 255, 255, 255);
+    SDL_SetTextureAlphaMod(tface, 255);
+
+    _clearScreen();
+    ret = SDL_CompatRenderSprites(renderer, sprites, (int)SDL_arraysize(sprites));
+    SDLTest_AssertCheck(ret == 0, "Validate result from SDL_CompatRenderSprites, expected: 0, got: %i", ret);
+    ret = SDL_RenderReadPixels(renderer, &rect, RENDER_COMPARE_FORMAT, results[1], TESTRENDER_SCREEN_W * 4);
+    SDLTest_AssertCheck(ret == 0, "Validate result from SDL_RenderReadPixels, expected: 0, got: %i", ret);
+    SDLTest_AssertCheck(SDL_memcmp(results[0], results[1], TESTRENDER_SCREEN_W * TESTRENDER_SCREEN_H * 4) == 0,
+                        "Verify SDL_CompatRenderSprites() draws like SDL_RenderCopyF()");
+
+    ret = SDL_CompatRenderSprites(renderer, sprites, 0);
+    SDLTest_AssertCheck(ret == 0, "Validate result from SDL_CompatRenderSprites with no sprites, expected: 0, got: %i", ret);
+    ret = SDL_CompatRenderSprites(renderer, NULL, 1);
+    SDLTest_AssertCheck(ret == -1, "Validate result from SDL_CompatRenderSprites with NULL sprites, expected: -1, got: %i", ret);
+    ret = SDL_CompatRenderSprites(renderer, sprites, -1);
+    SDLTest_AssertCheck(ret == -1, "Validate result from SDL_CompatRenderSprites with a negative count, expected: -1, got: %i", ret);
+
+    /* The same copies, interrupted by other drawing and texture changes, on a renderer that merges them */
+    SDL_SetHint("SDL_RENDER_BATCHING", "1");
+    SDL_SetHint("SDL2_RENDER_MERGE_COPIES", "1");
+    window2 = SDL_CreateWindow("render_testSprites", 100, 100, 320, 240, SDL_WINDOW_HIDDEN);
+    SDLTest_AssertCheck(window2 != NULL, "Check SDL_CreateWindow result");
+    if (window2) {
+        renderer2 = SDL_CreateRenderer(window2, -1, 0);
+        SDLTest_AssertCheck(renderer2 != NULL, "Check SDL_CreateRenderer result");
+    }
+    SDL_SetHint("SDL_RENDER_BATCHING", NULL);
+    SDL_SetHint("SDL2_RENDER_MERGE_COPIES", NULL);
+    if (renderer2) {
+        face = SDLTest_ImageFace();
+        if (face) {
+            tface2 = SDL_CreateTextureFromSurface(renderer2, face);
+            SDL_FreeSurface(face);
+        }
+        SDLTest_AssertCheck(tface2 != NULL, "Check SDL_CreateTextureFromSurface result");
+    }
+    if (tface2) {
+        renderers[0] = renderer;
+        renderers[1] = renderer2;
+        textures[0] = tface;
+        textures[1] = tface2;
+        fill.x = 20;
+        fill.y = 10;
+        fill.w = 30;
+        fill.h = 30;
+        for (r = 0; r < 2; r++) {
+            SDL_SetTextureBlendMode(textures[r], SDL_BLENDMODE_BLEND);
+            SDL_SetRenderDrawColor(renderers[r], 0, 0, 0, SDL_ALPHA_OPAQUE);
+            SDL_RenderClear(renderers[r]);
+            for (i = 0; i < (int)SDL_arraysize(sprites); i++) {
+                SDL_SetTextureColorMod(textures[r], sprites[i].color.r, sprites[i].color.g, sprites[i].color.b);
+                SDL_SetTextureAlphaMod(textures[r], sprites[i].color.a);
+                if (i == 3) {
+                    SDL_SetRenderDrawColor(renderers[r], 40, 80, 120, SDL_ALPHA_OPAQUE);
+                    SDL_RenderFillRect(renderers[r], &fill);
+                } else if (i == 6) {
+                    SDL_SetTextureBlendMode(textures[r], SDL_BLENDMODE_ADD);
+                }
+                ret = SDL_RenderCopyF(renderers[r], textures[r], sprites[i].srcrect.w ? &sprites[i].srcrect : NULL, &sprites[i].dstrect);
+                SDLTest_AssertCheck(ret == 0, "Validate result from SDL_RenderCopyF, expected: 0, got: %i", ret);
+            }
+            ret = SDL_RenderReadPixels(renderers[r], &rect, RENDER_COMPARE_FORMAT, results[r], TESTRENDER_SCREEN_W * 4);
+            SDLTest_AssertCheck(ret == 0, "Validate result from SDL_RenderReadPixels, expected: 0, got: %i", ret);
+        }
+        SDLTest_AssertCheck(SDL_memcmp(results[0], results[1], TESTRENDER_SCREEN_W * TESTRENDER_SCREEN_H * 4) == 0,
+                            "Verify merged copies draw like separate copies");
+    }
+
+    if (renderer2) {
+        SDL_DestroyRenderer(renderer2);
+    }
+    if (window2) {
+        SDL_DestroyWindow(window2);
+    }
+    SDL_free(results[0]);
+    SDL_free(results[1]);
+    SDL_DestroyTexture(tface);
+    return TEST_COMPLETED;
+}
+
+/* The number of calls to `name` in replay statistics, or 0 if there were none */
+static Uint64
+_getReplayCount(const SDL_CompatRenderCallStats *stats, int num_stats, const char *name)
+{
+    int i;
+
+    for (i = 0; i < num_stats; i++) {
+        if (SDL_strcmp(stats[i].name, name) == 0) {
+            return stats[i].count;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Records rendering calls to a trace and replays it offscreen.
+ */
+int render_testRecordAndReplay(void *arg)
+{
+    const char *file = "testautomation_render.trace";
+    const char *frame = "testautomation_render-replay-0.bmp";
+    SDL_CompatRenderCallStats stats[32];
+    SDL_Texture *tface;
+    SDL_Point points[3];
+    SDL_Rect rect;
+    Uint32 *pixels;
+    SDL_Surface *referenceSurface = NULL;
+    SDL_Surface *replayed, *converted, *area;
+    int num_stats;
+    int i, ret;
+
+    pixels = (Uint32 *)SDL_malloc(4 * TESTRENDER_SCREEN_W * TESTRENDER_SCREEN_H);
+    SDLTest_AssertCheck(pixels != NULL, "Validate allocated temp pixel buffer");
+    if (pixels == NULL) {
+        return TEST_ABORTED;
+    }
+
+    ret = SDL_CompatStartRenderRecording(file);
+    SDLTest_AssertPass("Call to SDL_CompatStartRenderRecording()");
+    SDLTest_AssertCheck(ret == 0, "Check result from SDL_CompatStartRenderRecording, expected: 0, got: %d", ret);
+    if (ret != 0) {
+        SDL_free(pixels);
+        return TEST_ABORTED;
+    }
+
+    tface = _loadTestFace();
+    SDLTest_AssertCheck(tface != NULL, "Verify _loadTestFace() result");
+    _clearScreen();
+    points[0].x = 0;
+    points[0].y = 0;
+    points[1].x = TESTRENDER_SCREEN_W - 1;
+    points[1].y = 0;
+    points[2].x = TESTRENDER_SCREEN_W - 1;
+    points[2].y = TESTRENDER_SCREEN_H - 1;
+    SDL_RenderDrawLines(renderer, points, (int)SDL_arraysize(points));
+    rect.x = 10;
+    rect.y = 10;
+    rect.w = 20;
+    rect.h = 20;
+    SDL_SetRenderDrawColor(renderer, 255, 0, 0, SDL_ALPHA_OPAQUE);
+    SDL_RenderFillRect(renderer, &rect);
+    for (i = 0; i < 3; i++) {
+        rect.x = 10 + i * 16;
+        SDL_RenderCopy(renderer, tface, NULL, &rect);
+    }
+
+    /* What was drawn, to compare the replay with */
+    rect.x = 0;
+    rect.y = 0;
+    rect.w = TESTRENDER_SCREEN_W;
+    rect.h = TESTRENDER_SCREEN_H;
+    ret = SDL_RenderReadPixels(renderer, &rect, RENDER_COMPARE_FORMAT, pixels, TESTRENDER_SCREEN_W * 4);
+    SDLTest_AssertCheck(ret == 0, "Validate result from SDL_RenderReadPixels, expected: 0, got: %i", ret);
+    referenceSurface = SDL_CreateRGBSurfaceWithFormatFrom(pixels, TESTRENDER_SCREEN_W, TESTRENDER_SCREEN_H, 32, TESTRENDER_SCREEN_W * 4, RENDER_COMPARE_FORMAT);
+    SDLTest_AssertCheck(referenceSurface != NULL, "Verify reference surface is not NULL");
+    SDL_RenderPresent(renderer);
+    SDL_CompatStopRenderRecording();
+    SDLTest_AssertPass("Call to SDL_CompatStopRenderRecording()");
+    SDL_DestroyTexture(tface);
+
+    SDL_SetHint("SDL2_RENDER_REPLAY_FRAMES", "testautomation_render-replay-");
+    num_stats = SDL_CompatReplayRenderRecording(file, stats, (int)SDL_arraysize(stats));
+    SDL_SetHint("SDL2_RENDER_REPLAY_FRAMES", "");
+    SDLTest_AssertPass("Call to SDL_CompatReplayRenderRecording()");
+    SDLTest_AssertCheck(num_stats > 0 && num_stats <= (int)SDL_arraysize(stats), "Check result from SDL_CompatReplayRenderRecording, got: %d", num_stats);
+    if (num_stats > 0 && num_stats <= (int)SDL_arraysize(stats)) {
+        SDLTest_AssertCheck(_getReplayCount(stats, num_stats, "SDL_CreateTextureFromSurface") == 1, "Check SDL_CreateTextureFromSurface was replayed once");
+        SDLTest_AssertCheck(_getReplayCount(stats, num_stats, "SDL_RenderClear") == 1, "Check SDL_RenderClear was replayed once");
+        SDLTest_AssertCheck(_getReplayCount(stats, num_stats, "SDL_RenderDrawLines") == 1, "Check SDL_RenderDrawLines was replayed once");
+        SDLTest_AssertCheck(_getReplayCount(stats, num_stats, "SDL_RenderFillRect") == 1, "Check SDL_RenderFillRect was replayed once");
+        SDLTest_AssertCheck(_getReplayCount(stats, num_stats, "SDL_RenderCopy") == 3, "Check SDL_RenderCopy was replayed 3 times");
+        SDLTest_AssertCheck(_getReplayCount(stats, num_stats, "SDL_RenderReadPixels") == 1, "Check SDL_RenderReadPixels was replayed once");
+        SDLTest_AssertCheck(_getReplayCount(stats, num_stats, "SDL_RenderPresent") == 1, "Check SDL_RenderPresent was replayed once");
+        SDLTest_AssertCheck(_getReplayCount(stats, num_stats, "SDL_RenderDrawPoint") == 0, "Check SDL_RenderDrawPoint was not replayed");
+    }
+
+    /* The replay has to draw the same thing the app did */
+    replayed = SDL_LoadBMP(frame);
+    SDLTest_AssertCheck(replayed != NULL, "Check the replayed frame was saved to %s", frame);
+    if (replayed && referenceSurface) {
+        converted = SDL_ConvertSurfaceFormat(replayed, RENDER_COMPARE_FORMAT, 0);
+        SDLTest_AssertCheck(converted != NULL, "Verify converted replayed frame is not NULL");
+        if (converted) {
+            SDLTest_AssertCheck(converted->w >= TESTRENDER_SCREEN_W && converted->h >= TESTRENDER_SCREEN_H,
+                                "Check replayed frame size, expected at least: %dx%d, got: %dx%d",
+                                TESTRENDER_SCREEN_W, TESTRENDER_SCREEN_H, converted->w, converted->h);
+            area = SDL_CreateRGBSurfaceWithFormatFrom(converted->pixels, SDL_min(converted->w, TESTRENDER_SCREEN_W), SDL_min(converted->h, TESTRENDER_SCREEN_H),
+                                                      32, converted->pitch, RENDER_COMPARE_FORMAT);
+            if (area && area->w == TESTRENDER_SCREEN_W && area->h == TESTRENDER_SCREEN_H) {
+                ret = SDLTest_CompareSurfaces(area, referenceSurface, ALLOWABLE_ERROR_OPAQUE);
+                SDLTest_AssertCheck(ret == 0, "Validate replayed frame against what was drawn, expected: 0, got: %i", ret);
+            }
+            SDL_FreeSurface(area);
+            SDL_FreeSurface(converted);
+        }
+        SDL_FreeSurface(replayed);
+    }
+    SDL_FreeSurface(referenceSurface);
+    SDL_free(pixels);
+    (void)remove(frame);
+
+    ret = SDL_CompatReplayRenderRecording(file, NULL, 0);
+    SDLTest_AssertCheck(ret == num_stats, "Check result from SDL_CompatReplayRenderRecording without stats, expected: %d, got: %d", num_stats, ret);
+    ret = SDL_CompatReplayRenderRecording(NULL, NULL, 0);
+    SDLTest_AssertCheck(ret == -1, "Check result from SDL_CompatReplayRenderRecording with a NULL file, expected: -1, got: %d", ret);
+
+    (void)remove(file);
+    return TEST_COMPLETED;
+}
+
+/* Write the first `size` bytes of a trace, with `patch` bytes at `offset` changed to 0xFF, and replay it */
+static int
+_replayDamagedTrace(const char *file, const Uint8 *trace, size_t size, size_t offset, size_t patch,
+                    SDL_CompatRenderCallStats *stats, int maxstats)
+{
+    SDL_RWops *rw;
+    Uint8 *copy;
+    int ret;
+
+    copy = (Uint8 *)SDL_malloc(size ? size : 1);
+    if (!copy) {
+        return -2;
+    }
+    SDL_memcpy(copy, trace, size);
+    if (patch) {
+        SDL_memset(copy + offset, 0xFF, patch);
+    }
+
+    rw = SDL_RWFromFile(file, "wb");
+    if (!rw) {
+        SDL_free(copy);
+        return -2;
+    }
+    SDL_RWwrite(rw, copy, 1, size);
+    SDL_RWclose(rw);
+    SDL_free(copy);
+
+    ret = SDL_CompatReplayRenderRecording(file, stats, maxstats);
+    (void)remove(file);
+    return ret;
+}
+
+/**
+ * @brief Replays traces that were cut short or damaged.
+ */
+int render_testReplayDamagedTrace(void *arg)
+{
+    const char *file = "testautomation_render-damaged.trace";
+    const char *damaged = "testautomation_render-damaged-copy.trace";
+    SDL_CompatRenderCallStats stats[8];
+    Uint8 *trace;
+    size_t size = 0;
+    int ret;
+
+    ret = SDL_CompatStartRenderRecording(file);
+    SDLTest_AssertCheck(ret == 0, "Check result from SDL_CompatStartRenderRecording, expected: 0, got: %d", ret);
+    if (ret != 0) {
+        return TEST_ABORTED;
+    }
+    _clearScreen();
+    SDL_RenderPresent(renderer);
+    SDL_CompatStopRenderRecording();
+
+    trace = (Uint8 *)SDL_LoadFile(file, &size);
+    (void)remove(file);
+    SDLTest_AssertCheck(trace != NULL, "Check the trace could be loaded");
+    if (!trace) {
+        return TEST_ABORTED;
+    }
+
+    ret = _replayDamagedTrace(damaged, trace, size, 0, 0, stats, (int)SDL_arraysize(stats));
+    SDLTest_AssertCheck(ret > 0 && _getReplayCount(stats, SDL_min(ret, (int)SDL_arraysize(stats)), "SDL_RenderPresent") == 1,
+                        "Check the whole trace replays with one SDL_RenderPresent, got: %d", ret);
+
+    /* The last record is the SDL_RenderPresent(), losing its last byte drops it and nothing else */
+    ret = _replayDamagedTrace(damaged, trace, size - 1, 0, 0, stats, (int)SDL_arraysize(stats));
+    SDLTest_AssertCheck(ret >= 0 && _getReplayCount(stats, SDL_min(ret, (int)SDL_arraysize(stats)), "SDL_RenderPresent") == 0,
+                        "Check a truncated trace replays up to its last whole record, got: %d", ret);
+
+    /* The header is 16 bytes: the magic, the version and the record size */
+    ret = _replayDamagedTrace(damaged, trace, 8, 0, 0, stats, (int)SDL_arraysize(stats));
+    SDLTest_AssertCheck(ret == -1, "Check a trace cut off in its header fails, expected: -1, got: %d", ret);
+    ret = _replayDamagedTrace(damaged, trace, size, 0, 1, stats, (int)SDL_arraysize(stats));
+    SDLTest_AssertCheck(ret == -1, "Check a trace with a bad magic fails, expected: -1, got: %d", ret);
+
+    /* The first record starts with its 16-bit call and then its 32-bit size */
+    ret = _replayDamagedTrace(damaged, trace, size, 16, 2, stats, (int)SDL_arraysize(stats));
+    SDLTest_AssertCheck(ret == -1, "Check a record with an unknown call fails, expected: -1, got: %d", ret);
+    SDLTest_AssertCheck(SDL_strstr(SDL_GetError(), "Corrupt") != NULL, "Check the error, got: %s", SDL_GetError());
+    ret = _replayDamagedTrace(damaged, trace, size, 20, 4, stats, (int)SDL_arraysize(stats));
+    SDLTest_AssertCheck(ret == -1, "Check a record with a huge size fails, expected: -1, got: %d", ret);
+    SDLTest_AssertCheck(SDL_strstr(SDL_GetError(), "Corrupt") != NULL, "Check the error, got: %s", SDL_GetError());
+
+    SDL_free(trace);
+    return TEST_COMPLETED;
+}
+
 /**
  * @brief Checks to see if functionality is supported. Helper function.
  */
@@ -1299,9 +1896,33 @@ static const SDLTest_TestCaseReference renderTest9 = {
     (SDLTest_TestCaseFp)render_testRGBSurfaceNoAlpha, "render_testRGBSurfaceNoAlpha", "Tests RGB surface with no alpha using software renderer", TEST_ENABLED
 };
 
+static const SDLTest_TestCaseReference renderTest10 = {
+    (SDLTest_TestCaseFp)render_testIntegerScale, "render_testIntegerScale", "Tests setting/getting integer scaling", TEST_ENABLED
+};
+
+static const SDLTest_TestCaseReference renderTest11 = {
+    (SDLTest_TestCaseFp)render_testIntegerDrawAPIs, "render_testIntegerDrawAPIs", "Tests drawing points, lines and rects given as ints", TEST_ENABLED
+};
+
+static const SDLTest_TestCaseReference renderTest12 = {
+    (SDLTest_TestCaseFp)render_testGeometryColors, "render_testGeometryColors", "Tests vertex colors in SDL_RenderGeometryRaw", TEST_ENABLED
+};
+
+static const SDLTest_TestCaseReference renderTest13 = {
+    (SDLTest_TestCaseFp)render_testSprites, "render_testSprites", "Tests SDL_CompatRenderSprites and merged SDL_RenderCopy calls", TEST_ENABLED
+};
+
+static const SDLTest_TestCaseReference renderTest14 = {
+    (SDLTest_TestCaseFp)render_testRecordAndReplay, "render_testRecordAndReplay", "Tests recording rendering calls and replaying them", TEST_ENABLED
+};
+
+static const SDLTest_TestCaseReference renderTest15 = {
+    (SDLTest_TestCaseFp)render_testReplayDamagedTrace, "render_testReplayDamagedTrace", "Tests replaying truncated and corrupt render traces", TEST_ENABLED
+};
+
 /* Sequence of Render test cases */
 static const SDLTest_TestCaseReference *renderTests[] = {
-    &renderTest1, &renderTest2, &renderTest3, &renderTest4, &renderTest5, &renderTest6, &renderTest7, &renderTest8, &renderTest9, NULL
+    &renderTest1, &renderTest2, &renderTest3, &renderTest4, &renderTest5, &renderTest6, &renderTest7, &renderTest8, &renderTest9, &renderTest10, &renderTest11, &renderTest12, &renderTest13, &renderTest14, &renderTest15, NULL
 };
 
 /* Render test suite (global) */
@@ -19,6 +19,7 @@
 
 #include "SDL.h"
 #include "SDL_test.h"
+#include "SDL_compat.h"
 
 #ifdef __MACOSX__
 #include <unistd.h> /* For unlink() */
@@ -594,6 +595,278 @@ int surface_testBlitBlendLoop(void *arg)
     return TEST_COMPLETED;
 }
 
+/**
+ * @brief Tests that parallel blits match the reference images exactly
+ */
+int surface_testParallelBlit(void *arg)
+{
+    static const struct
+    {
+        int mode;
+        SDL_Surface *(*image)(void);
+    } cases[] = {
+        { -1, SDLTest_ImageBlit },
+        { -2, SDLTest_ImageBlitColor },
+        { -3, SDLTest_ImageBlitAlpha },
+        { SDL_BLENDMODE_NONE, SDLTest_ImageBlitBlendNone },
+        { SDL_BLENDMODE_MOD, SDLTest_ImageBlitBlendMod }
+    };
+    int ret;
+    int i;
+    SDL_Surface *compareSurface;
+
+    /* Split every blit, no matter how small */
+    SDL_SetHint("SDL2_PARALLEL_BLIT", "4");
+    SDL_SetHint("SDL2_PARALLEL_BLIT_THRESHOLD", "0");
+
+    for (i = 0; i < (int)SDL_arraysize(cases); i++) {
+        _testBlitBlendMode(cases[i].mode);
+
+        compareSurface = cases[i].image();
+        ret = SDLTest_CompareSurfaces(testSurface, compareSurface, 0);
+        SDLTest_AssertCheck(ret == 0, "Validate result from SDLTest_CompareSurfaces for mode %d, expected: 0, got: %i", cases[i].mode, ret);
+        SDL_FreeSurface(compareSurface);
+    }
+
+    /* A blit the size of the whole surface */
+    _clearTestSurface();
+    compareSurface = SDLTest_ImageBlit();
+    ret = SDL_BlitSurface(compareSurface, NULL, testSurface, NULL);
+    SDLTest_AssertCheck(ret == 0, "Validate result from SDL_BlitSurface, expected: 0, got: %i", ret);
+    ret = SDLTest_CompareSurfaces(testSurface, compareSurface, 0);
+    SDLTest_AssertCheck(ret == 0, "Validate result from SDLTest_CompareSurfaces, expected: 0, got: %i", ret);
+    SDL_FreeSurface(compareSurface);
+
+    SDL_SetHint("SDL2_PARALLEL_BLIT", NULL);
+    SDL_SetHint("SDL2_PARALLEL_BLIT_THRESHOLD", NULL);
+
+    return TEST_COMPLETED;
+}
+
+/**
+ * @brief Tests that a batch of blits matches the same blits done one by one
+ */
+int surface_testBlitSurfaces(void *arg)
+{
+    int ret;
+    int i, j, ni, nj;
+    int count = 0;
+    SDL_Surface *face;
+    SDL_Surface *compareSurface;
+    SDL_Rect *dstrects;
+
+    face = SDLTest_ImageFace();
+    SDLTest_AssertCheck(face != NULL, "Verify face surface is not NULL");
+    if (face == NULL) {
+        return TEST_ABORTED;
+    }
+    _clearTestSurface();
+
+    /* The same blits as surface_testBlit, in one batch */
+    ni = testSurface->w - face->w;
+    nj = testSurface->h - face->h;
+    dstrects = (SDL_Rect *)SDL_calloc((ni / 4 + 1) * (nj / 4 + 1), sizeof(*dstrects));
+    SDLTest_AssertCheck(dstrects != NULL, "Verify dstrects is not NULL");
+    if (dstrects == NULL) {
+        SDL_FreeSurface(face);
+        return TEST_ABORTED;
+    }
+    for (j = 0; j <= nj; j += 4) {
+        for (i = 0; i <= ni; i += 4) {
+            dstrects[count].x = i;
+            dstrects[count].y = j;
+            count++;
+        }
+    }
+
+    ret = SDL_CompatBlitSurfaces(face, NULL, testSurface, dstrects, count);
+    SDLTest_AssertPass("Call to SDL_CompatBlitSurfaces()");
+    SDLTest_AssertCheck(ret == 0, "Validate result from SDL_CompatBlitSurfaces, expected: 0, got: %i", ret);
+    SDLTest_AssertCheck(dstrects[0].w == face->w && dstrects[0].h == face->h, "Verify dstrects were updated, expected: %ix%i, got: %ix%i", face->w, face->h, dstrects[0].w, dstrects[0].h);
+
+    compareSurface = SDLTest_ImageBlit();
+    ret = SDLTest_CompareSurfaces(testSurface, compareSurface, 0);
+    SDLTest_AssertCheck(ret == 0, "Validate result from SDLTest_CompareSurfaces, expected: 0, got: %i", ret);
+
+    /* Blits that are completely clipped away come back empty */
+    dstrects[0].x = testSurface->w;
+    dstrects[0].y = 0;
+    ret = SDL_CompatBlitSurfaces(face, NULL, testSurface, dstrects, 1);
+    SDLTest_AssertCheck(ret == 0, "Validate result from SDL_CompatBlitSurfaces, expected: 0, got: %i", ret);
+    SDLTest_AssertCheck(dstrects[0].w == 0 && dstrects[0].h == 0, "Verify clipped dstrect is empty, got: %ix%i", dstrects[0].w, dstrects[0].h);
+
+    SDL_free(dstrects);
+    SDL_FreeSurface(compareSurface);
+    SDL_FreeSurface(face);
+
+    return TEST_COMPLETED;
+}
+
+/**
+ * @brief Tests that repeated conversions to a palettized format get the right, unshared palettes
+ */
+int surface_testConvertSurfacePalette(void *arg)
+{
+    SDL_PixelFormat *format;
+    SDL_Surface *face;
+    SDL_Surface *result1;
+    SDL_Surface *result2;
+    SDL_Surface *result3;
+    SDL_Color colors[256];
+    int i;
+
+    face = SDLTest_ImageFace();
+    format = SDL_AllocFormat(SDL_PIXELFORMAT_INDEX8);
+    if (format != NULL) {
+        SDL_Palette *palette = SDL_AllocPalette(256);
+        SDL_SetPixelFormatPalette(format, palette);
+        SDL_FreePalette(palette); /* the format holds on to it */
+    }
+    SDLTest_AssertCheck(face != NULL && format != NULL && format->palette != NULL, "Verify face and INDEX8 format are not NULL");
+    if (face == NULL || format == NULL || format->palette == NULL) {
+        SDL_FreeSurface(face);
+        SDL_FreeFormat(format);
+        return TEST_ABORTED;
+    }
+
+    for (i = 0; i < 256; i++) {
+        colors[i].r = colors[i].g = colors[i].b = (Uint8)i;
+        colors[i].a = 255;
+    }
+    SDL_SetPaletteColors(format->palette, colors, 0, 256);
+    result1 = SDL_ConvertSurface(face, format, 0);
+    SDLTest_AssertCheck(result1 != NULL, "Verify result1 is not NULL");
+    if (result1 != NULL) {
+        SDLTest_AssertCheck(SDL_memcmp(result1->format->palette->colors, colors, sizeof(colors)) == 0, "Verify result1 has the format's colors");
+        SDL_FreeSurface(result1);
+    }
+
+    /* Change the colors, the next conversion must pick them up */
+    for (i = 0; i < 256; i++) {
+        colors[i].r = (Uint8)(255 - i);
+    }
+    SDL_SetPaletteColors(format->palette, colors, 0, 256);
+    result2 = SDL_ConvertSurface(face, format, 0);
+    result3 = SDL_ConvertSurface(face, format, 0);
+    SDLTest_AssertCheck(result2 != NULL && result3 != NULL, "Verify result2 and result3 are not NULL");
+    if (result2 != NULL && result3 != NULL) {
+        SDLTest_AssertCheck(SDL_memcmp(result2->format->palette->colors, colors, sizeof(colors)) == 0, "Verify result2 has the new colors");
+        SDLTest_AssertCheck(SDL_memcmp(result3->format->palette->colors, colors, sizeof(colors)) == 0, "Verify result3 has the new colors");
+        SDLTest_AssertCheck(result2->format->palette != result3->format->palette, "Verify live surfaces don't share a palette");
+    }
+
+    SDL_FreeSurface(result2);
+    SDL_FreeSurface(result3);
+    SDL_FreeFormat(format);
+    SDL_FreeSurface(face);
+
+    return TEST_COMPLETED;
+}
+
+/**
+ * @brief Tests that scaled blits clip like before, and match SDL_SoftStretch(), also when repeated
+ */
+int surface_testBlitScaledCache(void *arg)
+{
+    static const struct
+    {
+        int src_w, src_h;
+        int dst_w, dst_h;
+        Uint32 format;
+    } cases[] = {
+        { 37, 23, 101, 59, SDL_PIXELFORMAT_XRGB8888 },
+        { 101, 59, 37, 23, SDL_PIXELFORMAT_XRGB8888 },
+        { 320, 240, 1280, 960, SDL_PIXELFORMAT_RGB565 },
+        { 17, 9, 50, 31, SDL_PIXELFORMAT_RGB24 }
+    };
+    SDL_Surface *src, *dst, *ref;
+    SDL_Rect srcrect, dstrect;
+    int i, j, y, ret;
+
+    /* A source rectangle hanging off the left edge of a 100x100 surface, scaled by 2 */
+    src = SDL_CreateRGBSurfaceWithFormat(0, 100, 100, 0, SDL_PIXELFORMAT_XRGB8888);
+    dst = SDL_CreateRGBSurfaceWithFormat(0, 300, 300, 0, SDL_PIXELFORMAT_XRGB8888);
+    SDLTest_AssertCheck(src != NULL && dst != NULL, "Verify src and dst are not NULL");
+    if (src == NULL || dst == NULL) {
+        SDL_FreeSurface(src);
+        SDL_FreeSurface(dst);
+        return TEST_ABORTED;
+    }
+    for (j = 0; j < 2; j++) {
+        srcrect.x = -10;
+        srcrect.y = 0;
+        srcrect.w = 100;
+        srcrect.h = 100;
+        dstrect.x = 0;
+        dstrect.y = 0;
+        dstrect.w = 200;
+        dstrect.h = 200;
+        ret = SDL_BlitScaled(src, &srcrect, dst, &dstrect);
+        SDLTest_AssertCheck(ret == 0, "Verify result from SDL_BlitScaled, expected: 0, got: %i", ret);
+        SDLTest_AssertCheck(dstrect.x == 20 && dstrect.y == 0 && dstrect.w == 180 && dstrect.h == 200,
+                            "Verify clipped dstrect, expected: 20,0 180x200, got: %d,%d %dx%d",
+                            dstrect.x, dstrect.y, dstrect.w, dstrect.h);
+    }
+
+    /* Same blit, but with a clip rectangle, which must not be served from the previous result */
+    dstrect.x = 50;
+    dstrect.y = 60;
+    dstrect.w = 100;
+    dstrect.h = 100;
+    SDL_SetClipRect(dst, &dstrect);
+    dstrect.x = 0;
+    dstrect.y = 0;
+    dstrect.w = 200;
+    dstrect.h = 200;
+    ret = SDL_BlitScaled(src, &srcrect, dst, &dstrect);
+    SDLTest_AssertCheck(ret == 0, "Verify result from SDL_BlitScaled, expected: 0, got: %i", ret);
+    SDLTest_AssertCheck(dstrect.x == 50 && dstrect.y == 60 && dstrect.w == 100 && dstrect.h == 100,
+                        "Verify clipped dstrect, expected: 50,60 100x100, got: %d,%d %dx%d",
+                        dstrect.x, dstrect.y, dstrect.w, dstrect.h);
+    SDL_FreeSurface(src);
+    SDL_FreeSurface(dst);
+
+    for (i = 0; i < (int)SDL_arraysize(cases); i++) {
+        src = SDL_CreateRGBSurfaceWithFormat(0, cases[i].src_w, cases[i].src_h, 0, cases[i].format);
+        dst = SDL_CreateRGBSurfaceWithFormat(0, cases[i].dst_w, cases[i].dst_h, 0, cases[i].format);
+        ref = SDL_CreateRGBSurfaceWithFormat(0, cases[i].dst_w, cases[i].dst_h, 0, cases[i].format);
+        SDLTest_AssertCheck(src != NULL && dst != NULL && ref != NULL, "Verify src, dst and ref are not NULL");
+        if (src == NULL || dst == NULL || ref == NULL) {
+            SDL_FreeSurface(src);
+            SDL_FreeSurface(dst);
+            SDL_FreeSurface(ref);
+            return TEST_ABORTED;
+        }
+
+        for (y = 0; y < src->h; y++) {
+            Uint8 *row = (Uint8 *)src->pixels + y * src->pitch;
+            for (j = 0; j < src->w * src->format->BytesPerPixel; j++) {
+                row[j] = (Uint8)SDLTest_RandomIntegerInRange(0, 255);
+            }
+        }
+
+        ret = SDL_SoftStretch(src, NULL, ref, NULL);
+        SDLTest_AssertCheck(ret == 0, "Verify result from SDL_SoftStretch, expected: 0, got: %i", ret);
+
+        /* Twice, so the second blit reuses what the first one set up */
+        for (j = 0; j < 2; j++) {
+            SDL_FillRect(dst, NULL, 0);
+            ret = SDL_BlitScaled(src, NULL, dst, NULL);
+            SDLTest_AssertCheck(ret == 0, "Verify result from SDL_BlitScaled, expected: 0, got: %i", ret);
+            ret = SDLTest_CompareSurfaces(dst, ref, 0);
+            SDLTest_AssertCheck(ret == 0, "Verify %dx%d -> %dx%d %s blit matches SDL_SoftStretch, expected: 0, got: %i",
+                                cases[i].src_w, cases[i].src_h, cases[i].dst_w, cases[i].dst_h,
+                                SDL_GetPixelFormatName(cases[i].format), ret);
+        }
+
+        SDL_FreeSurface(src);
+        SDL_FreeSurface(dst);
+        SDL_FreeSurface(ref);
+    }
+
+    return TEST_COMPLETED;
+}
+
 int surface_testOverflow(void *arg)
 {
     char buf[1024];
@@ -855,6 +1128,22 @@ static const SDLTest_TestCaseReference surfaceTest12 = {
     (SDLTest_TestCaseFp)surface_testBlitBlendMod, "surface_testBlitBlendMod", "Tests blitting routines with mod blending mode.", TEST_ENABLED
 };
 
+static const SDLTest_TestCaseReference surfaceTest13 = {
+    (SDLTest_TestCaseFp)surface_testParallelBlit, "surface_testParallelBlit", "Tests that parallel blits match the reference images.", TEST_ENABLED
+};
+
+static const SDLTest_TestCaseReference surfaceTest14 = {
+    (SDLTest_TestCaseFp)surface_testBlitSurfaces, "surface_testBlitSurfaces", "Tests blitting a batch of rectangles in one call.", TEST_ENABLED
+};
+
+static const SDLTest_TestCaseReference surfaceTest15 = {
+    (SDLTest_TestCaseFp)surface_testConvertSurfacePalette, "surface_testConvertSurfacePalette", "Tests repeated conversions to a palettized format.", TEST_ENABLED
+};
+
+static const SDLTest_TestCaseReference surfaceTest16 = {
+    (SDLTest_TestCaseFp)surface_testBlitScaledCache, "surface_testBlitScaledCache", "Tests clipping and repeated scaled blits.", TEST_ENABLED
+};
+
 static const SDLTest_TestCaseReference surfaceTestOverflow = {
     surface_testOverflow, "surface_testOverflow", "Test overflow detection.", TEST_ENABLED
 };
@@ -863,7 +1152,7 @@ static const SDLTest_TestCaseReference surfaceTestOverflow = {
 static const SDLTest_TestCaseReference *surfaceTests[] = {
     &surfaceTest1, &surfaceTest2, &surfaceTest3, &surfaceTest4, &surfaceTest5,
     &surfaceTest6, &surfaceTest7, &surfaceTest8, &surfaceTest9, &surfaceTest10,
-    &surfaceTest11, &surfaceTest12, &surfaceTestOverflow, NULL
+    &surfaceTest11, &surfaceTest12, &surfaceTest13, &surfaceTest14, &surfaceTest15, &surfaceTest16, &surfaceTestOverflow, NULL
 };
 
 /* Surface test suite (global) */
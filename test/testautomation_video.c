@@ -2288,6 +2288,429 @@ static int video_setWindowInputFocus(void *arg)
     return TEST_COMPLETED;
 }
 
+/*
+ * Load the last frame the dummy video driver saved for a window, with SDL_VIDEO_DUMMY_SAVE_FRAMES
+ * set, and delete the saved frames. The number of frames that were saved goes in num_frames.
+ */
+static SDL_Surface *_loadDummyFrame(SDL_Window *window, int *num_frames)
+{
+    SDL_Surface *frame = NULL;
+    char file[128];
+    int i;
+
+    *num_frames = 0;
+    for (i = 1; i <= 256; ++i) {
+        SDL_Surface *saved;
+
+        (void)SDL_snprintf(file, sizeof(file), "SDL_window%" SDL_PRIu32 "-%8.8d.bmp", SDL_GetWindowID(window), i);
+        saved = SDL_LoadBMP(file);
+        if (saved) {
+            SDL_FreeSurface(frame);
+            frame = saved;
+            ++*num_frames;
+            (void)remove(file);
+        }
+    }
+    return frame;
+}
+
+static Uint32 _getFramePixel(SDL_Surface *frame, int x, int y)
+{
+    const Uint8 *p = (const Uint8 *)frame->pixels + y * frame->pitch + x * frame->format->BytesPerPixel;
+    Uint32 pixel = 0;
+    Uint8 r, g, b;
+
+    SDL_memcpy(&pixel, p, frame->format->BytesPerPixel);
+    SDL_GetRGB(pixel, frame->format, &r, &g, &b);
+    return ((Uint32)r << 16) | ((Uint32)g << 8) | b;
+}
+
+static void _checkDummyFramePixel(SDL_Window *window, Uint8 r, Uint8 g, Uint8 b)
+{
+    const Uint32 expected = ((Uint32)r << 16) | ((Uint32)g << 8) | b;
+    SDL_Surface *frame;
+    Uint32 pixel;
+    int num_frames;
+
+    frame = _loadDummyFrame(window, &num_frames);
+    SDLTest_AssertCheck(frame != NULL, "Validate that the presented frame was saved");
+    if (!frame) {
+        return;
+    }
+    pixel = _getFramePixel(frame, 0, 0);
+    SDLTest_AssertCheck(pixel == expected, "Validate the presented pixel; expected: %.6" SDL_PRIx32 ", got: %.6" SDL_PRIx32, expected, pixel);
+    SDL_FreeSurface(frame);
+}
+
+/**
+ * Tests the gamma ramp emulation on window surfaces
+ */
+static int video_emulateWindowGammaRamp(void *arg)
+{
+    const char *title = "video_emulateWindowGammaRamp Test Window";
+    const SDL_bool dummy = (SDL_strcmp(SDL_GetCurrentVideoDriver(), "dummy") == 0);
+    SDL_Window *window;
+    SDL_Surface *surface;
+    SDL_Renderer *renderer;
+    SDL_Rect rects[2];
+    Uint16 ramp[3][256];
+    Uint16 actual[3][256];
+    Uint32 color;
+    int i, result;
+
+    window = SDL_CreateWindow(title, SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, 64, 64, 0);
+    SDLTest_AssertPass("Call to SDL_CreateWindow('%s', SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, 64, 64, 0)", title);
+    SDLTest_AssertCheck(window != NULL, "Validate that returned window is not NULL");
+    if (!window) {
+        return TEST_ABORTED;
+    }
+
+    for (i = 0; i < 256; ++i) {
+        ramp[0][i] = (Uint16)(((255 - i) << 8) | (255 - i));
+        ramp[1][i] = (Uint16)((i << 8) | i);
+        ramp[2][i] = (Uint16)((i / 2) << 8);
+    }
+
+    /* Without the hint, gamma ramps aren't supported */
+    result = SDL_SetWindowGammaRamp(window, ramp[0], ramp[1], ramp[2]);
+    SDLTest_AssertPass("Call to SDL_SetWindowGammaRamp(window, r, g, b)");
+    SDLTest_AssertCheck(result == -1, "Validate result value; expected: -1, got: %d", result);
+
+    SDL_SetHint("SDL2_GAMMA_RAMP_EMULATION", "1");
+    result = SDL_SetWindowGammaRamp(window, ramp[0], ramp[1], ramp[2]);
+    SDLTest_AssertPass("Call to SDL_SetWindowGammaRamp(window, r, g, b) with SDL2_GAMMA_RAMP_EMULATION=1");
+    SDLTest_AssertCheck(result == 0, "Validate result value; expected: 0, got: %d", result);
+
+    result = SDL_GetWindowGammaRamp(window, actual[0], actual[1], actual[2]);
+    SDLTest_AssertPass("Call to SDL_GetWindowGammaRamp(window, r, g, b)");
+    SDLTest_AssertCheck(result == 0, "Validate result value; expected: 0, got: %d", result);
+    SDLTest_AssertCheck(SDL_memcmp(ramp, actual, sizeof(ramp)) == 0, "Validate that the ramps read back are the ones that were set");
+
+    surface = SDL_GetWindowSurface(window);
+    SDLTest_AssertPass("Call to SDL_GetWindowSurface(window)");
+    SDLTest_AssertCheck(surface != NULL, "Validate that returned surface is not NULL");
+    if (surface) {
+        color = SDL_MapRGB(surface->format, 0x40, 0x80, 0xC0);
+        SDL_FillRect(surface, NULL, color);
+
+        /* The ramp is only applied to what's shown, the app's pixels stay as they were */
+        result = SDL_UpdateWindowSurface(window);
+        SDLTest_AssertPass("Call to SDL_UpdateWindowSurface(window)");
+        SDLTest_AssertCheck(result == 0, "Verify return value; expected: 0, got: %d", result);
+        SDLTest_AssertCheck(*(Uint32 *)surface->pixels == color, "Validate the surface pixels; expected: 0x%.8" SDL_PRIx32 ", got: 0x%.8" SDL_PRIx32, color, *(Uint32 *)surface->pixels);
+
+        rects[0].x = 0;
+        rects[0].y = 0;
+        rects[0].w = 32;
+        rects[0].h = 32;
+        rects[1].x = 16;
+        rects[1].y = 16;
+        rects[1].w = 64;
+        rects[1].h = 64;
+        result = SDL_UpdateWindowSurfaceRects(window, rects, 2);
+        SDLTest_AssertPass("Call to SDL_UpdateWindowSurfaceRects(window, rects, 2)");
+        SDLTest_AssertCheck(result == 0, "Verify return value; expected: 0, got: %d", result);
+        SDLTest_AssertCheck(*(Uint32 *)surface->pixels == color, "Validate the surface pixels; expected: 0x%.8" SDL_PRIx32 ", got: 0x%.8" SDL_PRIx32, color, *(Uint32 *)surface->pixels);
+
+        /* What's shown went through the ramp: red is inverted, green kept and blue halved */
+        if (dummy) {
+            SDL_SetHint("SDL_VIDEO_DUMMY_SAVE_FRAMES", "1");
+            result = SDL_UpdateWindowSurface(window);
+            SDL_SetHint("SDL_VIDEO_DUMMY_SAVE_FRAMES", NULL);
+            SDLTest_AssertCheck(result == 0, "Verify return value; expected: 0, got: %d", result);
+            _checkDummyFramePixel(window, 0xBF, 0x80, 0x60);
+        }
+    }
+    SDL_DestroyWindow(window);
+
+    /* SDL_RenderPresent() draws the frame again through the ramp */
+    window = SDL_CreateWindow(title, SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, 64, 64, 0);
+    SDLTest_AssertCheck(window != NULL, "Validate that returned window is not NULL");
+    renderer = window ? SDL_CreateRenderer(window, -1, SDL_RENDERER_SOFTWARE) : NULL;
+    SDLTest_AssertPass("Call to SDL_CreateRenderer(window, -1, SDL_RENDERER_SOFTWARE)");
+    SDLTest_AssertCheck(renderer != NULL, "Validate that returned renderer is not NULL");
+    if (renderer) {
+        result = SDL_SetWindowGammaRamp(window, ramp[0], ramp[1], ramp[2]);
+        SDLTest_AssertCheck(result == 0, "Validate result value; expected: 0, got: %d", result);
+
+        SDL_SetRenderDrawColor(renderer, 0x40, 0x80, 0xC0, 0xFF);
+        SDL_RenderClear(renderer);
+        if (dummy) {
+            SDL_SetHint("SDL_VIDEO_DUMMY_SAVE_FRAMES", "1");
+        }
+        SDL_RenderPresent(renderer);
+        SDLTest_AssertPass("Call to SDL_RenderPresent(renderer)");
+        if (dummy) {
+            SDL_SetHint("SDL_VIDEO_DUMMY_SAVE_FRAMES", NULL);
+            _checkDummyFramePixel(window, 0xBF, 0x80, 0x60);
+        }
+        SDL_DestroyRenderer(renderer);
+    }
+
+    /* Clean up */
+    SDL_SetHint("SDL2_GAMMA_RAMP_EMULATION", NULL);
+    SDL_DestroyWindow(window);
+
+    return TEST_COMPLETED;
+}
+
+/**
+ * Tests window surface updates with damage tracking
+ */
+static int video_windowSurfaceDamage(void *arg)
+{
+    const char *title = "video_windowSurfaceDamage Test Window";
+    const SDL_bool dummy = (SDL_strcmp(SDL_GetCurrentVideoDriver(), "dummy") == 0);
+    SDL_Window *window;
+    SDL_Surface *surface;
+    SDL_Surface *sprite;
+    SDL_Surface *frame;
+    SDL_Surface *partial = NULL;
+    SDL_Rect rect;
+    Uint16 ramp[3][256];
+    Uint32 pixel;
+    int i, result, num_frames;
+
+    SDL_SetHint("SDL2_WINDOW_SURFACE_DAMAGE", "1");
+
+    window = SDL_CreateWindow(title, SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, 320, 320, 0);
+    SDLTest_AssertPass("Call to SDL_CreateWindow('%s', SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, 320, 320, 0)", title);
+    SDLTest_AssertCheck(window != NULL, "Validate that returned window is not NULL");
+    if (!window) {
+        SDL_SetHint("SDL2_WINDOW_SURFACE_DAMAGE", NULL);
+        return TEST_ABORTED;
+    }
+
+    /* Only what was updated goes through the gamma ramp, which inverts red, so the presented
+       frames saved by the dummy driver show which part of the window was updated */
+    for (i = 0; i < 256; ++i) {
+        ramp[0][i] = (Uint16)(((255 - i) << 8) | (255 - i));
+        ramp[1][i] = (Uint16)((i << 8) | i);
+        ramp[2][i] = (Uint16)((i << 8) | i);
+    }
+    SDL_SetHint("SDL2_GAMMA_RAMP_EMULATION", "1");
+    result = SDL_SetWindowGammaRamp(window, ramp[0], ramp[1], ramp[2]);
+    SDLTest_AssertCheck(result == 0, "Validate result value; expected: 0, got: %d", result);
+
+    surface = SDL_GetWindowSurface(window);
+    SDLTest_AssertPass("Call to SDL_GetWindowSurface(window)");
+    SDLTest_AssertCheck(surface != NULL, "Validate that returned surface is not NULL");
+    sprite = SDL_CreateRGBSurfaceWithFormat(0, 16, 16, 0, SDL_PIXELFORMAT_ARGB8888);
+    SDLTest_AssertCheck(sprite != NULL, "Validate that the sprite surface is not NULL");
+    if (surface && sprite) {
+        SDL_FillRect(surface, NULL, SDL_MapRGB(surface->format, 0, 0, 0));
+        SDL_FillRect(sprite, NULL, SDL_MapRGB(sprite->format, 0x40, 0x80, 0xC0));
+
+        /* The first update shows everything */
+        result = SDL_UpdateWindowSurface(window);
+        SDLTest_AssertPass("Call to SDL_UpdateWindowSurface(window)");
+        SDLTest_AssertCheck(result == 0, "Verify return value; expected: 0, got: %d", result);
+
+        if (dummy) {
+            SDL_SetHint("SDL_VIDEO_DUMMY_SAVE_FRAMES", "1");
+        }
+
+        /* Nothing was drawn, so there's nothing to update */
+        result = SDL_UpdateWindowSurface(window);
+        SDLTest_AssertPass("Call to SDL_UpdateWindowSurface(window) without drawing");
+        SDLTest_AssertCheck(result == 0, "Verify return value; expected: 0, got: %d", result);
+        if (dummy) {
+            frame = _loadDummyFrame(window, &num_frames);
+            SDLTest_AssertCheck(num_frames == 0, "Validate that the update was skipped; expected: 0 frames, got: %d", num_frames);
+            SDL_FreeSurface(frame);
+        }
+
+        /* Only the blitted rect is updated */
+        rect.x = 10;
+        rect.y = 10;
+        rect.w = 16;
+        rect.h = 16;
+        SDL_BlitSurface(sprite, NULL, surface, &rect);
+        result = SDL_UpdateWindowSurface(window);
+        SDLTest_AssertPass("Call to SDL_UpdateWindowSurface(window) after a blit");
+        SDLTest_AssertCheck(result == 0, "Verify return value; expected: 0, got: %d", result);
+        if (dummy) {
+            partial = _loadDummyFrame(window, &num_frames);
+            SDLTest_AssertCheck(num_frames == 1, "Validate the number of updates; expected: 1, got: %d", num_frames);
+            if (partial) {
+                pixel = _getFramePixel(partial, 15, 15);
+                SDLTest_AssertCheck(pixel == 0xBF80C0, "Validate the updated pixel; expected: bf80c0, got: %.6" SDL_PRIx32, pixel);
+                pixel = _getFramePixel(partial, 200, 200);
+                SDLTest_AssertCheck(pixel == 0x000000, "Validate the pixel outside the update; expected: 000000, got: %.6" SDL_PRIx32, pixel);
+            }
+        }
+
+        /* More damage than can be tracked separately is merged into one update of its bounding box */
+        for (i = 0; i < 32; ++i) {
+            rect.x = i * 9;
+            rect.y = i * 9;
+            rect.w = 4;
+            rect.h = 4;
+            SDL_FillRect(surface, &rect, SDL_MapRGB(surface->format, 0, 0, 0));
+        }
+        rect.x = -10;
+        rect.y = 300;
+        rect.w = 40;
+        rect.h = 40;
+        SDL_BlitScaled(sprite, NULL, surface, &rect);
+        result = SDL_UpdateWindowSurface(window);
+        SDLTest_AssertPass("Call to SDL_UpdateWindowSurface(window) after drawing");
+        SDLTest_AssertCheck(result == 0, "Verify return value; expected: 0, got: %d", result);
+        if (dummy) {
+            frame = _loadDummyFrame(window, &num_frames);
+            SDLTest_AssertCheck(num_frames == 1, "Validate the number of updates; expected: 1, got: %d", num_frames);
+            if (frame) {
+                pixel = _getFramePixel(frame, 100, 20);
+                SDLTest_AssertCheck(pixel == 0xFF0000, "Validate the pixel inside the merged update; expected: ff0000, got: %.6" SDL_PRIx32, pixel);
+                pixel = _getFramePixel(frame, 300, 300);
+                SDLTest_AssertCheck(pixel == 0x000000, "Validate the pixel outside the merged update; expected: 000000, got: %.6" SDL_PRIx32, pixel);
+            }
+            SDL_FreeSurface(frame);
+        }
+
+        /* Locking the surface damages all of it, and a full update shows the same pixels the partial one did */
+        SDL_LockSurface(surface);
+        SDL_UnlockSurface(surface);
+        result = SDL_UpdateWindowSurface(window);
+        SDLTest_AssertPass("Call to SDL_UpdateWindowSurface(window) after locking");
+        SDLTest_AssertCheck(result == 0, "Verify return value; expected: 0, got: %d", result);
+        if (dummy) {
+            frame = _loadDummyFrame(window, &num_frames);
+            SDLTest_AssertCheck(num_frames == 1, "Validate the number of updates; expected: 1, got: %d", num_frames);
+            if (frame && partial) {
+                pixel = _getFramePixel(frame, 15, 15);
+                SDLTest_AssertCheck(pixel == _getFramePixel(partial, 15, 15), "Validate the full update matches the partial one; expected: %.6" SDL_PRIx32 ", got: %.6" SDL_PRIx32, _getFramePixel(partial, 15, 15), pixel);
+                pixel = _getFramePixel(frame, 300, 300);
+                SDLTest_AssertCheck(pixel == 0xFF0000, "Validate the whole window was updated; expected: ff0000, got: %.6" SDL_PRIx32, pixel);
+            }
+            SDL_FreeSurface(frame);
+        }
+    }
+
+    /* Clean up */
+    SDL_SetHint("SDL_VIDEO_DUMMY_SAVE_FRAMES", NULL);
+    SDL_SetHint("SDL2_GAMMA_RAMP_EMULATION", NULL);
+    SDL_FreeSurface(partial);
+    SDL_FreeSurface(sprite);
+    SDL_DestroyWindow(window);
+    SDL_SetHint("SDL2_WINDOW_SURFACE_DAMAGE", NULL);
+
+    return TEST_COMPLETED;
+}
+
+#define SHAPE_TEST_WIDTH 37
+#define SHAPE_TEST_HEIGHT 23
+
+/* The start of SDL3's SDL_Surface, which is where SDL3 keeps the window shape */
+typedef struct
+{
+    Uint32 flags;
+    Uint32 format;
+    int w;
+    int h;
+    int pitch;
+    void *pixels;
+} _SDL3SurfaceHeader;
+
+static SDL_bool _getWindowShapeMask(SDL_Window *window, SDL_Surface *shape, SDL_WindowShapeMode *mode, const char *paths, Uint32 *mask)
+{
+    const _SDL3SurfaceHeader *result;
+    int y;
+
+    SDL_SetHint("SDL2_SHAPE_FAST_PATHS", paths);
+    if (SDL_SetWindowShape(window, shape, mode) != 0) {
+        return SDL_FALSE;
+    }
+    result = (const _SDL3SurfaceHeader *)SDL_GetWindowData(window, "SDL.window.shape");
+    if (!result || result->w != shape->w || result->h != shape->h) {
+        return SDL_FALSE;
+    }
+    for (y = 0; y < result->h; ++y) {
+        SDL_memcpy(&mask[y * shape->w], (const Uint8 *)result->pixels + y * result->pitch, shape->w * sizeof(Uint32));
+    }
+    return SDL_TRUE;
+}
+
+/**
+ * Tests that the shape mask fast paths match the generic path
+ */
+static int video_shapeFastPaths(void *arg)
+{
+    const Uint32 formats[] = { SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_RGBA8888, SDL_PIXELFORMAT_INDEX8 };
+    const WindowShapeMode modes[] = { ShapeModeDefault, ShapeModeBinarizeAlpha, ShapeModeReverseBinarizeAlpha, ShapeModeColorKey };
+    Uint32 generic[SHAPE_TEST_WIDTH * SHAPE_TEST_HEIGHT];
+    Uint32 scalar[SHAPE_TEST_WIDTH * SHAPE_TEST_HEIGHT];
+    Uint32 simd[SHAPE_TEST_WIDTH * SHAPE_TEST_HEIGHT];
+    SDL_Window *window;
+    SDL_Color colors[256];
+    Uint32 seed = 12345;
+    int f, m, i, x, y;
+
+    window = SDL_CreateShapedWindow("video_shapeFastPaths", 0, 0, SHAPE_TEST_WIDTH, SHAPE_TEST_HEIGHT, 0);
+    SDLTest_AssertPass("Call to SDL_CreateShapedWindow()");
+    if (!window) {
+        return TEST_SKIPPED;
+    }
+
+    for (i = 0; i < 256; ++i) {
+        colors[i].r = (Uint8)i;
+        colors[i].g = (Uint8)(i * 3);
+        colors[i].b = (Uint8)(i * 7);
+        colors[i].a = (Uint8)(i * 5);
+    }
+
+    for (f = 0; f < (int)SDL_arraysize(formats); ++f) {
+        SDL_Surface *shape = SDL_CreateRGBSurfaceWithFormat(0, SHAPE_TEST_WIDTH, SHAPE_TEST_HEIGHT, 0, formats[f]);
+        SDLTest_AssertCheck(shape != NULL, "Validate that the %s shape is not NULL", SDL_GetPixelFormatName(formats[f]));
+        if (!shape) {
+            continue;
+        }
+        if (shape->format->palette) {
+            SDL_SetPaletteColors(shape->format->palette, colors, 0, 256);
+        }
+
+        /* Noise, with the color key and the cutoff alpha showing up often enough to matter */
+        for (y = 0; y < shape->h; ++y) {
+            Uint8 *row = (Uint8 *)shape->pixels + y * shape->pitch;
+            for (x = 0; x < shape->w * shape->format->BytesPerPixel; ++x) {
+                seed = seed * 1103515245 + 12345;
+                row[x] = ((seed >> 12) & 3) ? (Uint8)(seed >> 16) : 0x80;
+            }
+        }
+
+        for (m = 0; m < (int)SDL_arraysize(modes); ++m) {
+            SDL_WindowShapeMode mode;
+            SDL_bool ok;
+
+            mode.mode = modes[m];
+            if (mode.mode == ShapeModeColorKey) {
+                mode.parameters.colorKey.r = 0x80;
+                mode.parameters.colorKey.g = 0x80;
+                mode.parameters.colorKey.b = 0x80;
+                mode.parameters.colorKey.a = 0xFF;
+            } else {
+                mode.parameters.binarizationCutoff = 0x80;
+            }
+
+            ok = _getWindowShapeMask(window, shape, &mode, "0", generic) &&
+                 _getWindowShapeMask(window, shape, &mode, "1", scalar) &&
+                 _getWindowShapeMask(window, shape, &mode, NULL, simd);
+            SDLTest_AssertCheck(ok, "Validate that the %s masks were computed for mode %d", SDL_GetPixelFormatName(formats[f]), (int)mode.mode);
+            if (ok) {
+                SDLTest_AssertCheck(SDL_memcmp(generic, scalar, sizeof(generic)) == 0, "Validate the %s fast path mask for mode %d matches the generic one", SDL_GetPixelFormatName(formats[f]), (int)mode.mode);
+                SDLTest_AssertCheck(SDL_memcmp(generic, simd, sizeof(generic)) == 0, "Validate the %s SIMD mask for mode %d matches the generic one", SDL_GetPixelFormatName(formats[f]), (int)mode.mode);
+            }
+        }
+        SDL_FreeSurface(shape);
+    }
+
+    /* Clean up */
+    SDL_SetHint("SDL2_SHAPE_FAST_PATHS", NULL);
+    SDL_DestroyWindow(window);
+
+    return TEST_COMPLETED;
+}
+
 /* ================= Test References ================== */
 
 /* Video test cases */
@@ -2378,6 +2801,15 @@ static const SDLTest_TestCaseReference videoTest25 = {
 static const SDLTest_TestCaseReference videoTest26 = {
     (SDLTest_TestCaseFp)video_setWindowInputFocus, "video_setWindowInputFocus", "Checks window input focus", TEST_ENABLED
 };
+static const SDLTest_TestCaseReference videoTest27 = {
+    (SDLTest_TestCaseFp)video_emulateWindowGammaRamp, "video_emulateWindowGammaRamp", "Checks gamma ramp emulation on window surfaces", TEST_ENABLED
+};
+static const SDLTest_TestCaseReference videoTest28 = {
+    (SDLTest_TestCaseFp)video_windowSurfaceDamage, "video_windowSurfaceDamage", "Checks window surface updates with damage tracking", TEST_ENABLED
+};
+static const SDLTest_TestCaseReference videoTest29 = {
+    (SDLTest_TestCaseFp)video_shapeFastPaths, "video_shapeFastPaths", "Checks that the shape mask fast paths match the generic path", TEST_ENABLED
+};
 
 /* Sequence of Video test cases */
 static const SDLTest_TestCaseReference *videoTests[] = {
@@ -2385,7 +2817,8 @@ static const SDLTest_TestCaseReference *videoTests[] = {
     &videoTest7, &videoTest8, &videoTest9, &videoTest10, &videoTest11, &videoTest12,
     &videoTest13, &videoTest14, &videoTest15, &videoTest16, &videoTest17,
     &videoTest18, &videoTest19, &videoTest20, &videoTest21, &videoTest22,
-    &videoTest23, &videoTest24, &videoTest25, &videoTest26, NULL
+    &videoTest23, &videoTest24, &videoTest25, &videoTest26, &videoTest27,
+    &videoTest28, &videoTest29, NULL
 };
 
 /* Video test suite (global) */
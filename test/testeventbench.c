@@ -0,0 +1,272 @@
+/*
+  Copyright (C) 1997-2025 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Measures how much the event path costs: pushes synthetic events of the
+   common types through SDL_PushEvent()/SDL_PeepEvents() and takes them
+   back off with SDL_PollEvent()/SDL_PeepEvents()/SDL_CompatPollEvents(),
+   with no, one and several event watchers installed. */
+
+#include "SDL_test.h"
+#include "SDL_compat.h"
+
+#define DEFAULT_EVENT_COUNT 100000
+#define BATCH_SIZE 1024
+
+static SDL_malloc_func real_malloc;
+static SDL_calloc_func real_calloc;
+static SDL_realloc_func real_realloc;
+static SDL_free_func real_free;
+static SDL_atomic_t num_allocations;
+
+static void *SDLCALL counting_malloc(size_t size)
+{
+    SDL_AtomicAdd(&num_allocations, 1);
+    return real_malloc(size);
+}
+
+static void *SDLCALL counting_calloc(size_t nmemb, size_t size)
+{
+    SDL_AtomicAdd(&num_allocations, 1);
+    return real_calloc(nmemb, size);
+}
+
+static void *SDLCALL counting_realloc(void *mem, size_t size)
+{
+    SDL_AtomicAdd(&num_allocations, 1);
+    return real_realloc(mem, size);
+}
+
+static void SDLCALL counting_free(void *mem)
+{
+    real_free(mem);
+}
+
+static int SDLCALL
+watch_event(void *userdata, SDL_Event *event)
+{
+    (*(int *)userdata)++;
+    return 1;
+}
+
+typedef enum
+{
+    PATH_PUSH_POLL,
+    PATH_PUSH_PEEP,
+    PATH_PUSH_COMPATPOLL,
+    PATH_PEEPADD_PEEP
+} EventPath;
+
+static const char *path_names[] = { "push+poll", "push+peep", "push+compatpoll", "peepadd+peep" };
+
+typedef struct
+{
+    const char *name;
+    Uint32 type;
+} EventKind;
+
+static const EventKind event_kinds[] = {
+    { "SDL_USEREVENT", SDL_USEREVENT },
+    { "SDL_KEYDOWN", SDL_KEYDOWN },
+    { "SDL_MOUSEMOTION", SDL_MOUSEMOTION },
+    { "SDL_MOUSEBUTTONDOWN", SDL_MOUSEBUTTONDOWN },
+    { "SDL_CONTROLLERAXISMOTION", SDL_CONTROLLERAXISMOTION },
+    { "SDL_WINDOWEVENT", SDL_WINDOWEVENT }
+};
+
+static void
+make_event(SDL_Event *event, Uint32 type, Uint32 windowID, int i)
+{
+    SDL_zerop(event);
+    event->type = type;
+    switch (type) {
+    case SDL_KEYDOWN:
+        event->key.windowID = windowID;
+        event->key.state = SDL_PRESSED;
+        event->key.keysym.scancode = SDL_SCANCODE_A;
+        event->key.keysym.sym = SDLK_a;
+        break;
+    case SDL_MOUSEMOTION:
+        event->motion.windowID = windowID;
+        event->motion.x = i & 0xFF;
+        event->motion.y = (i >> 8) & 0xFF;
+        event->motion.xrel = 1;
+        event->motion.yrel = 1;
+        break;
+    case SDL_MOUSEBUTTONDOWN:
+        event->button.windowID = windowID;
+        event->button.button = SDL_BUTTON_LEFT;
+        event->button.state = SDL_PRESSED;
+        event->button.x = i & 0xFF;
+        event->button.y = (i >> 8) & 0xFF;
+        break;
+    case SDL_CONTROLLERAXISMOTION:
+        event->caxis.axis = SDL_CONTROLLER_AXIS_LEFTX;
+        event->caxis.value = (Sint16)i;
+        break;
+    case SDL_WINDOWEVENT:
+        /* shown events aren't coalesced, so every one of them makes it through */
+        event->window.windowID = windowID;
+        event->window.event = SDL_WINDOWEVENT_SHOWN;
+        break;
+    default:
+        event->user.code = i;
+        break;
+    }
+}
+
+/* Returns the number of events that made it through */
+static int
+run_batch(EventPath path, SDL_Event *events, int count)
+{
+    int received = 0;
+    int i;
+
+    if (path == PATH_PEEPADD_PEEP) {
+        SDL_PeepEvents(events, count, SDL_ADDEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT);
+    } else {
+        for (i = 0; i < count; i++) {
+            SDL_PushEvent(&events[i]);
+        }
+    }
+
+    switch (path) {
+    case PATH_PUSH_POLL:
+        while (SDL_PollEvent(&events[0])) {
+            received++;
+        }
+        break;
+    case PATH_PUSH_COMPATPOLL:
+        for (;;) {
+            const int got = SDL_CompatPollEvents(events, count);
+            if (got <= 0) {
+                break;
+            }
+            received += got;
+        }
+        break;
+    default:
+        for (;;) {
+            const int got = SDL_PeepEvents(events, count, SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT);
+            if (got <= 0) {
+                break;
+            }
+            received += got;
+        }
+        break;
+    }
+    return received;
+}
+
+static void
+run_benchmark(const EventKind *kind, EventPath path, int num_watchers, Uint32 windowID, int total)
+{
+    SDL_Event events[BATCH_SIZE];
+    int watched[8];
+    Uint64 start, elapsed;
+    int allocations;
+    int received = 0;
+    int done;
+    int i;
+
+    for (i = 0; i < num_watchers; i++) {
+        watched[i] = 0;
+        SDL_AddEventWatch(watch_event, &watched[i]);
+    }
+
+    /* Warm up, so one-time allocations don't count */
+    for (i = 0; i < BATCH_SIZE; i++) {
+        make_event(&events[i], kind->type, windowID, i);
+    }
+    run_batch(path, events, BATCH_SIZE);
+
+    SDL_AtomicSet(&num_allocations, 0);
+    start = SDL_GetPerformanceCounter();
+    for (done = 0; done < total; done += BATCH_SIZE) {
+        const int count = SDL_min(BATCH_SIZE, total - done);
+        for (i = 0; i < count; i++) {
+            make_event(&events[i], kind->type, windowID, done + i);
+        }
+        received += run_batch(path, events, count);
+    }
+    elapsed = SDL_GetPerformanceCounter() - start;
+    allocations = SDL_AtomicGet(&num_allocations);
+
+    for (i = 0; i < num_watchers; i++) {
+        SDL_DelEventWatch(watch_event, &watched[i]);
+    }
+
+    SDL_Log("%-26s %-16s watchers=%d: %8.1f ns/event %6.2f allocs/event%s",
+            kind->name, path_names[path], num_watchers,
+            (double)elapsed * 1e9 / (double)SDL_GetPerformanceFrequency() / (double)total,
+            (double)allocations / (double)total,
+            (received < total) ? " (some events were dropped!)" : "");
+}
+
+int main(int argc, char *argv[])
+{
+    static const int watcher_counts[] = { 0, 1, 8 };
+    SDLTest_CommonState *state;
+    int total = DEFAULT_EVENT_COUNT;
+    Uint32 windowID;
+    int i, k, p, w;
+
+    /* Count allocations from here on, like SDLTest_TrackAllocations() */
+    SDL_GetMemoryFunctions(&real_malloc, &real_calloc, &real_realloc, &real_free);
+    SDL_SetMemoryFunctions(counting_malloc, counting_calloc, counting_realloc, counting_free);
+
+    state = SDLTest_CommonCreateState(argv, SDL_INIT_VIDEO);
+    if (!state) {
+        return 1;
+    }
+
+    /* Enable standard application logging */
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+
+    /* Parse commandline */
+    for (i = 1; i < argc;) {
+        int consumed;
+
+        consumed = SDLTest_CommonArg(state, i);
+        if (!consumed) {
+            if (SDL_strcmp(argv[i], "--count") == 0 && argv[i + 1]) {
+                total = SDL_atoi(argv[i + 1]);
+                consumed = (total > 0) ? 2 : -1;
+            }
+        }
+
+        if (consumed <= 0) {
+            static const char *options[] = { "[--count N]", NULL };
+            SDLTest_CommonLogUsage(state, argv[0], options);
+            return 1;
+        }
+
+        i += consumed;
+    }
+
+    state->window_flags |= SDL_WINDOW_HIDDEN;
+    if (!SDLTest_CommonInit(state)) {
+        return 1;
+    }
+    windowID = SDL_GetWindowID(state->windows[0]);
+
+    SDL_Log("Pushing %d events per case in batches of %d", total, BATCH_SIZE);
+    for (k = 0; k < (int)SDL_arraysize(event_kinds); k++) {
+        for (p = 0; p < (int)SDL_arraysize(path_names); p++) {
+            for (w = 0; w < (int)SDL_arraysize(watcher_counts); w++) {
+                run_benchmark(&event_kinds[k], (EventPath)p, watcher_counts[w], windowID, total);
+            }
+        }
+    }
+
+    SDLTest_CommonQuit(state);
+    return 0;
+}
@@ -0,0 +1,106 @@
+/*
+  Copyright (C) 1997-2025 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Replays a render trace, recorded with SDL2_RENDER_RECORD=<file> or
+   SDL_CompatStartRenderRecording(), on an offscreen software renderer and
+   prints how long each rendering function took when it was recorded and
+   when it was replayed. */
+
+#include "SDL_test.h"
+#include "SDL_compat.h"
+
+#define MAX_STATS 64
+
+static const char *options[] = { "[--iterations N]", "trace", NULL };
+
+int main(int argc, char *argv[])
+{
+    SDLTest_CommonState *state;
+    SDL_CompatRenderCallStats stats[MAX_STATS];
+    SDL_CompatRenderCallStats totals[MAX_STATS];
+    const char *file = NULL;
+    int iterations = 1;
+    int num_stats = 0;
+    int i, n;
+
+    state = SDLTest_CommonCreateState(argv, SDL_INIT_VIDEO);
+    if (!state) {
+        return 1;
+    }
+
+    /* Enable standard application logging */
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+
+    /* Parse commandline */
+    for (i = 1; i < argc;) {
+        int consumed;
+
+        consumed = SDLTest_CommonArg(state, i);
+        if (!consumed) {
+            if (SDL_strcmp(argv[i], "--iterations") == 0 && argv[i + 1]) {
+                iterations = SDL_atoi(argv[i + 1]);
+                consumed = (iterations > 0) ? 2 : -1;
+            } else if (!file && argv[i][0] != '-') {
+                file = argv[i];
+                consumed = 1;
+            }
+        }
+
+        if (consumed <= 0) {
+            SDLTest_CommonLogUsage(state, argv[0], options);
+            return 1;
+        }
+
+        i += consumed;
+    }
+
+    if (!file) {
+        SDLTest_CommonLogUsage(state, argv[0], options);
+        return 1;
+    }
+
+    if (SDL_Init(state->flags) < 0) {
+        SDL_Log("Couldn't initialize SDL: %s", SDL_GetError());
+        SDLTest_CommonQuit(state);
+        return 1;
+    }
+
+    /* Every replay makes the same calls, so the entries line up */
+    SDL_zero(totals);
+    for (n = 0; n < iterations; n++) {
+        num_stats = SDL_CompatReplayRenderRecording(file, stats, MAX_STATS);
+        if (num_stats < 0) {
+            SDL_Log("Couldn't replay %s: %s", file, SDL_GetError());
+            SDLTest_CommonQuit(state);
+            return 1;
+        }
+        num_stats = SDL_min(num_stats, MAX_STATS);
+        for (i = 0; i < num_stats; i++) {
+            totals[i].name = stats[i].name;
+            totals[i].count = stats[i].count;
+            totals[i].bytes = stats[i].bytes;
+            totals[i].recorded_ns = stats[i].recorded_ns;
+            totals[i].replayed_ns += stats[i].replayed_ns;
+        }
+    }
+
+    SDL_Log("Replayed %s %d time%s", file, iterations, (iterations == 1) ? "" : "s");
+    SDL_Log("%-30s %10s %12s %14s %14s", "function", "calls", "trace bytes", "recorded ns", "replayed ns");
+    for (i = 0; i < num_stats; i++) {
+        const SDL_CompatRenderCallStats *s = &totals[i];
+        SDL_Log("%-30s %10" SDL_PRIu64 " %12" SDL_PRIu64 " %14" SDL_PRIu64 " %14" SDL_PRIu64,
+                s->name, s->count, s->bytes, s->recorded_ns, s->replayed_ns / (Uint64)iterations);
+    }
+
+    SDLTest_CommonQuit(state);
+    return 0;
+}
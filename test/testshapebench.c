@@ -0,0 +1,186 @@
+/*
+  Copyright (C) 1997-2025 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Measures how long SDL_SetWindowShape() takes to turn a 1080p shape into
+   a window mask, with the per-format fast paths and with the generic
+   per-pixel path (SDL2_SHAPE_FAST_PATHS=0), for each shape mode. */
+
+#include "SDL_test.h"
+#include "SDL_shape.h"
+
+#define SHAPE_WIDTH 1920
+#define SHAPE_HEIGHT 1080
+#define DEFAULT_ITERATIONS 20
+
+typedef struct
+{
+    const char *name;
+    WindowShapeMode mode;
+} ShapeModeCase;
+
+static const ShapeModeCase shape_modes[] = {
+    { "default", ShapeModeDefault },
+    { "binarize", ShapeModeBinarizeAlpha },
+    { "reverse", ShapeModeReverseBinarizeAlpha },
+    { "colorkey", ShapeModeColorKey }
+};
+
+static const Uint32 shape_formats[] = {
+    SDL_PIXELFORMAT_ARGB8888,
+    SDL_PIXELFORMAT_RGBA8888,
+    SDL_PIXELFORMAT_INDEX8
+};
+
+static SDL_Surface *
+create_shape(Uint32 format)
+{
+    SDL_Surface *shape;
+    Uint32 seed = 12345;
+    int x, y;
+
+    shape = SDL_CreateRGBSurfaceWithFormat(0, SHAPE_WIDTH, SHAPE_HEIGHT, 0, format);
+    if (!shape) {
+        return NULL;
+    }
+
+    if (shape->format->palette) {
+        SDL_Color colors[256];
+        int i;
+        for (i = 0; i < 256; i++) {
+            colors[i].r = (Uint8)i;
+            colors[i].g = (Uint8)(i * 3);
+            colors[i].b = (Uint8)(i * 7);
+            colors[i].a = (Uint8)(i * 5);
+        }
+        SDL_SetPaletteColors(shape->format->palette, colors, 0, 256);
+    }
+
+    /* Fill with noise, so the masks aren't trivially uniform */
+    for (y = 0; y < shape->h; y++) {
+        Uint8 *row = (Uint8 *)shape->pixels + y * shape->pitch;
+        for (x = 0; x < shape->w * shape->format->BytesPerPixel; x++) {
+            seed = seed * 1103515245 + 12345;
+            row[x] = (Uint8)(seed >> 16);
+        }
+    }
+    return shape;
+}
+
+static double
+time_shape(SDL_Window *window, SDL_Surface *shape, SDL_WindowShapeMode *mode, int iterations, SDL_bool fast)
+{
+    Uint64 start;
+    int i;
+
+    SDL_SetHint("SDL2_SHAPE_FAST_PATHS", fast ? NULL : "0");
+
+    start = SDL_GetPerformanceCounter();
+    for (i = 0; i < iterations; i++) {
+        if (SDL_SetWindowShape(window, shape, mode) != 0) {
+            SDL_Log("SDL_SetWindowShape() failed: %s", SDL_GetError());
+            return -1.0;
+        }
+    }
+    return (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / (double)SDL_GetPerformanceFrequency() / (double)iterations;
+}
+
+int main(int argc, char *argv[])
+{
+    SDLTest_CommonState *state;
+    SDL_Window *window;
+    int iterations = DEFAULT_ITERATIONS;
+    int i, f, m;
+
+    state = SDLTest_CommonCreateState(argv, SDL_INIT_VIDEO);
+    if (!state) {
+        return 1;
+    }
+
+    /* Enable standard application logging */
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+
+    /* Parse commandline */
+    for (i = 1; i < argc;) {
+        int consumed;
+
+        consumed = SDLTest_CommonArg(state, i);
+        if (!consumed) {
+            if (SDL_strcmp(argv[i], "--iterations") == 0 && argv[i + 1]) {
+                iterations = SDL_atoi(argv[i + 1]);
+                consumed = (iterations > 0) ? 2 : -1;
+            }
+        }
+
+        if (consumed <= 0) {
+            static const char *options[] = { "[--iterations N]", NULL };
+            SDLTest_CommonLogUsage(state, argv[0], options);
+            return 1;
+        }
+
+        i += consumed;
+    }
+
+    if (SDL_Init(state->flags) < 0) {
+        SDL_Log("Couldn't initialize SDL: %s", SDL_GetError());
+        SDLTest_CommonQuit(state);
+        return 1;
+    }
+
+    window = SDL_CreateShapedWindow("testshapebench", 0, 0, SHAPE_WIDTH, SHAPE_HEIGHT, SDL_WINDOW_HIDDEN);
+    if (!window) {
+        SDL_Log("Couldn't create shaped window: %s", SDL_GetError());
+        SDLTest_CommonQuit(state);
+        return 1;
+    }
+
+    SDL_Log("Computing %dx%d shapes, %d times per case", SHAPE_WIDTH, SHAPE_HEIGHT, iterations);
+    for (f = 0; f < (int)SDL_arraysize(shape_formats); f++) {
+        SDL_Surface *shape = create_shape(shape_formats[f]);
+        if (!shape) {
+            SDL_Log("Couldn't create %s shape: %s", SDL_GetPixelFormatName(shape_formats[f]), SDL_GetError());
+            continue;
+        }
+
+        for (m = 0; m < (int)SDL_arraysize(shape_modes); m++) {
+            SDL_WindowShapeMode mode;
+            double generic, fast;
+
+            mode.mode = shape_modes[m].mode;
+            if (mode.mode == ShapeModeColorKey) {
+                mode.parameters.colorKey.r = 0x80;
+                mode.parameters.colorKey.g = 0x80;
+                mode.parameters.colorKey.b = 0x80;
+                mode.parameters.colorKey.a = 0xFF;
+            } else {
+                mode.parameters.binarizationCutoff = 128;
+            }
+
+            generic = time_shape(window, shape, &mode, iterations, SDL_FALSE);
+            fast = time_shape(window, shape, &mode, iterations, SDL_TRUE);
+            if (generic < 0.0 || fast < 0.0) {
+                SDL_FreeSurface(shape);
+                SDL_DestroyWindow(window);
+                SDLTest_CommonQuit(state);
+                return 1;
+            }
+            SDL_Log("%-24s %-9s generic: %8.3f ms  fast: %8.3f ms  (%.1fx)",
+                    SDL_GetPixelFormatName(shape_formats[f]), shape_modes[m].name,
+                    generic, fast, (fast > 0.0) ? (generic / fast) : 0.0);
+        }
+        SDL_FreeSurface(shape);
+    }
+
+    SDL_SetHint("SDL2_SHAPE_FAST_PATHS", NULL);
+    SDL_DestroyWindow(window);
+    SDLTest_CommonQuit(state);
+    return 0;
+}
@@ -0,0 +1,204 @@
+/*
+  Copyright (C) 1997-2025 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Measures a testsprite2-style frame on the software renderer, in a hidden
+   window: many small sprites drawn with one SDL_RenderCopy() each, with
+   SDL_RenderCopy() merging its copies (SDL2_RENDER_MERGE_COPIES=1), and with
+   one SDL_CompatRenderSprites() call. */
+
+#include "SDL_test.h"
+#include "SDL_compat.h"
+
+#define WINDOW_WIDTH 640
+#define WINDOW_HEIGHT 480
+#define SPRITE_SIZE 32
+#define DEFAULT_SPRITE_COUNT 1000
+#define DEFAULT_FRAMES 100
+
+typedef enum
+{
+    MODE_COPY,
+    MODE_MERGED_COPY,
+    MODE_COMPAT_SPRITES
+} SpriteMode;
+
+static const char *mode_names[] = { "RenderCopy", "merged RenderCopy", "CompatRenderSprites" };
+
+static void
+draw_frame(SDL_Renderer *renderer, SDL_Texture *sprite, SpriteMode mode, const SDL_CompatSprite *sprites, const SDL_Rect *positions, int count)
+{
+    int i;
+
+    SDL_SetRenderDrawColor(renderer, 0xA0, 0xA0, 0xA0, 0xFF);
+    SDL_RenderClear(renderer);
+    if (mode == MODE_COMPAT_SPRITES) {
+        SDL_CompatRenderSprites(renderer, sprites, count);
+    } else {
+        for (i = 0; i < count; i++) {
+            SDL_RenderCopy(renderer, sprite, NULL, &positions[i]);
+        }
+    }
+    SDL_RenderPresent(renderer);
+}
+
+/* Returns the milliseconds per frame, or a negative number on error */
+static double
+time_frames(SDL_Window *window, SDL_Surface *image, SpriteMode mode, const SDL_Rect *positions, SDL_CompatSprite *sprites, int count, int frames)
+{
+    SDL_Renderer *renderer;
+    SDL_Texture *sprite;
+    Uint64 start, elapsed;
+    int i;
+
+    /* Both hints are only looked at when the renderer is created */
+    SDL_SetHint("SDL_RENDER_BATCHING", "1");
+    SDL_SetHint("SDL2_RENDER_MERGE_COPIES", (mode == MODE_MERGED_COPY) ? "1" : "0");
+    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_SOFTWARE);
+    SDL_SetHint("SDL_RENDER_BATCHING", NULL);
+    SDL_SetHint("SDL2_RENDER_MERGE_COPIES", NULL);
+    if (!renderer) {
+        SDL_Log("Couldn't create software renderer: %s", SDL_GetError());
+        return -1.0;
+    }
+
+    sprite = SDL_CreateTextureFromSurface(renderer, image);
+    if (!sprite) {
+        SDL_Log("Couldn't create texture: %s", SDL_GetError());
+        SDL_DestroyRenderer(renderer);
+        return -1.0;
+    }
+    SDL_SetTextureBlendMode(sprite, SDL_BLENDMODE_BLEND);
+    for (i = 0; i < count; i++) {
+        sprites[i].texture = sprite;
+    }
+
+    /* Warm up, so one-time allocations don't count */
+    draw_frame(renderer, sprite, mode, sprites, positions, count);
+
+    start = SDL_GetPerformanceCounter();
+    for (i = 0; i < frames; i++) {
+        draw_frame(renderer, sprite, mode, sprites, positions, count);
+    }
+    elapsed = SDL_GetPerformanceCounter() - start;
+
+    SDL_DestroyTexture(sprite);
+    SDL_DestroyRenderer(renderer);
+    return (double)elapsed * 1000.0 / (double)SDL_GetPerformanceFrequency() / (double)frames;
+}
+
+int main(int argc, char *argv[])
+{
+    SDLTest_CommonState *state;
+    SDL_Window *window;
+    SDL_Surface *image;
+    SDL_Rect *positions;
+    SDL_CompatSprite *sprites;
+    double times[SDL_arraysize(mode_names)];
+    int count = DEFAULT_SPRITE_COUNT;
+    int frames = DEFAULT_FRAMES;
+    int i, m;
+
+    state = SDLTest_CommonCreateState(argv, SDL_INIT_VIDEO);
+    if (!state) {
+        return 1;
+    }
+
+    /* Enable standard application logging */
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+
+    /* Parse commandline */
+    for (i = 1; i < argc;) {
+        int consumed;
+
+        consumed = SDLTest_CommonArg(state, i);
+        if (!consumed) {
+            if (SDL_strcmp(argv[i], "--count") == 0 && argv[i + 1]) {
+                count = SDL_atoi(argv[i + 1]);
+                consumed = (count > 0) ? 2 : -1;
+            } else if (SDL_strcmp(argv[i], "--frames") == 0 && argv[i + 1]) {
+                frames = SDL_atoi(argv[i + 1]);
+                consumed = (frames > 0) ? 2 : -1;
+            }
+        }
+
+        if (consumed <= 0) {
+            static const char *options[] = { "[--count N]", "[--frames N]", NULL };
+            SDLTest_CommonLogUsage(state, argv[0], options);
+            return 1;
+        }
+
+        i += consumed;
+    }
+
+    if (SDL_Init(state->flags) < 0) {
+        SDL_Log("Couldn't initialize SDL: %s", SDL_GetError());
+        SDLTest_CommonQuit(state);
+        return 1;
+    }
+
+    window = SDL_CreateWindow("testspritebench", 0, 0, WINDOW_WIDTH, WINDOW_HEIGHT, SDL_WINDOW_HIDDEN);
+    image = SDLTest_ImageFace();
+    positions = (SDL_Rect *)SDL_malloc(count * sizeof(*positions));
+    sprites = (SDL_CompatSprite *)SDL_malloc(count * sizeof(*sprites));
+    if (!window || !image || !positions || !sprites) {
+        SDL_Log("Couldn't set up: %s", SDL_GetError());
+        SDL_free(positions);
+        SDL_free(sprites);
+        SDL_FreeSurface(image);
+        SDL_DestroyWindow(window);
+        SDLTest_CommonQuit(state);
+        return 1;
+    }
+
+    /* Scatter the sprites like testsprite2 does, the same way every run */
+    SDLTest_FuzzerInit(12345);
+    for (i = 0; i < count; i++) {
+        positions[i].x = SDLTest_RandomIntegerInRange(0, WINDOW_WIDTH - SPRITE_SIZE);
+        positions[i].y = SDLTest_RandomIntegerInRange(0, WINDOW_HEIGHT - SPRITE_SIZE);
+        positions[i].w = SPRITE_SIZE;
+        positions[i].h = SPRITE_SIZE;
+
+        SDL_zero(sprites[i]);
+        sprites[i].dstrect.x = (float)positions[i].x;
+        sprites[i].dstrect.y = (float)positions[i].y;
+        sprites[i].dstrect.w = (float)positions[i].w;
+        sprites[i].dstrect.h = (float)positions[i].h;
+        sprites[i].flip = SDL_FLIP_NONE;
+        sprites[i].color.r = 0xFF;
+        sprites[i].color.g = 0xFF;
+        sprites[i].color.b = 0xFF;
+        sprites[i].color.a = 0xFF;
+    }
+
+    SDL_Log("Drawing %d sprites per frame, %d frames per case", count, frames);
+    for (m = 0; m < (int)SDL_arraysize(mode_names); m++) {
+        times[m] = time_frames(window, image, (SpriteMode)m, positions, sprites, count, frames);
+        if (times[m] < 0.0) {
+            SDL_free(positions);
+            SDL_free(sprites);
+            SDL_FreeSurface(image);
+            SDL_DestroyWindow(window);
+            SDLTest_CommonQuit(state);
+            return 1;
+        }
+        SDL_Log("%-20s %8.3f ms/frame  %8.1f ns/sprite  (%.1fx)",
+                mode_names[m], times[m], times[m] * 1e6 / (double)count,
+                (times[m] > 0.0) ? (times[MODE_COPY] / times[m]) : 0.0);
+    }
+
+    SDL_free(positions);
+    SDL_free(sprites);
+    SDL_FreeSurface(image);
+    SDL_DestroyWindow(window);
+    SDLTest_CommonQuit(state);
+    return 0;
+}
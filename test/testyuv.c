@@ -211,6 +211,93 @@ done:
     return result;
 }
 
+/* Time converting 4K frames on one thread and split across every core, and make sure both give the same result */
+static int run_benchmark(int iterations)
+{
+    const struct
+    {
+        Uint32 src_format;
+        Uint32 dst_format;
+    } cases[] = {
+        { SDL_PIXELFORMAT_NV12, SDL_PIXELFORMAT_XRGB8888 },
+        { SDL_PIXELFORMAT_IYUV, SDL_PIXELFORMAT_XRGB8888 },
+        { SDL_PIXELFORMAT_YUY2, SDL_PIXELFORMAT_XRGB8888 },
+        { SDL_PIXELFORMAT_XRGB8888, SDL_PIXELFORMAT_NV12 },
+        { SDL_PIXELFORMAT_XRGB8888, SDL_PIXELFORMAT_IYUV },
+        { SDL_PIXELFORMAT_NV12, SDL_PIXELFORMAT_IYUV },
+        { SDL_PIXELFORMAT_XRGB8888, SDL_PIXELFORMAT_ABGR8888 }
+    };
+    const int w = 3840;
+    const int h = 2160;
+    const size_t size = (size_t)w * h * 4;
+    Uint8 *src = (Uint8 *)SDL_malloc(size);
+    Uint8 *dst1 = (Uint8 *)SDL_calloc(1, size);
+    Uint8 *dst2 = (Uint8 *)SDL_calloc(1, size);
+    Uint32 seed = 12345;
+    size_t n;
+    int i, j;
+    int result = -1;
+
+    if (!src || !dst1 || !dst2) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Out of memory");
+        goto done;
+    }
+
+    /* Noise is valid in every format, and makes sure every pixel is converted on its own */
+    for (n = 0; n < size; ++n) {
+        seed = seed * 1103515245 + 12345;
+        src[n] = (Uint8)(seed >> 16);
+    }
+
+    SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Converting %dx%d frames %d times per case\n", w, h, iterations);
+    for (i = 0; i < SDL_arraysize(cases); ++i) {
+        const Uint32 src_format = cases[i].src_format;
+        const Uint32 dst_format = cases[i].dst_format;
+        const int src_pitch = SDL_ISPIXELFORMAT_FOURCC(src_format) ? CalculateYUVPitch(src_format, w) : w * 4;
+        const int dst_pitch = SDL_ISPIXELFORMAT_FOURCC(dst_format) ? CalculateYUVPitch(dst_format, w) : w * 4;
+        Uint64 start, serial, parallel;
+
+        SDL_SetHint("SDL2_PARALLEL_CONVERT", "0");
+        start = SDL_GetPerformanceCounter();
+        for (j = 0; j < iterations; ++j) {
+            if (SDL_ConvertPixels(w, h, src_format, src, src_pitch, dst_format, dst1, dst_pitch) < 0) {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't convert %s to %s: %s\n", SDL_GetPixelFormatName(src_format), SDL_GetPixelFormatName(dst_format), SDL_GetError());
+                goto done;
+            }
+        }
+        serial = SDL_GetPerformanceCounter() - start;
+
+        SDL_SetHint("SDL2_PARALLEL_CONVERT", "1");
+        start = SDL_GetPerformanceCounter();
+        for (j = 0; j < iterations; ++j) {
+            if (SDL_ConvertPixels(w, h, src_format, src, src_pitch, dst_format, dst2, dst_pitch) < 0) {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't convert %s to %s: %s\n", SDL_GetPixelFormatName(src_format), SDL_GetPixelFormatName(dst_format), SDL_GetError());
+                goto done;
+            }
+        }
+        parallel = SDL_GetPerformanceCounter() - start;
+
+        if (SDL_memcmp(dst1, dst2, size) != 0) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Threaded conversion from %s to %s doesn't match\n", SDL_GetPixelFormatName(src_format), SDL_GetPixelFormatName(dst_format));
+            goto done;
+        }
+
+        SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "%s to %s: %.2fms serial, %.2fms threaded (%.1fx)\n",
+                    SDL_GetPixelFormatName(src_format), SDL_GetPixelFormatName(dst_format),
+                    (double)serial * 1000.0 / SDL_GetPerformanceFrequency() / iterations,
+                    (double)parallel * 1000.0 / SDL_GetPerformanceFrequency() / iterations,
+                    parallel ? (double)serial / parallel : 0.0);
+    }
+    result = 0;
+
+done:
+    SDL_SetHint("SDL2_PARALLEL_CONVERT", NULL);
+    SDL_free(src);
+    SDL_free(dst1);
+    SDL_free(dst2);
+    return result;
+}
+
 int main(int argc, char **argv)
 {
     struct
@@ -242,6 +329,8 @@ int main(int argc, char **argv)
         { SDL_TRUE, 33, 3 },
         { SDL_TRUE, 37, 3 },
     };
+    /* Big enough to be split into several bands, including an odd one at the end */
+    const int parallel_test_sizes[] = { 64, 67 };
     int arg = 1;
     const char *filename;
     SDL_Surface *original;
@@ -260,6 +349,7 @@ int main(int argc, char **argv)
     Uint8 *raw_yuv;
     Uint32 then, now, i, iterations = 100;
     SDL_bool should_run_automated_tests = SDL_FALSE;
+    SDL_bool should_run_benchmark = SDL_FALSE;
 
     while (argv[arg] && *argv[arg] == '-') {
         if (SDL_strcmp(argv[arg], "--jpeg") == 0) {
@@ -300,8 +390,10 @@ int main(int argc, char **argv)
             rgb_format = SDL_PIXELFORMAT_BGRA8888;
         } else if (SDL_strcmp(argv[arg], "--automated") == 0) {
             should_run_automated_tests = SDL_TRUE;
+        } else if (SDL_strcmp(argv[arg], "--benchmark") == 0) {
+            should_run_benchmark = SDL_TRUE;
         } else {
-            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Usage: %s [--jpeg|--bt601|-bt709|--auto] [--yv12|--iyuv|--yuy2|--uyvy|--yvyu|--nv12|--nv21] [--rgb555|--rgb565|--rgb24|--argb|--abgr|--rgba|--bgra] [image_filename]\n", argv[0]);
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Usage: %s [--jpeg|--bt601|-bt709|--auto] [--yv12|--iyuv|--yuy2|--uyvy|--yvyu|--nv12|--nv21] [--rgb555|--rgb565|--rgb24|--argb|--abgr|--rgba|--bgra] [--automated|--benchmark] [image_filename]\n", argv[0]);
             return 1;
         }
         ++arg;
@@ -318,9 +410,26 @@ int main(int argc, char **argv)
                 return 2;
             }
         }
+
+        /* Run them again with the conversions split across threads */
+        SDL_SetHint("SDL2_PARALLEL_CONVERT", "4");
+        SDL_SetHint("SDL2_PARALLEL_CONVERT_THRESHOLD", "0");
+        for (i = 0; i < SDL_arraysize(parallel_test_sizes); ++i) {
+            SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Running automated test, pattern size %d, threaded\n", parallel_test_sizes[i]);
+            if (run_automated_tests(parallel_test_sizes[i], 0) < 0 ||
+                run_automated_tests(parallel_test_sizes[i], 3) < 0) {
+                return 2;
+            }
+        }
+        SDL_SetHint("SDL2_PARALLEL_CONVERT", NULL);
+        SDL_SetHint("SDL2_PARALLEL_CONVERT_THRESHOLD", NULL);
         return 0;
     }
 
+    if (should_run_benchmark) {
+        return (run_benchmark(iterations) < 0) ? 2 : 0;
+    }
+
     if (argv[arg]) {
         filename = argv[arg];
     } else {